@@ -0,0 +1,143 @@
+#ifndef ASYNC_HTTP_CLIENT_H
+#define ASYNC_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include "HttpBodySink.h"
+#include "HttpRequestBuffer.h"
+
+/**
+ * Non-blocking HTTP/1.1 request engine over the Arduino Client interface.
+ *
+ * A request is submitted once and then advanced by poll() from the main loop.
+ * Each poll() only does the work that is possible without waiting: it writes
+ * what the socket accepts and parses whatever response bytes have arrived,
+ * so IMU sampling, BLE polling and LED animation keep running while the
+ * request is in flight. The socket is kept alive between requests.
+ */
+class AsyncHttpClient {
+public:
+    enum State {
+        IDLE,
+        CONNECTING,
+        SENDING,
+        READING_STATUS,
+        READING_HEADERS,
+        READING_BODY,
+        COMPLETE,
+        FAILED
+    };
+
+    // Error codes match ArduinoHttpClient so existing status logging still applies
+    static const int ERROR_CONNECTION_FAILED = -1;
+    static const int ERROR_API = -2;
+    static const int ERROR_TIMED_OUT = -3;
+    static const int ERROR_INVALID_RESPONSE = -4;
+
+    static const unsigned long DEFAULT_TIMEOUT_MS = 5000;
+    static const int MAX_BYTES_PER_POLL = 512;      // Response bytes read per poll()
+    static const unsigned int MAX_BODY_LENGTH = 4096;
+    static const unsigned int MAX_ERROR_BODY_LENGTH = 256;
+
+    AsyncHttpClient(Client& transport, const char* host, uint16_t port);
+
+    // Request composition (only while not busy); composed in a fixed buffer
+    bool begin(const char* method, const char* path);
+    void addHeader(const char* name, const char* value);
+    // Preformatted "Name: value\r\n" lines, e.g. a cached header block
+    void addHeaders(const char* lines);
+    // Not copied until submit(), so the body must outlive that call
+    void setBody(const char* body);
+    void setBody(const char* body, size_t length);
+    // Where a 2xx response body goes (reset by begin()). Error bodies are
+    // always kept, up to MAX_ERROR_BODY_LENGTH, for logging.
+    void streamBodyTo(HttpBodySink* sink);
+    void discardBody();
+    // nowMs starts the request timeout; the no-argument forms read millis()
+    bool submit() { return submit(millis()); }
+    bool submit(unsigned long nowMs);
+
+    // Advance the request state machine; never waits for network data
+    State poll() { return poll(millis()); }
+    State poll(unsigned long nowMs);
+
+    State getState() const { return state; }
+    bool isBusy() const { return state != IDLE && state != COMPLETE && state != FAILED; }
+    bool isComplete() const { return state == COMPLETE; }
+    int getStatusCode() const { return statusCode; }
+    const String& getResponseBody() const { return responseBody; }
+    bool wasConnectionReused() const { return connectionReused; }
+    bool hadStaleReconnect() const { return staleReconnect; }
+    // The whole request reached the transport; after a timeout the server
+    // may have acted on it even though no response arrived
+    bool wasRequestSent() const { return requestSent; }
+    // Transport write() calls for the request last sent, and the bytes the
+    // flush ending it pushed out (the whole request when it went in one write)
+    unsigned int getRequestWrites() const { return requestWrites; }
+    unsigned int getFlushBytes() const { return flushBytes; }
+    // Epoch seconds from the response's Date header, 0 if absent
+    uint32_t getServerDate() const { return serverDate; }
+    // Seconds the server asked us to wait (Retry-After), 0 if absent
+    uint32_t getRetryAfterSeconds() const;
+
+    void setTimeout(unsigned long timeoutMs) { timeout = timeoutMs; }
+    unsigned long getTimeout() const { return timeout; }
+    void stop();
+
+private:
+    Client& client;
+    const char* host;
+    uint16_t port;
+
+    State state;
+    unsigned long timeout;
+    unsigned long requestStartTime;
+
+    // Outgoing request
+    HttpRequestBuffer request;
+    const char* requestBody;
+    size_t requestBodyLength;
+    unsigned int bytesSent;
+    bool requestSent;
+    unsigned int requestWrites;
+    unsigned int flushBytes;
+
+    // Connection reuse tracking
+    bool connectionReused;
+    bool staleReconnect;
+    bool receivedAnyByte;
+
+    enum BodyMode { BUFFER_BODY, STREAM_BODY, DISCARD_BODY } bodyMode;
+    HttpBodySink* bodySink;
+
+    // Response parsing
+    char lineBuffer[128];
+    unsigned int lineLength;
+    int statusCode;
+    long contentLength;
+    long bodyBytesRead;
+    bool chunked;
+    bool connectionClose;
+    uint32_t serverDate;
+    uint32_t retryAfterSeconds;
+    uint32_t retryAfterDate;
+    String responseBody;
+
+    enum ChunkState { CHUNK_SIZE, CHUNK_DATA, CHUNK_DATA_END, CHUNK_TRAILER } chunkState;
+    long chunkRemaining;
+
+    void handleConnecting();
+    void handleSending();
+    void handleReading();
+    bool processByte(uint8_t c);
+    bool readLine(uint8_t c);
+    void parseStatusLine();
+    void parseHeaderLine();
+    bool processBodyByte(uint8_t c);
+    void storeBodyByte(uint8_t c);
+    bool retryOnFreshConnection();
+    void finish();
+    void fail(int errorCode);
+};
+
+#endif // ASYNC_HTTP_CLIENT_H
@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <ArduinoBLE.h>
+#include "Orientation.h"
 
 // Configuration State Machine states
 enum ConfigState {
@@ -22,7 +23,7 @@ private:
     String receivedPassword;
     String receivedToken;
     String receivedWorkspaceId;
-    int receivedProjectIds[6];
+    int receivedProjectIds[FACE_COUNT];
     String currentStatus;
     
     // State machine
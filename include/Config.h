@@ -1,15 +1,86 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stdint.h>
+#include "Orientation.h"
+
 // Configuration constants
 namespace Config {
     // Orientation detection
     constexpr float ORIENTATION_THRESHOLD = 0.75f;
-    constexpr unsigned long DEBOUNCE_TIME = 5000;
+    constexpr unsigned long DEBOUNCE_TIME = 500;              // A new face must hold this long to settle
+    constexpr unsigned long ORIENTATION_COALESCE_MS = 6000;   // Hold a face change this long before sending
+    constexpr int ORIENTATION_FILTER_SHIFT = 2;               // IIR low-pass weight 1/2^n per sample
+    // Thresholds are along the face normal and depend on how close neighbouring faces are
+#if TRACKER_FACE_COUNT == 6
+    constexpr int ORIENTATION_ENTER_MG = 800;                 // Filtered projection needed to enter a face
+    constexpr int ORIENTATION_EXIT_MG = 600;                  // Current face held until its projection drops below
+    constexpr int ORIENTATION_CALIBRATED_ENTER_MG = 900;      // Tighter once the board's misalignment is corrected
+    constexpr int ORIENTATION_CALIBRATED_EXIT_MG = 750;
+    constexpr int ORIENTATION_FULL_LEAD_MG = 1024;            // Lead over the next face for 100% confidence
+#elif TRACKER_FACE_COUNT == 8
+    constexpr int ORIENTATION_ENTER_MG = 900;                 // Neighbours 70.5 deg apart, boundary at 816 mg
+    constexpr int ORIENTATION_EXIT_MG = 700;
+    constexpr int ORIENTATION_CALIBRATED_ENTER_MG = 950;
+    constexpr int ORIENTATION_CALIBRATED_EXIT_MG = 850;
+    constexpr int ORIENTATION_FULL_LEAD_MG = 640;
+#else
+    constexpr int ORIENTATION_ENTER_MG = 920;                 // Neighbours 63.4 deg apart, boundary at 851 mg
+    constexpr int ORIENTATION_EXIT_MG = 780;
+    constexpr int ORIENTATION_CALIBRATED_ENTER_MG = 960;
+    constexpr int ORIENTATION_CALIBRATED_EXIT_MG = 880;
+    constexpr int ORIENTATION_FULL_LEAD_MG = 512;
+#endif
+    
+    // IMU calibration (ImuCalibrator): bias and axis correction from a capture on each face
+    constexpr int CALIBRATION_CAPTURE_SAMPLES = 26;           // Samples at rest averaged per face
+    constexpr int CALIBRATION_MAX_RESIDUAL_MG = 60;           // Worse fits are rejected (cube not flat, wrong face)
+    
+    // Motion gating: no face settles and no change is sent while the cube is moving
+    constexpr uint32_t MOTION_ACCEL_VARIANCE = 2500;          // mg^2 over ~0.6 s, summed over axes
+    constexpr int16_t MOTION_GYRO_DPS = 30;                   // Any axis above this is moving
+    constexpr unsigned long MOTION_REST_MS = 300;             // Quiet this long before it is at rest again
+    
+    // IMU sampling: the sensor FIFO collects samples that are read in one burst per batch
+    constexpr bool IMU_FIFO_ENABLED = true;
+    constexpr uint16_t IMU_FIFO_RATE_HZ = 26;
+    constexpr uint16_t IMU_FIFO_WATERMARK = 13;               // ~0.5 s of samples per batch
+    constexpr int IMU_MAX_BATCH = 32;
+    constexpr bool IMU_TRACE_ENABLED = false;                 // Stream raw samples over Serial (tools/trace_replay)
+    
+    // IMU events: the sensor's 6D and wake-up interrupts gate sampling where INT1 is wired
+    constexpr bool IMU_EVENTS_ENABLED = true;
+    constexpr uint16_t IMU_WAKE_THRESHOLD_MG = 125;           // Slope between samples that counts as motion
+    constexpr unsigned long IMU_AWAKE_MS = 3000;              // Keep sampling this long after the last event
+    constexpr unsigned long IMU_IDLE_LOOP_DELAY = 1000;       // Longest sleep between loops with nothing to do
+    
+    // IMU taps: the sensor's tap engine on INT1; a double tap pauses and resumes the timer (TimerPause).
+    // The trade-off: it keeps the accelerometer at 416 Hz high-performance, also while still, which
+    // costs most of the adaptive-rate saving (IMU_TAP_STILL_CURRENT_UA). Turn off for the lowest current.
+    constexpr bool IMU_TAPS_ENABLED = true;
+    constexpr uint16_t IMU_TAP_THRESHOLD_MG = 750;            // Shock on any axis; setting the cube down is filtered as motion
+
+    // Adaptive rate: a cube left alone drops to a low-power rate and is read about once a second
+    constexpr bool IMU_ADAPTIVE_RATE = true;
+    constexpr uint16_t IMU_STILL_RATE_HZ = 12;                // 12.5 Hz low-power mode, gyroscope off
+    constexpr unsigned long IMU_STILL_AFTER_MS = 2000;        // Nothing going on this long before stepping down
+    constexpr unsigned long IMU_ACTIVE_CURRENT_UA = 550;      // LSM6DSOX typicals, for the saving estimate only:
+    constexpr unsigned long IMU_STILL_CURRENT_UA = 10;        //   accel + gyro at 104 Hz vs accel alone low-power,
+    constexpr unsigned long IMU_TAP_STILL_CURRENT_UA = 170;   //   or accel alone at 416 Hz for the tap engine
     
     // Network settings
     constexpr int TOGGL_PORT = 443;
     constexpr char TOGGL_SERVER[] = "api.track.toggl.com";
+    constexpr bool TOGGL_SWITCH_IN_ONE_REQUEST = true;  // Rely on Toggl stopping the running entry
+    constexpr uint32_t TOGGL_RECONCILE_START_TOLERANCE_S = 30;  // Running entry counts as ours within this
+    
+    // Toggl request scheduling (RequestScheduler)
+    constexpr unsigned long TOGGL_RATE_REFILL_MS = 1000;        // Toggl allows ~1 request/s per token
+    constexpr int TOGGL_RATE_BURST = 2;                         // Requests per endpoint sent back to back
+    constexpr unsigned long TOGGL_RETRY_MIN_MS = 5000;
+    constexpr unsigned long TOGGL_RETRY_MAX_MS = 300000;
+    constexpr int TOGGL_BREAKER_THRESHOLD = 5;                  // Consecutive service failures
+    constexpr unsigned long TOGGL_BREAKER_OPEN_MS = 120000;     // Before a single probe is let through
     
     // Serial communication
     constexpr int SERIAL_BAUD = 115200;
@@ -17,6 +88,7 @@ namespace Config {
     
     // LED settings
     constexpr int LED_MAX_INTENSITY = 100;
+    constexpr int LED_PAUSED_INTENSITY = 15;                  // Face colour while its timer is paused
     
     // Timing constants
     constexpr unsigned long SERIAL_TIMEOUT_MS = 3000;
@@ -35,8 +107,21 @@ namespace Config {
     constexpr unsigned long ERROR_DISPLAY_DELAY = 2000;
     constexpr unsigned long SUCCESS_DISPLAY_DELAY = 2000;
     
+    // Flash storage layout (offsets within the reserved storage area)
+    constexpr uint32_t FLASH_STORAGE_SIZE = 32768;
+    constexpr uint32_t JOURNAL_FLASH_OFFSET = 0;
+    constexpr uint32_t JOURNAL_FLASH_SIZE = 16384;
+    constexpr uint32_t CONFIG_FLASH_OFFSET = 16384;           // Two slots (A/B) of 4 KB
+    constexpr uint32_t CONFIG_FLASH_SIZE = 8192;
+    constexpr uint32_t STATE_FLASH_OFFSET = 24576;            // KvStore log: calibration, running entry, counters
+    constexpr uint32_t STATE_FLASH_SIZE = 8192;
+    constexpr unsigned long STATE_COUNTERS_SAVE_MS = 600000;  // Lifetime diagnostics counters at most this often
+    
+    // Offline event journal replay
+    constexpr unsigned long JOURNAL_LIVE_WINDOW_MS = 10000;    // Younger events use server time
+    
     // Default project IDs (for testing)
-    extern int DEFAULT_PROJECT_IDS[6];
+    extern int DEFAULT_PROJECT_IDS[FACE_COUNT];
     
     // Project mapping indices
     enum OrientationIndex {
@@ -47,10 +132,6 @@ namespace Config {
         FRONT_EDGE_IDX = 4,
         BACK_EDGE_IDX = 5
     };
-    
-    // Color definitions for BLE setup mode
-    constexpr int BLE_SETUP_COLOR[3] = {0, 0, 128}; // Dim blue
-    constexpr int SUCCESS_COLOR[3] = {0, 255, 0};   // Green
 }
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -2,10 +2,9 @@
 #define CONFIG_STORAGE_H
 
 #include <Arduino.h>
-
-// For now, use a simple memory-based approach for configuration storage
-// This will persist for the duration of the power cycle, suitable for BLE config
-// TODO: Implement proper flash storage for production
+#include "ImuCalibration.h"
+#include "FlashRegion.h"
+#include "KvStore.h"
 
 // Configuration storage structure
 struct StoredConfig {
@@ -15,31 +14,68 @@ struct StoredConfig {
     char wifiPassword[64];      // WiFi password  
     char togglToken[256];       // Toggl API token
     char workspaceId[16];       // Toggl workspace ID
-    int projectIds[6];          // Project IDs for each orientation
+    int projectIds[FACE_COUNT]; // Project IDs for each orientation
     uint32_t lastUpdateTime;    // Last update timestamp
     bool isValid;               // Configuration validity flag
 };
 
+// Start of each flash slot; the config follows it. An erased header reads as all 0xFF.
+struct ConfigSlotHeader {
+    uint32_t magic;             // CONFIG_SLOT_MAGIC once the slot was written completely
+    uint32_t sequence;          // Higher is newer
+    uint16_t length;            // sizeof(StoredConfig) when written
+    uint16_t crc;               // CRC-16 over the config, then sequence and length
+};
+
 // Backup configuration structure
 struct BackupConfig {
     StoredConfig config;
     bool hasBackup;
 };
 
+/**
+ * The BLE configuration and IMU calibration, kept across power cycles.
+ *
+ * The calibration belongs to the device and changes on its own, so it is a
+ * KvStore record (KV_KEY_IMU_CALIBRATION) when a store is given: saving or
+ * clearing it appends a few dozen bytes instead of rewriting a config slot.
+ * Without a store it is kept in RAM.
+ *
+ * With a flash region the config is stored in two slots (A/B), each half of
+ * the region. Every save goes to the slot not holding the current copy:
+ * erase, program the config, then program the header last. A power cut at
+ * any point leaves the previous copy intact, and the torn slot fails its
+ * magic or CRC check. Loading reads both headers and takes the newest slot
+ * whose CRC checks out: at most four reads however often it was saved.
+ * Without a region (default constructor) the config lives in RAM only.
+ */
 class ConfigStorage {
 private:
-    static const uint16_t CONFIG_VERSION = 1;
-    static const int EEPROM_SIZE = 1024;
-    static const int CONFIG_START_ADDRESS = 0;
+    static const uint16_t CONFIG_VERSION = 3;
+    static const uint32_t CONFIG_SLOT_MAGIC = 0x54434647;   // "TCFG"
     
     StoredConfig config;
     BackupConfig backup;
+    ImuCalibrationData calibration;
+    FlashRegion* flash;
+    KvStore* state;
+    int activeSlot;             // Slot holding the current copy, or -1
+    uint32_t slotSequence;      // Sequence of that copy
+    bool flashHealthy;
     
     uint16_t calculateChecksum(const StoredConfig& cfg) const;
     bool validateChecksum(const StoredConfig& cfg) const;
+    
+    uint32_t slotSize() const;
+    bool slotsUsable() const;
+    bool readSlot(int slot, ConfigSlotHeader& header);
+    bool readNewestSlot();
+    bool store();
+    static uint16_t slotCrc(const StoredConfig& cfg, const ConfigSlotHeader& header);
 
 public:
     ConfigStorage();
+    explicit ConfigStorage(FlashRegion& flashRegion, KvStore* stateStore = nullptr);
     
     bool begin();
     bool saveConfiguration(const String& ssid, const String& password, 
@@ -57,6 +93,18 @@ public:
     const int* getProjectIds() const { return config.projectIds; }
     bool isConfigValid() const { return config.isValid; }
     
+    // IMU calibration (independent of the BLE configuration being valid)
+    bool saveCalibration(const ImuCalibrationData& data);
+    bool hasCalibration() const { return calibration.valid != 0; }
+    const ImuCalibrationData& getCalibration() const { return calibration; }
+    void clearCalibration();
+    
+    // Reset-twice gesture: a reset while the previous boot was still starting
+    // up asks for BLE setup again, so a provisioned cube can be reconfigured
+    // and recalibrated. Check at the start of setup(); finish once it is done.
+    bool checkSetupRequest();
+    void finishStartup();
+    
     // Validation methods
     bool validateWiFiCredentials(const String& ssid, const String& password) const;
     bool validateTogglCredentials(const String& token, const String& workspace) const;
@@ -73,6 +121,9 @@ public:
     uint32_t getLastUpdateTimestamp() const;
     bool isStorageHealthy() const;
     size_t getStorageUsage() const;
+    bool isPersistent() const { return flash != nullptr; }
+    int getActiveSlot() const { return activeSlot; }
+    uint32_t getSlotSequence() const { return slotSequence; }
     
     // Debug
     void printConfiguration() const;
@@ -1,6 +1,8 @@
 #ifndef CONFIGURATION_H
 #define CONFIGURATION_H
 
+#include "Orientation.h"
+
 // WiFi Configuration
 extern const char *ssid;
 extern const char *password;
@@ -9,11 +11,11 @@ extern const char *password;
 extern const char *togglApiToken;
 extern const int workspaceId;
 
-// Project names for each orientation (for display purposes)
-extern const char* projectNames[6];
+// Project names for each orientation (for display purposes; nullptr for unnamed faces)
+extern const char* projectNames[FACE_COUNT];
 
 // Direct Toggl project ID mapping for each orientation
 // Set to 0 to disable orientation, or use actual Toggl project ID
-extern const int orientationProjectIds[6];
+extern const int orientationProjectIds[FACE_COUNT];
 
 #endif // CONFIGURATION_H
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlashRegion.h"
+
+enum class JournalEventType : uint8_t {
+    START = 1,   // Timer started for an orientation
+    STOP = 2,    // Running timer stopped
+    COMMIT = 3   // All events up to 'timestamp' (a sequence number) were delivered
+};
+
+// One 16-byte journal slot; an erased slot reads back as all 0xFF
+struct JournalRecord {
+    uint32_t sequence;
+    uint32_t timestamp;     // Epoch seconds, or millis() of bootId with FLAG_RELATIVE_TIME
+    uint16_t bootId;
+    uint8_t type;           // JournalEventType
+    uint8_t orientation;
+    uint8_t flags;
+    uint8_t reserved;
+    uint16_t crc;
+};
+
+/**
+ * Write-ahead journal of timer start/stop intents in a flash ring buffer.
+ *
+ * Every orientation change is appended before any network request is made,
+ * so tracked time survives WiFi outages, Toggl errors and power loss. Records
+ * are never rewritten; delivery is marked by appending COMMIT records. When
+ * the ring wraps, the oldest sector is erased and any undelivered events in
+ * it are counted as dropped.
+ */
+class EventJournal {
+public:
+    static const uint8_t FLAG_RELATIVE_TIME = 0x01;
+    static const uint32_t ERASED_SEQUENCE = 0xFFFFFFFF;
+
+    explicit EventJournal(FlashRegion& flashRegion);
+
+    /**
+     * Scan flash and rebuild the in-RAM state
+     * @return false if the flash region is unusable
+     */
+    bool begin();
+    bool format();
+    bool isReady() const { return ready; }
+
+    /**
+     * Append an intent. With epoch == 0 (server time not known yet) the event is
+     * stored relative to millis() of the current boot.
+     */
+    bool recordStart(uint8_t orientation, uint32_t epoch, unsigned long nowMs);
+    bool recordStop(uint32_t epoch, unsigned long nowMs);
+
+    /**
+     * Read up to maxRecords undelivered START/STOP records, oldest first
+     */
+    int readPending(JournalRecord* out, int maxRecords);
+    bool commitThrough(uint32_t sequence);
+
+    bool hasPending() const { return lastEventSequence > committedThrough; }
+    bool isSegmentOpen() const { return segmentOpen; }
+    uint8_t getOpenOrientation() const { return segmentOrientation; }
+    uint16_t getBootId() const { return bootId; }
+    uint32_t getDroppedEvents() const { return droppedEvents; }
+    uint32_t getCommittedSequence() const { return committedThrough; }
+    uint32_t countPending();
+
+private:
+    FlashRegion& flash;
+    bool ready;
+
+    uint32_t slotCount;
+    uint32_t slotsPerSector;
+    uint32_t headSlot;          // Next slot to write
+    uint32_t oldestSlot;        // Slot holding the oldest record
+    uint32_t scanSlot;          // No undelivered events before this slot
+    bool full;                  // Every slot written: headSlot == oldestSlot, not an empty ring
+    uint32_t nextSequence;
+    uint32_t lastEventSequence;
+    uint32_t committedThrough;
+    uint16_t bootId;
+    bool segmentOpen;
+    uint8_t segmentOrientation;
+    uint32_t droppedEvents;
+
+    bool append(JournalEventType type, uint8_t orientation, uint32_t timestamp, uint8_t flags);
+    bool writeSlot(JournalEventType type, uint8_t orientation, uint32_t timestamp, uint8_t flags);
+    bool prepareSector(uint32_t slot, bool& erased);
+    bool readSlot(uint32_t slot, JournalRecord& record);
+    uint32_t slotsToScan() const;
+    bool isSlotErased(uint32_t slot);
+    static bool isEvent(const JournalRecord& record);
+};
+
+#endif // EVENT_JOURNAL_H
@@ -0,0 +1,40 @@
+#ifndef FACE_TABLE_H
+#define FACE_TABLE_H
+
+#include <stdint.h>
+#include "Orientation.h"
+
+// Unit vector read by the accelerometer when a face is the active one, Q14 (16384 = 1 g)
+struct FaceNormal {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+/**
+ * Face normals of the supported trackers, in the sensor frame.
+ *
+ * Every table starts with the face read along +z (or the one nearest it) and
+ * lists opposite faces in pairs, so face ^ 1 is the face underneath. A sample
+ * is classified as the face whose normal it projects onto most. The projection
+ * is three multiplies and a shift per face: no floats and no division.
+ */
+namespace FaceTable {
+    static const int NORMAL_SHIFT = 14;
+
+    // Table for this build's FACE_COUNT
+    const FaceNormal* normals();
+    // Table for any supported count (6, 8, 10 or 12), or nullptr
+    const FaceNormal* forCount(int faceCount);
+
+    // Component of v (milli-g) along a face normal, in milli-g
+    inline int32_t project(const FaceNormal& normal, const int32_t v[3]) {
+        // |n| <= 2^14 and |v| < 2^15: the sum stays within 32 bits
+        return (normal.x * v[0] + normal.y * v[1] + normal.z * v[2]) >> NORMAL_SHIFT;
+    }
+
+    // Face with the largest projection of v; its projection and the runner-up's
+    int nearest(const FaceNormal* table, int count, const int32_t v[3], int32_t& best, int32_t& second);
+}
+
+#endif // FACE_TABLE_H
@@ -0,0 +1,58 @@
+#ifndef FLASH_REGION_H
+#define FLASH_REGION_H
+
+#include <stdint.h>
+
+/**
+ * Byte-addressed window onto erasable flash.
+ *
+ * Follows NOR flash semantics: erase() sets whole sectors to 0xFF and
+ * program() can only clear bits, so a location is written once per erase.
+ * Offsets are relative to the start of the region.
+ */
+class FlashRegion {
+public:
+    virtual ~FlashRegion() {}
+
+    virtual uint32_t size() const = 0;
+    virtual uint32_t sectorSize() const = 0;
+
+    virtual bool read(uint32_t offset, void* data, uint32_t length) = 0;
+    virtual bool program(uint32_t offset, const void* data, uint32_t length) = 0;
+    virtual bool eraseSector(uint32_t offset) = 0;
+};
+
+/**
+ * Slice of the MCU's internal flash reserved for TimeTracker storage
+ * (see Config::FLASH_STORAGE_SIZE for the layout).
+ *
+ * RP2040 Connect: last sectors of the QSPI flash via mbed::FlashIAP.
+ * Nano 33 IoT: page-aligned array in the SAMD21 NVM, written through NVMCTRL.
+ */
+class InternalFlash : public FlashRegion {
+public:
+    InternalFlash(uint32_t regionOffset, uint32_t regionSize);
+
+    bool begin();
+
+    uint32_t size() const override { return regionSize; }
+    uint32_t sectorSize() const override { return eraseSize; }
+
+    bool read(uint32_t offset, void* data, uint32_t length) override;
+    bool program(uint32_t offset, const void* data, uint32_t length) override;
+    bool eraseSector(uint32_t offset) override;
+
+private:
+    uint32_t regionOffset;
+    uint32_t regionSize;
+    uint32_t baseAddress;
+    uint32_t eraseSize;
+    uint32_t pageSize;
+    bool initialized;
+
+    bool inRange(uint32_t offset, uint32_t length) const {
+        return initialized && offset <= regionSize && length <= regionSize - offset;
+    }
+};
+
+#endif // FLASH_REGION_H
@@ -0,0 +1,16 @@
+#ifndef HTTP_BODY_SINK_H
+#define HTTP_BODY_SINK_H
+
+#include <stdint.h>
+
+/**
+ * Receives a response body byte by byte as AsyncHttpClient decodes it,
+ * so the body never has to be buffered in RAM.
+ */
+class HttpBodySink {
+public:
+    virtual ~HttpBodySink() {}
+    virtual void onBodyByte(uint8_t c) = 0;
+};
+
+#endif // HTTP_BODY_SINK_H
@@ -0,0 +1,41 @@
+#ifndef HTTP_REQUEST_BUFFER_H
+#define HTTP_REQUEST_BUFFER_H
+
+#include <stddef.h>
+
+/**
+ * Fixed-size buffer an outgoing HTTP/1.1 request is composed in.
+ *
+ * Replaces String concatenation so a request costs no heap allocations.
+ * Anything that does not fit sets overflowed() instead of being truncated
+ * silently. Arduino-free so the host benchmarks in tools/ can link it.
+ */
+class HttpRequestBuffer {
+public:
+    static const size_t CAPACITY = 768;
+
+    HttpRequestBuffer();
+
+    void begin(const char* method, const char* path, const char* host);
+    void addHeader(const char* name, const char* value);
+    // Preformatted header lines, each ending in "\r\n"
+    void addRaw(const char* text);
+    void addRaw(const char* text, size_t length);
+    // Content-Length (when there is a body), keep-alive and the body itself
+    void finish(const char* body, size_t bodyLength);
+    void clear();
+
+    const char* data() const { return buffer; }
+    size_t length() const { return used; }
+    bool isEmpty() const { return used == 0; }
+    bool overflowed() const { return overflow; }
+
+private:
+    char buffer[CAPACITY];
+    size_t used;
+    bool overflow;
+
+    void appendNumber(unsigned long value);
+};
+
+#endif // HTTP_REQUEST_BUFFER_H
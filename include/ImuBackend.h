@@ -0,0 +1,127 @@
+#ifndef IMU_BACKEND_H
+#define IMU_BACKEND_H
+
+#include <stdint.h>
+
+// One accelerometer reading in milli-g (integer, so classification needs no soft-float)
+struct AccelSample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+// Angular rate in degrees per second
+struct GyroSample {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+};
+
+// Sensor events latched by the interrupt engines (bits returned by takeEvents())
+enum ImuEvent : uint8_t {
+    IMU_EVENT_ORIENTATION = 0x01,   // 6D engine: the dominant axis changed
+    IMU_EVENT_MOTION = 0x02,        // Wake-up engine: acceleration slope above the threshold
+    IMU_EVENT_SINGLE_TAP = 0x04,    // Tap engine: one shock on any axis
+    IMU_EVENT_DOUBLE_TAP = 0x08     // Tap engine: two shocks within the double-tap window
+};
+
+/**
+ * Source of accelerometer samples for OrientationDetector.
+ *
+ * Without a FIFO every sample is a status read plus a data read on the bus.
+ * With enableFifo() the sensor buffers samples itself and readSamples()
+ * drains them in a single burst. Implementations count their bus
+ * transactions so the two modes can be compared.
+ *
+ * Sensors with orientation and wake-up engines can also raise an interrupt
+ * (enableEvents()), so the detector only reads samples after an event. A
+ * tap engine (enableTaps()) reports taps the same way; tapping is far too
+ * short for the sample rate to catch.
+ */
+class ImuBackend {
+public:
+    virtual ~ImuBackend() {}
+
+    virtual bool begin() = 0;
+    // Buffer samples in the sensor at rateHz; false if the sensor has no usable FIFO
+    virtual bool enableFifo(uint16_t watermark, uint16_t rateHz) = 0;
+    // Samples ready to read (FIFO level, or 0/1 when polling)
+    virtual int available() = 0;
+    // Read up to maxSamples, oldest first; returns the number read
+    virtual int readSamples(AccelSample* samples, int maxSamples) = 0;
+    // True once if the FIFO filled up and dropped samples since the last call
+    virtual bool takeOverrun() = 0;
+
+    // Raise an interrupt on a 6D face change or movement above wakeThresholdMg;
+    // false if the sensor or its interrupt line is not available
+    virtual bool enableEvents(uint16_t wakeThresholdMg) { return false; }
+    // Interrupt line state, no bus traffic
+    virtual bool eventPending() { return false; }
+    // Read and clear the latched event sources (ImuEvent bits)
+    virtual uint8_t takeEvents() { return 0; }
+    // Also report single and double taps above thresholdMg through takeEvents();
+    // needs enableEvents() first, false if the sensor has no tap engine
+    virtual bool enableTaps(uint16_t thresholdMg) { return false; }
+
+    // Current angular rate; false if the sensor has no gyroscope
+    virtual bool readGyro(GyroSample& rate) { return false; }
+
+    // Accelerometer (and FIFO) down to rateHz in low-power mode with the gyroscope
+    // off, or back to the rates set by begin()/enableFifo(); false if not supported
+    virtual bool setLowPower(bool enabled, uint16_t rateHz) { return false; }
+
+    unsigned long getBusTransactions() const { return busTransactions; }
+
+protected:
+    unsigned long busTransactions = 0;
+};
+
+/**
+ * On-board LSM6DSOX (RP2040 Connect) or LSM6DS3 (Nano 33 IoT).
+ *
+ * The Arduino IMU library brings the sensor up (104 Hz, +-4 g); the FIFO
+ * is configured over Wire directly since the library does not expose it.
+ * The chip is told apart by WHO_AM_I, as the two FIFOs differ: tagged
+ * 7-byte words on the LSM6DSOX, untagged 16-bit words on the LSM6DS3.
+ * Both route their 6D and wake-up engines to INT1 with latched interrupts;
+ * events are only offered where the board wires INT1 to the MCU.
+ * Low-power mode rewrites the rates the library set up and drops the
+ * accelerometer out of high-performance mode. The tap engine needs the
+ * accelerometer at 416 Hz, so with taps on it stays there (high
+ * performance) in low-power mode too and only the gyroscope and the FIFO
+ * slow down.
+ */
+class LSM6DSBackend : public ImuBackend {
+public:
+    LSM6DSBackend();
+
+    bool begin() override;
+    bool enableFifo(uint16_t watermark, uint16_t rateHz) override;
+    int available() override;
+    int readSamples(AccelSample* samples, int maxSamples) override;
+    bool takeOverrun() override;
+    bool enableEvents(uint16_t wakeThresholdMg) override;
+    bool eventPending() override;
+    uint8_t takeEvents() override;
+    bool enableTaps(uint16_t thresholdMg) override;
+    bool readGyro(GyroSample& rate) override;
+    bool setLowPower(bool enabled, uint16_t rateHz) override;
+
+private:
+    enum Chip { CHIP_UNKNOWN, CHIP_LSM6DSOX, CHIP_LSM6DS3 };
+
+    Chip chip;
+    bool fifoEnabled;
+    bool overrun;
+    int fifoLevel;       // Samples in the FIFO at the last status read
+    bool eventsEnabled;
+    bool tapsEnabled;
+    uint8_t fifoRate;    // Rate code set by enableFifo(), restored after low-power mode
+
+    bool readRegisters(uint8_t reg, uint8_t* data, int length);
+    bool writeRegister(uint8_t reg, uint8_t value);
+    int readFifoLevel();
+    static uint8_t rateCode(uint16_t rateHz);
+};
+
+#endif // IMU_BACKEND_H
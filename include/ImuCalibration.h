@@ -0,0 +1,104 @@
+#ifndef IMU_CALIBRATION_H
+#define IMU_CALIBRATION_H
+
+#include <stdint.h>
+#include "Orientation.h"
+#include "ImuBackend.h"
+#include "Config.h"
+
+// Per-device correction, kept by ConfigStorage as a KvStore record
+struct ImuCalibrationData {
+    int16_t bias[3];      // Zero-g offset in milli-g, removed first
+    int16_t matrix[9];    // Row-major axis correction, Q14 (16384 = 1.0)
+    uint8_t valid;
+    uint8_t reserved;
+};
+
+// Calibration characteristic commands (one byte written by the app)
+enum CalibrationCommand : uint8_t {
+    CALIBRATION_COMMAND_CLEAR = 0x00,   // Drop the stored calibration
+    CALIBRATION_COMMAND_START = 0x01    // Capture each face in turn, then solve and store
+};
+
+/**
+ * Corrects accelerometer samples for a board mounted off true in the cube.
+ *
+ * A sample m becomes C (m - b): the bias b is the sensor's zero-g offset,
+ * and C undoes the rotation, scale and cross-axis error between the sensor
+ * axes and the face normals. apply() is integer only (Q14, nine multiplies
+ * per sample) so it can run on every sample read. solve() is the one-off
+ * float computation from a gravity capture on each of the six faces.
+ */
+class ImuCalibration {
+public:
+    static const int MATRIX_SHIFT = 14;
+
+    ImuCalibration();
+
+    // Invalid data clears the correction
+    void set(const ImuCalibrationData& data);
+    void clear();
+    bool isValid() const { return valid; }
+    const ImuCalibrationData& getData() const { return data; }
+
+    void apply(AccelSample* samples, int count) const;
+
+    // Fit from the mean gravity reading on each face (Orientation order, milli-g).
+    // False if the captures do not look like six faces of a cube at rest.
+    static bool solve(const AccelSample faces[6], ImuCalibrationData& result, int* worstResidualMg = nullptr);
+
+private:
+    ImuCalibrationData data;
+    bool valid;
+};
+
+enum CalibrationState {
+    CALIBRATION_IDLE,
+    CALIBRATION_CAPTURING,   // Waiting for the cube to rest on a face not captured yet
+    CALIBRATION_DONE,
+    CALIBRATION_FAILED
+};
+
+/**
+ * Calibration session: the cube is set on each face in turn, in any order.
+ *
+ * Samples are fed as they are read, with the correction off. A face is
+ * captured once CALIBRATION_CAPTURE_SAMPLES in a row were read on it at
+ * rest; movement or a different face starts the average over. The face is
+ * recognised from the raw dominant axis, which a board tilted by less than
+ * 45 degrees still gets right. After the sixth face the calibration is
+ * solved and the session ends as done or failed. The six poses are the
+ * sensor axes pointing up and down: a cube's faces, or a cube-shaped jig for
+ * trackers with more faces.
+ */
+class ImuCalibrator {
+public:
+    ImuCalibrator();
+
+    void start();
+    void cancel();
+    // True when these samples completed a face
+    bool addSamples(const AccelSample* samples, int count, bool moving);
+
+    CalibrationState getState() const { return state; }
+    int getCapturedCount() const;
+    bool hasCaptured(Orientation face) const { return face >= FACE_UP && face <= BACK_EDGE && captured[face]; }
+    Orientation getLastCaptured() const { return lastCaptured; }
+    const ImuCalibrationData& getResult() const { return result; }
+    int getWorstResidual() const { return worstResidual; }
+
+private:
+    CalibrationState state;
+    AccelSample means[6];
+    bool captured[6];
+    Orientation lastCaptured;
+    Orientation capturing;
+    int32_t sum[3];
+    int count;
+    ImuCalibrationData result;
+    int worstResidual;
+
+    void restart(Orientation face);
+};
+
+#endif // IMU_CALIBRATION_H
@@ -0,0 +1,69 @@
+#ifndef IMU_RATE_GOVERNOR_H
+#define IMU_RATE_GOVERNOR_H
+
+#include <stdint.h>
+#include "Config.h"
+
+class SystemDiagnostics;
+
+struct ImuRateStats {
+    unsigned long stepsDown;   // Active -> still
+    unsigned long stepsUp;     // Still -> active on the first sign of movement
+    unsigned long activeMs;    // Time at each rate in finished periods
+    unsigned long stillMs;
+};
+
+/**
+ * Picks the rate OrientationDetector samples at.
+ *
+ * Readings come in at the active rate while anything is going on: movement,
+ * a face that has not settled yet, a sensor event. Once none of that has
+ * been seen for the still time the detector drops the sensor to its
+ * low-power rate and reads about once a second; the first sign of activity
+ * in a reading brings the active rate straight back. Time is passed in, so
+ * the governor runs under a virtual clock in tests.
+ */
+class ImuRateGovernor {
+public:
+    explicit ImuRateGovernor(unsigned long stillAfterMs = Config::IMU_STILL_AFTER_MS);
+
+    // Start at the active rate
+    void start(unsigned long nowMs);
+    // Something is going on; true if this left the still rate
+    bool onActivity(unsigned long nowMs);
+    // A reading with nothing going on; true if this entered the still rate
+    bool onQuiet(unsigned long nowMs);
+
+    bool isStill() const { return still; }
+    // Time at each rate so far, including the current period
+    unsigned long getActiveMs(unsigned long nowMs) const;
+    unsigned long getStillMs(unsigned long nowMs) const;
+    const ImuRateStats& getStats() const { return stats; }
+    void setStillAfter(unsigned long stillAfterMs) { stillAfter = stillAfterMs; }
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics) { diagnostics = systemDiagnostics; }
+
+    // Estimated sensor supply current averaged over the two rates, and the saving
+    // against staying at the active rate (percent), from the Config typicals.
+    // stillCurrentUa is what the sensor draws at the still rate: see stillCurrentUa(taps)
+    static unsigned long averageCurrentUa(unsigned long activeMs, unsigned long stillMs,
+                                          unsigned long stillCurrentUa = Config::IMU_STILL_CURRENT_UA);
+    static int savingPercent(unsigned long activeMs, unsigned long stillMs,
+                             unsigned long stillCurrentUa = Config::IMU_STILL_CURRENT_UA);
+    // The tap engine holds the accelerometer at its own rate while still
+    static unsigned long stillCurrentUa(bool tapsEnabled) {
+        return tapsEnabled ? Config::IMU_TAP_STILL_CURRENT_UA : Config::IMU_STILL_CURRENT_UA;
+    }
+
+private:
+    unsigned long stillAfter;
+    bool started;
+    bool still;
+    unsigned long since;          // Start of the current period
+    unsigned long lastActivity;
+    ImuRateStats stats;
+    SystemDiagnostics* diagnostics;
+
+    void setStill(bool nowStill, unsigned long nowMs);
+};
+
+#endif // IMU_RATE_GOVERNOR_H
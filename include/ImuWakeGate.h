@@ -0,0 +1,47 @@
+#ifndef IMU_WAKE_GATE_H
+#define IMU_WAKE_GATE_H
+
+#include <stdint.h>
+#include "Config.h"
+
+struct ImuWakeStats {
+    unsigned long wakeups;            // Idle -> sampling transitions
+    unsigned long orientationEvents;  // 6D engine reported a face change
+    unsigned long motionEvents;       // Wake-up engine reported movement
+    unsigned long awakeMs;            // Sampling time in finished awake periods
+};
+
+/**
+ * Decides when OrientationDetector reads samples if the sensor raises
+ * interrupts (ImuBackend::enableEvents()).
+ *
+ * Any event keeps the detector sampling for the awake window, measured from
+ * the latest event, long enough for the classifier and the debouncer to
+ * settle a new face. Outside the window the detector reads nothing and the
+ * loop can sleep until the next interrupt. Time is passed in, so the gate
+ * runs under a virtual clock in tests.
+ */
+class ImuWakeGate {
+public:
+    explicit ImuWakeGate(unsigned long awakeWindowMs = Config::IMU_AWAKE_MS);
+
+    // Start a window without counting a wakeup (boot, first classification)
+    void start(unsigned long nowMs);
+    // Events taken from the sensor (ImuEvent bits); true if this woke the detector
+    bool onEvents(uint8_t events, unsigned long nowMs);
+
+    bool isAwake(unsigned long nowMs) const { return started && nowMs - awakeSince < awakeUntil - awakeSince; }
+    // Sampling time so far, including a window still open
+    unsigned long getAwakeMs(unsigned long nowMs) const;
+    void setWindow(unsigned long awakeWindowMs) { window = awakeWindowMs; }
+    const ImuWakeStats& getStats() const { return stats; }
+
+private:
+    unsigned long window;
+    bool started;
+    unsigned long awakeSince;
+    unsigned long awakeUntil;
+    ImuWakeStats stats;
+};
+
+#endif // IMU_WAKE_GATE_H
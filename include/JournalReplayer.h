@@ -0,0 +1,70 @@
+#ifndef JOURNAL_REPLAYER_H
+#define JOURNAL_REPLAYER_H
+
+#include <Arduino.h>
+#include "EventJournal.h"
+#include "TogglAPI.h"
+
+struct JournalReplayStats {
+    unsigned long requestsSent;
+    unsigned long entriesCollapsed;  // START/STOP pairs sent as one completed entry
+    unsigned long eventsDiscarded;   // Rejected by Toggl or without a usable timestamp
+    unsigned long retries;           // Transient failures that triggered a backoff
+    unsigned long outcomesReconciled; // Timed-out requests settled from the running entry
+};
+
+/**
+ * Drains the EventJournal into Toggl, one request at a time, from the main loop.
+ *
+ * Recent events are sent as plain start/stop calls, at their recorded time
+ * when the server clock is known. A segment whose start and end are both
+ * journaled (e.g. recorded while offline) is sent as a single completed entry
+ * with explicit start and duration. A live stop followed by a live start is
+ * sent as one switch request while TogglAPI::canSwitch() holds.
+ *
+ * A request that timed out after being sent is reconciled against the
+ * running entry before anything else goes out, and only resent if it never
+ * took effect. Network errors, auth errors, 5xx and 429 responses are retried
+ * once TogglAPI's RequestScheduler allows it (backoff, Retry-After, circuit
+ * breaker); other rejections drop the event so one bad record cannot block
+ * the queue.
+ */
+class JournalReplayer {
+public:
+    JournalReplayer(EventJournal& journal, TogglAPI& toggl);
+
+    void poll(bool networkAvailable, unsigned long nowMs);
+
+    bool isIdle() const { return !waiting && !hasWork(); }
+    const JournalReplayStats& getStats() const { return stats; }
+
+private:
+    enum TimeResolution {
+        RESOLVED,
+        NEEDS_CLOCK,     // Relative to this boot, server time not known yet
+        UNRESOLVABLE     // Relative to an earlier boot's millis()
+    };
+
+    EventJournal& journal;
+    TogglAPI& togglAPI;
+
+    bool waiting;
+    TogglOperation inFlight;
+    uint32_t commitSequence;
+    bool serverStateKnown;       // Running entry and clock fetched since boot
+    uint32_t reconcileSequence;  // Journal events covered by a request with unknown outcome
+    JournalReplayStats stats;
+
+    bool hasWork() const {
+        return journal.hasPending() || togglAPI.needsSwitchVerification() || togglAPI.hasUnknownOutcome();
+    }
+    void dispatchNext(unsigned long nowMs);
+    void handleResult(unsigned long nowMs);
+    bool send(TogglOperation operation, bool queued, uint32_t sequence);
+    TimeResolution resolveTime(const JournalRecord& record, uint32_t& epoch) const;
+    bool isLive(const JournalRecord& record, unsigned long nowMs) const;
+    uint32_t liveEpoch(const JournalRecord& record) const;
+    static String descriptionFor(uint8_t orientation);
+};
+
+#endif // JOURNAL_REPLAYER_H
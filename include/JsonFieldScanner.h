@@ -0,0 +1,93 @@
+#ifndef JSON_FIELD_SCANNER_H
+#define JSON_FIELD_SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "HttpBodySink.h"
+
+/**
+ * Incremental JSON scanner that extracts a few top-level fields.
+ *
+ * Bytes are fed as they arrive from the socket; only the values of the
+ * registered keys are copied, into caller-provided buffers, so parsing a
+ * multi-kilobyte Toggl time entry needs no heap and a fixed ~100 bytes of
+ * state. Nested objects and arrays are skipped. String values are unescaped
+ * (\uXXXX becomes '?'); numbers and literals are copied verbatim.
+ */
+class JsonFieldScanner : public HttpBodySink {
+public:
+    static const int MAX_FIELDS = 4;
+    static const int MAX_KEY_LENGTH = 24;
+
+    JsonFieldScanner();
+
+    /**
+     * Register a top-level key to capture. The key string must outlive the scanner.
+     * @return false if MAX_FIELDS are already registered
+     */
+    bool addField(const char* key, char* buffer, size_t bufferSize);
+    void clearFields();
+
+    // Forget captured values and parser state, keeping the registered fields
+    void reset();
+
+    void feed(char c);
+    void feed(const char* data, size_t length);
+    void onBodyByte(uint8_t c) override { feed((char)c); }
+
+    bool isFound(int fieldIndex) const;
+    bool isTruncated(int fieldIndex) const;
+    bool isComplete() const { return state == DONE; }
+    bool hasError() const { return state == FAILED; }
+    // Document is the literal null (e.g. no running time entry)
+    bool isNull() const;
+
+private:
+    enum State : uint8_t {
+        BEFORE_ROOT,
+        ROOT_LITERAL,
+        EXPECT_KEY,
+        IN_KEY,
+        EXPECT_COLON,
+        EXPECT_VALUE,
+        IN_STRING_VALUE,
+        IN_LITERAL_VALUE,
+        IN_NESTED_VALUE,
+        AFTER_VALUE,
+        DONE,
+        FAILED
+    };
+
+    struct Field {
+        const char* key;
+        char* buffer;
+        uint16_t size;
+        uint16_t length;
+        bool found;
+        bool truncated;
+    };
+
+    Field fields[MAX_FIELDS];
+    int fieldCount;
+
+    State state;
+    bool escaped;
+    bool nestedInString;
+    uint8_t unicodeRemaining;
+    uint16_t nestedDepth;
+    int8_t currentField;
+    uint8_t keyLength;
+    bool keyOverflow;
+    char keyBuffer[MAX_KEY_LENGTH + 1];
+    char rootLiteral[5];
+    uint8_t rootLiteralLength;
+
+    void beginValue(char c);
+    void appendValue(char c);
+    void finishValue();
+    void afterValue(char c);
+    int findField() const;
+    static bool isWhitespace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+};
+
+#endif // JSON_FIELD_SCANNER_H
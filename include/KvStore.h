@@ -0,0 +1,145 @@
+#ifndef KV_STORE_H
+#define KV_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "FlashRegion.h"
+
+class SystemDiagnostics;
+
+// Record keys; each names one value and its type. Never reuse a retired key.
+enum KvKey : uint8_t {
+    KV_KEY_IMU_CALIBRATION = 1,      // ImuCalibrationData (ConfigStorage)
+    KV_KEY_RUNNING_ENTRY = 2,        // Toggl entry left running, NUL-terminated id
+    KV_KEY_DIAGNOSTIC_COUNTERS = 3,  // DiagnosticCounters (SystemDiagnostics)
+    KV_KEY_STARTUP_MARK = 4          // Present while setup() runs (ConfigStorage reset gesture)
+};
+
+// Start of each page. An erased header reads as all 0xFF.
+struct KvPageHeader {
+    uint32_t magic;         // KV_PAGE_MAGIC once the page was opened
+    uint32_t sequence;      // Taken from the record sequence on opening; lowest is the oldest page
+};
+
+// Record header, followed by the value padded to 4 bytes
+struct KvRecordHeader {
+    uint8_t key;
+    uint8_t length;         // Value bytes; 0 marks the key removed
+    uint16_t crc;           // CRC-16 over sequence, key, length and value
+    uint32_t sequence;      // Global write order; the highest for a key is its value
+};
+
+struct KvStoreStats {
+    unsigned long writes;          // Records appended for put/remove
+    unsigned long skipped;         // Puts of the value already stored
+    unsigned long recordsMoved;    // Live records copied out of a page being reclaimed
+    unsigned long pagesErased;
+};
+
+/**
+ * Small values that change often (calibration, the running entry, counters)
+ * as an append-only log in a flash region.
+ *
+ * Each sector is a page. A put appends one record to the head page and
+ * never erases: a power cut during the write leaves a record that fails its
+ * CRC, and the previous one still counts. begin() scans every page once and
+ * keeps the location of each key's newest record in RAM, so reads are one
+ * flash read. When the head page fills, the next erased page in ring order
+ * takes over; poll() then reclaims the oldest page a step at a time: copy
+ * its live records to the head, then erase it. Pages are used and erased in
+ * turn, so wear is spread evenly, and a put never waits for an erase unless
+ * poll() has fallen behind.
+ */
+class KvStore {
+public:
+    static const int MAX_KEYS = 16;                // Keys 1..15
+    static const uint8_t MAX_VALUE_LENGTH = 64;
+    static const int MAX_PAGES = 64;
+    static const uint32_t KV_PAGE_MAGIC = 0x5454564B;   // "KVTT"
+
+    explicit KvStore(FlashRegion& flashRegion);
+
+    /**
+     * Scan flash and rebuild the index
+     * @return false if the region is unusable (under two pages, or too many)
+     */
+    bool begin();
+    bool isReady() const { return ready; }
+
+    bool putBytes(uint8_t key, const void* data, uint8_t length);
+    // Bytes copied into data, or -1 if the key has no value or it does not fit
+    int getBytes(uint8_t key, void* data, uint8_t maxLength);
+    bool remove(uint8_t key);
+    bool contains(uint8_t key) const;
+
+    // Typed access: the stored length must match the type
+    template <typename T>
+    bool put(uint8_t key, const T& value) {
+        static_assert(sizeof(T) <= MAX_VALUE_LENGTH, "Value too large for a KvStore record");
+        return putBytes(key, &value, sizeof(T));
+    }
+    template <typename T>
+    bool get(uint8_t key, T& value) {
+        return getBytes(key, &value, sizeof(T)) == (int)sizeof(T);
+    }
+    bool putString(uint8_t key, const char* text);
+    bool getString(uint8_t key, char* text, size_t size);
+
+    // One step of background work (erase a torn page, move a record, erase a reclaimed page).
+    // Returns true if it did something.
+    bool poll();
+    bool isCompactionDue() const { return ready && freePages + dirtyPages == 0; }
+
+    int getPageCount() const { return pageCount; }
+    int getFreePages() const { return freePages; }
+    const KvStoreStats& getStats() const { return stats; }
+    void setDiagnostics(SystemDiagnostics* diag) { diagnostics = diag; }
+
+private:
+    enum PageState : uint8_t {
+        PAGE_FREE,      // Erased and blank
+        PAGE_USED,      // Opened: header and records
+        PAGE_DIRTY      // Neither (torn erase or header write); erased before use
+    };
+
+    struct IndexEntry {
+        uint32_t offset;        // Record header within the region
+        uint32_t sequence;
+        uint8_t length;         // 0: removed, kept until its page is reclaimed
+        bool present;
+    };
+
+    FlashRegion& flash;
+    bool ready;
+    uint32_t pageSize;
+    int pageCount;
+    PageState pageState[MAX_PAGES];
+    uint32_t pageSequence[MAX_PAGES];
+    int freePages;
+    int dirtyPages;
+    int headPage;               // Page records are appended to, or -1
+    uint32_t headOffset;        // Next record within the head page
+    uint32_t nextSequence;
+    IndexEntry index[MAX_KEYS];
+    KvStoreStats stats;
+    SystemDiagnostics* diagnostics;
+
+    static uint32_t recordSize(uint8_t length) { return (sizeof(KvRecordHeader) + length + 3) & ~3u; }
+    static uint16_t recordCrc(const KvRecordHeader& header, const uint8_t* value);
+    static bool validKey(uint8_t key) { return key > 0 && key < MAX_KEYS; }
+
+    uint32_t scanPage(int page);
+    bool isBlank(uint32_t offset, uint32_t length);
+    uint32_t headRoom() const;
+    int oldestPage() const;
+    uint32_t liveBytes(int page) const;
+    bool erasePage(int page);
+    bool openPage();
+    void setPageState(int page, PageState state);
+    bool append(uint8_t key, const uint8_t* value, uint8_t length);
+    bool makeRoom(uint32_t size);
+    bool write(uint8_t key, const void* data, uint8_t length);
+    bool compactStep();
+};
+
+#endif // KV_STORE_H
@@ -3,52 +3,74 @@
 
 #include <Arduino.h>
 #include "OrientationDetector.h"
+#include "LedOutput.h"
+#include "LedAnimator.h"
+#include "LedPatterns.h"
 
-#if defined(ARDUINO_NANO_RP2040_CONNECT)
-  #include <WiFiNINA.h>
-#endif
+class SystemDiagnostics;
 
+// Channel writes sent to the LED, and those skipped because the level had not changed
+struct LedWriteStats {
+    unsigned long writes;
+    unsigned long skipped;
+};
+
+/**
+ * Status LED feedback: orientation colours or blink codes, errors and the
+ * BLE/WiFi states.
+ *
+ * All feedback is data in LedPatterns: pattern bytecode played by
+ * LedAnimator and advanced from updateBLEAnimation() in the main loop, so
+ * nothing here blocks: the IMU keeps being read and BLE polled while the
+ * LED blinks. Setting a colour directly ends any pattern.
+ *
+ * Colours are perceived levels: each channel goes through a gamma table
+ * on the way out, and is written only when its PWM level changed since
+ * the last write, so a held colour or the dark part of a blink costs no
+ * bus traffic.
+ */
 class LEDController {
 private:
+    LedOutput& output;
     bool useBuiltinLED;
-    
-    // Animation state for non-blocking LED patterns
-    enum LEDAnimationState { IDLE, PULSE, FLASH, WIFI_ERROR } currentAnimation;
-    unsigned long animationStartTime;
-    int animationStep;
-    int animationParam1, animationParam2; // For storing animation parameters
-    
-    void initializeHardware();
+    LedAnimator animator;
+    uint8_t shown[3];        // PWM level last written per channel
+    bool shownValid;
+    LedWriteStats writeStats;
+    SystemDiagnostics* diagnostics;
+
     uint8_t scaleIntensity(uint8_t value, int intensity) const;
-    void blinkPattern(int blinkCount);
-    int getBlinkCountForOrientation(Orientation orientation);
+    void show(uint8_t red, uint8_t green, uint8_t blue);
+    void play(const uint8_t* pattern, uint8_t passes);
 
 public:
-    LEDController();
-    
+    LEDController() : LEDController(BoardLed::shared()) {}
+    explicit LEDController(LedOutput& ledOutput);
+
     bool begin();
     void setColor(uint8_t red, uint8_t green, uint8_t blue);
     void setColorWithIntensity(uint8_t red, uint8_t green, uint8_t blue, int intensity);
+    // Colour, or on a single LED a blink code (one blink for FACE_UP up to six for BACK_EDGE)
     void updateColorForOrientation(Orientation orientation, int intensity = 100);
-    
-    void showError();
+
+    // The RGB or single-LED pattern for a status (non-blocking)
+    void showFeedback(LedFeedback feedback);
+    void showError() { showFeedback(LED_FEEDBACK_ERROR); }
     void turnOff();
-    
+
     // BLE state-specific LED feedback (non-blocking)
-    void showBLESetupMode();      // Blue (RGB) or slow pulse (single LED)
-    void showBLEConnecting();     // Yellow (RGB) or fast pulse (single LED)  
-    void showBLEConnected();      // Green (RGB) or solid on (single LED)
-    void showBLEError();          // Red blink (RGB) or triple flash (single LED)
-    void showWiFiError();         // 2 blinks, wait 1 second, repeat pattern
+    void showBLESetupMode() { showFeedback(LED_FEEDBACK_BLE_SETUP); }
+    void showBLEConnecting() { showFeedback(LED_FEEDBACK_BLE_CONNECTING); }
+    void showBLEConnected() { showFeedback(LED_FEEDBACK_BLE_CONNECTED); }
+    void showBLEError() { showFeedback(LED_FEEDBACK_BLE_ERROR); }
+    void showWiFiError() { showFeedback(LED_FEEDBACK_WIFI_ERROR); }
     void updateBLEAnimation();    // Call in main loop to update animations
-    
-private:
-    void setBuiltinLED(uint8_t brightness);
-    void setRGBLED(uint8_t red, uint8_t green, uint8_t blue);
-    
-    // Helper methods for single LED patterns
-    void pulseBuiltinLED(int duration, int pulseCount = 1);
-    void flashBuiltinLED(int flashCount, int onTime = 150, int offTime = 150);
+    bool isAnimating() const { return animator.isRunning(); }
+
+    void setDiagnostics(SystemDiagnostics* diag) { diagnostics = diag; }
+    const LedWriteStats& getWriteStats() const { return writeStats; }
+    // PWM duty for a perceived level (gamma 2.2)
+    static uint8_t gammaCorrect(uint8_t level);
 };
 
-#endif // LED_CONTROLLER_H
\ No newline at end of file
+#endif // LED_CONTROLLER_H
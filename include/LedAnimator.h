@@ -0,0 +1,81 @@
+#ifndef LED_ANIMATOR_H
+#define LED_ANIMATOR_H
+
+#include <stdint.h>
+
+struct LedColor {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+};
+
+// How a step gets from its colour to the next step's
+enum LedEase : uint8_t {
+    LED_EASE_HOLD = 0,      // Colour held for the whole step
+    LED_EASE_LINEAR = 1,
+    LED_EASE_SINE = 2       // Sine ease-in-out
+};
+
+/**
+ * LED pattern bytecode: a const byte array, so it stays in flash.
+ *
+ *   LED_PATTERN(steps, loopFrom), then one LED_STEP(red, green, blue, ease, ms) per step
+ *
+ * Steps before loopFrom play once, the rest (at least one) as often as the
+ * pattern is started for. A step is five bytes; durations are in 10 ms
+ * ticks, up to 2550 ms. A last step of 0 ms just sets the colour the
+ * pattern ends on, so a solid colour is one such step.
+ */
+static const uint8_t LED_PATTERN_HEADER_BYTES = 2;
+static const uint8_t LED_STEP_BYTES = 5;
+static const uint8_t LED_TICK_MS = 10;
+
+#define LED_PATTERN(steps, loopFrom) (steps), (loopFrom)
+#define LED_STEP(red, green, blue, ease, ms) (red), (green), (blue), (ease), (uint8_t)((ms) / LED_TICK_MS)
+
+/**
+ * Plays an LED pattern against the clock instead of with delay().
+ *
+ * update() works out which step nowMs falls in and returns the colour to
+ * show. The work per update does not depend on how late it comes: whole
+ * passes of the loop part are skipped arithmetically, then at most a pass
+ * of steps is walked. A pattern that does not repeat forever ends on its
+ * last step's colour. Time is passed in, so patterns run under a virtual
+ * clock in tests. There is no per-pattern code; every pattern is data.
+ */
+class LedAnimator {
+public:
+    static const uint8_t REPEAT_FOREVER = 0;
+
+    LedAnimator();
+
+    // Loop part played `passes` times (REPEAT_FOREVER: until stopped); the pattern must outlive the animation
+    void start(const uint8_t* pattern, unsigned long nowMs, uint8_t passes = 1);
+    void stop() { running = false; }
+    // Colour at nowMs; false when nothing is playing (color untouched)
+    bool update(unsigned long nowMs, LedColor& color);
+    bool isRunning() const { return running; }
+
+    // Fade progress after elapsedMs of durationMs, 0-256 along a sine ease-in-out
+    static uint16_t ease(uint32_t elapsedMs, uint32_t durationMs);
+
+private:
+    const uint8_t* pattern;
+    uint8_t steps;
+    uint8_t loopFrom;
+    unsigned long loopMs;    // One pass of the loop part
+    bool running;
+    uint8_t frame;
+    uint8_t passesLeft;      // Passes after the current one; unused when forever
+    bool forever;
+    unsigned long frameStart;
+
+    const uint8_t* step(uint8_t index) const {
+        return pattern + LED_PATTERN_HEADER_BYTES + index * LED_STEP_BYTES;
+    }
+    unsigned long stepMs(uint8_t index) const { return (unsigned long)step(index)[4] * LED_TICK_MS; }
+    // Index after frame, or -1 at the end of the last pass
+    int nextFrame() const;
+};
+
+#endif // LED_ANIMATOR_H
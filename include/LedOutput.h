@@ -0,0 +1,47 @@
+#ifndef LED_OUTPUT_H
+#define LED_OUTPUT_H
+
+#include <stdint.h>
+
+enum LedChannel : uint8_t {
+    LED_CHANNEL_RED = 0,
+    LED_CHANNEL_GREEN = 1,
+    LED_CHANNEL_BLUE = 2
+};
+
+/**
+ * The status LED as LEDController drives it, one channel at a time.
+ *
+ * Levels are 0-255 PWM duty, already scaled and gamma corrected. The
+ * controller only writes a channel whose level changed, since each write
+ * can be a bus transaction. An LED with a single channel (getChannels()
+ * is 1) gets the brightest colour channel on channel 0, and the
+ * controller switches to blink codes for it.
+ */
+class LedOutput {
+public:
+    virtual ~LedOutput() {}
+
+    virtual bool begin() = 0;
+    virtual void writeChannel(uint8_t channel, uint8_t level) = 0;
+    virtual int getChannels() const = 0;
+};
+
+/**
+ * The board's own LED.
+ *
+ * RP2040 Connect: common-anode RGB LED on the NINA module, one PWM
+ * command over SPI per channel write. Nano 33 IoT: the inverted built-in
+ * LED.
+ */
+class BoardLed : public LedOutput {
+public:
+    bool begin() override;
+    void writeChannel(uint8_t channel, uint8_t level) override;
+    int getChannels() const override;
+
+    // The one LED on the board, for LEDController's default constructor
+    static BoardLed& shared();
+};
+
+#endif // LED_OUTPUT_H
@@ -0,0 +1,59 @@
+#ifndef LED_PATTERNS_H
+#define LED_PATTERNS_H
+
+#include <stdint.h>
+#include "Orientation.h"
+#include "LedAnimator.h"
+
+// Status feedback, each with a pattern for the RGB LED and one for a single LED
+enum LedFeedback : uint8_t {
+    LED_FEEDBACK_STARTING,          // Blue while the components start
+    LED_FEEDBACK_ERROR,             // Five red flashes
+    LED_FEEDBACK_BLE_SETUP,         // Dim blue, or slow pulse
+    LED_FEEDBACK_BLE_CONNECTING,    // Dim yellow, or fast pulse
+    LED_FEEDBACK_BLE_CONNECTED,     // Dim green, or solid half brightness
+    LED_FEEDBACK_BLE_ERROR,         // Dim red, or three flashes
+    LED_FEEDBACK_WIFI_CONNECTING,   // Yellow
+    LED_FEEDBACK_WIFI_CONNECTED,    // Green
+    LED_FEEDBACK_WIFI_ERROR,        // Two red blinks every 1.75 s until replaced
+    LED_FEEDBACK_CONFIG_WAITING,    // Dim blue until the app sends a configuration
+    LED_FEEDBACK_CONFIG_APPLIED,    // Green
+    LED_FEEDBACK_COUNT
+};
+
+struct LedFeedbackPatterns {
+    const uint8_t* rgb;
+    uint8_t rgbPasses;
+    const uint8_t* single;
+    uint8_t singlePasses;
+};
+
+// A face's colour, and its blink code on a single LED
+struct LedFaceFeedback {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint8_t blinks;
+};
+
+/**
+ * Every LED pattern the firmware shows, as tables in flash.
+ *
+ * Patterns are LedAnimator bytecode; a feedback entry names the pattern and
+ * pass count for each kind of LED, and faces get a colour and a blink code.
+ * Adding feedback costs table bytes, not code. Golden frames for each
+ * pattern are in test/test_led_patterns.cpp.
+ */
+namespace LedPatterns {
+    extern const uint8_t BLINK_CODE[];     // Lead-in off, then one blink per pass
+    extern const uint8_t FLASH[];          // One red flash per pass
+    extern const uint8_t SLOW_PULSE[];     // 2 s breathing up to half brightness
+    extern const uint8_t FAST_PULSE[];     // 1 s breathing
+    extern const uint8_t WIFI_ERROR[];     // Blink, gap, blink, pause: 1.75 s
+
+    const LedFeedbackPatterns& feedback(LedFeedback which);
+    // UNKNOWN and anything past the table: white, no blinks
+    const LedFaceFeedback& face(Orientation face);
+}
+
+#endif // LED_PATTERNS_H
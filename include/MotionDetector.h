@@ -0,0 +1,64 @@
+#ifndef MOTION_DETECTOR_H
+#define MOTION_DETECTOR_H
+
+#include <stdint.h>
+#include "ImuBackend.h"
+#include "Config.h"
+
+class SystemDiagnostics;
+
+struct MotionStats {
+    unsigned long periods;         // Times the cube started moving
+    unsigned long movingMs;        // Finished motion periods
+    unsigned long restMs;          // Finished rest periods
+    unsigned long heldReadings;    // Classifier changes ignored while moving
+};
+
+/**
+ * Tells a cube being carried or turned from one at rest.
+ *
+ * Moving means the accelerometer variance over the last WINDOW samples
+ * (summed over the axes, in mg^2) or any axis of the angular rate read with
+ * the batch is above its limit. Rest returns once both have stayed below
+ * for the rest time. While moving, OrientationDetector settles no face and
+ * the main loop sends no change. Time is passed in, so the detector runs
+ * under a virtual clock in tests.
+ */
+class MotionDetector {
+public:
+    static const int WINDOW = 16;   // ~0.6 s at 26 Hz
+
+    MotionDetector(uint32_t accelVariance = Config::MOTION_ACCEL_VARIANCE,
+                   int16_t gyroDps = Config::MOTION_GYRO_DPS, unsigned long restMs = Config::MOTION_REST_MS);
+
+    // Samples just read, oldest first, and the angular rate (null without a gyroscope)
+    void update(const AccelSample* samples, int count, const GyroSample* rate, unsigned long nowMs);
+    void recordHeld() { stats.heldReadings++; }
+
+    bool isMoving() const { return moving; }
+    uint32_t getAccelVariance() const { return variance; }
+    const MotionStats& getStats() const { return stats; }
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics) { diagnostics = systemDiagnostics; }
+
+private:
+    uint32_t varianceLimit;
+    int16_t gyroLimit;
+    unsigned long restTime;
+
+    AccelSample window[WINDOW];
+    int filled;
+    int next;
+    uint32_t variance;
+
+    bool moving;
+    bool quiet;
+    unsigned long stateSince;
+    unsigned long quietSince;
+    MotionStats stats;
+    SystemDiagnostics* diagnostics;
+
+    uint32_t windowVariance() const;
+    void setMoving(bool nowMoving, unsigned long nowMs);
+};
+
+#endif // MOTION_DETECTOR_H
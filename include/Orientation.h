@@ -0,0 +1,24 @@
+#ifndef ORIENTATION_H
+#define ORIENTATION_H
+
+// Faces of the tracker: 6 for the cube, or 8, 10 or 12 for other dice
+// (set in build_flags; the face normals are in FaceTable.cpp)
+#ifndef TRACKER_FACE_COUNT
+#define TRACKER_FACE_COUNT 6
+#endif
+
+constexpr int FACE_COUNT = TRACKER_FACE_COUNT;
+
+// Tracker orientation: FACE_UP stops the timer, the other faces map to projects.
+// The names are the cube's; larger trackers number their extra faces on from 6.
+enum Orientation {
+    FACE_UP,
+    FACE_DOWN,
+    LEFT_SIDE,
+    RIGHT_SIDE,
+    FRONT_EDGE,
+    BACK_EDGE,
+    UNKNOWN = TRACKER_FACE_COUNT
+};
+
+#endif // ORIENTATION_H
@@ -0,0 +1,58 @@
+#ifndef ORIENTATION_CLASSIFIER_H
+#define ORIENTATION_CLASSIFIER_H
+
+#include <stdint.h>
+#include "Orientation.h"
+#include "ImuBackend.h"
+#include "FaceTable.h"
+#include "Config.h"
+
+/**
+ * Integer orientation classifier fed one accelerometer sample at a time.
+ *
+ * - Each axis runs through a first-order IIR low-pass (weight 1/2^filterShift)
+ *   kept in Q8 milli-g, so single-sample knocks do not reach the decision.
+ * - The filtered vector is projected onto every face normal (FaceTable).
+ *   The nearest face is entered when its projection reaches enterMg and kept
+ *   until its own projection drops below exitMg. Between the two (a cube
+ *   resting near 45 degrees) the decision holds instead of flickering.
+ * - Confidence (0-100) is how far the face's projection leads the next
+ *   face's, reaching 100 at ORIENTATION_FULL_LEAD_MG (about a tracker at rest).
+ *
+ * Only adds, shifts and three multiplies per face: no floats and no division,
+ * which both cost library calls on the SAMD21's Cortex-M0+.
+ */
+class OrientationClassifier {
+public:
+    OrientationClassifier(int enterMg = Config::ORIENTATION_ENTER_MG, int exitMg = Config::ORIENTATION_EXIT_MG,
+                          uint8_t filterShift = Config::ORIENTATION_FILTER_SHIFT);
+
+    // Forget the filter state; the next sample is taken as is
+    void reset();
+    Orientation update(const AccelSample& sample);
+    // Takes effect from the next sample; exitMg is capped at enterMg
+    void setThresholds(int enterMg, int exitMg);
+
+    Orientation getOrientation() const { return current; }
+    uint8_t getConfidence() const { return confidence; }
+    // Low-pass filtered acceleration in milli-g
+    AccelSample getFiltered() const;
+
+private:
+    static const int FRACTION_BITS = 8;
+
+    static const int32_t CONFIDENCE_SCALE = 25600 / Config::ORIENTATION_FULL_LEAD_MG;   // 100 / lead, Q8
+
+    const FaceNormal* normals;
+    int32_t enterThreshold;
+    int32_t exitThreshold;
+    uint8_t shift;
+    int32_t filtered[3];   // Q8 milli-g
+    bool primed;
+    Orientation current;
+    uint8_t confidence;
+
+    void decide(const int32_t axes[3]);
+};
+
+#endif // ORIENTATION_CLASSIFIER_H
@@ -0,0 +1,59 @@
+#ifndef ORIENTATION_COALESCER_H
+#define ORIENTATION_COALESCER_H
+
+#include "OrientationDetector.h"
+#include "Config.h"
+
+/**
+ * A face change that survived the coalescing window
+ */
+struct OrientationChange {
+    Orientation from;
+    Orientation to;
+    unsigned long atMs;    // millis() when the final face was reached
+};
+
+struct CoalescerStats {
+    unsigned long facesOffered;      // Settled faces reported by the detector
+    unsigned long changesCommitted;  // Changes passed on to Toggl
+    unsigned long facesSkipped;      // Intermediate faces replaced by a later one
+    unsigned long roundTripsDropped; // Held changes that ended on the tracked face
+};
+
+/**
+ * Sits between OrientationDetector and the Toggl path and holds a face change
+ * until no other face has been seen for the coalescing window.
+ *
+ * Rolling the cube over several faces commits only the face it ends on, and
+ * picking it up and putting it back (A -> B -> A) commits nothing. The
+ * committed change carries the time the final face was reached, so the stop
+ * and the new start can be back-dated to it.
+ */
+class OrientationCoalescer {
+public:
+    explicit OrientationCoalescer(unsigned long windowMs = Config::ORIENTATION_COALESCE_MS);
+
+    // Report a settled face; cheap, never talks to the network
+    void offer(Orientation face, unsigned long nowMs);
+
+    // Returns true once per committed change
+    bool poll(unsigned long nowMs, OrientationChange& change);
+
+    // Forget any held change and treat face as the tracked one
+    void reset(Orientation committed);
+
+    bool isHolding() const { return holding; }
+    Orientation getCommittedOrientation() const { return committedFace; }
+    void setWindow(unsigned long windowMs) { window = windowMs; }
+    const CoalescerStats& getStats() const { return stats; }
+
+private:
+    unsigned long window;
+    Orientation committedFace;
+    Orientation pendingFace;
+    unsigned long pendingSince;
+    bool holding;
+    CoalescerStats stats;
+};
+
+#endif // ORIENTATION_COALESCER_H
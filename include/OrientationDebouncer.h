@@ -0,0 +1,55 @@
+#ifndef ORIENTATION_DEBOUNCER_H
+#define ORIENTATION_DEBOUNCER_H
+
+#include "Orientation.h"
+#include "Config.h"
+
+struct DebouncerStats {
+    unsigned long candidates;       // Faces that started a dwell
+    unsigned long committed;        // Candidates that held for the dwell time
+    unsigned long rejected;         // Candidates replaced before their dwell was up
+    unsigned long candidateMs[FACE_COUNT + 1];   // Time spent as the candidate, per face (UNKNOWN last)
+};
+
+/**
+ * Settles a face only once the classifier has reported it continuously for
+ * the dwell time.
+ *
+ * Any other face, including the settled one, restarts the dwell, so a cube
+ * still wobbling between faces settles nothing. There is no dead time after
+ * a change: the next face can settle as soon as it has held for the dwell.
+ * Time is passed in, so the same code runs on the host with a virtual clock.
+ */
+class OrientationDebouncer {
+public:
+    explicit OrientationDebouncer(unsigned long dwellMs = Config::DEBOUNCE_TIME);
+
+    // Report the classified face; true while a new face has held for the dwell time
+    bool observe(Orientation face, unsigned long nowMs);
+    // The caller settled face (normally the candidate observe() reported)
+    void commit(Orientation face, unsigned long nowMs);
+    // Something other than a steady face (movement): any candidate starts over
+    void interrupt(unsigned long nowMs);
+    // Forget any candidate and treat face as the settled one
+    void reset(Orientation settled);
+
+    bool hasCandidate() const { return pending; }
+    Orientation getCandidate() const { return pending ? candidate : committedFace; }
+    unsigned long getCandidateAge(unsigned long nowMs) const { return pending ? nowMs - candidateSince : 0; }
+    Orientation getCommittedOrientation() const { return committedFace; }
+    void setDwell(unsigned long dwellMs) { dwell = dwellMs; }
+    unsigned long getDwell() const { return dwell; }
+    const DebouncerStats& getStats() const { return stats; }
+
+private:
+    unsigned long dwell;
+    Orientation committedFace;
+    Orientation candidate;
+    unsigned long candidateSince;
+    bool pending;
+    DebouncerStats stats;
+
+    void endCandidate(unsigned long nowMs);
+};
+
+#endif // ORIENTATION_DEBOUNCER_H
@@ -2,43 +2,145 @@
 #define ORIENTATION_DETECTOR_H
 
 #include <Arduino.h>
+#include "Orientation.h"
+#include "ImuBackend.h"
+#include "OrientationClassifier.h"
+#include "OrientationDebouncer.h"
+#include "ImuWakeGate.h"
+#include "MotionDetector.h"
+#include "ImuRateGovernor.h"
+#include "ImuCalibration.h"
+#include "TapEventQueue.h"
+#include "Config.h"
 
-enum Orientation {
-    FACE_UP,
-    FACE_DOWN,
-    LEFT_SIDE,
-    RIGHT_SIDE,
-    FRONT_EDGE,
-    BACK_EDGE,
-    UNKNOWN
+struct ImuBatchStats {
+    unsigned long batches;       // Blocks handed to the classifier
+    unsigned long samples;
+    unsigned long earlyChecks;   // FIFO checked but still below the watermark
+    unsigned long overruns;      // FIFO filled up before it was drained
 };
 
 class OrientationDetector {
 private:
+    ImuBackend& imu;
     Orientation currentOrientation;
-    unsigned long lastOrientationChange;
     float threshold;
-    unsigned long debounceTime;
+
+    // FIFO batching: the sensor buffers samples, drained once per watermark
+    bool batching;
+    uint16_t watermark;
+    unsigned long batchInterval;
+    unsigned long lastBatchTime;
+    AccelSample batch[Config::IMU_MAX_BATCH];
+    int batchSize;
+    ImuBatchStats batchStats;
+
+    // Board misalignment removed from every sample before anything else sees it
+    ImuCalibration calibration;
+
+    // Filtered, hysteretic decision over every sample read
+    OrientationClassifier classifier;
+    // A new face settles once the classifier has held it for the dwell time
+    OrientationDebouncer debouncer;
+
+    // Sensor interrupts: samples are only read in the awake window after an event
+    bool eventDriven;
+    bool resumed;          // First batch after a wakeup; the FIFO overran while idle
+    ImuWakeGate wakeGate;
+
+    // Gyroscope and accelerometer variance: no face settles while the cube moves
+    MotionDetector motion;
+
+    // Adaptive rate: low-power sampling about once a second while nothing is going on
+    bool adaptiveRate;
+    uint16_t stillRate;
+    unsigned long stillInterval;
+    ImuRateGovernor rateGovernor;
+
+    // Taps come from the sensor's own engine with the other events; nothing is sampled for them
+    bool tapsEnabled;
+    TapEventQueue taps;
+    SystemDiagnostics* diagnostics;
 
 public:
-    OrientationDetector(float orientationThreshold = 0.75f, unsigned long debounceMs = 5000);
+    OrientationDetector(ImuBackend& imuBackend, float orientationThreshold = 0.75f, unsigned long debounceMs = 5000);
     
     bool begin();
+    // Read samples in blocks from the sensor FIFO; false leaves per-sample polling on
+    bool enableBatching(uint16_t fifoWatermark, uint16_t rateHz);
+    bool isBatching() const { return batching; }
+    // Sample only after the sensor's 6D or wake-up interrupt; false keeps sampling continuously
+    bool enableEvents(uint16_t wakeThresholdMg);
+    bool isEventDriven() const { return eventDriven; }
+    // Queue the sensor's single and double taps; needs events, false without a tap engine
+    bool enableTaps(uint16_t thresholdMg);
+    bool areTapsEnabled() const { return tapsEnabled; }
+    // Oldest tap taken from the sensor so far; taps while moving are never queued
+    bool takeTap(TapEvent& tap) { return taps.pop(tap); }
+    bool hasTaps() const { return taps.size() > 0; }
+    // Drop the sensor to stillRateHz once the cube has been left alone; false keeps the full rate
+    bool enableAdaptiveRate(uint16_t stillRateHz);
+    bool isAdaptiveRate() const { return adaptiveRate; }
+    bool isStill() const { return adaptiveRate && rateGovernor.isStill(); }
+    // Nothing to read until the sensor raises an event, or only once a second while still
+    bool isIdle() const { return (eventDriven && !wakeGate.isAwake(millis()) && !motion.isMoving()) || isStill(); }
+    // Sleep until the sensor raises an event, the next still reading is due or maxMs have passed
+    void waitForEvent(unsigned long maxMs);
+
+    // One sample, or the mean of a batch once the FIFO reached its watermark.
+    // Every sample read also goes through the classifier.
     bool readAcceleration(float& accelX, float& accelY, float& accelZ);
+    // Classifier decision after the samples read so far
+    Orientation getClassifiedOrientation() const { return classifier.getOrientation(); }
+    uint8_t getConfidence() const { return classifier.getConfidence(); }
+    // Single-reading threshold test, no filtering or hysteresis
     Orientation detectOrientation(float accelX, float accelY, float accelZ);
+    // Classify a block of samples by their mean
+    Orientation classifyBlock(const AccelSample* samples, int count) const;
+    // True once newOrientation has been reported continuously for the debounce time, at rest
     bool hasOrientationChanged(Orientation newOrientation);
+    // Carried or turned right now; changes should wait until it is put down
+    bool isMoving() const { return motion.isMoving(); }
     void updateOrientation(Orientation newOrientation);
     
     Orientation getCurrentOrientation() const { return currentOrientation; }
-    String getOrientationName(Orientation orientation) const;
+    // Project name of a face, "Face N" if it has none; shared with the journal replayer
+    static String getOrientationName(Orientation orientation);
     String getCurrentOrientationName() const;
+
+    // Samples behind the last successful readAcceleration()
+    const AccelSample* getLastBatch() const { return batch; }
+    int getLastBatchSize() const { return batchSize; }
+    // Spacing of the samples within a batch (0 when polling)
+    unsigned long getSamplePeriodMs() const { return batching ? batchInterval / watermark : 0; }
+    const ImuBatchStats& getBatchStats() const { return batchStats; }
+    unsigned long getBusTransactions() const { return imu.getBusTransactions(); }
+    const DebouncerStats& getDebouncerStats() const { return debouncer.getStats(); }
+    const ImuWakeStats& getWakeStats() const { return wakeGate.getStats(); }
+    const MotionStats& getMotionStats() const { return motion.getStats(); }
+    const ImuRateStats& getRateStats() const { return rateGovernor.getStats(); }
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics);
+    // Corrects samples from the next read and tightens the hysteresis; nullptr or
+    // invalid data goes back to raw samples and the default thresholds
+    void setCalibration(const ImuCalibrationData* data);
+    bool isCalibrated() const { return calibration.isValid(); }
+    unsigned long getAwakeMs() const { return wakeGate.getAwakeMs(millis()); }
+    unsigned long getActiveRateMs() const { return rateGovernor.getActiveMs(millis()); }
+    unsigned long getStillRateMs() const { return rateGovernor.getStillMs(millis()); }
     
     void printOrientation(Orientation orientation, float x, float y, float z) const;
     void setThreshold(float newThreshold) { threshold = newThreshold; }
-    void setDebounceTime(unsigned long newDebounceMs) { debounceTime = newDebounceMs; }
+    void setDebounceTime(unsigned long newDebounceMs) { debouncer.setDwell(newDebounceMs); }
+    void setHysteresis(int enterMg, int exitMg) { classifier.setThresholds(enterMg, exitMg); }
+    void setAwakeWindow(unsigned long windowMs) { wakeGate.setWindow(windowMs); }
+    void setStillAfter(unsigned long stillAfterMs) { rateGovernor.setStillAfter(stillAfterMs); }
 
 private:
     Orientation determineOrientation(float x, float y, float z) const;
+    static AccelSample blockMean(const AccelSample* samples, int count);
+    void updateMotion();
+    void updateRate();
+    void queueTaps(uint8_t events);
 };
 
 #endif // ORIENTATION_DETECTOR_H
\ No newline at end of file
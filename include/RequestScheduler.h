@@ -0,0 +1,104 @@
+#ifndef REQUEST_SCHEDULER_H
+#define REQUEST_SCHEDULER_H
+
+#include <Arduino.h>
+#include "SystemDiagnostics.h"
+#include "Config.h"
+
+// Toggl endpoints with their own rate budget
+enum class TogglEndpoint {
+    CREATE_ENTRY = 0,   // POST /time_entries (start, switch, completed entry)
+    UPDATE_ENTRY = 1,   // PUT/PATCH of an existing entry (stop)
+    READ_ENTRY = 2      // GET current or single entry (time sync, switch check)
+};
+
+enum class CircuitState {
+    CLOSED = 0,
+    OPEN = 1,       // Requests suspended until the open period ends
+    HALF_OPEN = 2   // One probe request in flight
+};
+
+struct SchedulerStats {
+    unsigned long requestsAllowed;
+    unsigned long deferredByRateLimit;  // Endpoint bucket was empty
+    unsigned long deferredByBackoff;    // Backoff or Retry-After still running
+    unsigned long deferredByBreaker;
+    unsigned long retryAfterHonoured;   // Responses that carried Retry-After
+    unsigned long breakerTrips;
+};
+
+/**
+ * Decides when TogglAPI may put the next request on the wire.
+ *
+ * - One token bucket per endpoint keeps bursts within Toggl's rate limit.
+ * - Retryable failures push every request back by a jittered, exponentially
+ *   growing delay (TOGGL_RETRY_MIN_MS doubling up to TOGGL_RETRY_MAX_MS),
+ *   or by the server's Retry-After when that is longer.
+ * - After TOGGL_BREAKER_THRESHOLD consecutive service failures (network
+ *   errors, timeouts, 429, 5xx) the circuit opens for TOGGL_BREAKER_OPEN_MS;
+ *   then a single probe decides whether it closes again.
+ *
+ * Pure logic on caller-supplied times, so it runs on a host with a virtual
+ * clock. Results and breaker changes are reported to SystemDiagnostics.
+ */
+class RequestScheduler {
+public:
+    static const int ENDPOINT_COUNT = 3;
+
+    RequestScheduler();
+
+    void configure(unsigned long refillMs, int burst, unsigned long retryMinMs, unsigned long retryMaxMs,
+                   int breakerThreshold, unsigned long breakerOpenMs);
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics) { diagnostics = systemDiagnostics; }
+    void setJitterSeed(uint32_t seed) { jitterState = seed ? seed : 1; }
+
+    // Takes a token and returns true if a request to the endpoint may go now
+    bool tryAcquire(TogglEndpoint endpoint, unsigned long nowMs);
+    // Give back an acquired slot when nothing was sent after all
+    void release(TogglEndpoint endpoint);
+    // No backoff, Retry-After or open circuit in the way (buckets not checked)
+    bool isReady(unsigned long nowMs) const;
+    void recordResult(TogglEndpoint endpoint, int statusCode, uint32_t retryAfterSeconds, unsigned long nowMs);
+
+    // Failures worth retrying: transport errors, auth (fixable over BLE), 408, 429, 5xx
+    static bool isRetryable(int statusCode);
+    // Failures that say the service is unreachable or overloaded
+    static bool isServiceFailure(int statusCode);
+
+    CircuitState getCircuitState() const { return circuit; }
+    int getConsecutiveFailures() const { return consecutiveFailures; }
+    unsigned long getHoldUntil() const { return holdUntil; }
+    const SchedulerStats& getStats() const { return stats; }
+
+private:
+    struct TokenBucket {
+        int tokens;
+        unsigned long lastRefill;
+    };
+
+    unsigned long refillInterval;
+    int bucketCapacity;
+    unsigned long retryMin;
+    unsigned long retryMax;
+    int breakerThreshold;
+    unsigned long breakerOpenTime;
+
+    TokenBucket buckets[ENDPOINT_COUNT];
+    int consecutiveFailures;      // Retryable failures, drives the backoff
+    int serviceFailures;          // Consecutive service failures, drives the breaker
+    bool holding;
+    unsigned long holdUntil;
+    CircuitState circuit;
+    unsigned long openUntil;
+    uint32_t jitterState;
+    SystemDiagnostics* diagnostics;
+    SchedulerStats stats;
+
+    void refill(TokenBucket& bucket, unsigned long nowMs);
+    unsigned long backoffDelay();
+    uint32_t nextRandom();
+    void setCircuit(CircuitState state, unsigned long nowMs);
+    static const char* endpointName(TogglEndpoint endpoint);
+};
+
+#endif // REQUEST_SCHEDULER_H
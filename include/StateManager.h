@@ -5,8 +5,12 @@
 #include "LEDController.h"
 #include "NetworkManager.h"
 #include "OrientationDetector.h"
+#include "OrientationCoalescer.h"
+#include "TimerPause.h"
 #include "TogglAPI.h"
 #include "ConfigStorage.h"
+#include "EventJournal.h"
+#include "JournalReplayer.h"
 
 /**
  * System state enumeration for enhanced state management
@@ -42,6 +46,14 @@ public:
      */
     void setBLEActive(bool active) { bleActive = active; }
     bool isBLEActive() const { return bleActive; }
+    
+    /**
+     * Route timer changes through a flash journal instead of direct requests
+     */
+    void attachJournal(EventJournal& journal, JournalReplayer& replayer) {
+        eventJournal = &journal;
+        journalReplayer = &replayer;
+    }
 
 private:
     LEDController& ledController;
@@ -49,12 +61,18 @@ private:
     OrientationDetector& orientationDetector;
     TogglAPI& togglAPI;
     ConfigStorage& configStorage;
+    EventJournal* eventJournal = nullptr;
+    JournalReplayer* journalReplayer = nullptr;
+    OrientationCoalescer orientationCoalescer;
+    TimerPause timerPause;
     
     bool bleActive = false;
     bool configApplied = false;
     unsigned long lastLEDUpdate = 0;
     
     void handleOrientationChange(Orientation newOrientation, float accelX, float accelY, float accelZ);
+    void commitOrientationChange(const OrientationChange& change);
+    void handleTap(const TapEvent& tap);
     void updateBLEStatusLED();
 };
 
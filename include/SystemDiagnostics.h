@@ -3,6 +3,15 @@
 
 #include <Arduino.h>
 
+// Lifetime totals kept across power cycles (KvStore, KV_KEY_DIAGNOSTIC_COUNTERS)
+struct DiagnosticCounters {
+    uint32_t boots;
+    uint32_t timerOperations;
+    uint32_t timerFailures;
+    uint32_t doubleTaps;
+    uint32_t timerPauses;
+};
+
 /**
  * System diagnostics and health monitoring
  */
@@ -36,6 +45,63 @@ public:
     bool isTogglAPIHealthy() const;
     int getAPISuccessRate() const;
     unsigned long getLastAPIFailure() const;
+    void recordCircuitState(bool open);
+    bool isTogglCircuitOpen() const;
+    
+    // HTTP request writes (fed by TogglAPI from AsyncHttpClient)
+    void recordRequestWrites(unsigned int writeCalls, unsigned int flushBytes);
+    unsigned long getRequestsSent() const;
+    unsigned int getLastRequestWrites() const;
+    unsigned long getAverageWritesPerRequest() const;
+    unsigned long getAverageFlushBytes() const;
+    
+    // Motion monitoring (fed by MotionDetector)
+    void recordMotion(bool moving, unsigned long periodMs);
+    bool isMoving() const;
+    unsigned long getMotionPeriods() const;
+    unsigned long getMotionTime() const;
+    unsigned long getRestTime() const;
+    
+    // IMU rate monitoring (fed by ImuRateGovernor)
+    void recordImuRate(bool still, unsigned long periodMs);
+    bool isImuStill() const;
+    unsigned long getImuActiveTime() const;
+    unsigned long getImuStillTime() const;
+    // Sensor current at the still rate, set by OrientationDetector (higher with the tap engine on)
+    void setImuStillCurrent(unsigned long currentUa) { imuStillCurrentUa = currentUa; }
+    unsigned long getImuAverageCurrent() const;
+    int getImuSavingPercent() const;
+    
+    // Tap monitoring (fed by OrientationDetector and TimerPause)
+    void recordTap(bool doubleTap, bool accepted);
+    void recordTimerPause(bool paused);
+    unsigned long getSingleTaps() const;
+    unsigned long getDoubleTaps() const;
+    unsigned long getTapsIgnored() const;
+    bool isTimerPaused() const;
+    unsigned long getTimerPauses() const;
+    
+    // LED output monitoring (fed by LEDController, one call per channel update)
+    void recordLedWrite(bool sent);
+    unsigned long getLedWrites() const;
+    unsigned long getLedWritesSkipped() const;
+    unsigned long getLedWritesPerSecond() const;
+    
+    // Boot monitoring: reset to ready for tracking, and whether BLE setup was skipped
+    void recordBoot(unsigned long readyMs, bool storedConfig);
+    unsigned long getBootReadyTime() const;
+    bool isBootFromStoredConfig() const;
+    
+    // State store monitoring (fed by KvStore): appended records, puts of an unchanged value, page erases
+    void recordStateWrite(bool written);
+    void recordStateErase();
+    unsigned long getStateWrites() const;
+    unsigned long getStateWritesSkipped() const;
+    unsigned long getStateErases() const;
+    
+    // Lifetime counters: the totals of earlier boots, restored at boot, plus this one
+    void restoreCounters(const DiagnosticCounters& stored);
+    DiagnosticCounters getLifetimeCounters() const;
     
     // Storage monitoring
     void recordStorageOperation(bool success, const String& operation);
@@ -66,6 +132,50 @@ private:
     int apiSuccessCount;
     int apiTotalCount;
     unsigned long lastAPIFailureTime;
+    bool togglCircuitOpen;
+    
+    // Request writes: totals over the requests sent, and the last one
+    unsigned long requestsSent;
+    unsigned long requestWriteCalls;
+    unsigned long requestFlushBytes;
+    unsigned int lastRequestWrites;
+    
+    // Motion status: time in finished periods
+    bool moving;
+    unsigned long motionPeriods;
+    unsigned long motionTimeMs;
+    unsigned long restTimeMs;
+    
+    // IMU rate: time in finished periods at each rate
+    bool imuStill;
+    unsigned long imuActiveTimeMs;
+    unsigned long imuStillTimeMs;
+    unsigned long imuStillCurrentUa;
+    
+    // Taps reported by the sensor; ignored ones came while the cube was moving
+    unsigned long singleTaps;
+    unsigned long doubleTaps;
+    unsigned long tapsIgnored;
+    bool timerPaused;
+    unsigned long timerPauses;
+    
+    // LED channel writes (SPI commands to the NINA module on the RP2040); the rate is over ~1 s windows
+    static const unsigned long LED_RATE_WINDOW_MS = 1000;
+    unsigned long ledWrites;
+    unsigned long ledWritesSkipped;
+    unsigned long ledWindowStart;
+    unsigned long ledWindowWrites;
+    unsigned long ledWritesPerSecond;
+    
+    // Boot
+    unsigned long bootReadyMs;
+    bool bootFromStoredConfig;
+    
+    // State store
+    unsigned long stateWrites;
+    unsigned long stateWritesSkipped;
+    unsigned long stateErases;
+    DiagnosticCounters storedCounters;   // Totals before this boot
     
     // Storage status
     bool storageHealthy;
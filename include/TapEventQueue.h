@@ -0,0 +1,45 @@
+#ifndef TAP_EVENT_QUEUE_H
+#define TAP_EVENT_QUEUE_H
+
+#include <stdint.h>
+
+enum TapGesture : uint8_t {
+    TAP_SINGLE,
+    TAP_DOUBLE
+};
+
+struct TapEvent {
+    TapGesture gesture;
+    unsigned long atMs;    // millis() when the sensor's latched event was read
+};
+
+/**
+ * Taps reported by the sensor, held for the main loop in the order they came.
+ *
+ * OrientationDetector pushes taps whenever it takes the sensor's events and
+ * the loop drains them with pop(), so the state machine sees a tap the same
+ * way whether it was read in a sampling pass or while waiting for an event.
+ * A full queue keeps what it has and counts the newer taps as dropped.
+ */
+class TapEventQueue {
+public:
+    static const int CAPACITY = 8;
+
+    TapEventQueue();
+
+    bool push(const TapEvent& event);
+    // Oldest tap first; false when empty
+    bool pop(TapEvent& event);
+    void clear();
+
+    int size() const { return count; }
+    unsigned long getDropped() const { return dropped; }
+
+private:
+    TapEvent events[CAPACITY];
+    int head;
+    int count;
+    unsigned long dropped;
+};
+
+#endif // TAP_EVENT_QUEUE_H
@@ -0,0 +1,40 @@
+#ifndef TIME_UTILS_H
+#define TIME_UTILS_H
+
+#include <stdint.h>
+
+/**
+ * Wall-clock helpers. The device has no RTC; epoch time is learned from the
+ * HTTP Date header of Toggl responses and kept relative to millis().
+ */
+namespace TimeUtils {
+
+    // Length of "2026-10-16T08:12:31Z" including terminator
+    constexpr int ISO8601_BUFFER_SIZE = 21;
+
+    /**
+     * Convert a UTC calendar date to seconds since 1970-01-01
+     */
+    uint32_t toEpoch(int year, int month, int day, int hour, int minute, int second);
+
+    /**
+     * Parse an RFC 7231 HTTP date ("Fri, 16 Oct 2026 08:12:31 GMT")
+     * @return epoch seconds, or 0 if the value could not be parsed
+     */
+    uint32_t parseHttpDate(const char* value);
+
+    /**
+     * Parse an ISO 8601 UTC timestamp ("2026-10-16T08:12:31Z", fraction and
+     * "+00:00" suffix accepted)
+     * @return epoch seconds, or 0 if the value could not be parsed
+     */
+    uint32_t parseIso8601(const char* value);
+
+    /**
+     * Format epoch seconds as "YYYY-MM-DDTHH:MM:SSZ" into a buffer of at least
+     * ISO8601_BUFFER_SIZE bytes
+     */
+    void formatIso8601(uint32_t epoch, char* out);
+}
+
+#endif // TIME_UTILS_H
@@ -0,0 +1,54 @@
+#ifndef TIMER_PAUSE_H
+#define TIMER_PAUSE_H
+
+#include "Orientation.h"
+#include "TapEventQueue.h"
+
+class SystemDiagnostics;
+
+enum TimerPauseAction : uint8_t {
+    TIMER_PAUSE_NONE,
+    TIMER_PAUSE_STOP,     // Stop the face's timer, as turning the cube face up would
+    TIMER_PAUSE_RESUME    // Start the face's timer again
+};
+
+struct TimerPauseStats {
+    unsigned long pauses;
+    unsigned long resumes;
+    unsigned long tapsIgnored;   // Double taps with no timer to pause or a change under way
+};
+
+/**
+ * Double tap to pause the timer of the face the cube rests on, and again to
+ * resume it, without turning the cube.
+ *
+ * Only the settled face counts: a tap on FACE_UP or an unknown face has no
+ * timer to pause, and one while a face change is still being held or the
+ * cube is moving is ignored, since the change is about to replace the timer
+ * anyway. A committed face change ends a pause, so turning the cube starts
+ * the new face as usual. Single taps are left for other uses.
+ */
+class TimerPause {
+public:
+    TimerPause();
+
+    // A tap from the detector; busy while a face change is pending or the cube moves
+    TimerPauseAction onTap(const TapEvent& tap, Orientation settledFace, bool busy);
+    // A face change reached the timer
+    void onFaceCommitted();
+
+    bool isPaused() const { return paused; }
+    Orientation getPausedFace() const { return paused ? pausedFace : UNKNOWN; }
+    unsigned long getPausedAtMs() const { return pausedAtMs; }
+    const TimerPauseStats& getStats() const { return stats; }
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics) { diagnostics = systemDiagnostics; }
+
+private:
+    bool paused;
+    Orientation pausedFace;
+    unsigned long pausedAtMs;
+    TimerPauseStats stats;
+    SystemDiagnostics* diagnostics;
+};
+
+#endif // TIMER_PAUSE_H
@@ -2,39 +2,218 @@
 #define TOGGL_API_H
 
 #include <Arduino.h>
-#include <ArduinoHttpClient.h>
-#include <ArduinoJson.h>
+#include <Client.h>
+#include "AsyncHttpClient.h"
+#include "JsonFieldScanner.h"
+#include "TogglRequestTemplates.h"
+#include "RequestScheduler.h"
+#include "Config.h"
+
+// Connection reuse counters for the keep-alive socket to Config::TOGGL_SERVER
+struct TogglConnectionStats {
+    unsigned long handshakes;        // Requests that paid for DNS + TCP + TLS
+    unsigned long reusedConnections; // Requests sent on an already open socket
+    unsigned long staleReconnects;   // Reused sockets the server had already closed
+};
+
+enum class TogglOperation {
+    NONE = 0,
+    START = 1,
+    STOP = 2,
+    COMPLETED_ENTRY = 3, // Start and stop in one request (journal replay)
+    TIME_SYNC = 4,       // Fetch the running entry and the server clock
+    SWITCH = 5,          // Start a new entry, letting the server stop the running one
+    VERIFY_SWITCH = 6,   // Check that a switch really stopped the previous entry
+    RECONCILE = 7        // Settle a start/switch/stop whose response never arrived
+};
+
+// Whether the server stops the running entry when a new one is started
+enum class SwitchSupport {
+    UNKNOWN = 0,
+    VERIFIED = 1,
+    UNSUPPORTED = 2
+};
+
+// Called from poll() when a queued operation has finished
+typedef void (*TogglCompletionCallback)(TogglOperation operation, bool success, int statusCode);
 
 class TogglAPI {
+public:
+    static const size_t MAX_ENTRY_ID_LENGTH = 24;
+    static const size_t MAX_DESCRIPTION_LENGTH = 64;
+
 private:
-    HttpClient* client;
-    String currentTimeEntryId;
-    String currentTimeEntryName;
-    
+    AsyncHttpClient http;
+
+    // Header block and body prefixes rebuilt on configuration changes; the
+    // request path below only fills fixed buffers (no heap allocations)
+    TogglRequestTemplates templates;
+    char requestPath[TogglRequestTemplates::MAX_PATH_LENGTH];
+    char requestBody[TogglRequestTemplates::MAX_BODY_LENGTH];
+
+    // Time entry responses are parsed as they stream in; only these are kept
+    JsonFieldScanner responseScanner;
+    char responseId[MAX_ENTRY_ID_LENGTH];
+    char responseDescription[MAX_DESCRIPTION_LENGTH];
+    char responseStart[32];
+    char responseDuration[16];
+    static const int FIELD_ID = 0;
+    static const int FIELD_DESCRIPTION = 1;
+    static const int FIELD_START = 2;
+    static const int FIELD_DURATION = 3;
+
+    char currentTimeEntryId[MAX_ENTRY_ID_LENGTH];
+    char currentTimeEntryName[MAX_DESCRIPTION_LENGTH];
+
     // Runtime configuration (overrides compile-time Configuration.h when provided)
     String runtimeToken;
-    String runtimeWorkspaceId; // kept as string for easy path building
-    int runtimeProjectIds[6] = {0,0,0,0,0,0};
+    String runtimeWorkspaceId;
+    int runtimeProjectIds[FACE_COUNT] = {0};
     bool hasRuntimeConfig = false;
-    
-    String base64Encode(const String& str);
+
+    // Keep-alive connection management
+    TogglConnectionStats startStats = {0, 0, 0};
+    TogglConnectionStats stopStats = {0, 0, 0};
+    bool lastRequestReusedConnection = false;
+
+    // Operations queued by requestStart()/requestStop(), executed in order by poll()
+    struct PendingOperation {
+        TogglOperation type;
+        int orientationIndex;
+        char description[MAX_DESCRIPTION_LENGTH];
+        uint32_t epoch;          // Explicit start/stop time, 0 = server's now
+        uint32_t duration;       // Seconds, COMPLETED_ENTRY only
+    };
+    static const int MAX_PENDING_OPERATIONS = 4;
+    PendingOperation pendingOperations[MAX_PENDING_OPERATIONS];
+    int pendingHead = 0;
+    int pendingCount = 0;
+    PendingOperation activeOperation = {TogglOperation::NONE, -1, {0}, 0, 0};
+    bool lastOperationSuccess = false;
+    int lastStatusCode = 0;
+
+    // Single-request switching; the first switch is verified before relying on it
+    bool switchEnabled = Config::TOGGL_SWITCH_IN_ONE_REQUEST;
+    SwitchSupport switchSupport = SwitchSupport::UNKNOWN;
+    char switchPreviousEntryId[MAX_ENTRY_ID_LENGTH];  // Running entry when the active switch was dispatched
+    char unverifiedEntryId[MAX_ENTRY_ID_LENGTH];      // Entry a switch relied on the server to stop
+    uint32_t unverifiedStopEpoch = 0;
+    bool verifyStopping = false;    // VERIFY_SWITCH is stopping the entry explicitly
+
+    // A start, switch or stop that reached the server but got no response
+    // (timeout, dropped socket); settled by RECONCILE instead of resending
+    struct UnknownOutcome {
+        TogglOperation type;                      // NONE when nothing is unsettled
+        char description[MAX_DESCRIPTION_LENGTH];
+        uint32_t expectedStart;                   // Start the new entry would have, 0 if unknown
+        char entryId[MAX_ENTRY_ID_LENGTH];        // Entry running when the request was sent
+    };
+    UnknownOutcome unknownOutcome;
+    uint32_t activeDispatchEpoch = 0;
+    bool reconcileApplied = false;
+
+    // Rate limits, backoff and circuit breaker applied before each dispatch
+    RequestScheduler scheduler;
+    SystemDiagnostics* diagnostics = nullptr;
+
+    // Server clock learned from response Date headers
+    uint32_t serverEpoch = 0;
+    unsigned long serverEpochMillis = 0;
+    unsigned long pollMs = 0;       // Time of the poll() in progress
+    TogglCompletionCallback completionCallback = nullptr;
+
+    void rebuildRequestTemplates();
+    bool dispatchNextOperation();
+    bool dispatchStart(const PendingOperation& operation);
+    bool dispatchStop(const PendingOperation& operation);
+    bool submitStop(const char* entryId, uint32_t stopEpoch);
+    bool dispatchTimeSync();
+    bool dispatchVerifySwitch();
+    bool enqueue(TogglOperation type, int orientationIndex, const String& description,
+                 uint32_t epoch, uint32_t duration);
+    void completeActiveOperation();
+    bool handleStartResponse(int statusCode, const String& response);
+    bool handleCompletedEntryResponse(int statusCode, const String& response);
+    bool handleStopResponse(int statusCode, const String& response);
+    bool handleTimeSyncResponse(int statusCode, const String& response);
+    bool handleSwitchResponse(int statusCode, const String& response);
+    bool handleVerifySwitchResponse(int statusCode, const String& response);
+    bool handleReconcileResponse(int statusCode);
+    void rememberUnknownOutcome(TogglOperation operation);
+    bool waitForIdle();
+    static TogglEndpoint endpointFor(TogglOperation operation);
 
 public:
-    TogglAPI(HttpClient* httpClient);
-    
+    TogglAPI(Client* transport);
+
+    // Non-blocking API: queue an operation, then call poll() every loop iteration.
+    // An epoch of 0 lets the server use its current time.
+    bool requestStart(int orientationIndex, const String& description, uint32_t startEpoch = 0);
+    bool requestStop(uint32_t stopEpoch = 0);
+    bool requestCompletedEntry(int orientationIndex, const String& description,
+                               uint32_t startEpoch, uint32_t durationSeconds);
+    bool requestTimeSync();
+    // Stop the running entry and start a new one in a single request
+    bool requestSwitch(int orientationIndex, const String& description, uint32_t startEpoch = 0);
+    bool requestSwitchVerification();
+    // nowMs drives dispatch, backoff and timeouts; tests pass a virtual clock
+    void poll() { poll(millis()); }
+    void poll(unsigned long nowMs);
+    bool isBusy() const { return activeOperation.type != TogglOperation::NONE || pendingCount > 0; }
+    void setCompletionCallback(TogglCompletionCallback callback) { completionCallback = callback; }
+    bool wasLastOperationSuccessful() const { return lastOperationSuccess; }
+    int getLastStatusCode() const { return lastStatusCode; }
+
+    // Queued operations wait here while rate limited, backing off or with the circuit open
+    RequestScheduler& getScheduler() { return scheduler; }
+    const RequestScheduler& getScheduler() const { return scheduler; }
+    // Request results, breaker changes (via the scheduler) and request writes
+    void setDiagnostics(SystemDiagnostics* systemDiagnostics) {
+        diagnostics = systemDiagnostics;
+        scheduler.setDiagnostics(systemDiagnostics);
+    }
+
+    // A start/switch/stop timed out after being sent. requestReconcile() reads
+    // the running entry once and adopts it (or notes that nothing happened)
+    // instead of posting again; the result is in wasUnknownOutcomeApplied().
+    bool hasUnknownOutcome() const { return unknownOutcome.type != TogglOperation::NONE; }
+    bool requestReconcile();
+    bool wasUnknownOutcomeApplied() const { return reconcileApplied; }
+
+    bool canSwitch() const { return switchEnabled && switchSupport != SwitchSupport::UNSUPPORTED; }
+    bool needsSwitchVerification() const { return unverifiedEntryId[0] != '\0'; }
+    SwitchSupport getSwitchSupport() const { return switchSupport; }
+    void setSwitchEnabled(bool enabled) { switchEnabled = enabled; }
+
+    // Server clock (epoch seconds); 0 until a response carried a Date header
+    bool hasServerTime() const { return serverEpoch != 0; }
+    uint32_t currentEpoch() const { return epochAtMillis(millis()); }
+    uint32_t epochAtMillis(unsigned long ms) const;
+
+    // Blocking wrappers around the queue (setup code and hardware tests). They
+    // wait one request timeout at most, plus the request already in flight; if
+    // backoff or the circuit breaker still holds the queue they return false
+    // and the operation stays queued for poll().
     bool startTimeEntry(int orientationIndex, const String& description);
     bool stopCurrentTimeEntry();
-    
-    String getCurrentEntryId() const { return currentTimeEntryId; }
-    String getCurrentEntryName() const { return currentTimeEntryName; }
+
+    bool hasCurrentEntry() const { return currentTimeEntryId[0] != '\0'; }
+    // Entry left running before a reset, so the next stop or switch ends it; ignored once one is known
+    void restoreCurrentEntry(const char* entryId);
+    String getCurrentEntryId() const { return String(currentTimeEntryId); }
+    String getCurrentEntryName() const { return String(currentTimeEntryName); }
     int getProjectId(int orientationIndex) const;
-    
+
     // Runtime configuration setters
     void setCredentials(const String& token, const String& workspaceId);
     void setProjectIds(const int* ids);
     void clearRuntimeConfig();
-    
-    // Note: No longer needs external time setting since using millis() based timing
+
+    // Keep-alive diagnostics
+    const TogglConnectionStats& getStartConnectionStats() const { return startStats; }
+    const TogglConnectionStats& getStopConnectionStats() const { return stopStats; }
+    bool wasLastConnectionReused() const { return lastRequestReusedConnection; }
+    void closeConnection();
 };
 
 #endif // TOGGL_API_H
@@ -0,0 +1,58 @@
+#ifndef TOGGL_REQUEST_TEMPLATES_H
+#define TOGGL_REQUEST_TEMPLATES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Orientation.h"
+
+/**
+ * Request pieces that only change when the configuration does, built once
+ * by configure() so a start or stop call only patches in its variable parts.
+ *
+ * Holds the Authorization/Content-Type header block, the workspace time
+ * entry path and one POST body prefix per orientation (workspace, project
+ * and created_with already serialized). All output goes to caller buffers;
+ * nothing here touches the heap. Arduino-free for the host benchmarks.
+ */
+class TogglRequestTemplates {
+public:
+    static const int ORIENTATION_COUNT = FACE_COUNT;
+    static const size_t HEADER_BLOCK_SIZE = 192;
+    static const size_t BODY_PREFIX_SIZE = 128;
+    static const size_t PATH_PREFIX_SIZE = 64;
+    static const size_t MAX_BODY_LENGTH = 320;
+    static const size_t MAX_PATH_LENGTH = 96;
+
+    TogglRequestTemplates();
+
+    // Rebuild all templates; projectIds has ORIENTATION_COUNT entries (0 = none)
+    bool configure(const char* apiToken, const char* workspaceId, const int* projectIds);
+
+    const char* headerBlock() const { return headers; }
+
+    /**
+     * Body for POST /api/v9/time_entries.
+     * @param startEpoch explicit start, 0 for the server's current time
+     * @param duration seconds, or -1 for a running entry
+     * @return body length, 0 if it did not fit
+     */
+    size_t formatStartBody(int orientationIndex, const char* description, uint32_t startEpoch,
+                           long duration, char* out, size_t size) const;
+
+    // {"stop":"<ISO 8601>"} for back-dated stops
+    size_t formatStopBody(uint32_t stopEpoch, char* out, size_t size) const;
+
+    // /api/v9/workspaces/{wid}/time_entries/{entryId}{suffix}
+    size_t formatEntryPath(const char* entryId, const char* suffix, char* out, size_t size) const;
+
+    static size_t base64Encode(const char* in, size_t length, char* out, size_t size);
+
+private:
+    char headers[HEADER_BLOCK_SIZE];
+    char entryPathPrefix[PATH_PREFIX_SIZE];
+    size_t entryPathPrefixLength;
+    char bodyPrefix[ORIENTATION_COUNT][BODY_PREFIX_SIZE];
+    size_t bodyPrefixLength[ORIENTATION_COUNT];
+};
+
+#endif // TOGGL_REQUEST_TEMPLATES_H
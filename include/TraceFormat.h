@@ -0,0 +1,72 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ImuBackend.h"
+
+/**
+ * Binary accelerometer trace as streamed over serial by TraceRecorder.
+ *
+ * Every frame is 0xA5, a type byte, the payload (little-endian) and a checksum
+ * that makes the byte sum of the whole frame zero:
+ *
+ *   'T'  uint32 ms                       absolute time, starts a trace and resyncs it
+ *   'S'  uint16 dt_ms, int16 x, y, z     one sample in milli-g, dt after the previous frame
+ *
+ * A sample costs 11 bytes, about 290 bytes/s at 26 Hz. Log lines printed to
+ * the same port are plain ASCII and never start a frame, so the decoder skips
+ * them, and it drops any frame whose checksum does not add up.
+ */
+namespace TraceFormat {
+    static const uint8_t SYNC = 0xA5;
+    static const uint8_t TYPE_TIME = 'T';
+    static const uint8_t TYPE_SAMPLE = 'S';
+    static const int TIME_FRAME_BYTES = 7;
+    static const int SAMPLE_FRAME_BYTES = 11;
+    static const int MAX_FRAME_BYTES = SAMPLE_FRAME_BYTES;
+
+    // Encoders return the number of bytes written to out
+    int encodeTime(uint32_t ms, uint8_t* out);
+    int encodeSample(uint16_t dtMs, const AccelSample& sample, uint8_t* out);
+}
+
+struct TraceRecord {
+    uint32_t ms;          // Absolute time of the sample
+    AccelSample sample;
+};
+
+struct TraceDecoderStats {
+    unsigned long samples;
+    unsigned long timeFrames;
+    unsigned long badFrames;      // Checksum mismatch or unknown type
+    unsigned long skippedBytes;   // Outside any frame (log text, noise)
+};
+
+/**
+ * Incremental decoder; bytes can come straight from a capture file or port.
+ * Samples before the first time frame are dropped, as their time is unknown.
+ */
+class TraceDecoder {
+public:
+    TraceDecoder();
+
+    void reset();
+    // Returns true when byte completed a sample, stored in record
+    bool feed(uint8_t byte, TraceRecord& record);
+
+    const TraceDecoderStats& getStats() const { return stats; }
+
+private:
+    uint8_t frame[TraceFormat::MAX_FRAME_BYTES];
+    int length;
+    int expected;
+    bool haveTime;
+    uint32_t timeMs;
+    TraceDecoderStats stats;
+
+    bool completeFrame(TraceRecord& record);
+    void resync();
+};
+
+#endif // TRACE_FORMAT_H
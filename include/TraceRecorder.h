@@ -0,0 +1,39 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <Arduino.h>
+#include "TraceFormat.h"
+
+/**
+ * Streams raw accelerometer samples in the TraceFormat framing, for replay on
+ * a host (tools/trace_replay). Enabled with Config::IMU_TRACE_ENABLED.
+ *
+ * Samples from a FIFO batch all arrive at once; they are back-dated one
+ * sample period apart so the trace keeps the sensor's timing. A time frame is
+ * repeated every TIME_FRAME_INTERVAL samples, so a capture started while the
+ * cube is already running locks on within a few seconds.
+ */
+class TraceRecorder {
+public:
+    static const int TIME_FRAME_INTERVAL = 256;
+
+    explicit TraceRecorder(Print& output);
+
+    // Samples oldest first; nowMs is when the newest one was read
+    void record(const AccelSample* samples, int count, unsigned long nowMs, unsigned long samplePeriodMs);
+
+    unsigned long getSamplesWritten() const { return samplesWritten; }
+    unsigned long getBytesWritten() const { return bytesWritten; }
+
+private:
+    Print& out;
+    bool started;
+    unsigned long lastMs;
+    int sinceTimeFrame;
+    unsigned long samplesWritten;
+    unsigned long bytesWritten;
+
+    void writeTime(unsigned long ms);
+};
+
+#endif // TRACE_RECORDER_H
@@ -0,0 +1,410 @@
+#include "AsyncHttpClient.h"
+#include "TimeUtils.h"
+
+static bool headerNameEquals(const char* line, unsigned int nameLength, const char* expected) {
+    if (strlen(expected) != nameLength) return false;
+    for (unsigned int i = 0; i < nameLength; i++) {
+        if (tolower((unsigned char)line[i]) != expected[i]) return false;
+    }
+    return true;
+}
+
+static bool valueContains(const char* value, const char* token) {
+    // Case-insensitive substring search for short header values
+    size_t tokenLength = strlen(token);
+    for (const char* p = value; *p; p++) {
+        size_t i = 0;
+        while (i < tokenLength && p[i] && tolower((unsigned char)p[i]) == token[i]) i++;
+        if (i == tokenLength) return true;
+    }
+    return false;
+}
+
+AsyncHttpClient::AsyncHttpClient(Client& transport, const char* serverHost, uint16_t serverPort)
+    : client(transport), host(serverHost), port(serverPort), state(IDLE),
+      timeout(DEFAULT_TIMEOUT_MS), requestStartTime(0), requestBody(nullptr), requestBodyLength(0), bytesSent(0),
+      requestSent(false), requestWrites(0), flushBytes(0), connectionReused(false), staleReconnect(false), receivedAnyByte(false),
+      bodyMode(BUFFER_BODY), bodySink(nullptr),
+      lineLength(0), statusCode(0), contentLength(-1), bodyBytesRead(0),
+      chunked(false), connectionClose(false), serverDate(0), retryAfterSeconds(0), retryAfterDate(0),
+      chunkState(CHUNK_SIZE), chunkRemaining(0) {
+    lineBuffer[0] = '\0';
+}
+
+bool AsyncHttpClient::begin(const char* method, const char* path) {
+    if (isBusy()) return false;
+
+    request.begin(method, path, host);
+    requestBody = nullptr;
+    requestBodyLength = 0;
+    requestSent = false;
+    statusCode = 0;
+    responseBody = "";
+    bodyMode = BUFFER_BODY;
+    bodySink = nullptr;
+    state = IDLE;
+    return true;
+}
+
+void AsyncHttpClient::addHeader(const char* name, const char* value) {
+    request.addHeader(name, value);
+}
+
+void AsyncHttpClient::addHeaders(const char* lines) {
+    request.addRaw(lines);
+}
+
+void AsyncHttpClient::setBody(const char* body) {
+    setBody(body, body ? strlen(body) : 0);
+}
+
+void AsyncHttpClient::setBody(const char* body, size_t length) {
+    requestBody = body;
+    requestBodyLength = length;
+}
+
+void AsyncHttpClient::streamBodyTo(HttpBodySink* sink) {
+    bodyMode = sink ? STREAM_BODY : DISCARD_BODY;
+    bodySink = sink;
+}
+
+void AsyncHttpClient::discardBody() {
+    bodyMode = DISCARD_BODY;
+    bodySink = nullptr;
+}
+
+bool AsyncHttpClient::submit(unsigned long nowMs) {
+    if (isBusy() || request.isEmpty()) return false;
+
+    request.finish(requestBody, requestBodyLength);
+    requestBody = nullptr;
+    requestBodyLength = 0;
+    if (request.overflowed()) {
+        Serial.println("[HTTP] Request does not fit the request buffer");
+        request.clear();
+        return false;
+    }
+
+    staleReconnect = false;
+    requestStartTime = nowMs;
+    state = CONNECTING;
+    return true;
+}
+
+AsyncHttpClient::State AsyncHttpClient::poll(unsigned long nowMs) {
+    // Run consecutive states in one call as long as no network wait is needed
+    State previous;
+    do {
+        previous = state;
+        switch (state) {
+            case CONNECTING:
+                handleConnecting();
+                break;
+            case SENDING:
+                handleSending();
+                break;
+            case READING_STATUS:
+            case READING_HEADERS:
+            case READING_BODY:
+                handleReading();
+                break;
+            default:
+                return state;
+        }
+    } while (state != previous && isBusy() && previous != READING_STATUS &&
+             previous != READING_HEADERS && previous != READING_BODY);
+
+    if (isBusy() && nowMs - requestStartTime > timeout) {
+        Serial.println("[HTTP] Request timed out");
+        fail(ERROR_TIMED_OUT);
+    }
+    return state;
+}
+
+uint32_t AsyncHttpClient::getRetryAfterSeconds() const {
+    if (retryAfterDate != 0 && serverDate != 0) {
+        return retryAfterDate > serverDate ? retryAfterDate - serverDate : 0;
+    }
+    return retryAfterSeconds;
+}
+
+void AsyncHttpClient::stop() {
+    client.stop();
+    if (isBusy()) {
+        state = FAILED;
+        statusCode = ERROR_API;
+    }
+}
+
+void AsyncHttpClient::handleConnecting() {
+    // Reset per-attempt response state
+    bytesSent = 0;
+    requestSent = false;
+    requestWrites = 0;
+    flushBytes = 0;
+    receivedAnyByte = false;
+    lineLength = 0;
+    statusCode = 0;
+    contentLength = -1;
+    bodyBytesRead = 0;
+    chunked = false;
+    connectionClose = false;
+    serverDate = 0;
+    retryAfterSeconds = 0;
+    retryAfterDate = 0;
+    chunkState = CHUNK_SIZE;
+    chunkRemaining = 0;
+    responseBody = "";
+
+    if (client.connected()) {
+        connectionReused = true;
+        state = SENDING;
+        return;
+    }
+
+    // The TLS handshake itself is a blocking call on WiFiNINA; with keep-alive
+    // it is only paid when the socket has to be re-established
+    connectionReused = false;
+    client.stop();
+    if (!client.connect(host, port)) {
+        Serial.println("[HTTP] Connection failed");
+        fail(ERROR_CONNECTION_FAILED);
+        return;
+    }
+    state = SENDING;
+}
+
+void AsyncHttpClient::handleSending() {
+    // The whole composed request in one write: on WiFiNINA each write is an
+    // SPI command to the co-processor and usually its own TLS record
+    size_t written = client.write((const uint8_t*)request.data() + bytesSent, request.length() - bytesSent);
+    requestWrites++;
+    if (written == 0) {
+        if (!retryOnFreshConnection()) {
+            fail(ERROR_CONNECTION_FAILED);
+        }
+        return;
+    }
+
+    bytesSent += written;
+    if (bytesSent >= request.length()) {
+        // End of request: push out whatever the transport still holds
+        client.clearWriteError();
+        client.flush();
+        flushBytes = bytesSent;
+        if (client.getWriteError()) {
+            if (!retryOnFreshConnection()) {
+                fail(ERROR_CONNECTION_FAILED);
+            }
+            return;
+        }
+        requestSent = true;
+        state = READING_STATUS;
+    }
+}
+
+void AsyncHttpClient::handleReading() {
+    int budget = MAX_BYTES_PER_POLL;
+    while (budget-- > 0 && client.available() > 0) {
+        int c = client.read();
+        if (c < 0) break;
+        receivedAnyByte = true;
+        if (!processByte((uint8_t)c)) {
+            return; // Response finished or failed
+        }
+    }
+
+    if (client.available() > 0 || client.connected()) {
+        return; // Wait for more data on a later poll
+    }
+
+    // Socket closed by the server
+    if (state == READING_BODY && !chunked && contentLength < 0) {
+        finish(); // Body delimited by connection close
+    } else if (!retryOnFreshConnection()) {
+        fail(ERROR_CONNECTION_FAILED);
+    }
+}
+
+bool AsyncHttpClient::processByte(uint8_t c) {
+    switch (state) {
+        case READING_STATUS:
+            if (readLine(c)) {
+                parseStatusLine();
+                lineLength = 0;
+                if (statusCode <= 0) {
+                    fail(ERROR_INVALID_RESPONSE);
+                    return false;
+                }
+                state = READING_HEADERS;
+            }
+            return true;
+
+        case READING_HEADERS:
+            if (readLine(c)) {
+                if (lineLength == 0) {
+                    // End of headers
+                    if (statusCode >= 100 && statusCode < 200) {
+                        state = READING_STATUS; // Interim response, real status follows
+                        return true;
+                    }
+                    if (!chunked && (contentLength == 0 || statusCode == 204 || statusCode == 304)) {
+                        finish();
+                        return false;
+                    }
+                    state = READING_BODY;
+                    chunkState = CHUNK_SIZE;
+                    return true;
+                }
+                parseHeaderLine();
+                lineLength = 0;
+            }
+            return true;
+
+        case READING_BODY:
+            return processBodyByte(c);
+
+        default:
+            return false;
+    }
+}
+
+bool AsyncHttpClient::readLine(uint8_t c) {
+    if (c == '\r') return false;
+    if (c == '\n') {
+        lineBuffer[lineLength] = '\0';
+        return true;
+    }
+    // Over-long lines are truncated; only short headers are of interest
+    if (lineLength < sizeof(lineBuffer) - 1) {
+        lineBuffer[lineLength++] = (char)c;
+    }
+    return false;
+}
+
+void AsyncHttpClient::parseStatusLine() {
+    // "HTTP/1.1 200 OK"
+    statusCode = 0;
+    if (strncmp(lineBuffer, "HTTP/", 5) != 0) return;
+    const char* space = strchr(lineBuffer, ' ');
+    if (space) {
+        statusCode = atoi(space + 1);
+    }
+}
+
+void AsyncHttpClient::parseHeaderLine() {
+    const char* colon = strchr(lineBuffer, ':');
+    if (!colon) return;
+
+    unsigned int nameLength = colon - lineBuffer;
+    const char* value = colon + 1;
+    while (*value == ' ') value++;
+
+    if (headerNameEquals(lineBuffer, nameLength, "content-length")) {
+        contentLength = atol(value);
+    } else if (headerNameEquals(lineBuffer, nameLength, "transfer-encoding")) {
+        chunked = valueContains(value, "chunked");
+    } else if (headerNameEquals(lineBuffer, nameLength, "connection")) {
+        connectionClose = valueContains(value, "close");
+    } else if (headerNameEquals(lineBuffer, nameLength, "date")) {
+        serverDate = TimeUtils::parseHttpDate(value);
+    } else if (headerNameEquals(lineBuffer, nameLength, "retry-after")) {
+        // Either delta-seconds or an HTTP date (resolved against Date later)
+        if (*value >= '0' && *value <= '9') {
+            retryAfterSeconds = strtoul(value, nullptr, 10);
+        } else {
+            retryAfterDate = TimeUtils::parseHttpDate(value);
+        }
+    }
+}
+
+bool AsyncHttpClient::processBodyByte(uint8_t c) {
+    if (!chunked) {
+        storeBodyByte(c);
+        bodyBytesRead++;
+        if (contentLength >= 0 && bodyBytesRead >= contentLength) {
+            finish();
+            return false;
+        }
+        return true;
+    }
+
+    switch (chunkState) {
+        case CHUNK_SIZE:
+            if (readLine(c)) {
+                chunkRemaining = strtol(lineBuffer, nullptr, 16);
+                lineLength = 0;
+                chunkState = chunkRemaining > 0 ? CHUNK_DATA : CHUNK_TRAILER;
+            }
+            return true;
+
+        case CHUNK_DATA:
+            storeBodyByte(c);
+            bodyBytesRead++;
+            if (--chunkRemaining == 0) {
+                chunkState = CHUNK_DATA_END;
+            }
+            return true;
+
+        case CHUNK_DATA_END:
+            if (readLine(c)) {
+                lineLength = 0;
+                chunkState = CHUNK_SIZE;
+            }
+            return true;
+
+        case CHUNK_TRAILER:
+            if (readLine(c)) {
+                bool emptyLine = lineLength == 0;
+                lineLength = 0;
+                if (emptyLine) {
+                    finish();
+                    return false;
+                }
+            }
+            return true;
+    }
+    return true;
+}
+
+void AsyncHttpClient::storeBodyByte(uint8_t c) {
+    bool success = statusCode >= 200 && statusCode < 300;
+    if (success && bodyMode == STREAM_BODY) {
+        bodySink->onBodyByte(c);
+        return;
+    }
+    if (success && bodyMode == DISCARD_BODY) {
+        return;
+    }
+    unsigned int limit = bodyMode == BUFFER_BODY ? MAX_BODY_LENGTH : MAX_ERROR_BODY_LENGTH;
+    if (responseBody.length() < limit) {
+        responseBody += (char)c;
+    }
+}
+
+bool AsyncHttpClient::retryOnFreshConnection() {
+    // A kept-alive socket can be closed by the server between requests without
+    // us noticing; only a reused socket that produced no response is retried
+    if (!connectionReused || receivedAnyByte || staleReconnect) {
+        return false;
+    }
+    Serial.println("[HTTP] Kept-alive connection was closed by server, reconnecting");
+    staleReconnect = true;
+    client.stop();
+    state = CONNECTING;
+    return true;
+}
+
+void AsyncHttpClient::finish() {
+    state = COMPLETE;
+    if (connectionClose || (!chunked && contentLength < 0)) {
+        client.stop();
+    }
+}
+
+void AsyncHttpClient::fail(int errorCode) {
+    statusCode = errorCode;
+    state = FAILED;
+    // The socket may still deliver a late response; never reuse it
+    client.stop();
+}
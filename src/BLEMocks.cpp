@@ -1,5 +1,6 @@
 #include "BLEMocks.h"
 #include <ArduinoBLE.h>
+#include "Orientation.h"
 
 // Mock BLE service state
 static bool bleInitialized = false;
@@ -8,7 +9,7 @@ static String mockWifiSSID = "";
 static String mockWifiPassword = "";
 static String mockTogglToken = "";
 static String mockWorkspaceId = "";
-static int mockProjectIds[6] = {0, 0, 0, 0, 0, 0};
+static int mockProjectIds[FACE_COUNT] = {0};
 
 bool simpleBLEBegin() {
     // Initialize BLE if not already done
@@ -77,7 +78,7 @@ bool processManagementCommand(const String& command) {
         mockWifiPassword = "";
         mockTogglToken = "";
         mockWorkspaceId = "";
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             mockProjectIds[i] = 0;
         }
         bleConfigComplete = false;
@@ -119,7 +120,7 @@ void setMockTogglCredentials(const String& token, const String& workspace) {
 
 void setMockProjectIds(const int* projects) {
     if (projects) {
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             mockProjectIds[i] = projects[i];
         }
     }
@@ -1,4 +1,4 @@
 #include "Config.h"
 
 // Default project IDs (to be configured via BLE)
-int Config::DEFAULT_PROJECT_IDS[6] = {0, 0, 0, 0, 0, 0};
\ No newline at end of file
+int Config::DEFAULT_PROJECT_IDS[FACE_COUNT] = {0};
\ No newline at end of file
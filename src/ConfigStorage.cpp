@@ -1,22 +1,137 @@
 #include "ConfigStorage.h"
+#include "Crc16.h"
 
-ConfigStorage::ConfigStorage() {
+ConfigStorage::ConfigStorage()
+    : flash(nullptr), state(nullptr), activeSlot(-1), slotSequence(0), flashHealthy(true) {
     // Initialize config structure
     memset(&config, 0, sizeof(StoredConfig));
     config.version = CONFIG_VERSION;
     config.isValid = false;
     config.lastUpdateTime = 0;
     
+    memset(&calibration, 0, sizeof(calibration));
+    
     // Initialize backup structure
     memset(&backup, 0, sizeof(BackupConfig));
     backup.hasBackup = false;
 }
 
+ConfigStorage::ConfigStorage(FlashRegion& flashRegion, KvStore* stateStore) : ConfigStorage() {
+    flash = &flashRegion;
+    state = stateStore;
+}
+
 bool ConfigStorage::begin() {
-    Serial.println("Initializing memory-based configuration storage");
-    // For now, just initialize with empty config
-    // In production, this would load from flash storage
-    config.isValid = false;
+    // Calibration applies even before (or without) a valid BLE configuration
+    ImuCalibrationData stored;
+    if (state && state->get(KV_KEY_IMU_CALIBRATION, stored) && stored.valid) {
+        calibration = stored;
+    }
+    
+    if (!flash) {
+        Serial.println("Initializing memory-based configuration storage");
+        config.isValid = false;
+        return true;
+    }
+    
+    Serial.println("Initializing flash configuration storage");
+    if (!slotsUsable()) {
+        Serial.println("Configuration flash region too small - keeping configuration in memory only");
+        flash = nullptr;
+        config.isValid = false;
+        return false;
+    }
+    
+    if (!readNewestSlot()) {
+        Serial.println("No stored configuration in flash");
+    }
+    return true;
+}
+
+uint32_t ConfigStorage::slotSize() const {
+    return flash->size() / 2;
+}
+
+bool ConfigStorage::slotsUsable() const {
+    uint32_t sector = flash->sectorSize();
+    return sector > 0 && slotSize() % sector == 0 &&
+           slotSize() >= sizeof(ConfigSlotHeader) + sizeof(StoredConfig);
+}
+
+uint16_t ConfigStorage::slotCrc(const StoredConfig& cfg, const ConfigSlotHeader& header) {
+    uint16_t crc = crc16((const uint8_t*)&cfg, sizeof(StoredConfig));
+    crc = crc16((const uint8_t*)&header.sequence, sizeof(header.sequence), crc);
+    return crc16((const uint8_t*)&header.length, sizeof(header.length), crc);
+}
+
+bool ConfigStorage::readSlot(int slot, ConfigSlotHeader& header) {
+    return flash->read(slot * slotSize(), &header, sizeof(header)) &&
+           header.magic == CONFIG_SLOT_MAGIC && header.length == sizeof(StoredConfig);
+}
+
+bool ConfigStorage::readNewestSlot() {
+    // Both headers, then the newer slot's config; the older one only if that fails its CRC
+    ConfigSlotHeader headers[2];
+    bool present[2] = {readSlot(0, headers[0]), readSlot(1, headers[1])};
+    int first = present[1] && (!present[0] || headers[1].sequence > headers[0].sequence) ? 1 : 0;
+    
+    for (int attempt = 0; attempt < 2; attempt++) {
+        int slot = attempt == 0 ? first : 1 - first;
+        if (!present[slot]) continue;
+        StoredConfig stored;
+        if (!flash->read(slot * slotSize() + sizeof(ConfigSlotHeader), &stored, sizeof(stored))) continue;
+        if (slotCrc(stored, headers[slot]) != headers[slot].crc) {
+            Serial.print("Configuration slot ");
+            Serial.print(slot);
+            Serial.println(" failed its CRC check");
+            continue;
+        }
+        config = stored;
+        activeSlot = slot;
+        slotSequence = headers[slot].sequence;
+        return true;
+    }
+    activeSlot = -1;
+    slotSequence = 0;
+    return false;
+}
+
+bool ConfigStorage::store() {
+    if (!flash) {
+        Serial.println("Configuration saved to memory (not persistent across power cycles)");
+        return true;
+    }
+    
+    // Into the other slot, so the current copy survives a power cut during the write
+    int slot = activeSlot == 0 ? 1 : 0;
+    uint32_t start = slot * slotSize();
+    for (uint32_t offset = 0; offset < slotSize(); offset += flash->sectorSize()) {
+        if (!flash->eraseSector(start + offset)) {
+            flashHealthy = false;
+            Serial.println("Configuration flash erase failed");
+            return false;
+        }
+    }
+    
+    ConfigSlotHeader header;
+    header.magic = CONFIG_SLOT_MAGIC;
+    header.sequence = slotSequence + 1;
+    header.length = sizeof(StoredConfig);
+    header.crc = slotCrc(config, header);
+    
+    // Header last: the slot only counts once the config is all there
+    if (!flash->program(start + sizeof(ConfigSlotHeader), &config, sizeof(config)) ||
+        !flash->program(start, &header, sizeof(header))) {
+        flashHealthy = false;
+        Serial.println("Configuration flash write failed");
+        return false;
+    }
+    
+    activeSlot = slot;
+    slotSequence = header.sequence;
+    flashHealthy = true;
+    Serial.print("Configuration saved to flash slot ");
+    Serial.println(slot);
     return true;
 }
 
@@ -43,7 +158,7 @@ bool ConfigStorage::validateChecksum(const StoredConfig& cfg) const {
 bool ConfigStorage::saveConfiguration(const String& ssid, const String& password, 
                                      const String& token, const String& workspace,
                                      const int* projects) {
-    Serial.println("Saving configuration to EEPROM...");
+    Serial.println("Saving configuration...");
     
     // Clear the structure
     memset(&config, 0, sizeof(StoredConfig));
@@ -77,18 +192,20 @@ bool ConfigStorage::saveConfiguration(const String& ssid, const String& password
     // Calculate and set checksum
     config.checksum = calculateChecksum(config);
     
-    // For now, just keep in memory (no persistent storage)
-    // TODO: Implement flash storage for production
-    Serial.println("Configuration saved to memory (not persistent across power cycles)");
-    return true;
+    return store();
 }
 
 bool ConfigStorage::loadConfiguration() {
-    Serial.println("Loading configuration from memory...");
+    if (flash) {
+        Serial.println("Loading configuration from flash...");
+        readNewestSlot();
+    } else {
+        // For memory-based storage, configuration is only valid if it was set this session
+        Serial.println("Loading configuration from memory...");
+    }
     
-    // For memory-based storage, configuration is only valid if it was set this session
     if (!config.isValid) {
-        Serial.println("No valid configuration in memory");
+        Serial.println("No valid configuration stored");
         return false;
     }
     
@@ -125,13 +242,54 @@ void ConfigStorage::clearConfiguration() {
     memset(&config, 0, sizeof(StoredConfig));
     config.version = CONFIG_VERSION;
     config.isValid = false;
-    
-    // For memory-based storage, just clear the in-memory config
-    // TODO: Implement flash storage clear for production
+    store();
     
     Serial.println("Configuration cleared");
 }
 
+bool ConfigStorage::saveCalibration(const ImuCalibrationData& data) {
+    if (!data.valid) {
+        return false;
+    }
+    calibration = data;
+    if (state && !state->put(KV_KEY_IMU_CALIBRATION, calibration)) {
+        flashHealthy = false;
+        Serial.println("IMU calibration write failed");
+        return false;
+    }
+    Serial.println("IMU calibration saved");
+    return true;
+}
+
+void ConfigStorage::clearCalibration() {
+    memset(&calibration, 0, sizeof(calibration));
+    if (state && !state->remove(KV_KEY_IMU_CALIBRATION)) {
+        flashHealthy = false;
+    }
+    Serial.println("IMU calibration cleared");
+}
+
+bool ConfigStorage::checkSetupRequest() {
+    if (!state || !state->isReady()) {
+        return false;
+    }
+    if (state->contains(KV_KEY_STARTUP_MARK)) {
+        // Not armed again: one more reset during setup boots the stored configuration
+        state->remove(KV_KEY_STARTUP_MARK);
+        Serial.println("Reset during startup - BLE setup requested");
+        return true;
+    }
+    uint8_t mark = 1;
+    state->put(KV_KEY_STARTUP_MARK, mark);
+    return false;
+}
+
+void ConfigStorage::finishStartup() {
+    if (state && state->isReady()) {
+        state->remove(KV_KEY_STARTUP_MARK);
+    }
+}
+
 void ConfigStorage::printConfiguration() const {
     Serial.println("=== Configuration Status ===");
     Serial.print("Version: ");
@@ -140,6 +298,8 @@ void ConfigStorage::printConfiguration() const {
     Serial.println(config.isValid ? "Yes" : "No");
     Serial.print("Checksum: ");
     Serial.println(config.checksum);
+    Serial.print("IMU calibrated: ");
+    Serial.println(calibration.valid ? "Yes" : "No");
     
     if (config.isValid) {
         Serial.print("WiFi SSID: ");
@@ -150,7 +310,7 @@ void ConfigStorage::printConfiguration() const {
         Serial.println(config.workspaceId);
         
         Serial.println("Project IDs:");
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             Serial.print("  [" + String(i) + "]: ");
             Serial.println(config.projectIds[i]);
         }
@@ -202,7 +362,7 @@ bool ConfigStorage::validateProjectIds(const int* projects) const {
         return false; // Null pointer
     }
     
-    for (int i = 0; i < 6; i++) {
+    for (int i = 0; i < FACE_COUNT; i++) {
         if (projects[i] < 0 || projects[i] >= 1000000000) {
             return false; // Invalid project ID range
         }
@@ -260,9 +420,10 @@ bool ConfigStorage::restoreFromBackup() {
     // Restore from backup
     memcpy(&config, &backup.config, sizeof(StoredConfig));
     config.lastUpdateTime = millis();
+    config.checksum = calculateChecksum(config);
     
     Serial.println("Configuration restored from backup");
-    return true;
+    return store();
 }
 
 bool ConfigStorage::factoryReset() {
@@ -285,11 +446,14 @@ uint32_t ConfigStorage::getLastUpdateTimestamp() const {
 }
 
 bool ConfigStorage::isStorageHealthy() const {
-    // For memory-based storage, always healthy unless corrupted
+    // Healthy unless the last flash write failed or the config is corrupted
+    if (!flashHealthy) return false;
     return hasValidConfiguration() ? validateCompleteConfiguration(config) : true;
 }
 
 size_t ConfigStorage::getStorageUsage() const {
-    // For memory-based storage, return the size of our config structure
-    return sizeof(StoredConfig) + sizeof(BackupConfig);
+    // RAM for the config and its backup, plus both slots when stored in flash
+    size_t usage = sizeof(StoredConfig) + sizeof(BackupConfig);
+    if (flash) usage += 2 * (sizeof(ConfigSlotHeader) + sizeof(StoredConfig));
+    return usage;
 }
\ No newline at end of file
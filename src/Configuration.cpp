@@ -6,7 +6,7 @@ const char *password = "IoT99Rul3s.";
 const char *togglApiToken = "8512ae2df80f50ecaa5a7e0c4c96cc57";
 const int workspaceId = 20181448; // YOUR_WORKSPACE_ID
 
-const char* projectNames[6] = {
+const char* projectNames[FACE_COUNT] = {
     "Break Time",         // FACE_UP (now stops timers)
     "Face Down Project",  // FACE_DOWN  
     "Left Side Project",  // LEFT_SIDE
@@ -17,7 +17,7 @@ const char* projectNames[6] = {
 
 // Direct Toggl project ID mapping for each orientation
 // FACE_UP = 0 (disabled, break time), others set to your actual project IDs
-const int orientationProjectIds[6] = {
+const int orientationProjectIds[FACE_COUNT] = {
     0,          // FACE_UP - disabled (break time)
     212267805,          // FACE_DOWN - set to your project ID
     212267804,          // LEFT_SIDE - set to your project ID  
@@ -0,0 +1,277 @@
+#include "EventJournal.h"
+#include <Arduino.h>
+#include <string.h>
+#include "Crc16.h"
+
+static const uint32_t RECORD_SIZE = sizeof(JournalRecord);
+static_assert(sizeof(JournalRecord) == 16, "Journal records must fill a 16-byte slot");
+
+EventJournal::EventJournal(FlashRegion& flashRegion)
+    : flash(flashRegion), ready(false), slotCount(0), slotsPerSector(0),
+      headSlot(0), oldestSlot(0), scanSlot(0), full(false), nextSequence(1), lastEventSequence(0),
+      committedThrough(0), bootId(1), segmentOpen(false), segmentOrientation(0),
+      droppedEvents(0) {
+}
+
+bool EventJournal::begin() {
+    ready = false;
+    uint32_t sector = flash.sectorSize();
+    if (sector == 0 || sector % RECORD_SIZE != 0 || flash.size() < 2 * sector) {
+        Serial.println("[JOURNAL] Flash region too small or misaligned");
+        return false;
+    }
+    slotsPerSector = sector / RECORD_SIZE;
+    slotCount = flash.size() / RECORD_SIZE;
+
+    nextSequence = 1;
+    lastEventSequence = 0;
+    committedThrough = 0;
+    segmentOpen = false;
+    segmentOrientation = 0;
+    droppedEvents = 0;
+
+    bool found = false;
+    bool dirty = false;
+    uint32_t highestSequence = 0;
+    uint32_t lowestSequence = ERASED_SEQUENCE;
+    uint32_t highestSlot = 0;
+    uint16_t lastBootId = 0;
+
+    for (uint32_t slot = 0; slot < slotCount; slot++) {
+        JournalRecord record;
+        if (!readSlot(slot, record)) {
+            if (!isSlotErased(slot)) dirty = true;
+            continue;
+        }
+        found = true;
+
+        if (record.sequence >= highestSequence) {
+            highestSequence = record.sequence;
+            highestSlot = slot;
+            lastBootId = record.bootId;
+        }
+        if (record.sequence < lowestSequence) {
+            lowestSequence = record.sequence;
+            oldestSlot = slot;
+        }
+        if ((JournalEventType)record.type == JournalEventType::COMMIT) {
+            if (record.timestamp > committedThrough) committedThrough = record.timestamp;
+        } else if (record.sequence > lastEventSequence) {
+            lastEventSequence = record.sequence;
+            segmentOpen = (JournalEventType)record.type == JournalEventType::START;
+            segmentOrientation = record.orientation;
+        }
+    }
+
+    if (!found) {
+        // Blank region, or nothing but garbage from an older firmware
+        if (dirty && !format()) return false;
+        headSlot = 0;
+        oldestSlot = 0;
+        bootId = 1;
+    } else {
+        nextSequence = highestSequence + 1;
+        bootId = lastBootId + 1;
+        headSlot = (highestSlot + 1) % slotCount;
+        // Skip slots torn by a power cut during the last write
+        while (headSlot % slotsPerSector != 0 && !isSlotErased(headSlot)) {
+            headSlot = (headSlot + 1) % slotCount;
+        }
+    }
+    // The slot after the newest record holds the oldest one only once the ring is full
+    full = found && headSlot == oldestSlot;
+    scanSlot = oldestSlot;
+    ready = true;
+
+    Serial.print("[JOURNAL] Ready - boot ");
+    Serial.print(bootId);
+    Serial.print(", next sequence ");
+    Serial.print(nextSequence);
+    Serial.print(", pending events ");
+    Serial.println(countPending());
+    return true;
+}
+
+bool EventJournal::format() {
+    uint32_t sector = flash.sectorSize();
+    for (uint32_t offset = 0; offset < flash.size(); offset += sector) {
+        if (!flash.eraseSector(offset)) {
+            Serial.println("[JOURNAL] Sector erase failed during format");
+            return false;
+        }
+    }
+    headSlot = 0;
+    oldestSlot = 0;
+    scanSlot = 0;
+    full = false;
+    nextSequence = 1;
+    lastEventSequence = 0;
+    committedThrough = 0;
+    segmentOpen = false;
+    return true;
+}
+
+bool EventJournal::recordStart(uint8_t orientation, uint32_t epoch, unsigned long nowMs) {
+    bool relative = epoch == 0;
+    if (!append(JournalEventType::START, orientation,
+                relative ? (uint32_t)nowMs : epoch, relative ? FLAG_RELATIVE_TIME : 0)) {
+        return false;
+    }
+    segmentOpen = true;
+    segmentOrientation = orientation;
+    return true;
+}
+
+bool EventJournal::recordStop(uint32_t epoch, unsigned long nowMs) {
+    bool relative = epoch == 0;
+    if (!append(JournalEventType::STOP, segmentOrientation,
+                relative ? (uint32_t)nowMs : epoch, relative ? FLAG_RELATIVE_TIME : 0)) {
+        return false;
+    }
+    segmentOpen = false;
+    return true;
+}
+
+int EventJournal::readPending(JournalRecord* out, int maxRecords) {
+    if (!ready || !hasPending()) return 0;
+
+    int count = 0;
+    bool cursorMoved = false;
+    uint32_t slot = scanSlot;
+    for (uint32_t n = slotsToScan(); n > 0 && count < maxRecords; n--, slot = (slot + 1) % slotCount) {
+        JournalRecord record;
+        if (readSlot(slot, record) && isEvent(record) && record.sequence > committedThrough) {
+            if (!cursorMoved) {
+                // Everything before this slot is delivered; start there next time
+                scanSlot = slot;
+                cursorMoved = true;
+            }
+            out[count++] = record;
+        }
+    }
+    if (!cursorMoved) scanSlot = headSlot;
+    return count;
+}
+
+bool EventJournal::commitThrough(uint32_t sequence) {
+    if (sequence <= committedThrough) return true;
+    if (!append(JournalEventType::COMMIT, 0, sequence, 0)) return false;
+    committedThrough = sequence;
+    return true;
+}
+
+uint32_t EventJournal::countPending() {
+    if (!ready || !hasPending()) return 0;
+
+    uint32_t count = 0;
+    uint32_t slot = scanSlot;
+    for (uint32_t n = slotsToScan(); n > 0; n--, slot = (slot + 1) % slotCount) {
+        JournalRecord record;
+        if (readSlot(slot, record) && isEvent(record) && record.sequence > committedThrough) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool EventJournal::append(JournalEventType type, uint8_t orientation, uint32_t timestamp, uint8_t flags) {
+    if (!ready) return false;
+
+    if (headSlot % slotsPerSector == 0) {
+        bool erased = false;
+        if (!prepareSector(headSlot, erased)) return false;
+        // The latest COMMIT may have lived in the erased sector; restate it
+        if (erased && committedThrough > 0 && type != JournalEventType::COMMIT) {
+            if (!writeSlot(JournalEventType::COMMIT, 0, committedThrough, 0)) return false;
+        }
+    }
+    return writeSlot(type, orientation, timestamp, flags);
+}
+
+bool EventJournal::writeSlot(JournalEventType type, uint8_t orientation, uint32_t timestamp, uint8_t flags) {
+    JournalRecord record;
+    record.sequence = nextSequence;
+    record.timestamp = timestamp;
+    record.bootId = bootId;
+    record.type = (uint8_t)type;
+    record.orientation = orientation;
+    record.flags = flags;
+    record.reserved = 0xFF;
+    record.crc = crc16((const uint8_t*)&record, offsetof(JournalRecord, crc));
+
+    uint32_t slot = headSlot;
+    // A failed program leaves the slot in an unknown state, so never reuse it
+    headSlot = (headSlot + 1) % slotCount;
+    full = headSlot == oldestSlot;
+    nextSequence++;
+
+    if (!flash.program(slot * RECORD_SIZE, &record, RECORD_SIZE)) {
+        Serial.println("[JOURNAL] Flash program failed");
+        return false;
+    }
+    if (isEvent(record)) lastEventSequence = record.sequence;
+    return true;
+}
+
+bool EventJournal::prepareSector(uint32_t slot, bool& erased) {
+    erased = false;
+    uint32_t sectorEnd = slot + slotsPerSector;
+
+    bool blank = true;
+    for (uint32_t i = slot; i < sectorEnd; i++) {
+        if (!isSlotErased(i)) {
+            blank = false;
+            break;
+        }
+    }
+    if (blank) return true;
+
+    // Ring has wrapped: undelivered events in the oldest sector are lost
+    for (uint32_t i = slot; i < sectorEnd; i++) {
+        JournalRecord record;
+        if (readSlot(i, record) && isEvent(record) && record.sequence > committedThrough) {
+            droppedEvents++;
+        }
+    }
+    if (!flash.eraseSector(slot * RECORD_SIZE)) {
+        Serial.println("[JOURNAL] Sector erase failed");
+        return false;
+    }
+    erased = true;
+    full = false;
+
+    // A cursor in the erased sector resumes at the new oldest record; slots
+    // already delivered are skipped again by sequence
+    uint32_t nextSector = sectorEnd % slotCount;
+    if (oldestSlot >= slot && oldestSlot < sectorEnd) oldestSlot = nextSector;
+    if (scanSlot >= slot && scanSlot < sectorEnd) scanSlot = oldestSlot;
+    return true;
+}
+
+uint32_t EventJournal::slotsToScan() const {
+    if (full && scanSlot == headSlot) return slotCount;
+    return (headSlot + slotCount - scanSlot) % slotCount;
+}
+
+bool EventJournal::readSlot(uint32_t slot, JournalRecord& record) {
+    if (!flash.read(slot * RECORD_SIZE, &record, RECORD_SIZE)) return false;
+    if (record.sequence == ERASED_SEQUENCE) return false;
+    if (record.type < (uint8_t)JournalEventType::START || record.type > (uint8_t)JournalEventType::COMMIT) {
+        return false;
+    }
+    return record.crc == crc16((const uint8_t*)&record, offsetof(JournalRecord, crc));
+}
+
+bool EventJournal::isSlotErased(uint32_t slot) {
+    uint8_t raw[RECORD_SIZE];
+    if (!flash.read(slot * RECORD_SIZE, raw, RECORD_SIZE)) return false;
+    for (uint32_t i = 0; i < RECORD_SIZE; i++) {
+        if (raw[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+bool EventJournal::isEvent(const JournalRecord& record) {
+    return (JournalEventType)record.type == JournalEventType::START ||
+           (JournalEventType)record.type == JournalEventType::STOP;
+}
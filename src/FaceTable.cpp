@@ -0,0 +1,72 @@
+#include "FaceTable.h"
+
+// Cube: Orientation order (up, down, left, right, front, back)
+static const FaceNormal CUBE[6] = {
+    {0, 0, 16384}, {0, 0, -16384},
+    {-16384, 0, 0}, {16384, 0, 0},
+    {0, 16384, 0}, {0, -16384, 0}
+};
+
+// Octahedron resting on a face: up, down, then three faces 19.5 degrees above
+// the horizon (azimuth 0, 120, 240), each followed by its opposite below
+static const FaceNormal OCTAHEDRON[8] = {
+    {0, 0, 16384}, {0, 0, -16384},
+    {15447, 0, 5461}, {-15447, 0, -5461},
+    {-7723, 13377, 5461}, {7723, -13377, -5461},
+    {-7723, -13377, 5461}, {7723, 13377, -5461}
+};
+
+// Pentagonal trapezohedron (d10) with its axis along z: five faces 26.6 degrees
+// above the horizon (azimuth 0, 72, ...), each followed by its opposite below
+static const FaceNormal TRAPEZOHEDRON[10] = {
+    {14654, 0, 7327}, {-14654, 0, -7327},
+    {4528, 13937, 7327}, {-4528, -13937, -7327},
+    {-11856, 8614, 7327}, {11856, -8614, -7327},
+    {-11856, -8614, 7327}, {11856, 8614, -7327},
+    {4528, -13937, 7327}, {-4528, 13937, -7327}
+};
+
+// Dodecahedron resting on a face: up, down, then the d10's ten faces
+static const FaceNormal DODECAHEDRON[12] = {
+    {0, 0, 16384}, {0, 0, -16384},
+    {14654, 0, 7327}, {-14654, 0, -7327},
+    {4528, 13937, 7327}, {-4528, -13937, -7327},
+    {-11856, 8614, 7327}, {11856, -8614, -7327},
+    {-11856, -8614, 7327}, {11856, 8614, -7327},
+    {4528, -13937, 7327}, {-4528, 13937, -7327}
+};
+
+#if TRACKER_FACE_COUNT != 6 && TRACKER_FACE_COUNT != 8 && TRACKER_FACE_COUNT != 10 && TRACKER_FACE_COUNT != 12
+#error "TRACKER_FACE_COUNT must be 6, 8, 10 or 12"
+#endif
+
+const FaceNormal* FaceTable::normals() {
+    return forCount(FACE_COUNT);
+}
+
+const FaceNormal* FaceTable::forCount(int faceCount) {
+    switch (faceCount) {
+        case 6: return CUBE;
+        case 8: return OCTAHEDRON;
+        case 10: return TRAPEZOHEDRON;
+        case 12: return DODECAHEDRON;
+        default: return nullptr;
+    }
+}
+
+int FaceTable::nearest(const FaceNormal* table, int count, const int32_t v[3], int32_t& best, int32_t& second) {
+    int face = 0;
+    best = project(table[0], v);
+    second = INT32_MIN;
+    for (int i = 1; i < count; i++) {
+        int32_t along = project(table[i], v);
+        if (along > best) {
+            second = best;
+            best = along;
+            face = i;
+        } else if (along > second) {
+            second = along;
+        }
+    }
+    return face;
+}
@@ -0,0 +1,68 @@
+#include "HttpRequestBuffer.h"
+#include <string.h>
+
+HttpRequestBuffer::HttpRequestBuffer() : used(0), overflow(false) {
+    buffer[0] = '\0';
+}
+
+void HttpRequestBuffer::clear() {
+    used = 0;
+    overflow = false;
+    buffer[0] = '\0';
+}
+
+void HttpRequestBuffer::begin(const char* method, const char* path, const char* host) {
+    clear();
+    addRaw(method);
+    addRaw(" ", 1);
+    addRaw(path);
+    addRaw(" HTTP/1.1\r\n", 11);
+    addHeader("Host", host);
+}
+
+void HttpRequestBuffer::addHeader(const char* name, const char* value) {
+    addRaw(name);
+    addRaw(": ", 2);
+    addRaw(value);
+    addRaw("\r\n", 2);
+}
+
+void HttpRequestBuffer::addRaw(const char* text) {
+    addRaw(text, strlen(text));
+}
+
+void HttpRequestBuffer::addRaw(const char* text, size_t length) {
+    // Keep room for the terminator so data() is always a C string
+    if (overflow || used + length >= CAPACITY) {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + used, text, length);
+    used += length;
+    buffer[used] = '\0';
+}
+
+void HttpRequestBuffer::finish(const char* body, size_t bodyLength) {
+    if (bodyLength > 0) {
+        addRaw("Content-Length: ", 16);
+        appendNumber(bodyLength);
+        addRaw("\r\n", 2);
+    }
+    addRaw("Connection: keep-alive\r\n\r\n", 26);
+    if (bodyLength > 0) {
+        addRaw(body, bodyLength);
+    }
+}
+
+void HttpRequestBuffer::appendNumber(unsigned long value) {
+    char digits[12];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0 && count < (int)sizeof(digits));
+
+    char text[12];
+    for (int i = 0; i < count; i++) text[i] = digits[count - 1 - i];
+    addRaw(text, count);
+}
@@ -0,0 +1,214 @@
+#include "ImuCalibration.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Axis (0 = x, 1 = y, 2 = z) and direction of each face, as in OrientationClassifier
+static const uint8_t FACE_AXIS[] = {2, 2, 0, 0, 1, 1};
+static const int8_t FACE_SIGN[] = {1, -1, -1, 1, 1, -1};
+// Faces whose reading points along +axis and -axis
+static const Orientation POSITIVE_FACE[3] = {RIGHT_SIDE, FRONT_EDGE, FACE_UP};
+static const Orientation NEGATIVE_FACE[3] = {LEFT_SIDE, BACK_EDGE, FACE_DOWN};
+
+// Limits for a plausible fit: a few degrees off and a few percent out is normal
+static const float MIN_AXIS_SCALE = 0.8f;
+static const float MAX_AXIS_SCALE = 1.2f;
+static const float MIN_DETERMINANT = 0.5f;   // Below this the axes are swapped or mirrored
+static const int MAX_BIAS_MG = 200;
+static const int MIN_FACE_MG = 700;          // Dominant axis of a sample resting on a face
+
+ImuCalibration::ImuCalibration() {
+    clear();
+}
+
+void ImuCalibration::clear() {
+    memset(&data, 0, sizeof(data));
+    data.matrix[0] = data.matrix[4] = data.matrix[8] = 1 << MATRIX_SHIFT;
+    valid = false;
+}
+
+void ImuCalibration::set(const ImuCalibrationData& calibration) {
+    if (!calibration.valid) {
+        clear();
+        return;
+    }
+    data = calibration;
+    valid = true;
+}
+
+void ImuCalibration::apply(AccelSample* samples, int count) const {
+    if (!valid) return;
+    const int16_t* m = data.matrix;
+    const int32_t round = 1 << (MATRIX_SHIFT - 1);
+    for (int i = 0; i < count; i++) {
+        int32_t v[3] = {samples[i].x - data.bias[0], samples[i].y - data.bias[1], samples[i].z - data.bias[2]};
+        int32_t out[3];
+        for (int r = 0; r < 3; r++) {
+            // |m| < 2^15 and |v| < 2^13 at +-4 g: the sum stays within 32 bits
+            out[r] = (m[r * 3] * v[0] + m[r * 3 + 1] * v[1] + m[r * 3 + 2] * v[2] + round) >> MATRIX_SHIFT;
+            if (out[r] > INT16_MAX) out[r] = INT16_MAX;
+            if (out[r] < INT16_MIN) out[r] = INT16_MIN;
+        }
+        samples[i].x = (int16_t)out[0];
+        samples[i].y = (int16_t)out[1];
+        samples[i].z = (int16_t)out[2];
+    }
+}
+
+bool ImuCalibration::solve(const AccelSample faces[6], ImuCalibrationData& result, int* worstResidualMg) {
+    memset(&result, 0, sizeof(result));
+    if (worstResidualMg) *worstResidualMg = -1;
+
+    float reading[6][3];
+    float bias[3] = {0, 0, 0};
+    for (int f = 0; f < 6; f++) {
+        reading[f][0] = faces[f].x;
+        reading[f][1] = faces[f].y;
+        reading[f][2] = faces[f].z;
+        for (int r = 0; r < 3; r++) bias[r] += reading[f][r] / 6.0f;
+    }
+
+    // Opposite faces see gravity with opposite signs, so the bias cancels in
+    // their difference: column k is the sensor's reading per g along axis k
+    float sensor[3][3];
+    for (int k = 0; k < 3; k++) {
+        float norm = 0;
+        for (int r = 0; r < 3; r++) {
+            sensor[r][k] = (reading[POSITIVE_FACE[k]][r] - reading[NEGATIVE_FACE[k]][r]) / 2000.0f;
+            norm += sensor[r][k] * sensor[r][k];
+        }
+        norm = sqrtf(norm);
+        if (norm < MIN_AXIS_SCALE || norm > MAX_AXIS_SCALE) return false;
+    }
+    for (int r = 0; r < 3; r++) {
+        if (fabsf(bias[r]) > MAX_BIAS_MG) return false;
+    }
+
+    // Correction = inverse of the sensor matrix, via the adjugate
+    const float (*s)[3] = sensor;
+    float det = s[0][0] * (s[1][1] * s[2][2] - s[1][2] * s[2][1]) -
+                s[0][1] * (s[1][0] * s[2][2] - s[1][2] * s[2][0]) +
+                s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+    if (det < MIN_DETERMINANT) return false;
+    float inverse[3][3];
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 3; c++) {
+            // Cofactor of s[c][r], from the rows and columns that skip c and r
+            int r0 = (c + 1) % 3, r1 = (c + 2) % 3;
+            int c0 = (r + 1) % 3, c1 = (r + 2) % 3;
+            inverse[r][c] = (s[r0][c0] * s[r1][c1] - s[r0][c1] * s[r1][c0]) / det;
+        }
+    }
+
+    for (int r = 0; r < 3; r++) {
+        result.bias[r] = (int16_t)lroundf(bias[r]);
+        for (int c = 0; c < 3; c++) {
+            float q = inverse[r][c] * (1 << MATRIX_SHIFT);
+            if (fabsf(q) >= 32767.0f) return false;
+            result.matrix[r * 3 + c] = (int16_t)lroundf(q);
+        }
+    }
+    result.valid = 1;
+
+    // Judge the fit with the quantized correction, as it will run on the cube
+    ImuCalibration check;
+    check.set(result);
+    int worst = 0;
+    for (int f = 0; f < 6; f++) {
+        AccelSample corrected = faces[f];
+        check.apply(&corrected, 1);
+        int32_t expected[3] = {0, 0, 0};
+        expected[FACE_AXIS[f]] = FACE_SIGN[f] * 1000;
+        int32_t axes[3] = {corrected.x, corrected.y, corrected.z};
+        for (int r = 0; r < 3; r++) {
+            int error = abs((int)(axes[r] - expected[r]));
+            if (error > worst) worst = error;
+        }
+    }
+    if (worstResidualMg) *worstResidualMg = worst;
+    if (worst > Config::CALIBRATION_MAX_RESIDUAL_MG) {
+        result.valid = 0;
+        return false;
+    }
+    return true;
+}
+
+// --- Capture session ---
+
+static Orientation dominantFace(const AccelSample& sample) {
+    int32_t axes[3] = {sample.x, sample.y, sample.z};
+    int dominant = 0;
+    for (int i = 1; i < 3; i++) {
+        if (abs((int)axes[i]) > abs((int)axes[dominant])) dominant = i;
+    }
+    if (abs((int)axes[dominant]) < MIN_FACE_MG) return UNKNOWN;
+    return axes[dominant] > 0 ? POSITIVE_FACE[dominant] : NEGATIVE_FACE[dominant];
+}
+
+ImuCalibrator::ImuCalibrator() : state(CALIBRATION_IDLE), worstResidual(-1) {
+    memset(&result, 0, sizeof(result));
+    cancel();
+}
+
+void ImuCalibrator::start() {
+    for (int f = 0; f < 6; f++) captured[f] = false;
+    lastCaptured = UNKNOWN;
+    worstResidual = -1;
+    memset(&result, 0, sizeof(result));
+    restart(UNKNOWN);
+    state = CALIBRATION_CAPTURING;
+}
+
+void ImuCalibrator::cancel() {
+    for (int f = 0; f < 6; f++) captured[f] = false;
+    lastCaptured = UNKNOWN;
+    restart(UNKNOWN);
+    state = CALIBRATION_IDLE;
+}
+
+int ImuCalibrator::getCapturedCount() const {
+    int n = 0;
+    for (int f = 0; f < 6; f++) {
+        if (captured[f]) n++;
+    }
+    return n;
+}
+
+void ImuCalibrator::restart(Orientation face) {
+    capturing = face;
+    sum[0] = sum[1] = sum[2] = 0;
+    count = 0;
+}
+
+bool ImuCalibrator::addSamples(const AccelSample* samples, int sampleCount, bool moving) {
+    if (state != CALIBRATION_CAPTURING) return false;
+    if (moving) {
+        restart(UNKNOWN);
+        return false;
+    }
+
+    bool completed = false;
+    for (int i = 0; i < sampleCount; i++) {
+        Orientation face = dominantFace(samples[i]);
+        if (face != capturing) restart(face);
+        if (face == UNKNOWN || captured[face]) continue;
+
+        sum[0] += samples[i].x;
+        sum[1] += samples[i].y;
+        sum[2] += samples[i].z;
+        if (++count < Config::CALIBRATION_CAPTURE_SAMPLES) continue;
+
+        means[face].x = (int16_t)(sum[0] / count);
+        means[face].y = (int16_t)(sum[1] / count);
+        means[face].z = (int16_t)(sum[2] / count);
+        captured[face] = true;
+        lastCaptured = face;
+        completed = true;
+        restart(face);
+    }
+
+    if (completed && getCapturedCount() == 6) {
+        state = ImuCalibration::solve(means, result, &worstResidual) ? CALIBRATION_DONE : CALIBRATION_FAILED;
+    }
+    return completed;
+}
@@ -0,0 +1,67 @@
+#include "ImuRateGovernor.h"
+#include "SystemDiagnostics.h"
+
+ImuRateGovernor::ImuRateGovernor(unsigned long stillAfterMs)
+    : stillAfter(stillAfterMs), started(false), still(false), since(0), lastActivity(0), stats({0, 0, 0, 0}),
+      diagnostics(nullptr) {
+}
+
+void ImuRateGovernor::start(unsigned long nowMs) {
+    started = true;
+    still = false;
+    since = nowMs;
+    lastActivity = nowMs;
+}
+
+bool ImuRateGovernor::onActivity(unsigned long nowMs) {
+    if (!started) start(nowMs);
+    lastActivity = nowMs;
+    if (!still) return false;
+    setStill(false, nowMs);
+    return true;
+}
+
+bool ImuRateGovernor::onQuiet(unsigned long nowMs) {
+    if (!started) start(nowMs);
+    if (still || nowMs - lastActivity < stillAfter) return false;
+    setStill(true, nowMs);
+    return true;
+}
+
+unsigned long ImuRateGovernor::getActiveMs(unsigned long nowMs) const {
+    return stats.activeMs + (started && !still ? nowMs - since : 0);
+}
+
+unsigned long ImuRateGovernor::getStillMs(unsigned long nowMs) const {
+    return stats.stillMs + (still ? nowMs - since : 0);
+}
+
+void ImuRateGovernor::setStill(bool nowStill, unsigned long nowMs) {
+    unsigned long periodMs = nowMs - since;
+    if (nowStill) {
+        stats.stepsDown++;
+        stats.activeMs += periodMs;
+    } else {
+        stats.stepsUp++;
+        stats.stillMs += periodMs;
+    }
+    if (diagnostics) {
+        diagnostics->recordImuRate(nowStill, periodMs);
+    }
+    still = nowStill;
+    since = nowMs;
+}
+
+unsigned long ImuRateGovernor::averageCurrentUa(unsigned long activeMs, unsigned long stillMs,
+                                                unsigned long stillCurrentUa) {
+    unsigned long totalMs = activeMs + stillMs;
+    if (totalMs == 0) return Config::IMU_ACTIVE_CURRENT_UA;
+    // In 64-bit: a month of milliseconds times a few hundred uA overflows 32 bits
+    uint64_t charge = (uint64_t)activeMs * Config::IMU_ACTIVE_CURRENT_UA + (uint64_t)stillMs * stillCurrentUa;
+    return (unsigned long)(charge / totalMs);
+}
+
+int ImuRateGovernor::savingPercent(unsigned long activeMs, unsigned long stillMs, unsigned long stillCurrentUa) {
+    unsigned long average = averageCurrentUa(activeMs, stillMs, stillCurrentUa);
+    return 100 - (int)(average * 100 / Config::IMU_ACTIVE_CURRENT_UA);
+}
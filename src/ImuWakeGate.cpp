@@ -0,0 +1,34 @@
+#include "ImuWakeGate.h"
+#include "ImuBackend.h"
+
+ImuWakeGate::ImuWakeGate(unsigned long awakeWindowMs)
+    : window(awakeWindowMs), started(false), awakeSince(0), awakeUntil(0), stats({0, 0, 0, 0}) {
+}
+
+void ImuWakeGate::start(unsigned long nowMs) {
+    if (started && isAwake(nowMs)) {
+        awakeUntil = nowMs + window;
+        return;
+    }
+    if (started) stats.awakeMs += awakeUntil - awakeSince;
+    started = true;
+    awakeSince = nowMs;
+    awakeUntil = nowMs + window;
+}
+
+bool ImuWakeGate::onEvents(uint8_t events, unsigned long nowMs) {
+    if (events & IMU_EVENT_ORIENTATION) stats.orientationEvents++;
+    if (events & IMU_EVENT_MOTION) stats.motionEvents++;
+    if (events == 0) return false;
+
+    bool woke = !isAwake(nowMs);
+    start(nowMs);
+    if (woke) stats.wakeups++;
+    return woke;
+}
+
+unsigned long ImuWakeGate::getAwakeMs(unsigned long nowMs) const {
+    if (!started) return 0;
+    unsigned long open = isAwake(nowMs) ? nowMs - awakeSince : awakeUntil - awakeSince;
+    return stats.awakeMs + open;
+}
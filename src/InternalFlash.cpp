@@ -0,0 +1,134 @@
+#include "FlashRegion.h"
+#include "Config.h"
+#include <Arduino.h>
+
+#if defined(ARDUINO_ARCH_MBED)
+  #include <FlashIAP.h>
+  static mbed::FlashIAP flashIap;
+#elif defined(ARDUINO_ARCH_SAMD)
+  // Reserved storage area, aligned to an NVM row so it can be erased independently
+  __attribute__((__aligned__(256)))
+  static const uint8_t storageArea[Config::FLASH_STORAGE_SIZE] = {};
+  static const uint32_t SAMD_PAGE_SIZE = 64;
+  static const uint32_t SAMD_ROW_SIZE = 256;
+#endif
+
+InternalFlash::InternalFlash(uint32_t offset, uint32_t length)
+    : regionOffset(offset), regionSize(length), baseAddress(0),
+      eraseSize(0), pageSize(0), initialized(false) {
+}
+
+bool InternalFlash::begin() {
+    if (initialized) return true;
+
+#if defined(ARDUINO_ARCH_MBED)
+    if (flashIap.init() != 0) {
+        Serial.println("[FLASH] FlashIAP init failed");
+        return false;
+    }
+    // Storage area occupies the last FLASH_STORAGE_SIZE bytes of flash
+    uint32_t storageStart = flashIap.get_flash_start() + flashIap.get_flash_size() - Config::FLASH_STORAGE_SIZE;
+    baseAddress = storageStart + regionOffset;
+    eraseSize = flashIap.get_sector_size(baseAddress);
+    pageSize = flashIap.get_page_size();
+#elif defined(ARDUINO_ARCH_SAMD)
+    baseAddress = (uint32_t)storageArea + regionOffset;
+    eraseSize = SAMD_ROW_SIZE;
+    pageSize = SAMD_PAGE_SIZE;
+#else
+    Serial.println("[FLASH] No internal flash backend for this platform");
+    return false;
+#endif
+
+    if (regionOffset + regionSize > Config::FLASH_STORAGE_SIZE ||
+        regionOffset % eraseSize != 0 || regionSize % eraseSize != 0) {
+        Serial.println("[FLASH] Region is not sector aligned");
+        return false;
+    }
+    initialized = true;
+    return true;
+}
+
+bool InternalFlash::read(uint32_t offset, void* data, uint32_t length) {
+    if (!inRange(offset, length)) return false;
+#if defined(ARDUINO_ARCH_MBED)
+    return flashIap.read(data, baseAddress + offset, length) == 0;
+#else
+    memcpy(data, (const void*)(baseAddress + offset), length);
+    return true;
+#endif
+}
+
+bool InternalFlash::program(uint32_t offset, const void* data, uint32_t length) {
+    if (!inRange(offset, length)) return false;
+    const uint8_t* source = (const uint8_t*)data;
+
+#if defined(ARDUINO_ARCH_MBED)
+    // FlashIAP only programs whole pages; pad partial pages with 0xFF, which
+    // leaves already programmed bytes in that page unchanged
+    uint8_t pageBuffer[256];
+    if (pageSize > sizeof(pageBuffer)) return false;
+
+    while (length > 0) {
+        uint32_t pageStart = offset - (offset % pageSize);
+        uint32_t inPage = offset - pageStart;
+        uint32_t chunk = pageSize - inPage;
+        if (chunk > length) chunk = length;
+
+        memset(pageBuffer, 0xFF, pageSize);
+        memcpy(pageBuffer + inPage, source, chunk);
+        if (flashIap.program(pageBuffer, baseAddress + pageStart, pageSize) != 0) {
+            return false;
+        }
+        offset += chunk;
+        source += chunk;
+        length -= chunk;
+    }
+    return true;
+#elif defined(ARDUINO_ARCH_SAMD)
+    // NVM page buffer is written in 32-bit words; partial words are padded with 0xFF
+    if (offset % 4 != 0) return false;
+
+    NVMCTRL->CTRLB.bit.MANW = 1;
+    while (length > 0) {
+        uint32_t pageStart = offset - (offset % SAMD_PAGE_SIZE);
+        uint32_t chunk = pageStart + SAMD_PAGE_SIZE - offset;
+        if (chunk > length) chunk = length;
+
+        NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_PBC;
+        while (NVMCTRL->INTFLAG.bit.READY == 0) { }
+
+        volatile uint32_t* destination = (volatile uint32_t*)(baseAddress + offset);
+        for (uint32_t i = 0; i < chunk; i += 4) {
+            uint32_t word = 0xFFFFFFFF;
+            uint32_t wordBytes = (chunk - i) < 4 ? (chunk - i) : 4;
+            memcpy(&word, source + i, wordBytes);
+            *destination++ = word;
+        }
+
+        NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_WP;
+        while (NVMCTRL->INTFLAG.bit.READY == 0) { }
+
+        offset += chunk;
+        source += chunk;
+        length -= chunk;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool InternalFlash::eraseSector(uint32_t offset) {
+    if (!inRange(offset, eraseSize) || offset % eraseSize != 0) return false;
+#if defined(ARDUINO_ARCH_MBED)
+    return flashIap.erase(baseAddress + offset, eraseSize) == 0;
+#elif defined(ARDUINO_ARCH_SAMD)
+    NVMCTRL->ADDR.reg = (baseAddress + offset) / 2;
+    NVMCTRL->CTRLA.reg = NVMCTRL_CTRLA_CMDEX_KEY | NVMCTRL_CTRLA_CMD_ER;
+    while (NVMCTRL->INTFLAG.bit.READY == 0) { }
+    return true;
+#else
+    return false;
+#endif
+}
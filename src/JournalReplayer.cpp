@@ -0,0 +1,224 @@
+#include "JournalReplayer.h"
+#include "OrientationDetector.h"
+#include "Config.h"
+
+JournalReplayer::JournalReplayer(EventJournal& eventJournal, TogglAPI& toggl)
+    : journal(eventJournal), togglAPI(toggl), waiting(false), inFlight(TogglOperation::NONE),
+      commitSequence(0), serverStateKnown(false), reconcileSequence(0), stats({0, 0, 0, 0, 0}) {
+}
+
+void JournalReplayer::poll(bool networkAvailable, unsigned long nowMs) {
+    if (waiting) {
+        if (togglAPI.isBusy()) return;
+        handleResult(nowMs);
+    }
+
+    if (!hasWork() || !networkAvailable || togglAPI.isBusy()) return;
+    // Decide what to send only once backoff and circuit breaker allow it
+    if (!togglAPI.getScheduler().isReady(nowMs)) return;
+
+    dispatchNext(nowMs);
+}
+
+void JournalReplayer::dispatchNext(unsigned long nowMs) {
+    // Settle a request that may or may not have reached Toggl before sending
+    // anything else; the answer also tells the running entry and the clock
+    if (togglAPI.hasUnknownOutcome()) {
+        send(TogglOperation::RECONCILE, togglAPI.requestReconcile(), reconcileSequence);
+        return;
+    }
+
+    // After boot (or a rejection) the running entry on the server is unknown
+    if (!serverStateKnown) {
+        send(TogglOperation::TIME_SYNC, togglAPI.requestTimeSync(), 0);
+        return;
+    }
+
+    // Confirm the first single-request switch before relying on it again
+    if (togglAPI.needsSwitchVerification()) {
+        send(TogglOperation::VERIFY_SWITCH, togglAPI.requestSwitchVerification(), 0);
+        return;
+    }
+
+    JournalRecord records[2];
+    int count = journal.readPending(records, 2);
+    if (count == 0) return;
+    const JournalRecord& first = records[0];
+    uint32_t firstEpoch = 0;
+
+    if ((JournalEventType)first.type == JournalEventType::STOP) {
+        if (!togglAPI.hasCurrentEntry()) {
+            // Nothing running on the server (start was dropped or already stopped)
+            journal.commitThrough(first.sequence);
+            return;
+        }
+        if (isLive(first, nowMs)) {
+            const JournalRecord& next = records[1];
+            if (count == 2 && (JournalEventType)next.type == JournalEventType::START &&
+                isLive(next, nowMs) && togglAPI.canSwitch()) {
+                // Face change: the server stops the running entry when the next one starts
+                send(TogglOperation::SWITCH,
+                     togglAPI.requestSwitch(next.orientation, descriptionFor(next.orientation), liveEpoch(next)),
+                     next.sequence);
+                return;
+            }
+            send(TogglOperation::STOP, togglAPI.requestStop(liveEpoch(first)), first.sequence);
+            return;
+        }
+        TimeResolution resolution = resolveTime(first, firstEpoch);
+        if (resolution == NEEDS_CLOCK) {
+            send(TogglOperation::TIME_SYNC, togglAPI.requestTimeSync(), 0);
+        } else {
+            // Without a usable timestamp, stopping late beats never stopping
+            send(TogglOperation::STOP, togglAPI.requestStop(resolution == RESOLVED ? firstEpoch : 0),
+                 first.sequence);
+        }
+        return;
+    }
+
+    String description = descriptionFor(first.orientation);
+
+    if (count == 1) {
+        // Trailing start becomes the running entry
+        if (isLive(first, nowMs)) {
+            send(TogglOperation::START, togglAPI.requestStart(first.orientation, description, liveEpoch(first)),
+                 first.sequence);
+            return;
+        }
+        TimeResolution resolution = resolveTime(first, firstEpoch);
+        if (resolution == NEEDS_CLOCK) {
+            send(TogglOperation::TIME_SYNC, togglAPI.requestTimeSync(), 0);
+        } else {
+            send(TogglOperation::START,
+                 togglAPI.requestStart(first.orientation, description, resolution == RESOLVED ? firstEpoch : 0),
+                 first.sequence);
+        }
+        return;
+    }
+
+    // Start followed by the event that ended it: one completed entry
+    const JournalRecord& next = records[1];
+    bool endsWithStop = (JournalEventType)next.type == JournalEventType::STOP;
+    uint32_t lastSequence = endsWithStop ? next.sequence : first.sequence;
+    uint32_t endEpoch = 0;
+    TimeResolution startResolution = resolveTime(first, firstEpoch);
+    TimeResolution endResolution = resolveTime(next, endEpoch);
+
+    if (startResolution == NEEDS_CLOCK || endResolution == NEEDS_CLOCK) {
+        send(TogglOperation::TIME_SYNC, togglAPI.requestTimeSync(), 0);
+        return;
+    }
+    if (startResolution == UNRESOLVABLE || endResolution == UNRESOLVABLE) {
+        Serial.println("[JOURNAL] Dropping segment without a usable timestamp");
+        stats.eventsDiscarded++;
+        journal.commitThrough(lastSequence);
+        return;
+    }
+    if (endEpoch <= firstEpoch) {
+        // Shorter than the clock resolution; nothing worth recording
+        journal.commitThrough(lastSequence);
+        return;
+    }
+
+    if (send(TogglOperation::COMPLETED_ENTRY,
+             togglAPI.requestCompletedEntry(first.orientation, description, firstEpoch, endEpoch - firstEpoch),
+             lastSequence) && endsWithStop) {
+        stats.entriesCollapsed++;
+    }
+}
+
+bool JournalReplayer::send(TogglOperation operation, bool queued, uint32_t sequence) {
+    if (!queued) return false;
+    waiting = true;
+    inFlight = operation;
+    commitSequence = sequence;
+    stats.requestsSent++;
+    return true;
+}
+
+void JournalReplayer::handleResult(unsigned long nowMs) {
+    waiting = false;
+    bool success = togglAPI.wasLastOperationSuccessful();
+    int statusCode = togglAPI.getLastStatusCode();
+
+    if (success) {
+        if (inFlight == TogglOperation::RECONCILE) {
+            serverStateKnown = true;
+            stats.outcomesReconciled++;
+            // Not applied: the events stay pending and are sent as usual
+            if (togglAPI.wasUnknownOutcomeApplied() && commitSequence != 0) {
+                journal.commitThrough(commitSequence);
+            }
+            reconcileSequence = 0;
+        } else if (inFlight == TogglOperation::TIME_SYNC) {
+            serverStateKnown = true;
+        } else if (inFlight != TogglOperation::VERIFY_SWITCH) {
+            journal.commitThrough(commitSequence);
+        }
+        return;
+    }
+
+    // Auth errors are retried too: the token can be fixed over BLE. The
+    // scheduler has already pushed the next attempt back.
+    bool transient = RequestScheduler::isRetryable(statusCode);
+    if (inFlight != TogglOperation::RECONCILE && togglAPI.hasUnknownOutcome()) {
+        // Sent but unanswered: reconcile instead of resending
+        reconcileSequence = commitSequence;
+    }
+    // Sync, verification and reconcile requests are not journal events and cannot be dropped
+    if (transient || inFlight == TogglOperation::TIME_SYNC || inFlight == TogglOperation::VERIFY_SWITCH ||
+        inFlight == TogglOperation::RECONCILE) {
+        stats.retries++;
+        const RequestScheduler& scheduler = togglAPI.getScheduler();
+        Serial.print("[JOURNAL] Replay failed (");
+        Serial.print(statusCode);
+        Serial.print(")");
+        if (!scheduler.isReady(nowMs)) {
+            Serial.print(", retrying in ");
+            Serial.print(scheduler.getHoldUntil() - nowMs);
+            Serial.print(" ms");
+        }
+        Serial.println();
+        return;
+    }
+
+    // Rejected (e.g. deleted project or entry); retrying cannot succeed
+    Serial.print("[JOURNAL] Toggl rejected replayed event (");
+    Serial.print(statusCode);
+    Serial.println("), dropping it");
+    stats.eventsDiscarded++;
+    journal.commitThrough(commitSequence);
+    serverStateKnown = false;
+}
+
+JournalReplayer::TimeResolution JournalReplayer::resolveTime(const JournalRecord& record, uint32_t& epoch) const {
+    if (!(record.flags & EventJournal::FLAG_RELATIVE_TIME)) {
+        epoch = record.timestamp;
+        return RESOLVED;
+    }
+    if (record.bootId != journal.getBootId()) return UNRESOLVABLE;
+    if (!togglAPI.hasServerTime()) return NEEDS_CLOCK;
+    epoch = togglAPI.epochAtMillis(record.timestamp);
+    return RESOLVED;
+}
+
+uint32_t JournalReplayer::liveEpoch(const JournalRecord& record) const {
+    // Coalesced changes are back-dated; keep that time when it is known
+    uint32_t epoch = 0;
+    return resolveTime(record, epoch) == RESOLVED ? epoch : 0;
+}
+
+bool JournalReplayer::isLive(const JournalRecord& record, unsigned long nowMs) const {
+    if (record.flags & EventJournal::FLAG_RELATIVE_TIME) {
+        return record.bootId == journal.getBootId() &&
+               nowMs - record.timestamp <= Config::JOURNAL_LIVE_WINDOW_MS;
+    }
+    if (!togglAPI.hasServerTime()) return false;
+    uint32_t now = togglAPI.epochAtMillis(nowMs);
+    return now >= record.timestamp && now - record.timestamp <= Config::JOURNAL_LIVE_WINDOW_MS / 1000;
+}
+
+String JournalReplayer::descriptionFor(uint8_t orientation) {
+    // Same name the live path sends, so replayed entries match
+    return OrientationDetector::getOrientationName((Orientation)orientation);
+}
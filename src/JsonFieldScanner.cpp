@@ -0,0 +1,238 @@
+#include "JsonFieldScanner.h"
+#include <string.h>
+
+JsonFieldScanner::JsonFieldScanner() : fieldCount(0) {
+    reset();
+}
+
+bool JsonFieldScanner::addField(const char* key, char* buffer, size_t bufferSize) {
+    if (fieldCount >= MAX_FIELDS || bufferSize == 0) return false;
+    Field& field = fields[fieldCount++];
+    field.key = key;
+    field.buffer = buffer;
+    field.size = bufferSize > 0xFFFF ? 0xFFFF : (uint16_t)bufferSize;
+    field.length = 0;
+    field.found = false;
+    field.truncated = false;
+    buffer[0] = '\0';
+    return true;
+}
+
+void JsonFieldScanner::clearFields() {
+    fieldCount = 0;
+    reset();
+}
+
+void JsonFieldScanner::reset() {
+    for (int i = 0; i < fieldCount; i++) {
+        fields[i].length = 0;
+        fields[i].found = false;
+        fields[i].truncated = false;
+        fields[i].buffer[0] = '\0';
+    }
+    state = BEFORE_ROOT;
+    escaped = false;
+    nestedInString = false;
+    unicodeRemaining = 0;
+    nestedDepth = 0;
+    currentField = -1;
+    keyLength = 0;
+    keyOverflow = false;
+    keyBuffer[0] = '\0';
+    rootLiteralLength = 0;
+    rootLiteral[0] = '\0';
+}
+
+void JsonFieldScanner::feed(const char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) feed(data[i]);
+}
+
+void JsonFieldScanner::feed(char c) {
+    switch (state) {
+        case BEFORE_ROOT:
+            if (isWhitespace(c)) return;
+            if (c == '{') {
+                state = EXPECT_KEY;
+            } else if (c == 'n' || c == 't' || c == 'f' || c == '-' || (c >= '0' && c <= '9')) {
+                state = ROOT_LITERAL;
+                rootLiteral[rootLiteralLength++] = c;
+            } else {
+                state = FAILED;
+            }
+            return;
+
+        case ROOT_LITERAL:
+            if (isWhitespace(c)) {
+                state = DONE;
+            } else if (rootLiteralLength < sizeof(rootLiteral) - 1) {
+                rootLiteral[rootLiteralLength++] = c;
+            }
+            rootLiteral[rootLiteralLength] = '\0';
+            return;
+
+        case EXPECT_KEY:
+            if (isWhitespace(c)) return;
+            if (c == '"') {
+                state = IN_KEY;
+                keyLength = 0;
+                keyOverflow = false;
+            } else if (c == '}') {
+                state = DONE;
+            } else {
+                state = FAILED;
+            }
+            return;
+
+        case IN_KEY:
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\') {
+                escaped = true;
+                return;
+            } else if (c == '"') {
+                keyBuffer[keyLength] = '\0';
+                currentField = keyOverflow ? -1 : findField();
+                state = EXPECT_COLON;
+                return;
+            }
+            if (keyLength < MAX_KEY_LENGTH) {
+                keyBuffer[keyLength++] = c;
+            } else {
+                keyOverflow = true;
+            }
+            return;
+
+        case EXPECT_COLON:
+            if (isWhitespace(c)) return;
+            state = c == ':' ? EXPECT_VALUE : FAILED;
+            return;
+
+        case EXPECT_VALUE:
+            if (isWhitespace(c)) return;
+            beginValue(c);
+            return;
+
+        case IN_STRING_VALUE:
+            if (unicodeRemaining > 0) {
+                unicodeRemaining--;
+            } else if (escaped) {
+                escaped = false;
+                switch (c) {
+                    case 'n': appendValue('\n'); break;
+                    case 't': appendValue('\t'); break;
+                    case 'r': appendValue('\r'); break;
+                    case 'b': appendValue('\b'); break;
+                    case 'f': appendValue('\f'); break;
+                    case 'u': appendValue('?'); unicodeRemaining = 4; break;
+                    default:  appendValue(c); break;
+                }
+            } else if (c == '\\') {
+                escaped = true;
+            } else if (c == '"') {
+                finishValue();
+                state = AFTER_VALUE;
+            } else {
+                appendValue(c);
+            }
+            return;
+
+        case IN_LITERAL_VALUE:
+            if (c == ',' || c == '}' || isWhitespace(c)) {
+                finishValue();
+                state = AFTER_VALUE;
+                afterValue(c);
+            } else {
+                appendValue(c);
+            }
+            return;
+
+        case IN_NESTED_VALUE:
+            if (nestedInString) {
+                if (escaped) {
+                    escaped = false;
+                } else if (c == '\\') {
+                    escaped = true;
+                } else if (c == '"') {
+                    nestedInString = false;
+                }
+            } else if (c == '"') {
+                nestedInString = true;
+            } else if (c == '{' || c == '[') {
+                nestedDepth++;
+            } else if (c == '}' || c == ']') {
+                if (--nestedDepth == 0) state = AFTER_VALUE;
+            }
+            return;
+
+        case AFTER_VALUE:
+            afterValue(c);
+            return;
+
+        case DONE:
+        case FAILED:
+            return;
+    }
+}
+
+void JsonFieldScanner::beginValue(char c) {
+    if (c == '"') {
+        state = IN_STRING_VALUE;
+    } else if (c == '{' || c == '[') {
+        // Nested values are skipped, never captured
+        currentField = -1;
+        nestedDepth = 1;
+        nestedInString = false;
+        state = IN_NESTED_VALUE;
+    } else {
+        state = IN_LITERAL_VALUE;
+        appendValue(c);
+    }
+}
+
+void JsonFieldScanner::appendValue(char c) {
+    if (currentField < 0) return;
+    Field& field = fields[currentField];
+    if (field.length + 1 < field.size) {
+        field.buffer[field.length++] = c;
+    } else {
+        field.truncated = true;
+    }
+}
+
+void JsonFieldScanner::finishValue() {
+    if (currentField < 0) return;
+    Field& field = fields[currentField];
+    field.buffer[field.length] = '\0';
+    field.found = true;
+    currentField = -1;
+}
+
+void JsonFieldScanner::afterValue(char c) {
+    if (isWhitespace(c)) return;
+    if (c == ',') {
+        state = EXPECT_KEY;
+    } else if (c == '}') {
+        state = DONE;
+    } else {
+        state = FAILED;
+    }
+}
+
+int JsonFieldScanner::findField() const {
+    for (int i = 0; i < fieldCount; i++) {
+        if (strcmp(fields[i].key, keyBuffer) == 0) return i;
+    }
+    return -1;
+}
+
+bool JsonFieldScanner::isFound(int fieldIndex) const {
+    return fieldIndex >= 0 && fieldIndex < fieldCount && fields[fieldIndex].found;
+}
+
+bool JsonFieldScanner::isTruncated(int fieldIndex) const {
+    return fieldIndex >= 0 && fieldIndex < fieldCount && fields[fieldIndex].truncated;
+}
+
+bool JsonFieldScanner::isNull() const {
+    return (state == ROOT_LITERAL || state == DONE) && strcmp(rootLiteral, "null") == 0;
+}
@@ -0,0 +1,329 @@
+#include "KvStore.h"
+#include <Arduino.h>
+#include <string.h>
+#include "Crc16.h"
+#include "SystemDiagnostics.h"
+
+static_assert(sizeof(KvPageHeader) == 8, "Page header must keep records 4-byte aligned");
+static_assert(sizeof(KvRecordHeader) == 8, "Record header must keep values 4-byte aligned");
+
+KvStore::KvStore(FlashRegion& flashRegion)
+    : flash(flashRegion), ready(false), pageSize(0), pageCount(0), freePages(0), dirtyPages(0),
+      headPage(-1), headOffset(0), nextSequence(1), stats{0, 0, 0, 0}, diagnostics(nullptr) {
+    memset(index, 0, sizeof(index));
+}
+
+bool KvStore::begin() {
+    ready = false;
+    pageSize = flash.sectorSize();
+    pageCount = pageSize > 0 ? flash.size() / pageSize : 0;
+    if (pageCount < 2 || pageCount > MAX_PAGES ||
+        pageSize < sizeof(KvPageHeader) + 2 * recordSize(MAX_VALUE_LENGTH)) {
+        Serial.println("[KV] Flash region too small, or too many sectors");
+        return false;
+    }
+
+    memset(index, 0, sizeof(index));
+    freePages = 0;
+    dirtyPages = 0;
+    headPage = -1;
+    headOffset = 0;
+    nextSequence = 1;
+
+    uint32_t ends[MAX_PAGES];
+    for (int page = 0; page < pageCount; page++) {
+        ends[page] = scanPage(page);
+        if (pageState[page] == PAGE_USED &&
+            (headPage < 0 || pageSequence[page] > pageSequence[headPage])) {
+            headPage = page;
+        }
+    }
+    if (headPage >= 0) headOffset = ends[headPage];
+    ready = true;
+
+    int keys = 0;
+    for (int key = 1; key < MAX_KEYS; key++) {
+        if (contains(key)) keys++;
+    }
+    Serial.print("[KV] Ready - ");
+    Serial.print(keys);
+    Serial.print(" keys, ");
+    Serial.print(freePages);
+    Serial.print(" of ");
+    Serial.print(pageCount);
+    Serial.println(" pages free");
+    return true;
+}
+
+uint16_t KvStore::recordCrc(const KvRecordHeader& header, const uint8_t* value) {
+    uint16_t crc = crc16((const uint8_t*)&header.sequence, sizeof(header.sequence));
+    crc = crc16(&header.key, 1, crc);
+    crc = crc16(&header.length, 1, crc);
+    return crc16(value, header.length, crc);
+}
+
+bool KvStore::isBlank(uint32_t offset, uint32_t length) {
+    uint8_t chunk[32];
+    while (length > 0) {
+        uint32_t part = length < sizeof(chunk) ? length : sizeof(chunk);
+        if (!flash.read(offset, chunk, part)) return false;
+        for (uint32_t i = 0; i < part; i++) {
+            if (chunk[i] != 0xFF) return false;
+        }
+        offset += part;
+        length -= part;
+    }
+    return true;
+}
+
+uint32_t KvStore::scanPage(int page) {
+    uint32_t start = page * pageSize;
+    KvPageHeader header;
+    if (!flash.read(start, &header, sizeof(header)) || header.magic != KV_PAGE_MAGIC) {
+        pageState[page] = isBlank(start, pageSize) ? PAGE_FREE : PAGE_DIRTY;
+        if (pageState[page] == PAGE_FREE) freePages++; else dirtyPages++;
+        return 0;
+    }
+    pageState[page] = PAGE_USED;
+    pageSequence[page] = header.sequence;
+    if (header.sequence >= nextSequence) nextSequence = header.sequence + 1;
+
+    // Records run up to a blank tail. A torn record is stepped over a word at a
+    // time until the next record that checks out, or the tail.
+    uint32_t offset = sizeof(KvPageHeader);
+    while (offset + sizeof(KvRecordHeader) <= pageSize) {
+        KvRecordHeader record;
+        if (!flash.read(start + offset, &record, sizeof(record))) break;
+        uint8_t value[MAX_VALUE_LENGTH];
+        bool plausible = validKey(record.key) && record.length <= MAX_VALUE_LENGTH &&
+                         offset + recordSize(record.length) <= pageSize &&
+                         record.sequence >= header.sequence;
+        if (plausible && flash.read(start + offset + sizeof(record), value, record.length) &&
+            recordCrc(record, value) == record.crc) {
+            IndexEntry& entry = index[record.key];
+            if (!entry.present || record.sequence > entry.sequence) {
+                entry.offset = start + offset;
+                entry.sequence = record.sequence;
+                entry.length = record.length;
+                entry.present = true;
+            }
+            if (record.sequence >= nextSequence) nextSequence = record.sequence + 1;
+            offset += recordSize(record.length);
+            continue;
+        }
+        if (record.key == 0xFF && isBlank(start + offset, pageSize - offset)) break;
+        offset += 4;
+    }
+    return offset;
+}
+
+void KvStore::setPageState(int page, PageState state) {
+    if (pageState[page] == PAGE_FREE) freePages--;
+    if (pageState[page] == PAGE_DIRTY) dirtyPages--;
+    pageState[page] = state;
+    if (state == PAGE_FREE) freePages++;
+    if (state == PAGE_DIRTY) dirtyPages++;
+}
+
+uint32_t KvStore::headRoom() const {
+    return headPage < 0 ? 0 : pageSize - headOffset;
+}
+
+int KvStore::oldestPage() const {
+    int oldest = -1;
+    for (int page = 0; page < pageCount; page++) {
+        if (page == headPage || pageState[page] != PAGE_USED) continue;
+        if (oldest < 0 || pageSequence[page] < pageSequence[oldest]) oldest = page;
+    }
+    return oldest;
+}
+
+uint32_t KvStore::liveBytes(int page) const {
+    uint32_t bytes = 0;
+    for (int key = 1; key < MAX_KEYS; key++) {
+        const IndexEntry& entry = index[key];
+        if (entry.present && entry.length > 0 && (int)(entry.offset / pageSize) == page) {
+            bytes += recordSize(entry.length);
+        }
+    }
+    return bytes;
+}
+
+bool KvStore::erasePage(int page) {
+    bool erased = flash.eraseSector(page * pageSize);
+    setPageState(page, erased ? PAGE_FREE : PAGE_DIRTY);
+    if (erased) {
+        stats.pagesErased++;
+        if (diagnostics) diagnostics->recordStateErase();
+    } else {
+        Serial.println("[KV] Page erase failed");
+    }
+    return erased;
+}
+
+bool KvStore::openPage() {
+    // The next page in ring order after the head, so every page takes its turn
+    int first = headPage < 0 ? 0 : headPage + 1;
+    for (int i = 0; i < pageCount; i++) {
+        int page = (first + i) % pageCount;
+        if (pageState[page] == PAGE_USED) continue;
+        if (pageState[page] == PAGE_DIRTY && !erasePage(page)) continue;
+
+        // Sequence first, magic last: a torn header leaves the page dirty, not open
+        uint32_t start = page * pageSize;
+        uint32_t sequence = nextSequence;
+        uint32_t magic = KV_PAGE_MAGIC;
+        if (!flash.program(start + offsetof(KvPageHeader, sequence), &sequence, sizeof(sequence)) ||
+            !flash.program(start, &magic, sizeof(magic))) {
+            setPageState(page, PAGE_DIRTY);
+            Serial.println("[KV] Page header write failed");
+            return false;
+        }
+        setPageState(page, PAGE_USED);
+        pageSequence[page] = nextSequence++;
+        headPage = page;
+        headOffset = sizeof(KvPageHeader);
+        return true;
+    }
+    return false;
+}
+
+bool KvStore::append(uint8_t key, const uint8_t* value, uint8_t length) {
+    uint32_t size = recordSize(length);
+    if (headRoom() < size) return false;
+
+    // Header and value in one program; padding stays erased
+    uint8_t buffer[sizeof(KvRecordHeader) + MAX_VALUE_LENGTH + 3];
+    KvRecordHeader header;
+    header.key = key;
+    header.length = length;
+    header.sequence = nextSequence;
+    header.crc = recordCrc(header, value);
+    memset(buffer, 0xFF, size);
+    memcpy(buffer, &header, sizeof(header));
+    if (length > 0) memcpy(buffer + sizeof(header), value, length);
+
+    uint32_t offset = headPage * pageSize + headOffset;
+    // A failed write still used its space; the next scan steps over it
+    headOffset += size;
+    if (!flash.program(offset, buffer, size)) return false;
+
+    nextSequence++;
+    IndexEntry& entry = index[key];
+    entry.offset = offset;
+    entry.sequence = header.sequence;
+    entry.length = length;
+    entry.present = true;
+    return true;
+}
+
+bool KvStore::compactStep() {
+    int page = oldestPage();
+    if (page < 0) return false;
+
+    for (int key = 1; key < MAX_KEYS; key++) {
+        IndexEntry& entry = index[key];
+        if (!entry.present || (int)(entry.offset / pageSize) != page) continue;
+        if (entry.length == 0) {
+            // Older values of a removed key are in this page or were erased before it
+            entry.present = false;
+            continue;
+        }
+        uint8_t value[MAX_VALUE_LENGTH];
+        if (!flash.read(entry.offset + sizeof(KvRecordHeader), value, entry.length) ||
+            !append((uint8_t)key, value, entry.length)) {
+            Serial.println("[KV] Moving a record out of the oldest page failed");
+            return false;
+        }
+        stats.recordsMoved++;
+        return true;
+    }
+    return erasePage(page);
+}
+
+bool KvStore::makeRoom(uint32_t size) {
+    // Once no page is spare, the head keeps room for the oldest page's live
+    // records: reclaiming it can always finish, in poll() or right here
+    for (int attempt = 0; attempt < pageCount + MAX_KEYS + 2; attempt++) {
+        uint32_t owed = isCompactionDue() ? liveBytes(oldestPage()) : 0;
+        if (headRoom() >= size + owed) return true;
+        if (isCompactionDue()) {
+            if (!compactStep()) return false;
+        } else if (!openPage()) {
+            return false;
+        }
+    }
+    return false;
+}
+
+bool KvStore::write(uint8_t key, const void* data, uint8_t length) {
+    if (!makeRoom(recordSize(length)) || !append(key, (const uint8_t*)data, length)) {
+        Serial.print("[KV] Write failed for key ");
+        Serial.println(key);
+        return false;
+    }
+    stats.writes++;
+    if (diagnostics) diagnostics->recordStateWrite(true);
+    return true;
+}
+
+bool KvStore::putBytes(uint8_t key, const void* data, uint8_t length) {
+    if (!ready || !validKey(key) || length == 0 || length > MAX_VALUE_LENGTH) return false;
+
+    // Rewriting the same value would only cost flash
+    const IndexEntry& entry = index[key];
+    if (entry.present && entry.length == length) {
+        uint8_t stored[MAX_VALUE_LENGTH];
+        if (flash.read(entry.offset + sizeof(KvRecordHeader), stored, length) &&
+            memcmp(stored, data, length) == 0) {
+            stats.skipped++;
+            if (diagnostics) diagnostics->recordStateWrite(false);
+            return true;
+        }
+    }
+    return write(key, data, length);
+}
+
+int KvStore::getBytes(uint8_t key, void* data, uint8_t maxLength) {
+    if (!ready || !contains(key)) return -1;
+    const IndexEntry& entry = index[key];
+    if (entry.length > maxLength ||
+        !flash.read(entry.offset + sizeof(KvRecordHeader), data, entry.length)) {
+        return -1;
+    }
+    return entry.length;
+}
+
+bool KvStore::remove(uint8_t key) {
+    if (!ready || !validKey(key)) return false;
+    if (!contains(key)) return true;
+    return write(key, nullptr, 0);
+}
+
+bool KvStore::contains(uint8_t key) const {
+    return validKey(key) && index[key].present && index[key].length > 0;
+}
+
+bool KvStore::putString(uint8_t key, const char* text) {
+    size_t length = strlen(text) + 1;
+    if (length > MAX_VALUE_LENGTH) return false;
+    return putBytes(key, text, (uint8_t)length);
+}
+
+bool KvStore::getString(uint8_t key, char* text, size_t size) {
+    if (size == 0) return false;
+    int length = getBytes(key, text, size > MAX_VALUE_LENGTH ? MAX_VALUE_LENGTH : (uint8_t)size);
+    if (length <= 0) return false;
+    text[length - 1] = '\0';
+    return true;
+}
+
+bool KvStore::poll() {
+    if (!ready) return false;
+    if (isCompactionDue()) return compactStep();
+    // Torn pages are erased now rather than when the head next needs one
+    for (int page = 0; page < pageCount; page++) {
+        if (pageState[page] == PAGE_DIRTY) return erasePage(page);
+    }
+    return false;
+}
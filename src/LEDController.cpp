@@ -1,44 +1,74 @@
 #include "LEDController.h"
 #include "Config.h"
-
-LEDController::LEDController() : useBuiltinLED(false), currentAnimation(IDLE), animationStartTime(0), animationStep(0), animationParam1(0), animationParam2(0) {
+#include "SystemDiagnostics.h"
+#include "LedPatterns.h"
+
+// PWM duty for each perceived level, 255 * (level / 255)^2.2. Levels are
+// given as they should look, so half brightness and intensity scaling look
+// half as bright instead of nearly full.
+static constexpr uint8_t GAMMA[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6,
+    6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 11, 11, 11, 12,
+    12, 13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19,
+    20, 20, 21, 22, 22, 23, 23, 24, 25, 25, 26, 26, 27, 28, 28, 29,
+    30, 30, 31, 32, 33, 33, 34, 35, 35, 36, 37, 38, 39, 39, 40, 41,
+    42, 43, 43, 44, 45, 46, 47, 48, 49, 49, 50, 51, 52, 53, 54, 55,
+    56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    73, 74, 75, 76, 77, 78, 79, 81, 82, 83, 84, 85, 87, 88, 89, 90,
+    91, 93, 94, 95, 97, 98, 99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+LEDController::LEDController(LedOutput& ledOutput)
+    : output(ledOutput), useBuiltinLED(false), shownValid(false), writeStats{0, 0}, diagnostics(nullptr) {
 }
 
 bool LEDController::begin() {
-    initializeHardware();
-    return true;
+    bool ok = output.begin();
+    // A single LED shows blink codes and pulses instead of colours
+    useBuiltinLED = output.getChannels() == 1;
+    shownValid = false;   // begin() left the LED in its own state
+    return ok;
 }
 
-void LEDController::initializeHardware() {
-    // Detect board type and initialize appropriate LED hardware
-    #if defined(ARDUINO_NANO_RP2040_CONNECT)
-        Serial.println("Using RGB LED on Nano RP2040 Connect");
-        useBuiltinLED = false;
-        // Initialize WiFiNINA (required for LED control on RP2040)
-        WiFiDrv::pinMode(25, OUTPUT); // Green LED
-        WiFiDrv::pinMode(26, OUTPUT); // Red LED
-        WiFiDrv::pinMode(27, OUTPUT); // Blue LED
-        
-        // Turn off all LEDs initially
-        WiFiDrv::digitalWrite(25, LOW);
-        WiFiDrv::digitalWrite(26, LOW);
-        WiFiDrv::digitalWrite(27, LOW);
-    #else
-        Serial.println("Using built-in LED on Nano 33 IoT");
-        useBuiltinLED = true;
-        pinMode(LED_BUILTIN, OUTPUT);
-        digitalWrite(LED_BUILTIN, HIGH); // HIGH = OFF for inverted LED
-    #endif
+void LEDController::setColor(uint8_t red, uint8_t green, uint8_t blue) {
+    animator.stop();
+    show(red, green, blue);
 }
 
-void LEDController::setColor(uint8_t red, uint8_t green, uint8_t blue) {
-    if (useBuiltinLED) {
-        // For built-in LED, use brightness based on color intensity
-        uint8_t brightness = max(red, max(green, blue));
-        setBuiltinLED(brightness);
-    } else {
-        setRGBLED(red, green, blue);
+uint8_t LEDController::gammaCorrect(uint8_t level) {
+    return GAMMA[level];
+}
+
+void LEDController::show(uint8_t red, uint8_t green, uint8_t blue) {
+    uint8_t levels[3] = {GAMMA[red], GAMMA[green], GAMMA[blue]};
+    int channels = output.getChannels();
+    if (channels == 1) {
+        // A single LED shows the brightest channel
+        if (levels[1] > levels[0]) levels[0] = levels[1];
+        if (levels[2] > levels[0]) levels[0] = levels[2];
+    }
+
+    // Only changed channels go out: on the RP2040 each write is an SPI
+    // command to the NINA module, sharing the bus with WiFi and BLE
+    for (int channel = 0; channel < channels && channel < 3; channel++) {
+        bool changed = !shownValid || shown[channel] != levels[channel];
+        if (changed) {
+            output.writeChannel((uint8_t)channel, levels[channel]);
+            shown[channel] = levels[channel];
+            writeStats.writes++;
+        } else {
+            writeStats.skipped++;
+        }
+        if (diagnostics) diagnostics->recordLedWrite(changed);
     }
+    shownValid = true;
 }
 
 void LEDController::setColorWithIntensity(uint8_t red, uint8_t green, uint8_t blue, int intensity) {
@@ -54,323 +84,41 @@ void LEDController::setColorWithIntensity(uint8_t red, uint8_t green, uint8_t bl
 }
 
 void LEDController::updateColorForOrientation(Orientation orientation, int intensity) {
+    const LedFaceFeedback& face = LedPatterns::face(orientation);
     if (useBuiltinLED) {
         // For built-in LED, use blink patterns instead of colors
-        int blinkCount = getBlinkCountForOrientation(orientation);
-        blinkPattern(blinkCount);
+        if (face.blinks > 0) play(LedPatterns::BLINK_CODE, face.blinks);
     } else {
-        // For RGB LED, use colors as before
-        switch (orientation) {
-            case FACE_UP:
-                setColorWithIntensity(0, 255, 0, intensity); // Green
-                break;
-            case FACE_DOWN:
-                setColorWithIntensity(255, 0, 0, intensity); // Red
-                break;
-            case LEFT_SIDE:
-                setColorWithIntensity(0, 0, 255, intensity); // Blue
-                break;
-            case RIGHT_SIDE:
-                setColorWithIntensity(255, 255, 0, intensity); // Yellow
-                break;
-            case FRONT_EDGE:
-                setColorWithIntensity(128, 0, 128, intensity); // Purple
-                break;
-            case BACK_EDGE:
-                setColorWithIntensity(0, 255, 255, intensity); // Cyan
-                break;
-            default:
-                setColorWithIntensity(255, 255, 255, intensity); // White
-                break;
-        }
+        setColorWithIntensity(face.red, face.green, face.blue, intensity);
     }
 }
 
-
-void LEDController::showError() {
-    // Flash red to indicate error
-    for (int i = 0; i < 5; i++) {
-        setColor(255, 0, 0); // Red
-        delay(200);
-        setColor(0, 0, 0); // Off
-        delay(200);
+void LEDController::showFeedback(LedFeedback feedback) {
+    const LedFeedbackPatterns& patterns = LedPatterns::feedback(feedback);
+    if (useBuiltinLED) {
+        play(patterns.single, patterns.singlePasses);
+    } else {
+        play(patterns.rgb, patterns.rgbPasses);
     }
 }
 
-
 void LEDController::turnOff() {
     setColor(0, 0, 0);
 }
 
-void LEDController::blinkPattern(int blinkCount) {
-    if (blinkCount <= 0) return;
-    
-    // Turn off LED first
-    setBuiltinLED(0);
-    delay(300); // Brief pause before starting pattern
-    
-    for (int i = 0; i < blinkCount; i++) {
-        setBuiltinLED(255); // On
-        delay(200);
-        setBuiltinLED(0);   // Off
-        delay(200);
-    }
-    
-    // Leave LED off after pattern
-    delay(300);
-}
-
-int LEDController::getBlinkCountForOrientation(Orientation orientation) {
-    switch (orientation) {
-        case FACE_UP:      return 1; // 1 blink for face up
-        case FACE_DOWN:    return 2; // 2 blinks for face down
-        case LEFT_SIDE:    return 3; // 3 blinks for left side
-        case RIGHT_SIDE:   return 4; // 4 blinks for right side
-        case FRONT_EDGE:   return 5; // 5 blinks for front edge
-        case BACK_EDGE:    return 6; // 6 blinks for back edge
-        default:           return 0; // No blinks for unknown
-    }
+void LEDController::play(const uint8_t* pattern, uint8_t passes) {
+    animator.start(pattern, millis(), passes);
+    updateBLEAnimation();   // First frame now, not on the next loop
 }
 
 uint8_t LEDController::scaleIntensity(uint8_t value, int intensity) const {
     return (value * intensity) / Config::LED_MAX_INTENSITY;
 }
 
-void LEDController::setBuiltinLED(uint8_t brightness) {
-    analogWrite(LED_BUILTIN, 255 - brightness); // Invert for built-in LED
-}
-
-void LEDController::setRGBLED(uint8_t red, uint8_t green, uint8_t blue) {
-    #if defined(ARDUINO_NANO_RP2040_CONNECT)
-    // The RGB LED is controlled through the NINA module on RP2040 Connect
-    // Convert 0-255 range to PWM values and invert (LED is common anode)
-    uint8_t redPWM = 255 - red;
-    uint8_t greenPWM = 255 - green;
-    uint8_t bluePWM = 255 - blue;
-
-    // Set PWM values for each color channel
-    WiFiDrv::analogWrite(26, redPWM);   // Red
-    WiFiDrv::analogWrite(25, greenPWM); // Green
-    WiFiDrv::analogWrite(27, bluePWM);  // Blue
-    #endif
-}
-
-// BLE state-specific LED feedback methods (non-blocking)
-void LEDController::showBLESetupMode() {
-    if (useBuiltinLED) {
-        // Start slow pulse animation
-        currentAnimation = PULSE;
-        animationStartTime = millis();
-        animationStep = 0;
-        animationParam1 = 2000; // 2-second cycle
-        animationParam2 = 1;    // Single pulse
-    } else {
-        // Blue color for RGB LED
-        currentAnimation = IDLE;
-        setColor(0, 0, 128); // Dim blue
-    }
-}
-
-void LEDController::showBLEConnecting() {
-    if (useBuiltinLED) {
-        // Start fast pulse animation
-        currentAnimation = PULSE;
-        animationStartTime = millis();
-        animationStep = 0;
-        animationParam1 = 1000; // 1-second cycle
-        animationParam2 = 2;    // Double pulse
-    } else {
-        // Yellow color for RGB LED
-        currentAnimation = IDLE;
-        setColor(128, 128, 0); // Dim yellow
-    }
-}
-
-void LEDController::showBLEConnected() {
-    if (useBuiltinLED) {
-        // Solid on for connected
-        currentAnimation = IDLE;
-        setBuiltinLED(128); // Medium brightness solid
-    } else {
-        // Green color for RGB LED
-        currentAnimation = IDLE;
-        setColor(0, 128, 0); // Dim green
-    }
-}
-
-void LEDController::showBLEError() {
-    if (useBuiltinLED) {
-        // Start triple flash animation
-        currentAnimation = FLASH;
-        animationStartTime = millis();
-        animationStep = 0;
-        animationParam1 = 3;   // 3 flashes
-        animationParam2 = 200; // 200ms on/off time
-    } else {
-        // Red color for RGB LED (static error indication)
-        currentAnimation = IDLE;
-        setColor(128, 0, 0); // Dim red
-    }
-}
-
-void LEDController::showWiFiError() {
-    if (useBuiltinLED) {
-        // Start WiFi error animation: 2 blinks, wait 1 second, repeat
-        currentAnimation = WIFI_ERROR;
-        animationStartTime = millis();
-        animationStep = 0;
-        animationParam1 = 2;    // 2 blinks per cycle
-        animationParam2 = 150;  // 150ms on/off time for each blink
-    } else {
-        // Red color for RGB LED with slight flashing pattern
-        currentAnimation = WIFI_ERROR;
-        animationStartTime = millis();
-        animationStep = 0;
-        animationParam1 = 2;    // 2 blinks per cycle
-        animationParam2 = 150;  // 150ms on/off time for each blink
-        setColor(128, 0, 0); // Start with dim red
-    }
-}
-
 // Non-blocking animation update method
 void LEDController::updateBLEAnimation() {
-    if (currentAnimation == IDLE) {
-        return; // No animation needed
-    }
-    
-    unsigned long elapsed = millis() - animationStartTime;
-    
-    switch (currentAnimation) {
-        case PULSE: {
-            int cycleDuration = animationParam1; // Full cycle time
-            int cyclePosition = elapsed % cycleDuration;
-            
-            // Simple sine-wave approximation for smooth pulse
-            if (cyclePosition < cycleDuration / 2) {
-                // Fade in
-                int brightness = (cyclePosition * 128) / (cycleDuration / 2);
-                setBuiltinLED(brightness);
-            } else {
-                // Fade out
-                int brightness = 128 - ((cyclePosition - cycleDuration / 2) * 128) / (cycleDuration / 2);
-                setBuiltinLED(brightness);
-            }
-            break;
-        }
-        
-        case FLASH: {
-            int flashDuration = animationParam2; // Time for one flash (on+off)
-            int totalFlashes = animationParam1;
-            int currentFlash = elapsed / (flashDuration * 2); // Each flash is on+off
-            
-            if (currentFlash >= totalFlashes) {
-                // Animation complete
-                setBuiltinLED(0);
-                currentAnimation = IDLE;
-            } else {
-                // Determine if we're in on or off phase of current flash
-                int flashPhase = elapsed % (flashDuration * 2);
-                if (flashPhase < flashDuration) {
-                    setBuiltinLED(255); // On
-                } else {
-                    setBuiltinLED(0);   // Off
-                }
-            }
-            break;
-        }
-        
-        case WIFI_ERROR: {
-            // WiFi error pattern: blink, gap, blink, wait 1 second, repeat
-            int blinkOnTime = animationParam2;   // 150ms ON
-            int blinkOffTime = animationParam2;  // 150ms OFF
-            int gapTime = animationParam2;       // 150ms gap between blinks
-            int waitTime = 1000;                 // 1 second wait
-            
-            // Timing: ON(150) + OFF(150) + ON(150) + OFF(150) + WAIT(1000) = 1600ms total
-            int cycleDuration = (blinkOnTime + blinkOffTime) + gapTime + (blinkOnTime + blinkOffTime) + waitTime;
-            int cyclePosition = elapsed % cycleDuration;
-            
-            if (cyclePosition < blinkOnTime) {
-                // First blink ON phase
-                if (useBuiltinLED) {
-                    setBuiltinLED(255);
-                } else {
-                    setColor(255, 0, 0);
-                }
-            } else if (cyclePosition < (blinkOnTime + blinkOffTime)) {
-                // First blink OFF phase
-                if (useBuiltinLED) {
-                    setBuiltinLED(0);
-                } else {
-                    setColor(0, 0, 0);
-                }
-            } else if (cyclePosition < (blinkOnTime + blinkOffTime + gapTime)) {
-                // Gap between blinks (OFF)
-                if (useBuiltinLED) {
-                    setBuiltinLED(0);
-                } else {
-                    setColor(0, 0, 0);
-                }
-            } else if (cyclePosition < (blinkOnTime + blinkOffTime + gapTime + blinkOnTime)) {
-                // Second blink ON phase
-                if (useBuiltinLED) {
-                    setBuiltinLED(255);
-                } else {
-                    setColor(255, 0, 0);
-                }
-            } else if (cyclePosition < (blinkOnTime + blinkOffTime + gapTime + blinkOnTime + blinkOffTime)) {
-                // Second blink OFF phase
-                if (useBuiltinLED) {
-                    setBuiltinLED(0);
-                } else {
-                    setColor(0, 0, 0);
-                }
-            } else {
-                // Wait phase (1 second OFF)
-                if (useBuiltinLED) {
-                    setBuiltinLED(0);
-                } else {
-                    setColor(0, 0, 0);
-                }
-            }
-            break;
-        }
-        
-        default:
-            currentAnimation = IDLE;
-            break;
+    LedColor color;
+    if (animator.update(millis(), color)) {
+        show(color.red, color.green, color.blue);
     }
 }
-
-// Helper methods for single LED patterns (kept for compatibility)
-void LEDController::pulseBuiltinLED(int duration, int pulseCount) {
-    for (int pulse = 0; pulse < pulseCount; pulse++) {
-        // Fade in
-        for (int brightness = 0; brightness <= 128; brightness += 8) {
-            setBuiltinLED(brightness);
-            delay(duration / (16 * pulseCount)); // Smooth fade timing
-        }
-        // Fade out  
-        for (int brightness = 128; brightness >= 0; brightness -= 8) {
-            setBuiltinLED(brightness);
-            delay(duration / (16 * pulseCount)); // Smooth fade timing
-        }
-        
-        if (pulse < pulseCount - 1) {
-            delay(200); // Brief pause between pulses
-        }
-    }
-}
-
-void LEDController::flashBuiltinLED(int flashCount, int onTime, int offTime) {
-    for (int flash = 0; flash < flashCount; flash++) {
-        setBuiltinLED(255); // Full brightness
-        delay(onTime);
-        setBuiltinLED(0);   // Off
-        
-        if (flash < flashCount - 1) {
-            delay(offTime); // Pause between flashes
-        }
-    }
-    delay(300); // Final pause after pattern
-}
\ No newline at end of file
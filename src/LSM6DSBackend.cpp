@@ -0,0 +1,365 @@
+#include "ImuBackend.h"
+#include <Arduino.h>
+#include <Wire.h>
+
+#if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_NANO33BLE)
+  #include <Arduino_LSM6DSOX.h>
+#elif defined(ARDUINO_ARCH_ESP32)
+  #include <LSM6DS3.h>
+#else
+  #include <Arduino_LSM6DSOX.h>
+#endif
+
+static const uint8_t IMU_ADDRESS = 0x6A;
+static const uint8_t REG_WHO_AM_I = 0x0F;
+static const uint8_t WHO_AM_I_LSM6DSOX = 0x6C;
+static const uint8_t WHO_AM_I_LSM6DS3 = 0x69;
+
+// Shared by both chips
+static const uint8_t REG_CTRL1_XL = 0x10;       // ODR [7:4], full scale [3:2], LPF2 [1]
+static const uint8_t REG_CTRL2_G = 0x11;        // ODR [7:4], full scale [3:1]
+static const uint8_t REG_CTRL6_C = 0x15;        // XL_HM_MODE [4]: 1 disables high performance
+static const uint8_t CTRL1_XL_4G_LPF2 = 0x0A;   // As the IMU library sets it, 104 Hz in [7:4]
+static const uint8_t CTRL2_G_2000DPS = 0x0C;    // Power-down with ODR 0
+static const uint8_t ODR_104_HZ = 0x04;
+static const uint8_t ODR_416_HZ = 0x06;         // Tap engine rate; INT_DUR2 below is set for it
+static const uint8_t CTRL6_C_XL_HM_MODE = 0x10;
+static const uint8_t REG_OUTX_L_G = 0x22;       // Gyroscope X/Y/Z, 6 bytes
+static const uint8_t REG_FIFO_STATUS1 = 0x3A;   // Level, low byte
+static const uint8_t FIFO_STATUS2_OVERRUN = 0x40;
+
+// LSM6DSOX: one tagged 7-byte word per sample
+static const uint8_t DSOX_FIFO_CTRL1 = 0x07;    // Watermark [7:0]
+static const uint8_t DSOX_FIFO_CTRL2 = 0x08;    // Watermark [8]
+static const uint8_t DSOX_FIFO_CTRL3 = 0x09;    // Batch rates: gyro [7:4], accel [3:0]
+static const uint8_t DSOX_FIFO_CTRL4 = 0x0A;    // Mode [2:0]
+static const uint8_t DSOX_FIFO_DATA_OUT_TAG = 0x78;
+static const uint8_t DSOX_TAG_ACCEL = 0x02;
+static const int DSOX_WORD_BYTES = 7;
+
+// LSM6DS3: untagged 16-bit words, X/Y/Z in turn
+static const uint8_t DS3_FIFO_CTRL1 = 0x06;     // Threshold in words [7:0]
+static const uint8_t DS3_FIFO_CTRL2 = 0x07;     // Threshold [11:8]
+static const uint8_t DS3_FIFO_CTRL3 = 0x08;     // Decimation: gyro [5:3], accel [2:0]
+static const uint8_t DS3_FIFO_CTRL5 = 0x0A;     // FIFO rate [6:3], mode [2:0]
+static const uint8_t DS3_FIFO_DATA_OUT_L = 0x3E;
+static const int DS3_SAMPLE_BYTES = 6;
+
+static const uint8_t FIFO_MODE_CONTINUOUS = 0x06;
+
+// Event engines, same addresses on both chips except for the latch and tap threshold bits
+static const uint8_t REG_WAKE_UP_SRC = 0x1B;    // Followed by TAP_SRC and D6D_SRC
+static const uint8_t WAKE_UP_SRC_WU_IA = 0x08;
+static const uint8_t TAP_SRC_SINGLE_TAP = 0x20;
+static const uint8_t TAP_SRC_DOUBLE_TAP = 0x10;
+static const uint8_t D6D_SRC_D6D_IA = 0x40;
+static const uint8_t DSOX_TAP_CFG0 = 0x56;      // LIR [0], TAP_X/Y/Z_EN [3:1], INT_CLR_ON_READ [6]
+static const uint8_t DSOX_TAP_CFG1 = 0x57;      // TAP_THS_X [4:0], axis priority [7:5]
+static const uint8_t REG_TAP_CFG = 0x58;        // INTERRUPTS_ENABLE [7]; TAP_THS_Y [4:0] on the LSM6DSOX,
+                                                // TAP_X/Y/Z_EN [3:1] and LIR [0] on the LSM6DS3
+static const uint8_t REG_TAP_THS_6D = 0x59;     // SIXD_THS [6:5], TAP_THS(_Z) [4:0], FS/32 per LSB
+static const uint8_t REG_INT_DUR2 = 0x5A;       // Double-tap gap [7:4], quiet [3:2], shock [1:0]
+static const uint8_t REG_WAKE_UP_THS = 0x5B;    // SINGLE_DOUBLE_TAP [7], WK_THS [5:0], FS/64 per LSB
+static const uint8_t REG_WAKE_UP_DUR = 0x5C;
+static const uint8_t REG_MD1_CFG = 0x5E;        // INT1 routing
+static const uint8_t SIXD_THS_60_DEG = 0x40;
+static const uint8_t TAP_XYZ_EN = 0x0E;
+static const uint8_t WAKE_UP_THS_DOUBLE_TAP = 0x80;
+static const uint8_t MD1_INT1_6D = 0x04;
+static const uint8_t MD1_INT1_DOUBLE_TAP = 0x08;
+static const uint8_t MD1_INT1_WU = 0x20;
+static const uint8_t MD1_INT1_SINGLE_TAP = 0x40;
+// At 416 Hz: shock window 58 ms, quiet 29 ms, up to 540 ms between the taps of a double
+static const uint8_t INT_DUR2_TAP_416_HZ = 0x7F;
+
+// INT1 as wired by the board variant; not every board routes it to the MCU
+#if defined(INT_IMU)
+static const int IMU_INT1_PIN = INT_IMU;
+#else
+static const int IMU_INT1_PIN = -1;
+#endif
+
+static volatile bool imuInterrupt = false;
+
+static void onImuInterrupt() {
+    imuInterrupt = true;
+}
+
+// +-4 g as set by the IMU library: 4000 mg / 32768 LSB = 125 / 1024 exactly
+static int16_t rawToMilliG(const uint8_t* data) {
+    int32_t raw = (int16_t)(data[0] | (data[1] << 8));
+    return (int16_t)((raw * 125) >> 10);
+}
+
+// +-2000 dps as set by the IMU library: 70 mdps/LSB, 287 / 4096 to within 0.1%
+static int16_t rawToDps(const uint8_t* data) {
+    int32_t raw = (int16_t)(data[0] | (data[1] << 8));
+    return (int16_t)((raw * 287) >> 12);
+}
+
+// Largest burst; Wire buffers are 256 bytes on both cores
+static const int MAX_BURST_SAMPLES = 32;
+
+LSM6DSBackend::LSM6DSBackend()
+    : chip(CHIP_UNKNOWN), fifoEnabled(false), overrun(false), fifoLevel(0), eventsEnabled(false), tapsEnabled(false), fifoRate(0) {
+}
+
+bool LSM6DSBackend::begin() {
+    busTransactions++;
+    if (!IMU.begin()) {
+        return false;
+    }
+    uint8_t id = 0;
+    readRegisters(REG_WHO_AM_I, &id, 1);
+    chip = id == WHO_AM_I_LSM6DSOX ? CHIP_LSM6DSOX : id == WHO_AM_I_LSM6DS3 ? CHIP_LSM6DS3 : CHIP_UNKNOWN;
+    fifoEnabled = false;
+    eventsEnabled = false;
+    tapsEnabled = false;
+    return true;
+}
+
+bool LSM6DSBackend::enableFifo(uint16_t watermark, uint16_t rateHz) {
+    uint8_t rate = rateCode(rateHz);
+    bool ok;
+    if (chip == CHIP_LSM6DSOX) {
+        ok = writeRegister(DSOX_FIFO_CTRL4, 0x00) &&   // Bypass clears the FIFO
+             writeRegister(DSOX_FIFO_CTRL1, watermark & 0xFF) &&
+             writeRegister(DSOX_FIFO_CTRL2, (watermark >> 8) & 0x01) &&
+             writeRegister(DSOX_FIFO_CTRL3, rate) &&   // Accelerometer only
+             writeRegister(DSOX_FIFO_CTRL4, FIFO_MODE_CONTINUOUS);
+    } else if (chip == CHIP_LSM6DS3) {
+        uint16_t words = watermark * 3;
+        ok = writeRegister(DS3_FIFO_CTRL5, 0x00) &&
+             writeRegister(DS3_FIFO_CTRL1, words & 0xFF) &&
+             writeRegister(DS3_FIFO_CTRL2, (words >> 8) & 0x0F) &&
+             writeRegister(DS3_FIFO_CTRL3, 0x01) &&    // Accelerometer, no decimation
+             writeRegister(DS3_FIFO_CTRL5, (rate << 3) | FIFO_MODE_CONTINUOUS);
+    } else {
+        ok = false;
+    }
+    fifoEnabled = ok;
+    fifoRate = ok ? rate : 0;
+    overrun = false;
+    return ok;
+}
+
+bool LSM6DSBackend::setLowPower(bool enabled, uint16_t rateHz) {
+    if (chip == CHIP_UNKNOWN) return false;
+
+    // Both output rates use the FIFO rate encoding; the gyroscope stops at 0.
+    // The tap engine keeps the accelerometer at its own rate either way
+    uint8_t odr = enabled ? rateCode(rateHz) : ODR_104_HZ;
+    uint8_t accelOdr = tapsEnabled ? ODR_416_HZ : odr;
+    bool lowPowerAccel = enabled && !tapsEnabled;
+    uint8_t ctrl6;
+    if (!readRegisters(REG_CTRL6_C, &ctrl6, 1)) return false;
+    ctrl6 = lowPowerAccel ? (ctrl6 | CTRL6_C_XL_HM_MODE) : (ctrl6 & ~CTRL6_C_XL_HM_MODE);
+    bool ok = writeRegister(REG_CTRL6_C, ctrl6) &&
+              writeRegister(REG_CTRL1_XL, (accelOdr << 4) | CTRL1_XL_4G_LPF2) &&
+              writeRegister(REG_CTRL2_G, enabled ? CTRL2_G_2000DPS : (ODR_104_HZ << 4) | CTRL2_G_2000DPS);
+    if (!ok || !fifoEnabled) return ok;
+
+    // The FIFO cannot batch faster than the sensor produces samples; continuous
+    // mode is written again with the new rate, which keeps what is queued
+    uint8_t batchRate = enabled ? odr : fifoRate;
+    if (chip == CHIP_LSM6DSOX) {
+        return writeRegister(DSOX_FIFO_CTRL3, batchRate);
+    }
+    return writeRegister(DS3_FIFO_CTRL5, (batchRate << 3) | FIFO_MODE_CONTINUOUS);
+}
+
+bool LSM6DSBackend::enableEvents(uint16_t wakeThresholdMg) {
+    if (IMU_INT1_PIN < 0 || chip == CHIP_UNKNOWN) return false;
+
+    // +-4 g full scale: 62.5 mg per threshold step
+    uint16_t steps = (uint16_t)((wakeThresholdMg * 64UL + 2000) / 4000);
+    if (steps < 1) steps = 1;
+    if (steps > 63) steps = 63;
+
+    bool ok;
+    if (chip == CHIP_LSM6DSOX) {
+        ok = writeRegister(DSOX_TAP_CFG0, 0x41) &&          // Latched, cleared by reading the source
+             writeRegister(REG_TAP_CFG, 0x80);
+    } else {
+        ok = writeRegister(REG_TAP_CFG, 0x81);              // Enabled, latched
+    }
+    ok = ok && writeRegister(REG_TAP_THS_6D, SIXD_THS_60_DEG) &&
+         writeRegister(REG_WAKE_UP_THS, (uint8_t)steps) &&
+         writeRegister(REG_WAKE_UP_DUR, 0x00) &&
+         writeRegister(REG_MD1_CFG, MD1_INT1_6D | MD1_INT1_WU);
+    if (!ok) return false;
+
+    pinMode(IMU_INT1_PIN, INPUT);
+    imuInterrupt = false;
+    attachInterrupt(digitalPinToInterrupt(IMU_INT1_PIN), onImuInterrupt, RISING);
+    eventsEnabled = true;
+    takeEvents();   // Anything latched during setup
+    return true;
+}
+
+bool LSM6DSBackend::eventPending() {
+    // The line stays high while an event is latched, should the edge have been missed
+    return eventsEnabled && (imuInterrupt || digitalRead(IMU_INT1_PIN) == HIGH);
+}
+
+uint8_t LSM6DSBackend::takeEvents() {
+    if (!eventsEnabled) return 0;
+    imuInterrupt = false;
+    uint8_t sources[3];   // WAKE_UP_SRC, TAP_SRC, D6D_SRC
+    if (!readRegisters(REG_WAKE_UP_SRC, sources, 3)) return 0;
+    uint8_t events = 0;
+    if (sources[0] & WAKE_UP_SRC_WU_IA) events |= IMU_EVENT_MOTION;
+    if (sources[1] & TAP_SRC_SINGLE_TAP) events |= IMU_EVENT_SINGLE_TAP;
+    if (sources[1] & TAP_SRC_DOUBLE_TAP) events |= IMU_EVENT_DOUBLE_TAP;
+    if (sources[2] & D6D_SRC_D6D_IA) events |= IMU_EVENT_ORIENTATION;
+    return events;
+}
+
+bool LSM6DSBackend::enableTaps(uint16_t thresholdMg) {
+    if (!eventsEnabled) return false;
+
+    // +-4 g full scale: 125 mg per tap threshold step
+    uint16_t steps = (uint16_t)((thresholdMg * 32UL + 2000) / 4000);
+    if (steps < 1) steps = 1;
+    if (steps > 31) steps = 31;
+
+    // Threshold, axes and latching go into registers enableEvents() set up
+    uint8_t wakeThs, tapCfg, ths6d;
+    if (!readRegisters(REG_WAKE_UP_THS, &wakeThs, 1) || !readRegisters(REG_TAP_CFG, &tapCfg, 1) ||
+        !readRegisters(REG_TAP_THS_6D, &ths6d, 1)) {
+        return false;
+    }
+    bool ok;
+    if (chip == CHIP_LSM6DSOX) {
+        ok = writeRegister(DSOX_TAP_CFG0, 0x41 | TAP_XYZ_EN) &&
+             writeRegister(DSOX_TAP_CFG1, (uint8_t)steps) &&
+             writeRegister(REG_TAP_CFG, (tapCfg & 0xE0) | steps);
+    } else {
+        ok = writeRegister(REG_TAP_CFG, tapCfg | TAP_XYZ_EN);
+    }
+    ok = ok && writeRegister(REG_TAP_THS_6D, (ths6d & 0xE0) | steps) &&
+         writeRegister(REG_INT_DUR2, INT_DUR2_TAP_416_HZ) &&
+         writeRegister(REG_WAKE_UP_THS, wakeThs | WAKE_UP_THS_DOUBLE_TAP) &&
+         writeRegister(REG_CTRL1_XL, (ODR_416_HZ << 4) | CTRL1_XL_4G_LPF2) &&
+         writeRegister(REG_MD1_CFG, MD1_INT1_6D | MD1_INT1_WU | MD1_INT1_SINGLE_TAP | MD1_INT1_DOUBLE_TAP);
+    tapsEnabled = ok;
+    return ok;
+}
+
+bool LSM6DSBackend::readGyro(GyroSample& rate) {
+    // The IMU library runs the gyroscope at 104 Hz alongside the accelerometer
+    uint8_t data[6];
+    if (chip == CHIP_UNKNOWN || !readRegisters(REG_OUTX_L_G, data, 6)) return false;
+    rate.x = rawToDps(data);
+    rate.y = rawToDps(data + 2);
+    rate.z = rawToDps(data + 4);
+    return true;
+}
+
+int LSM6DSBackend::available() {
+    if (!fifoEnabled) {
+        busTransactions++;
+        return IMU.accelerationAvailable() ? 1 : 0;
+    }
+    return readFifoLevel();
+}
+
+int LSM6DSBackend::readSamples(AccelSample* samples, int maxSamples) {
+    if (maxSamples <= 0) return 0;
+
+    if (!fifoEnabled) {
+        busTransactions++;
+        float x, y, z;
+        IMU.readAcceleration(x, y, z);
+        samples[0].x = (int16_t)(x * 1000.0f);
+        samples[0].y = (int16_t)(y * 1000.0f);
+        samples[0].z = (int16_t)(z * 1000.0f);
+        return 1;
+    }
+
+    // The FIFO output address wraps back to its first register after the
+    // last one, so a whole block comes out of one burst read
+    uint8_t buffer[MAX_BURST_SAMPLES * DSOX_WORD_BYTES];
+    int count = 0;
+    int level = fifoLevel;   // From the available() call before this read
+    while (count < maxSamples) {
+        int burst = maxSamples - count;
+        if (burst > level) burst = level;
+        if (burst > MAX_BURST_SAMPLES) burst = MAX_BURST_SAMPLES;
+        if (burst <= 0) break;
+
+        if (chip == CHIP_LSM6DSOX) {
+            if (!readRegisters(DSOX_FIFO_DATA_OUT_TAG, buffer, burst * DSOX_WORD_BYTES)) break;
+            for (int i = 0; i < burst; i++) {
+                const uint8_t* word = buffer + i * DSOX_WORD_BYTES;
+                if ((word[0] >> 3) != DSOX_TAG_ACCEL) continue;
+                samples[count].x = rawToMilliG(word + 1);
+                samples[count].y = rawToMilliG(word + 3);
+                samples[count].z = rawToMilliG(word + 5);
+                count++;
+            }
+        } else {
+            if (!readRegisters(DS3_FIFO_DATA_OUT_L, buffer, burst * DS3_SAMPLE_BYTES)) break;
+            for (int i = 0; i < burst; i++) {
+                const uint8_t* sample = buffer + i * DS3_SAMPLE_BYTES;
+                samples[count].x = rawToMilliG(sample);
+                samples[count].y = rawToMilliG(sample + 2);
+                samples[count].z = rawToMilliG(sample + 4);
+                count++;
+            }
+        }
+        if (burst < MAX_BURST_SAMPLES) break;
+        level = readFifoLevel();
+    }
+    fifoLevel = 0;
+    return count;
+}
+
+bool LSM6DSBackend::takeOverrun() {
+    bool result = overrun;
+    overrun = false;
+    return result;
+}
+
+int LSM6DSBackend::readFifoLevel() {
+    uint8_t status[2];
+    fifoLevel = 0;
+    if (!readRegisters(REG_FIFO_STATUS1, status, 2)) return 0;
+    if (status[1] & FIFO_STATUS2_OVERRUN) overrun = true;
+    if (chip == CHIP_LSM6DSOX) {
+        fifoLevel = status[0] | ((status[1] & 0x03) << 8);
+    } else {
+        // LSM6DS3 counts 16-bit words
+        fifoLevel = (status[0] | ((status[1] & 0x0F) << 8)) / 3;
+    }
+    return fifoLevel;
+}
+
+bool LSM6DSBackend::readRegisters(uint8_t reg, uint8_t* data, int length) {
+    // Register address then repeated start: one bus transaction
+    busTransactions++;
+    Wire.beginTransmission(IMU_ADDRESS);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom(IMU_ADDRESS, (uint8_t)length) != length) return false;
+    for (int i = 0; i < length; i++) {
+        data[i] = Wire.read();
+    }
+    return true;
+}
+
+bool LSM6DSBackend::writeRegister(uint8_t reg, uint8_t value) {
+    busTransactions++;
+    Wire.beginTransmission(IMU_ADDRESS);
+    Wire.write(reg);
+    Wire.write(value);
+    return Wire.endTransmission() == 0;
+}
+
+uint8_t LSM6DSBackend::rateCode(uint16_t rateHz) {
+    // Same encoding on both chips: 1 = 12.5 Hz, doubling per step up to 104 Hz
+    if (rateHz <= 13) return 0x01;
+    if (rateHz <= 26) return 0x02;
+    if (rateHz <= 52) return 0x03;
+    return 0x04;
+}
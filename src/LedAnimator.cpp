@@ -0,0 +1,85 @@
+#include "LedAnimator.h"
+
+// Sine ease-in-out, (1 - cos(pi * i / 64)) / 2 in 1/256ths: a fade starts and
+// ends gently instead of jumping into and out of a linear ramp
+static constexpr uint16_t SINE_EASE[65] = {
+    0, 0, 1, 1, 2, 4, 6, 7, 10, 12, 15, 18, 22,
+    25, 29, 33, 37, 42, 47, 52, 57, 62, 68, 73, 79, 85,
+    91, 97, 103, 109, 115, 122, 128, 134, 141, 147, 153, 159, 165,
+    171, 177, 183, 188, 194, 199, 204, 209, 214, 219, 223, 227, 231,
+    234, 238, 241, 244, 246, 249, 250, 252, 254, 255, 255, 256, 256
+};
+
+LedAnimator::LedAnimator()
+    : pattern(nullptr), steps(0), loopFrom(0), loopMs(0), running(false), frame(0), passesLeft(0),
+      forever(false), frameStart(0) {
+}
+
+void LedAnimator::start(const uint8_t* newPattern, unsigned long nowMs, uint8_t passes) {
+    pattern = newPattern;
+    steps = newPattern[0];
+    loopFrom = newPattern[1] < steps ? newPattern[1] : 0;
+    loopMs = 0;
+    for (uint8_t i = loopFrom; i < steps; i++) loopMs += stepMs(i);
+    running = steps > 0;
+    frame = 0;
+    // A loop part with no duration can only be played once
+    forever = passes == REPEAT_FOREVER && loopMs > 0;
+    passesLeft = forever || loopMs == 0 ? 0 : passes - 1;
+    frameStart = nowMs;
+}
+
+uint16_t LedAnimator::ease(uint32_t elapsedMs, uint32_t durationMs) {
+    if (elapsedMs >= durationMs) return 256;
+    // 16 steps between table entries, interpolated
+    uint32_t position = elapsedMs * 1024 / durationMs;
+    uint32_t index = position >> 4;
+    uint32_t remainder = position & 15;
+    return SINE_EASE[index] + (uint16_t)(((SINE_EASE[index + 1] - SINE_EASE[index]) * remainder) >> 4);
+}
+
+int LedAnimator::nextFrame() const {
+    if (frame + 1 < steps) return frame + 1;
+    return (forever || passesLeft > 0) ? loopFrom : -1;
+}
+
+bool LedAnimator::update(unsigned long nowMs, LedColor& color) {
+    if (!running) return false;
+
+    // Catch up over the steps that have run out since the last update
+    while (nowMs - frameStart >= stepMs(frame)) {
+        // Whole passes of the loop part land on the same step: skip them
+        // without walking the steps
+        if (frame >= loopFrom && loopMs > 0 && nowMs - frameStart >= loopMs) {
+            unsigned long passed = (nowMs - frameStart) / loopMs;
+            if (!forever && passed > passesLeft) passed = passesLeft;
+            frameStart += passed * loopMs;
+            if (!forever) passesLeft -= (uint8_t)passed;
+            if (nowMs - frameStart < stepMs(frame)) break;
+        }
+        int next = nextFrame();
+        if (next < 0) {
+            const uint8_t* last = step(frame);
+            color = {last[0], last[1], last[2]};
+            running = false;
+            return true;
+        }
+        frameStart += stepMs(frame);
+        if (next <= frame && !forever) passesLeft--;
+        frame = (uint8_t)next;
+    }
+
+    const uint8_t* current = step(frame);
+    color = {current[0], current[1], current[2]};
+    int next = nextFrame();
+    if (current[3] != LED_EASE_HOLD && next >= 0) {
+        const uint8_t* target = step((uint8_t)next);
+        uint32_t elapsed = nowMs - frameStart;
+        uint32_t duration = stepMs(frame);
+        int32_t progress = current[3] == LED_EASE_SINE ? ease(elapsed, duration) : elapsed * 256 / duration;
+        color.red = (uint8_t)(current[0] + (target[0] - current[0]) * progress / 256);
+        color.green = (uint8_t)(current[1] + (target[1] - current[1]) * progress / 256);
+        color.blue = (uint8_t)(current[2] + (target[2] - current[2]) * progress / 256);
+    }
+    return true;
+}
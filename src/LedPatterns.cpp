@@ -0,0 +1,94 @@
+#include "LedPatterns.h"
+
+// Const arrays stay in flash on the Nano RP2040 Connect and the Nano 33 IoT
+namespace LedPatterns {
+
+const uint8_t BLINK_CODE[] = {
+    LED_PATTERN(3, 1),
+    LED_STEP(0, 0, 0, LED_EASE_HOLD, 300),
+    LED_STEP(255, 255, 255, LED_EASE_HOLD, 200),
+    LED_STEP(0, 0, 0, LED_EASE_HOLD, 200)
+};
+
+// Ends off
+const uint8_t FLASH[] = {
+    LED_PATTERN(2, 0),
+    LED_STEP(255, 0, 0, LED_EASE_HOLD, 200),
+    LED_STEP(0, 0, 0, LED_EASE_HOLD, 200)
+};
+
+const uint8_t SLOW_PULSE[] = {
+    LED_PATTERN(2, 0),
+    LED_STEP(0, 0, 0, LED_EASE_SINE, 1000),
+    LED_STEP(128, 128, 128, LED_EASE_SINE, 1000)
+};
+
+const uint8_t FAST_PULSE[] = {
+    LED_PATTERN(2, 0),
+    LED_STEP(0, 0, 0, LED_EASE_SINE, 500),
+    LED_STEP(128, 128, 128, LED_EASE_SINE, 500)
+};
+
+const uint8_t WIFI_ERROR[] = {
+    LED_PATTERN(4, 0),
+    LED_STEP(255, 0, 0, LED_EASE_HOLD, 150),
+    LED_STEP(0, 0, 0, LED_EASE_HOLD, 300),
+    LED_STEP(255, 0, 0, LED_EASE_HOLD, 150),
+    LED_STEP(0, 0, 0, LED_EASE_HOLD, 1150)
+};
+
+// Solid colours: a single step that ends the pattern at once
+static const uint8_t BLUE[] = {LED_PATTERN(1, 0), LED_STEP(0, 0, 255, LED_EASE_HOLD, 0)};
+static const uint8_t DIM_BLUE[] = {LED_PATTERN(1, 0), LED_STEP(0, 0, 128, LED_EASE_HOLD, 0)};
+static const uint8_t YELLOW[] = {LED_PATTERN(1, 0), LED_STEP(255, 255, 0, LED_EASE_HOLD, 0)};
+static const uint8_t DIM_YELLOW[] = {LED_PATTERN(1, 0), LED_STEP(128, 128, 0, LED_EASE_HOLD, 0)};
+static const uint8_t GREEN[] = {LED_PATTERN(1, 0), LED_STEP(0, 255, 0, LED_EASE_HOLD, 0)};
+static const uint8_t DIM_GREEN[] = {LED_PATTERN(1, 0), LED_STEP(0, 128, 0, LED_EASE_HOLD, 0)};
+static const uint8_t DIM_RED[] = {LED_PATTERN(1, 0), LED_STEP(128, 0, 0, LED_EASE_HOLD, 0)};
+static const uint8_t HALF_ON[] = {LED_PATTERN(1, 0), LED_STEP(128, 128, 128, LED_EASE_HOLD, 0)};
+
+static const uint8_t FOREVER = LedAnimator::REPEAT_FOREVER;
+
+// LedFeedback order: RGB pattern and passes, single LED pattern and passes
+static const LedFeedbackPatterns FEEDBACK[LED_FEEDBACK_COUNT] = {
+    {BLUE, 1, BLUE, 1},                     // STARTING
+    {FLASH, 5, FLASH, 5},                   // ERROR
+    {DIM_BLUE, 1, SLOW_PULSE, FOREVER},     // BLE_SETUP
+    {DIM_YELLOW, 1, FAST_PULSE, FOREVER},   // BLE_CONNECTING
+    {DIM_GREEN, 1, HALF_ON, 1},             // BLE_CONNECTED
+    {DIM_RED, 1, FLASH, 3},                 // BLE_ERROR
+    {YELLOW, 1, YELLOW, 1},                 // WIFI_CONNECTING
+    {GREEN, 1, GREEN, 1},                   // WIFI_CONNECTED
+    {WIFI_ERROR, FOREVER, WIFI_ERROR, FOREVER},   // WIFI_ERROR
+    {DIM_BLUE, 1, DIM_BLUE, 1},             // CONFIG_WAITING
+    {GREEN, 1, GREEN, 1}                    // CONFIG_APPLIED
+};
+
+// Orientation order; blinks count up with the face
+static const LedFaceFeedback FACES[] = {
+    {0, 255, 0, 1},       // FACE_UP: green
+    {255, 0, 0, 2},       // FACE_DOWN: red
+    {0, 0, 255, 3},       // LEFT_SIDE: blue
+    {255, 255, 0, 4},     // RIGHT_SIDE: yellow
+    {128, 0, 128, 5},     // FRONT_EDGE: purple
+    {0, 255, 255, 6},     // BACK_EDGE: cyan
+    {255, 128, 0, 7},     // Faces 6-11 of larger trackers: orange, pink,
+    {255, 0, 128, 8},     //   lime, sky blue, violet, spring green
+    {128, 255, 0, 9},
+    {0, 128, 255, 10},
+    {128, 0, 255, 11},
+    {0, 255, 128, 12}
+};
+static const LedFaceFeedback UNKNOWN_FACE = {255, 255, 255, 0};
+
+static_assert(sizeof(FACES) / sizeof(FACES[0]) >= FACE_COUNT, "A colour for every face");
+
+const LedFeedbackPatterns& feedback(LedFeedback which) {
+    return FEEDBACK[which < LED_FEEDBACK_COUNT ? which : LED_FEEDBACK_ERROR];
+}
+
+const LedFaceFeedback& face(Orientation face) {
+    return face >= FACE_UP && face < FACE_COUNT ? FACES[face] : UNKNOWN_FACE;
+}
+
+} // namespace LedPatterns
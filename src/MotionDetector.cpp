@@ -0,0 +1,71 @@
+#include "MotionDetector.h"
+#include "SystemDiagnostics.h"
+
+MotionDetector::MotionDetector(uint32_t accelVariance, int16_t gyroDps, unsigned long restMs)
+    : varianceLimit(accelVariance), gyroLimit(gyroDps), restTime(restMs), filled(0), next(0), variance(0),
+      moving(false), quiet(true), stateSince(0), quietSince(0), stats({0, 0, 0, 0}), diagnostics(nullptr) {
+}
+
+void MotionDetector::update(const AccelSample* samples, int count, const GyroSample* rate, unsigned long nowMs) {
+    for (int i = 0; i < count; i++) {
+        window[next] = samples[i];
+        next = (next + 1) % WINDOW;
+        if (filled < WINDOW) filled++;
+    }
+    variance = windowVariance();
+
+    bool active = variance > varianceLimit;
+    if (rate) {
+        active = active || abs(rate->x) > gyroLimit || abs(rate->y) > gyroLimit || abs(rate->z) > gyroLimit;
+    }
+
+    if (active) {
+        quiet = false;
+        if (!moving) setMoving(true, nowMs);
+        return;
+    }
+    if (!quiet) {
+        quiet = true;
+        quietSince = nowMs;
+    }
+    if (moving && nowMs - quietSince >= restTime) setMoving(false, nowMs);
+}
+
+uint32_t MotionDetector::windowVariance() const {
+    if (filled < 2) return 0;
+    int32_t sum[3] = {0, 0, 0};
+    for (int i = 0; i < filled; i++) {
+        sum[0] += window[i].x;
+        sum[1] += window[i].y;
+        sum[2] += window[i].z;
+    }
+    int32_t mean[3] = {sum[0] / filled, sum[1] / filled, sum[2] / filled};
+
+    // Deviations stay within +-8 g, so a window of squares fits in 32 bits per axis
+    uint32_t total = 0;
+    for (int axis = 0; axis < 3; axis++) {
+        uint32_t squares = 0;
+        for (int i = 0; i < filled; i++) {
+            int32_t value = axis == 0 ? window[i].x : axis == 1 ? window[i].y : window[i].z;
+            int32_t deviation = value - mean[axis];
+            squares += (uint32_t)(deviation * deviation);
+        }
+        total += squares / filled;
+    }
+    return total;
+}
+
+void MotionDetector::setMoving(bool nowMoving, unsigned long nowMs) {
+    unsigned long periodMs = nowMs - stateSince;
+    if (nowMoving) {
+        stats.periods++;
+        stats.restMs += periodMs;
+    } else {
+        stats.movingMs += periodMs;
+    }
+    if (diagnostics) {
+        diagnostics->recordMotion(nowMoving, periodMs);
+    }
+    moving = nowMoving;
+    stateSince = nowMs;
+}
@@ -0,0 +1,72 @@
+#include "OrientationClassifier.h"
+
+OrientationClassifier::OrientationClassifier(int enterMg, int exitMg, uint8_t filterShift)
+    : normals(FaceTable::normals()), enterThreshold(enterMg), exitThreshold(exitMg < enterMg ? exitMg : enterMg), shift(filterShift) {
+    reset();
+}
+
+void OrientationClassifier::reset() {
+    filtered[0] = filtered[1] = filtered[2] = 0;
+    primed = false;
+    current = UNKNOWN;
+    confidence = 0;
+}
+
+void OrientationClassifier::setThresholds(int enterMg, int exitMg) {
+    enterThreshold = enterMg;
+    exitThreshold = exitMg < enterMg ? exitMg : enterMg;
+}
+
+Orientation OrientationClassifier::update(const AccelSample& sample) {
+    int32_t input[3] = {
+        (int32_t)sample.x * (1 << FRACTION_BITS),
+        (int32_t)sample.y * (1 << FRACTION_BITS),
+        (int32_t)sample.z * (1 << FRACTION_BITS)
+    };
+    int32_t axes[3];
+    for (int i = 0; i < 3; i++) {
+        if (primed) {
+            // y += (x - y) / 2^shift; arithmetic shift on the signed difference
+            filtered[i] += (input[i] - filtered[i]) >> shift;
+        } else {
+            filtered[i] = input[i];
+        }
+        axes[i] = filtered[i] >> FRACTION_BITS;
+    }
+    primed = true;
+    decide(axes);
+    return current;
+}
+
+AccelSample OrientationClassifier::getFiltered() const {
+    AccelSample sample;
+    sample.x = (int16_t)(filtered[0] >> FRACTION_BITS);
+    sample.y = (int16_t)(filtered[1] >> FRACTION_BITS);
+    sample.z = (int16_t)(filtered[2] >> FRACTION_BITS);
+    return sample;
+}
+
+void OrientationClassifier::decide(const int32_t axes[3]) {
+    int32_t best, second;
+    int nearest = FaceTable::nearest(normals, FACE_COUNT, axes, best, second);
+    int32_t along = current != UNKNOWN ? FaceTable::project(normals[current], axes) : 0;
+
+    if (current != UNKNOWN && along >= exitThreshold) {
+        // Hysteresis: still within the current face's exit threshold
+    } else if (best >= enterThreshold) {
+        current = (Orientation)nearest;
+        along = best;
+    } else {
+        current = UNKNOWN;
+    }
+
+    if (current == UNKNOWN) {
+        confidence = 0;
+        return;
+    }
+    // Lead over the strongest other face; none while held by hysteresis off the nearest
+    int32_t lead = current == nearest ? best - second : along - best;
+    // lead * 100 / ORIENTATION_FULL_LEAD_MG without a division
+    int32_t scaled = lead > 0 ? (lead * CONFIDENCE_SCALE) >> 8 : 0;
+    confidence = (uint8_t)(scaled > 100 ? 100 : scaled);
+}
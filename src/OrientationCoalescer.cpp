@@ -0,0 +1,42 @@
+#include "OrientationCoalescer.h"
+
+OrientationCoalescer::OrientationCoalescer(unsigned long windowMs)
+    : window(windowMs), committedFace(UNKNOWN), pendingFace(UNKNOWN), pendingSince(0),
+      holding(false), stats({0, 0, 0, 0}) {
+}
+
+void OrientationCoalescer::offer(Orientation face, unsigned long nowMs) {
+    stats.facesOffered++;
+
+    if (!holding) {
+        if (face == committedFace) return;
+        holding = true;
+    } else if (face == committedFace) {
+        // Back on the tracked face before the window ran out: nothing to send
+        holding = false;
+        stats.roundTripsDropped++;
+        return;
+    } else if (face != pendingFace) {
+        stats.facesSkipped++;
+    }
+
+    pendingFace = face;
+    pendingSince = nowMs;
+}
+
+bool OrientationCoalescer::poll(unsigned long nowMs, OrientationChange& change) {
+    if (!holding || nowMs - pendingSince < window) return false;
+
+    change.from = committedFace;
+    change.to = pendingFace;
+    change.atMs = pendingSince;
+    committedFace = pendingFace;
+    holding = false;
+    stats.changesCommitted++;
+    return true;
+}
+
+void OrientationCoalescer::reset(Orientation committed) {
+    committedFace = committed;
+    holding = false;
+}
@@ -0,0 +1,55 @@
+#include "OrientationDebouncer.h"
+
+OrientationDebouncer::OrientationDebouncer(unsigned long dwellMs)
+    : dwell(dwellMs), committedFace(UNKNOWN), candidate(UNKNOWN), candidateSince(0), pending(false),
+      stats({0, 0, 0, {0, 0, 0, 0, 0, 0, 0}}) {
+}
+
+bool OrientationDebouncer::observe(Orientation face, unsigned long nowMs) {
+    if (face == committedFace) {
+        // Fell back before the dwell was up
+        if (pending) {
+            endCandidate(nowMs);
+            stats.rejected++;
+        }
+        return false;
+    }
+
+    if (!pending || face != candidate) {
+        if (pending) {
+            endCandidate(nowMs);
+            stats.rejected++;
+        }
+        pending = true;
+        candidate = face;
+        candidateSince = nowMs;
+        stats.candidates++;
+    }
+    return nowMs - candidateSince >= dwell;
+}
+
+void OrientationDebouncer::commit(Orientation face, unsigned long nowMs) {
+    if (pending && face == candidate) {
+        endCandidate(nowMs);
+        stats.committed++;
+    }
+    pending = false;
+    committedFace = face;
+}
+
+void OrientationDebouncer::interrupt(unsigned long nowMs) {
+    if (pending) {
+        endCandidate(nowMs);
+        stats.rejected++;
+    }
+}
+
+void OrientationDebouncer::reset(Orientation settled) {
+    committedFace = settled;
+    pending = false;
+}
+
+void OrientationDebouncer::endCandidate(unsigned long nowMs) {
+    stats.candidateMs[candidate] += nowMs - candidateSince;
+    pending = false;
+}
@@ -1,79 +1,262 @@
 #include "OrientationDetector.h"
 #include "Configuration.h"
+#include "SystemDiagnostics.h"
+#include <math.h>
 
-#if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_NANO33BLE)
-  #include <Arduino_LSM6DSOX.h>
-#elif defined(ARDUINO_ARCH_ESP32)
-  #include <LSM6DS3.h>
-#else
-  #include <Arduino_LSM6DSOX.h>
-#endif
-
-OrientationDetector::OrientationDetector(float orientationThreshold, unsigned long debounceMs) 
-    : currentOrientation(UNKNOWN), lastOrientationChange(0), 
-      threshold(orientationThreshold), debounceTime(debounceMs) {
+OrientationDetector::OrientationDetector(ImuBackend& imuBackend, float orientationThreshold, unsigned long debounceMs) 
+    : imu(imuBackend), currentOrientation(UNKNOWN), threshold(orientationThreshold),
+      batching(false), watermark(1), batchInterval(0), lastBatchTime(0), batchSize(0),
+      batchStats({0, 0, 0, 0}), debouncer(debounceMs), eventDriven(false), resumed(false),
+      adaptiveRate(false), stillRate(0), stillInterval(0), tapsEnabled(false), diagnostics(nullptr) {
 }
 
 bool OrientationDetector::begin() {
-    if (!IMU.begin()) {
+    if (!imu.begin()) {
         Serial.println("Failed to initialize IMU!");
         return false;
     }
     Serial.println("IMU initialized successfully");
+    if (Config::IMU_FIFO_ENABLED && !enableBatching(Config::IMU_FIFO_WATERMARK, Config::IMU_FIFO_RATE_HZ)) {
+        Serial.println("IMU FIFO unavailable - polling samples one by one");
+    }
+    if (Config::IMU_EVENTS_ENABLED && !enableEvents(Config::IMU_WAKE_THRESHOLD_MG)) {
+        Serial.println("IMU interrupts unavailable - sampling continuously");
+    }
+    // Before the rate is set up: taps hold the accelerometer at their own rate
+    if (Config::IMU_TAPS_ENABLED && !enableTaps(Config::IMU_TAP_THRESHOLD_MG)) {
+        Serial.println("IMU taps unavailable - no tap to pause");
+    }
+    if (Config::IMU_ADAPTIVE_RATE && !enableAdaptiveRate(Config::IMU_STILL_RATE_HZ)) {
+        Serial.println("IMU low-power mode unavailable - full rate while still");
+    }
     return true;
 }
 
+bool OrientationDetector::enableBatching(uint16_t fifoWatermark, uint16_t rateHz) {
+    if (fifoWatermark == 0 || fifoWatermark > Config::IMU_MAX_BATCH || rateHz == 0) return false;
+    batching = imu.enableFifo(fifoWatermark, rateHz);
+    if (batching) {
+        watermark = fifoWatermark;
+        // No point asking the sensor before the watermark can have been reached
+        batchInterval = (unsigned long)fifoWatermark * 1000UL / rateHz;
+        lastBatchTime = millis();
+    }
+    return batching;
+}
+
+bool OrientationDetector::enableEvents(uint16_t wakeThresholdMg) {
+    eventDriven = imu.enableEvents(wakeThresholdMg);
+    if (eventDriven) {
+        // Sample until the first face has been classified
+        wakeGate.start(millis());
+    }
+    return eventDriven;
+}
+
+bool OrientationDetector::enableTaps(uint16_t thresholdMg) {
+    tapsEnabled = eventDriven && thresholdMg > 0 && imu.enableTaps(thresholdMg);
+    taps.clear();
+    if (diagnostics) diagnostics->setImuStillCurrent(ImuRateGovernor::stillCurrentUa(tapsEnabled));
+    return tapsEnabled;
+}
+
+bool OrientationDetector::enableAdaptiveRate(uint16_t stillRateHz) {
+    if (stillRateHz == 0) return false;
+    // Also puts the sensor in the known full-rate state
+    adaptiveRate = imu.setLowPower(false, stillRateHz);
+    if (adaptiveRate) {
+        stillRate = stillRateHz;
+        // One batch per interval as at full rate, or one sample a second when polling
+        stillInterval = batching ? (unsigned long)watermark * 1000UL / stillRateHz : Config::IMU_IDLE_LOOP_DELAY;
+        rateGovernor.start(millis());
+    }
+    return adaptiveRate;
+}
+
+void OrientationDetector::setDiagnostics(SystemDiagnostics* systemDiagnostics) {
+    diagnostics = systemDiagnostics;
+    motion.setDiagnostics(systemDiagnostics);
+    rateGovernor.setDiagnostics(systemDiagnostics);
+    if (diagnostics) diagnostics->setImuStillCurrent(ImuRateGovernor::stillCurrentUa(tapsEnabled));
+}
+
+void OrientationDetector::setCalibration(const ImuCalibrationData* data) {
+    if (data && data->valid) {
+        calibration.set(*data);
+        classifier.setThresholds(Config::ORIENTATION_CALIBRATED_ENTER_MG, Config::ORIENTATION_CALIBRATED_EXIT_MG);
+    } else {
+        calibration.clear();
+        classifier.setThresholds(Config::ORIENTATION_ENTER_MG, Config::ORIENTATION_EXIT_MG);
+    }
+}
+
+void OrientationDetector::waitForEvent(unsigned long maxMs) {
+    if (isStill()) {
+        // Wake for the next reading, but not more often than the loop would run anyway
+        unsigned long elapsed = millis() - lastBatchTime;
+        unsigned long due = elapsed < stillInterval ? stillInterval - elapsed : 0;
+        if (due < Config::MAIN_LOOP_DELAY) due = Config::MAIN_LOOP_DELAY;
+        if (due < maxMs) maxMs = due;
+    }
+    unsigned long start = millis();
+    while (millis() - start < maxMs && !imu.eventPending()) {
+#if defined(ARDUINO_ARCH_SAMD)
+        __WFI();    // SysTick wakes the core every millisecond
+#else
+        delay(1);   // The mbed idle thread sleeps the core
+#endif
+    }
+}
+
 bool OrientationDetector::readAcceleration(float& accelX, float& accelY, float& accelZ) {
-    if (IMU.accelerationAvailable()) {
-        IMU.readAcceleration(accelX, accelY, accelZ);
+    if (eventDriven) {
+        if (imu.eventPending()) {
+            uint8_t events = imu.takeEvents();
+            if (events & (IMU_EVENT_SINGLE_TAP | IMU_EVENT_DOUBLE_TAP)) queueTaps(events);
+            // A tap alone says nothing about the face; its knock shows as motion if it moved the cube
+            events &= IMU_EVENT_ORIENTATION | IMU_EVENT_MOTION;
+            if (wakeGate.onEvents(events, millis())) resumed = true;
+            // The sensor noticed first: back to full rate before the next reading
+            if (events && adaptiveRate && rateGovernor.onActivity(millis())) {
+                imu.setLowPower(false, stillRate);
+            }
+        }
+        // Keep sampling until a movement has come to rest
+        if (!wakeGate.isAwake(millis()) && !motion.isMoving()) {
+            if (adaptiveRate && rateGovernor.onQuiet(millis())) imu.setLowPower(true, stillRate);
+            return false;
+        }
+    }
+
+    if (!batching) {
+        if (isStill() && millis() - lastBatchTime < stillInterval) return false;
+        if (imu.available() <= 0 || imu.readSamples(batch, 1) != 1) return false;
+        calibration.apply(batch, 1);
+        lastBatchTime = millis();
+        batchSize = 1;
+        batchStats.samples++;
+        classifier.update(batch[0]);
+        updateMotion();
+        updateRate();
+        accelX = batch[0].x * 0.001f;
+        accelY = batch[0].y * 0.001f;
+        accelZ = batch[0].z * 0.001f;
         return true;
     }
-    return false;
+
+    if (millis() - lastBatchTime < (isStill() ? stillInterval : batchInterval)) return false;
+    int level = imu.available();
+    if (level < watermark) {
+        batchStats.earlyChecks++;
+        return false;
+    }
+    // Anything beyond one batch (after a long blocking call) is read next time
+    int count = imu.readSamples(batch, level < Config::IMU_MAX_BATCH ? level : Config::IMU_MAX_BATCH);
+    // Samples are expected to be overwritten while nothing reads them
+    if (imu.takeOverrun() && !resumed) {
+        batchStats.overruns++;
+    }
+    resumed = false;
+    lastBatchTime = millis();
+    if (count <= 0) return false;
+    calibration.apply(batch, count);
+
+    batchSize = count;
+    batchStats.batches++;
+    batchStats.samples += count;
+    for (int i = 0; i < count; i++) {
+        classifier.update(batch[i]);
+    }
+    updateMotion();
+    updateRate();
+    AccelSample mean = blockMean(batch, count);
+    accelX = mean.x * 0.001f;
+    accelY = mean.y * 0.001f;
+    accelZ = mean.z * 0.001f;
+    return true;
 }
 
 Orientation OrientationDetector::detectOrientation(float accelX, float accelY, float accelZ) {
     return determineOrientation(accelX, accelY, accelZ);
 }
 
-Orientation OrientationDetector::determineOrientation(float x, float y, float z) const {
-    //TODO: Add checks for other axis to make detection more solid:  && abs(x) < threshold && abs(y) < threshold
-    // Z-axis: Face up/down
-    if (z > threshold) {
-        return FACE_UP;
-    } else if (z < -threshold) {
-        return FACE_DOWN;
-    }
+Orientation OrientationDetector::classifyBlock(const AccelSample* samples, int count) const {
+    if (count <= 0) return UNKNOWN;
+    AccelSample mean = blockMean(samples, count);
+    return determineOrientation(mean.x * 0.001f, mean.y * 0.001f, mean.z * 0.001f);
+}
 
-    // X-axis: Left/right side
-    if (x > threshold) {
-        return RIGHT_SIDE;
-    } else if (x < -threshold) {
-        return LEFT_SIDE;
+AccelSample OrientationDetector::blockMean(const AccelSample* samples, int count) {
+    int32_t x = 0, y = 0, z = 0;
+    for (int i = 0; i < count; i++) {
+        x += samples[i].x;
+        y += samples[i].y;
+        z += samples[i].z;
     }
+    AccelSample mean;
+    mean.x = (int16_t)(x / count);
+    mean.y = (int16_t)(y / count);
+    mean.z = (int16_t)(z / count);
+    return mean;
+}
+
+Orientation OrientationDetector::determineOrientation(float x, float y, float z) const {
+    // Nearest face normal, taken if the reading is at least threshold g along it
+    int32_t v[3] = {(int32_t)lroundf(x * 1000.0f), (int32_t)lroundf(y * 1000.0f), (int32_t)lroundf(z * 1000.0f)};
+    int32_t best, second;
+    int face = FaceTable::nearest(FaceTable::normals(), FACE_COUNT, v, best, second);
+    return best > (int32_t)(threshold * 1000.0f) ? (Orientation)face : UNKNOWN;
+}
 
-    // Y-axis: Front/back edge
-    if (y > threshold) {
-        return FRONT_EDGE;
-    } else if (y < -threshold) {
-        return BACK_EDGE;
+void OrientationDetector::updateMotion() {
+    // One angular rate reading per batch, current when the batch was drained;
+    // the gyroscope is off while still
+    GyroSample rate;
+    bool haveRate = !isStill() && imu.readGyro(rate);
+    motion.update(batch, batchSize, haveRate ? &rate : nullptr, millis());
+}
+
+void OrientationDetector::updateRate() {
+    if (!adaptiveRate) return;
+    // A turn shows as movement or as a face that differs from the settled one
+    bool settling = motion.isMoving() || debouncer.hasCandidate() ||
+                    classifier.getOrientation() != currentOrientation;
+    bool changed = settling ? rateGovernor.onActivity(millis()) : rateGovernor.onQuiet(millis());
+    if (changed) {
+        imu.setLowPower(rateGovernor.isStill(), stillRate);
     }
+}
 
-    return UNKNOWN;
+void OrientationDetector::queueTaps(uint8_t events) {
+    // Picking the cube up or setting it down knocks like a tap; those come while it moves
+    bool accepted = tapsEnabled && !motion.isMoving();
+    // One read can carry both kinds
+    const uint8_t bits[] = {IMU_EVENT_SINGLE_TAP, IMU_EVENT_DOUBLE_TAP};
+    for (int i = 0; i < 2; i++) {
+        if (!(events & bits[i])) continue;
+        TapEvent tap = {bits[i] == IMU_EVENT_DOUBLE_TAP ? TAP_DOUBLE : TAP_SINGLE, millis()};
+        if (accepted) taps.push(tap);
+        if (diagnostics) diagnostics->recordTap(tap.gesture == TAP_DOUBLE, accepted);
+    }
 }
 
 bool OrientationDetector::hasOrientationChanged(Orientation newOrientation) {
-    return (newOrientation != currentOrientation && 
-            millis() - lastOrientationChange > debounceTime);
+    if (motion.isMoving()) {
+        if (newOrientation != currentOrientation) motion.recordHeld();
+        debouncer.interrupt(millis());
+        return false;
+    }
+    return debouncer.observe(newOrientation, millis());
 }
 
 void OrientationDetector::updateOrientation(Orientation newOrientation) {
     currentOrientation = newOrientation;
-    lastOrientationChange = millis();
+    debouncer.commit(newOrientation, millis());
 }
 
-String OrientationDetector::getOrientationName(Orientation orientation) const {
-    if (orientation >= FACE_UP && orientation <= BACK_EDGE) {
-        return String(projectNames[orientation]);
+String OrientationDetector::getOrientationName(Orientation orientation) {
+    if (orientation >= FACE_UP && orientation < UNKNOWN) {
+        return projectNames[orientation] ? String(projectNames[orientation]) : "Face " + String((int)orientation + 1);
     }
     return "Unknown";
 }
@@ -0,0 +1,172 @@
+#include "RequestScheduler.h"
+
+RequestScheduler::RequestScheduler()
+    : consecutiveFailures(0), serviceFailures(0), holding(false), holdUntil(0),
+      circuit(CircuitState::CLOSED), openUntil(0), jitterState(0x9E3779B9UL), diagnostics(nullptr),
+      stats({0, 0, 0, 0, 0, 0}) {
+    configure(Config::TOGGL_RATE_REFILL_MS, Config::TOGGL_RATE_BURST, Config::TOGGL_RETRY_MIN_MS,
+              Config::TOGGL_RETRY_MAX_MS, Config::TOGGL_BREAKER_THRESHOLD, Config::TOGGL_BREAKER_OPEN_MS);
+}
+
+void RequestScheduler::configure(unsigned long refillMs, int burst, unsigned long retryMinMs,
+                                 unsigned long retryMaxMs, int threshold, unsigned long breakerOpenMs) {
+    refillInterval = refillMs;
+    bucketCapacity = burst > 0 ? burst : 1;
+    retryMin = retryMinMs;
+    retryMax = retryMaxMs > retryMinMs ? retryMaxMs : retryMinMs;
+    breakerThreshold = threshold > 0 ? threshold : 1;
+    breakerOpenTime = breakerOpenMs;
+    for (int i = 0; i < ENDPOINT_COUNT; i++) {
+        buckets[i].tokens = bucketCapacity;
+        buckets[i].lastRefill = 0;
+    }
+}
+
+bool RequestScheduler::tryAcquire(TogglEndpoint endpoint, unsigned long nowMs) {
+    if (circuit == CircuitState::HALF_OPEN ||
+        (circuit == CircuitState::OPEN && (long)(nowMs - openUntil) < 0)) {
+        stats.deferredByBreaker++;
+        return false;
+    }
+    if (holding && (long)(nowMs - holdUntil) < 0) {
+        stats.deferredByBackoff++;
+        return false;
+    }
+
+    TokenBucket& bucket = buckets[(int)endpoint];
+    refill(bucket, nowMs);
+    if (bucket.tokens == 0) {
+        stats.deferredByRateLimit++;
+        return false;
+    }
+    bucket.tokens--;
+
+    if (circuit == CircuitState::OPEN) {
+        // Open period is over: this request is the probe
+        setCircuit(CircuitState::HALF_OPEN, nowMs);
+    }
+    stats.requestsAllowed++;
+    return true;
+}
+
+void RequestScheduler::release(TogglEndpoint endpoint) {
+    TokenBucket& bucket = buckets[(int)endpoint];
+    if (bucket.tokens < bucketCapacity) bucket.tokens++;
+    if (circuit == CircuitState::HALF_OPEN) {
+        // The probe never went out; the next request probes instead
+        circuit = CircuitState::OPEN;
+    }
+}
+
+bool RequestScheduler::isReady(unsigned long nowMs) const {
+    if (circuit == CircuitState::HALF_OPEN) return false;
+    if (circuit == CircuitState::OPEN && (long)(nowMs - openUntil) < 0) return false;
+    return !holding || (long)(nowMs - holdUntil) >= 0;
+}
+
+void RequestScheduler::recordResult(TogglEndpoint endpoint, int statusCode, uint32_t retryAfterSeconds,
+                                    unsigned long nowMs) {
+    bool success = statusCode >= 200 && statusCode < 300;
+    if (diagnostics) {
+        diagnostics->recordTimerOperation(success, endpointName(endpoint));
+    }
+
+    if (isRetryable(statusCode)) {
+        consecutiveFailures++;
+        unsigned long delay = backoffDelay();
+        if (retryAfterSeconds > 0) {
+            stats.retryAfterHonoured++;
+            unsigned long requested = retryAfterSeconds * 1000UL;
+            if (requested > delay) delay = requested;
+        }
+        holding = true;
+        holdUntil = nowMs + delay;
+    } else {
+        consecutiveFailures = 0;
+        holding = false;
+    }
+
+    if (isServiceFailure(statusCode)) {
+        serviceFailures++;
+        if (circuit == CircuitState::HALF_OPEN ||
+            (circuit == CircuitState::CLOSED && serviceFailures >= breakerThreshold)) {
+            stats.breakerTrips++;
+            openUntil = nowMs + breakerOpenTime;
+            setCircuit(CircuitState::OPEN, nowMs);
+        }
+    } else {
+        // The service answered, even if it rejected the request
+        serviceFailures = 0;
+        if (circuit != CircuitState::CLOSED) {
+            setCircuit(CircuitState::CLOSED, nowMs);
+        }
+    }
+}
+
+bool RequestScheduler::isRetryable(int statusCode) {
+    return statusCode <= 0 || statusCode == 401 || statusCode == 403 || isServiceFailure(statusCode);
+}
+
+bool RequestScheduler::isServiceFailure(int statusCode) {
+    return statusCode <= 0 || statusCode == 408 || statusCode == 429 || statusCode >= 500;
+}
+
+void RequestScheduler::refill(TokenBucket& bucket, unsigned long nowMs) {
+    if (bucket.tokens >= bucketCapacity || refillInterval == 0) {
+        bucket.tokens = bucketCapacity;
+        bucket.lastRefill = nowMs;
+        return;
+    }
+    unsigned long added = (nowMs - bucket.lastRefill) / refillInterval;
+    if (added == 0) return;
+    if (added >= (unsigned long)(bucketCapacity - bucket.tokens)) {
+        bucket.tokens = bucketCapacity;
+        bucket.lastRefill = nowMs;
+    } else {
+        bucket.tokens += (int)added;
+        bucket.lastRefill += added * refillInterval;
+    }
+}
+
+unsigned long RequestScheduler::backoffDelay() {
+    // Equal jitter: a random point in the upper half of the exponential step,
+    // so cubes that failed together do not retry together
+    unsigned long step = retryMin;
+    for (int i = 1; i < consecutiveFailures && step < retryMax; i++) {
+        step *= 2;
+    }
+    if (step > retryMax) step = retryMax;
+    unsigned long half = step / 2;
+    return half + nextRandom() % (step - half + 1);
+}
+
+uint32_t RequestScheduler::nextRandom() {
+    // xorshift32; seeded per device with setJitterSeed()
+    jitterState ^= jitterState << 13;
+    jitterState ^= jitterState >> 17;
+    jitterState ^= jitterState << 5;
+    return jitterState;
+}
+
+void RequestScheduler::setCircuit(CircuitState state, unsigned long nowMs) {
+    circuit = state;
+    if (state == CircuitState::OPEN) {
+        Serial.print("[TOGGL] Circuit breaker open, pausing requests for ");
+        Serial.print(openUntil - nowMs);
+        Serial.println(" ms");
+    } else if (state == CircuitState::CLOSED) {
+        Serial.println("[TOGGL] Circuit breaker closed, Toggl reachable again");
+    }
+    if (diagnostics) {
+        diagnostics->recordCircuitState(state != CircuitState::CLOSED);
+    }
+}
+
+const char* RequestScheduler::endpointName(TogglEndpoint endpoint) {
+    switch (endpoint) {
+        case TogglEndpoint::CREATE_ENTRY: return "create_entry";
+        case TogglEndpoint::UPDATE_ENTRY: return "update_entry";
+        case TogglEndpoint::READ_ENTRY: return "read_entry";
+    }
+    return "unknown";
+}
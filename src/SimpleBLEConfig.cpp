@@ -1,5 +1,6 @@
 #include <Arduino.h>
 #include <ArduinoBLE.h>
+#include "Orientation.h"
 
 // Base64 decoding lookup table
 static const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -39,15 +40,17 @@ BLECharacteristic* projectIdsChar = nullptr;
 BLEStringCharacteristic* statusChar = nullptr;
 BLEStringCharacteristic* authChallengeChar = nullptr;
 BLECharacteristic* authResponseChar = nullptr;
+BLECharacteristic* calibrationChar = nullptr;
 
 // Configuration data storage
 String receivedSSID = "";
 String receivedPassword = "";
 String receivedToken = "";
 String receivedWorkspace = "";
-int receivedProjectIds[6] = {0, 0, 0, 0, 0, 0};
+int receivedProjectIds[FACE_COUNT] = {0};
 bool configComplete = false;
 bool projectIdsReceived = false;
+int pendingCalibrationCommand = -1;   // CalibrationCommand written by the app, -1 when none
 
 // BLE initialization state
 bool bleInitialized = false;
@@ -167,6 +170,10 @@ void generateAuthResponse(const uint8_t* challenge, uint8_t* response) {
 #define STATUS_CHAR_UUID        "6ba7b816-9dad-11d1-80b4-00c04fd430c8"
 #define AUTH_CHALLENGE_CHAR_UUID "6ba7b817-9dad-11d1-80b4-00c04fd430c8"
 #define AUTH_RESPONSE_CHAR_UUID  "6ba7b818-9dad-11d1-80b4-00c04fd430c8"
+#define CALIBRATION_CHAR_UUID    "6ba7b819-9dad-11d1-80b4-00c04fd430c8"
+
+// One little-endian int32 per face
+static const int PROJECT_IDS_LENGTH = FACE_COUNT * 4;
 
 // Callback functions
 void onWifiSSIDWritten(BLEDevice central, BLECharacteristic characteristic) {
@@ -330,16 +337,16 @@ void onProjectIdsWritten(BLEDevice central, BLECharacteristic characteristic) {
     Serial.print(dataLength);
     Serial.println(" bytes");
     
-    if (dataLength == 24) { // 6 integers * 4 bytes each
+    if (dataLength == PROJECT_IDS_LENGTH) {
         // Convert byte array to integers (little endian)
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             receivedProjectIds[i] = (data[i*4]) | 
                                    (data[i*4 + 1] << 8) | 
                                    (data[i*4 + 2] << 16) | 
                                    (data[i*4 + 3] << 24);
         }
         Serial.println("Project IDs parsed successfully:");
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             Serial.print("  Orientation[" + String(i) + "]: ");
             Serial.println(receivedProjectIds[i]);
         }
@@ -359,11 +366,25 @@ void onProjectIdsWritten(BLEDevice central, BLECharacteristic characteristic) {
         
         checkConfigComplete();
     } else {
-        Serial.print("Invalid project IDs data length - expected 24 bytes, got ");
+        Serial.print("Invalid project IDs data length - expected ");
+        Serial.print(PROJECT_IDS_LENGTH);
+        Serial.print(" bytes, got ");
         Serial.println(dataLength);
     }
 }
 
+void onCalibrationWritten(BLEDevice central, BLECharacteristic characteristic) {
+    if (characteristic.valueLength() != 1) {
+        Serial.print("Invalid calibration command length - expected 1 byte, got ");
+        Serial.println(characteristic.valueLength());
+        return;
+    }
+    // Capturing reads the IMU, which happens in the main loop rather than in this callback
+    pendingCalibrationCommand = characteristic.value()[0];
+    Serial.print("Calibration command received: ");
+    Serial.println(pendingCalibrationCommand);
+}
+
 void onAuthChallengeWritten(BLEDevice central, BLECharacteristic characteristic) {
     Serial.println("=== AUTHENTICATION CHALLENGE CALLBACK TRIGGERED ===");
     Serial.print("Timestamp: ");
@@ -543,10 +564,11 @@ bool simpleBLEBegin() {
     wifiPasswordChar = new BLEStringCharacteristic(WIFI_PASSWORD_CHAR_UUID, BLERead | BLEWrite, 128); // Increased for base64
     togglTokenChar = new BLEStringCharacteristic(TOGGL_TOKEN_CHAR_UUID, BLERead | BLEWrite, 512); // Increased for base64
     workspaceIdChar = new BLEStringCharacteristic(WORKSPACE_ID_CHAR_UUID, BLERead | BLEWrite, 32); // Increased for base64
-    projectIdsChar = new BLECharacteristic(PROJECT_IDS_CHAR_UUID, BLERead | BLEWrite, 24); // 6 integers * 4 bytes
+    projectIdsChar = new BLECharacteristic(PROJECT_IDS_CHAR_UUID, BLERead | BLEWrite, PROJECT_IDS_LENGTH);
     statusChar = new BLEStringCharacteristic(STATUS_CHAR_UUID, BLERead | BLENotify, 32);
     authChallengeChar = new BLEStringCharacteristic(AUTH_CHALLENGE_CHAR_UUID, BLERead | BLEWrite | BLEWriteWithoutResponse, 32); // base64 challenge string
     authResponseChar = new BLECharacteristic(AUTH_RESPONSE_CHAR_UUID, BLERead | BLENotify, 16); // raw binary response
+    calibrationChar = new BLECharacteristic(CALIBRATION_CHAR_UUID, BLERead | BLEWrite, 1); // CalibrationCommand; progress on status
     
     Serial.println("Authentication characteristics created:");
     Serial.println("  Challenge UUID: " AUTH_CHALLENGE_CHAR_UUID);
@@ -573,6 +595,7 @@ bool simpleBLEBegin() {
     
     // Set authentication handler
     authChallengeChar->setEventHandler(BLEWritten, onAuthChallengeWritten);
+    calibrationChar->setEventHandler(BLEWritten, onCalibrationWritten);
     
     // Add characteristics to service
     configService->addCharacteristic(*wifiSSIDChar);
@@ -583,6 +606,7 @@ bool simpleBLEBegin() {
     configService->addCharacteristic(*statusChar);
     configService->addCharacteristic(*authChallengeChar);
     configService->addCharacteristic(*authResponseChar);
+    configService->addCharacteristic(*calibrationChar);
     
     // Add service to BLE
     BLE.addService(*configService);
@@ -694,6 +718,13 @@ extern "C" void updateBLEStatus(const char* status) {
     }
 }
 
+// Calibration command written since the last call, or -1
+int takeCalibrationCommand() {
+    int command = pendingCalibrationCommand;
+    pendingCalibrationCommand = -1;
+    return command;
+}
+
 // Make test function externally callable
 void testAuthCallbackSetup() {
     Serial.println("=== TESTING AUTH CALLBACK SETUP ===");
@@ -3,15 +3,6 @@
 #include "Config.h"
 #include <ArduinoBLE.h>
 
-// Platform-specific includes
-#if defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_NANO33BLE)
-  #include <Arduino_LSM6DSOX.h>
-#elif defined(ARDUINO_ARCH_ESP32)
-  #include <LSM6DS3.h>
-#else
-  #include <Arduino_LSM6DSOX.h>
-#endif
-
 // External BLE functions
 extern void simpleBLEPoll();
 
@@ -38,10 +29,11 @@ bool StateManager::handleBLEMode() {
         }
     }
     
-    // Show BLE setup mode with status LED (only if not configured)
-    if (!configApplied) {
+    // Show BLE setup mode with status LED (only if not configured), once any error flash is over
+    if (!configApplied && !ledController.isAnimating()) {
         updateBLEStatusLED();
     }
+    ledController.updateBLEAnimation();
     
     // Continue in BLE mode
     delay(Config::MAIN_LOOP_DELAY);
@@ -65,14 +57,12 @@ void StateManager::handleNormalOperation() {
     // Read IMU data and handle orientation changes
     float accelX, accelY, accelZ;
     if (Serial) Serial.println("[DEBUG] Checking IMU availability");
-    if (IMU.accelerationAvailable()) {
-        if (Serial) Serial.println("[DEBUG] Reading IMU data");
-        IMU.readAcceleration(accelX, accelY, accelZ);
+    if (orientationDetector.readAcceleration(accelX, accelY, accelZ)) {
         if (Serial) Serial.println("[DEBUG] IMU data read complete");
         
         // Determine current orientation
         if (Serial) Serial.println("[DEBUG] Detecting orientation");
-        Orientation newOrientation = orientationDetector.detectOrientation(accelX, accelY, accelZ);
+        Orientation newOrientation = orientationDetector.getClassifiedOrientation();
         if (Serial) Serial.println("[DEBUG] Orientation detection complete");
         
         // Check if orientation changed and handle debouncing
@@ -88,29 +78,44 @@ void StateManager::handleNormalOperation() {
         if (Serial) Serial.println("[DEBUG] IMU not available");
     }
     
-    // Small delay for stability
+    // Rapid flips are held until the cube settles; only the final face reaches Toggl.
+    // Nothing is sent while it is being carried or turned
+    OrientationChange change;
+    if (!orientationDetector.isMoving() && orientationCoalescer.poll(millis(), change)) {
+        timerPause.onFaceCommitted();
+        commitOrientationChange(change);
+    }
+    
+    // Double tap pauses or resumes the resting face's timer; the sensor detected the taps
+    TapEvent tap;
+    while (orientationDetector.takeTap(tap)) {
+        handleTap(tap);
+    }
+    
+    // Replay journaled events and advance in-flight Toggl requests without blocking IMU sampling
+    if (journalReplayer) {
+        journalReplayer->poll(networkManager.isConnected(), millis());
+    }
+    togglAPI.poll();
+    
+    // Blink codes and error flashes run from here; nothing in the LED path blocks
+    ledController.updateBLEAnimation();
+    
+    // Sleep while nothing is moving or pending; the IMU interrupt ends the wait
     if (Serial) Serial.println("[DEBUG] Main loop delay");
-    delay(Config::MAIN_LOOP_DELAY);
+    bool replaying = journalReplayer && !journalReplayer->isIdle();
+    if (orientationDetector.isIdle() && !orientationCoalescer.isHolding() && !replaying &&
+        !togglAPI.isBusy() && !ledController.isAnimating()) {
+        orientationDetector.waitForEvent(Config::IMU_IDLE_LOOP_DELAY);
+    } else {
+        delay(Config::MAIN_LOOP_DELAY);
+    }
     if (Serial) Serial.println("[DEBUG] handleNormalOperation() end");
 }
 
 void StateManager::handleOrientationChange(Orientation newOrientation, float accelX, float accelY, float accelZ) {
     if (Serial) Serial.println("[DEBUG] handleOrientationChange() start");
     
-    // Stop current timer if running
-    if (Serial) Serial.println("[DEBUG] Checking for current timer");
-    if (!togglAPI.getCurrentEntryId().isEmpty()) {
-        if (Serial) Serial.println("[DEBUG] Stopping current timer with timeout protection");
-        bool success = togglAPI.stopCurrentTimeEntry();
-        if (success) {
-            if (Serial) Serial.println("[DEBUG] Timer stopped successfully");
-        } else {
-            if (Serial) Serial.println("[DEBUG] Timer stop failed - continuing anyway");
-        }
-    } else {
-        if (Serial) Serial.println("[DEBUG] No current timer to stop");
-    }
-    
     // Update orientation
     if (Serial) Serial.println("[DEBUG] Updating orientation");
     orientationDetector.updateOrientation(newOrientation);
@@ -126,18 +131,83 @@ void StateManager::handleOrientationChange(Orientation newOrientation, float acc
     orientationDetector.printOrientation(newOrientation, accelX, accelY, accelZ);
     if (Serial) Serial.println("[DEBUG] Orientation info printed");
     
+    // Timer change is held until the coalescing window passes
+    orientationCoalescer.offer(newOrientation, millis());
+    
+    if (Serial) Serial.println("[DEBUG] handleOrientationChange() end");
+}
+
+void StateManager::handleTap(const TapEvent& tap) {
+    Orientation face = orientationDetector.getCurrentOrientation();
+    bool busy = orientationCoalescer.isHolding() || orientationDetector.isMoving();
+    TimerPauseAction action = timerPause.onTap(tap, face, busy);
+    if (action == TIMER_PAUSE_NONE) {
+        if (Serial) Serial.println("[DEBUG] Tap ignored");
+        return;
+    }
+    
+    // A pause stops the timer as FACE_UP would; resuming starts the same face again
+    if (Serial) Serial.println(action == TIMER_PAUSE_STOP ? "[DEBUG] Double tap - pausing timer" : "[DEBUG] Double tap - resuming timer");
+    OrientationChange change = {face, action == TIMER_PAUSE_STOP ? FACE_UP : face, tap.atMs};
+    commitOrientationChange(change);
+    ledController.updateColorForOrientation(face, action == TIMER_PAUSE_STOP ? Config::LED_PAUSED_INTENSITY
+                                                                             : Config::LED_MAX_INTENSITY);
+}
+
+void StateManager::commitOrientationChange(const OrientationChange& change) {
+    if (Serial) Serial.println("[DEBUG] commitOrientationChange() start");
+    Orientation newOrientation = change.to;
+    
+    // Stop current timer if running
+    if (Serial) Serial.println("[DEBUG] Checking for current timer");
+    bool journaling = eventJournal && eventJournal->isReady();
+    // Back-dated to when the cube reached the final face
+    uint32_t epoch = togglAPI.epochAtMillis(change.atMs);
+    bool tracked = newOrientation != UNKNOWN && newOrientation != FACE_UP;
+    bool timerRunning = togglAPI.hasCurrentEntry() || togglAPI.isBusy();
+    // Without the journal, a face change is sent as one switch request
+    bool switching = !journaling && tracked && timerRunning && togglAPI.canSwitch();
+    if (journaling) {
+        if (eventJournal->isSegmentOpen()) {
+            // Written to flash before any request, so an outage cannot lose it
+            bool success = eventJournal->recordStop(epoch, change.atMs);
+            if (Serial) Serial.println(success ? "[DEBUG] Timer stop journaled" : "[DEBUG] Timer stop could not be journaled");
+        } else {
+            if (Serial) Serial.println("[DEBUG] No current timer to stop");
+        }
+    } else if (switching) {
+        if (Serial) Serial.println("[DEBUG] Current timer will be stopped by the switch request");
+    } else if (timerRunning) {
+        if (Serial) Serial.println("[DEBUG] Queueing stop of current timer");
+        bool success = togglAPI.requestStop(epoch);
+        if (success) {
+            if (Serial) Serial.println("[DEBUG] Timer stop queued");
+        } else {
+            if (Serial) Serial.println("[DEBUG] Timer stop could not be queued - continuing anyway");
+        }
+    } else {
+        if (Serial) Serial.println("[DEBUG] No current timer to stop");
+    }
+    
     // Start new timer if orientation is known and not timer stopped
     if (Serial) Serial.println("[DEBUG] Checking if should start timer");
-    if (newOrientation != UNKNOWN && newOrientation != FACE_UP) {
+    if (tracked) {
         String description = orientationDetector.getOrientationName(newOrientation);
         
-        if (Serial) Serial.println("[DEBUG] Starting timer with timeout protection for: " + description);
-        bool success = togglAPI.startTimeEntry(newOrientation, description);
-        
-        if (success) {
-            if (Serial) Serial.println("[DEBUG] Timer started successfully");
+        if (journaling) {
+            bool success = eventJournal->recordStart(newOrientation, epoch, change.atMs);
+            if (Serial) Serial.println(success ? "[DEBUG] Timer start journaled" : "[DEBUG] Timer start could not be journaled");
         } else {
-            if (Serial) Serial.println("[DEBUG] Timer start failed - continuing anyway");
+            if (Serial) Serial.println("[DEBUG] Queueing timer start for: " + description);
+            bool success = switching
+                ? togglAPI.requestSwitch(newOrientation, description, epoch)
+                : togglAPI.requestStart(newOrientation, description, epoch);
+            
+            if (success) {
+                if (Serial) Serial.println("[DEBUG] Timer start queued");
+            } else {
+                if (Serial) Serial.println("[DEBUG] Timer start could not be queued - continuing anyway");
+            }
         }
         
     } else if (newOrientation == FACE_UP) {
@@ -147,7 +217,7 @@ void StateManager::handleOrientationChange(Orientation newOrientation, float acc
         if (Serial) Serial.println("[DEBUG] Unknown orientation - no timer action");
     }
     
-    if (Serial) Serial.println("[DEBUG] handleOrientationChange() end");
+    if (Serial) Serial.println("[DEBUG] commitOrientationChange() end");
 }
 
 void StateManager::updateBLEStatusLED() {
@@ -1,4 +1,5 @@
 #include "SystemDiagnostics.h"
+#include "ImuRateGovernor.h"
 
 SystemDiagnostics::SystemDiagnostics() {
     // Initialize performance metrics
@@ -20,6 +21,42 @@ SystemDiagnostics::SystemDiagnostics() {
     apiSuccessCount = 0;
     apiTotalCount = 0;
     lastAPIFailureTime = 0;
+    togglCircuitOpen = false;
+    
+    requestsSent = 0;
+    requestWriteCalls = 0;
+    requestFlushBytes = 0;
+    lastRequestWrites = 0;
+    
+    moving = false;
+    motionPeriods = 0;
+    motionTimeMs = 0;
+    restTimeMs = 0;
+    
+    imuStill = false;
+    imuActiveTimeMs = 0;
+    imuStillTimeMs = 0;
+    imuStillCurrentUa = Config::IMU_STILL_CURRENT_UA;
+    
+    singleTaps = 0;
+    doubleTaps = 0;
+    tapsIgnored = 0;
+    timerPaused = false;
+    timerPauses = 0;
+    
+    ledWrites = 0;
+    ledWritesSkipped = 0;
+    ledWindowStart = millis();
+    ledWindowWrites = 0;
+    ledWritesPerSecond = 0;
+    
+    bootReadyMs = 0;
+    bootFromStoredConfig = false;
+    
+    stateWrites = 0;
+    stateWritesSkipped = 0;
+    stateErases = 0;
+    memset(&storedCounters, 0, sizeof(storedCounters));
     
     storageHealthy = true;
     lastStorageErrorTime = 0;
@@ -125,7 +162,8 @@ void SystemDiagnostics::recordTimerOperation(bool success, const String& operati
 }
 
 bool SystemDiagnostics::isTogglAPIHealthy() const {
-    return getAPISuccessRate() >= 80; // 80% success rate threshold
+    // Requests are suspended while the circuit breaker is open
+    return !togglCircuitOpen && getAPISuccessRate() >= 80; // 80% success rate threshold
 }
 
 int SystemDiagnostics::getAPISuccessRate() const {
@@ -139,6 +177,210 @@ unsigned long SystemDiagnostics::getLastAPIFailure() const {
     return lastAPIFailureTime;
 }
 
+void SystemDiagnostics::recordCircuitState(bool open) {
+    togglCircuitOpen = open;
+}
+
+bool SystemDiagnostics::isTogglCircuitOpen() const {
+    return togglCircuitOpen;
+}
+
+void SystemDiagnostics::recordRequestWrites(unsigned int writeCalls, unsigned int flushBytes) {
+    requestsSent++;
+    requestWriteCalls += writeCalls;
+    requestFlushBytes += flushBytes;
+    lastRequestWrites = writeCalls;
+}
+
+unsigned long SystemDiagnostics::getRequestsSent() const {
+    return requestsSent;
+}
+
+unsigned int SystemDiagnostics::getLastRequestWrites() const {
+    return lastRequestWrites;
+}
+
+unsigned long SystemDiagnostics::getAverageWritesPerRequest() const {
+    return requestsSent > 0 ? requestWriteCalls / requestsSent : 0;
+}
+
+unsigned long SystemDiagnostics::getAverageFlushBytes() const {
+    return requestsSent > 0 ? requestFlushBytes / requestsSent : 0;
+}
+
+void SystemDiagnostics::recordMotion(bool nowMoving, unsigned long periodMs) {
+    // periodMs is the rest or motion period that just ended
+    if (nowMoving) {
+        motionPeriods++;
+        restTimeMs += periodMs;
+    } else {
+        motionTimeMs += periodMs;
+    }
+    moving = nowMoving;
+}
+
+bool SystemDiagnostics::isMoving() const {
+    return moving;
+}
+
+unsigned long SystemDiagnostics::getMotionPeriods() const {
+    return motionPeriods;
+}
+
+unsigned long SystemDiagnostics::getMotionTime() const {
+    return motionTimeMs;
+}
+
+unsigned long SystemDiagnostics::getRestTime() const {
+    return restTimeMs;
+}
+
+void SystemDiagnostics::recordImuRate(bool nowStill, unsigned long periodMs) {
+    // periodMs is the time at the rate just left
+    if (nowStill) {
+        imuActiveTimeMs += periodMs;
+    } else {
+        imuStillTimeMs += periodMs;
+    }
+    imuStill = nowStill;
+}
+
+bool SystemDiagnostics::isImuStill() const {
+    return imuStill;
+}
+
+unsigned long SystemDiagnostics::getImuActiveTime() const {
+    return imuActiveTimeMs;
+}
+
+unsigned long SystemDiagnostics::getImuStillTime() const {
+    return imuStillTimeMs;
+}
+
+unsigned long SystemDiagnostics::getImuAverageCurrent() const {
+    return ImuRateGovernor::averageCurrentUa(imuActiveTimeMs, imuStillTimeMs, imuStillCurrentUa);
+}
+
+int SystemDiagnostics::getImuSavingPercent() const {
+    return ImuRateGovernor::savingPercent(imuActiveTimeMs, imuStillTimeMs, imuStillCurrentUa);
+}
+
+void SystemDiagnostics::recordTap(bool doubleTap, bool accepted) {
+    if (doubleTap) {
+        doubleTaps++;
+    } else {
+        singleTaps++;
+    }
+    if (!accepted) tapsIgnored++;
+}
+
+void SystemDiagnostics::recordTimerPause(bool paused) {
+    if (paused) timerPauses++;
+    timerPaused = paused;
+}
+
+unsigned long SystemDiagnostics::getSingleTaps() const {
+    return singleTaps;
+}
+
+unsigned long SystemDiagnostics::getDoubleTaps() const {
+    return doubleTaps;
+}
+
+unsigned long SystemDiagnostics::getTapsIgnored() const {
+    return tapsIgnored;
+}
+
+bool SystemDiagnostics::isTimerPaused() const {
+    return timerPaused;
+}
+
+unsigned long SystemDiagnostics::getTimerPauses() const {
+    return timerPauses;
+}
+
+void SystemDiagnostics::recordLedWrite(bool sent) {
+    if (!sent) {
+        ledWritesSkipped++;
+        return;
+    }
+    ledWrites++;
+    unsigned long now = millis();
+    unsigned long elapsed = now - ledWindowStart;
+    if (elapsed >= LED_RATE_WINDOW_MS) {
+        ledWritesPerSecond = ledWindowWrites * 1000 / elapsed;
+        ledWindowStart = now;
+        ledWindowWrites = 0;
+    }
+    ledWindowWrites++;
+}
+
+unsigned long SystemDiagnostics::getLedWrites() const {
+    return ledWrites;
+}
+
+unsigned long SystemDiagnostics::getLedWritesSkipped() const {
+    return ledWritesSkipped;
+}
+
+unsigned long SystemDiagnostics::getLedWritesPerSecond() const {
+    // No write has closed the current window yet: rate over it so far
+    unsigned long elapsed = millis() - ledWindowStart;
+    if (elapsed >= LED_RATE_WINDOW_MS) return ledWindowWrites * 1000 / elapsed;
+    return ledWritesPerSecond;
+}
+
+void SystemDiagnostics::recordBoot(unsigned long readyMs, bool storedConfig) {
+    bootReadyMs = readyMs;
+    bootFromStoredConfig = storedConfig;
+}
+
+unsigned long SystemDiagnostics::getBootReadyTime() const {
+    return bootReadyMs;
+}
+
+bool SystemDiagnostics::isBootFromStoredConfig() const {
+    return bootFromStoredConfig;
+}
+
+void SystemDiagnostics::recordStateWrite(bool written) {
+    if (written) {
+        stateWrites++;
+    } else {
+        stateWritesSkipped++;
+    }
+}
+
+void SystemDiagnostics::recordStateErase() {
+    stateErases++;
+}
+
+unsigned long SystemDiagnostics::getStateWrites() const {
+    return stateWrites;
+}
+
+unsigned long SystemDiagnostics::getStateWritesSkipped() const {
+    return stateWritesSkipped;
+}
+
+unsigned long SystemDiagnostics::getStateErases() const {
+    return stateErases;
+}
+
+void SystemDiagnostics::restoreCounters(const DiagnosticCounters& stored) {
+    storedCounters = stored;
+}
+
+DiagnosticCounters SystemDiagnostics::getLifetimeCounters() const {
+    DiagnosticCounters total = storedCounters;
+    total.boots += 1;
+    total.timerOperations += apiTotalCount;
+    total.timerFailures += apiTotalCount - apiSuccessCount;
+    total.doubleTaps += doubleTaps;
+    total.timerPauses += timerPauses;
+    return total;
+}
+
 void SystemDiagnostics::recordStorageOperation(bool success, const String& operation) {
     if (!success) {
         storageHealthy = false;
@@ -164,6 +406,39 @@ String SystemDiagnostics::generateDiagnosticsReport() const {
     report += "\"ble_connections\":" + String(bleConnections) + ",";
     report += "\"api_healthy\":" + String(isTogglAPIHealthy() ? "true" : "false") + ",";
     report += "\"api_success_rate\":" + String(getAPISuccessRate()) + ",";
+    report += "\"api_circuit_open\":" + String(togglCircuitOpen ? "true" : "false") + ",";
+    report += "\"http_requests\":" + String(requestsSent) + ",";
+    report += "\"http_write_calls\":" + String(requestWriteCalls) + ",";
+    report += "\"http_last_request_writes\":" + String(lastRequestWrites) + ",";
+    report += "\"http_flush_bytes_avg\":" + String(getAverageFlushBytes()) + ",";
+    report += "\"moving\":" + String(moving ? "true" : "false") + ",";
+    report += "\"motion_periods\":" + String(motionPeriods) + ",";
+    report += "\"motion_ms\":" + String(motionTimeMs) + ",";
+    report += "\"rest_ms\":" + String(restTimeMs) + ",";
+    report += "\"imu_still\":" + String(imuStill ? "true" : "false") + ",";
+    report += "\"imu_active_ms\":" + String(imuActiveTimeMs) + ",";
+    report += "\"imu_still_ms\":" + String(imuStillTimeMs) + ",";
+    report += "\"imu_current_ua\":" + String(getImuAverageCurrent()) + ",";
+    report += "\"imu_saving_pct\":" + String(getImuSavingPercent()) + ",";
+    report += "\"single_taps\":" + String(singleTaps) + ",";
+    report += "\"double_taps\":" + String(doubleTaps) + ",";
+    report += "\"taps_ignored\":" + String(tapsIgnored) + ",";
+    report += "\"timer_paused\":" + String(timerPaused ? "true" : "false") + ",";
+    report += "\"timer_pauses\":" + String(timerPauses) + ",";
+    report += "\"led_writes\":" + String(ledWrites) + ",";
+    report += "\"led_writes_skipped\":" + String(ledWritesSkipped) + ",";
+    report += "\"led_writes_per_s\":" + String(getLedWritesPerSecond()) + ",";
+    report += "\"boot_ready_ms\":" + String(bootReadyMs) + ",";
+    report += "\"boot_stored_config\":" + String(bootFromStoredConfig ? "true" : "false") + ",";
+    DiagnosticCounters lifetime = getLifetimeCounters();
+    report += "\"state_writes\":" + String(stateWrites) + ",";
+    report += "\"state_writes_skipped\":" + String(stateWritesSkipped) + ",";
+    report += "\"state_erases\":" + String(stateErases) + ",";
+    report += "\"lifetime_boots\":" + String(lifetime.boots) + ",";
+    report += "\"lifetime_timer_operations\":" + String(lifetime.timerOperations) + ",";
+    report += "\"lifetime_timer_failures\":" + String(lifetime.timerFailures) + ",";
+    report += "\"lifetime_double_taps\":" + String(lifetime.doubleTaps) + ",";
+    report += "\"lifetime_timer_pauses\":" + String(lifetime.timerPauses) + ",";
     report += "\"storage_healthy\":" + String(storageHealthy ? "true" : "false") + ",";
     report += "\"avg_loop_time\":" + String(getAverageLoopTime()) + ",";
     report += "\"max_loop_time\":" + String(maxLoopTime);
@@ -113,7 +113,7 @@ namespace SystemUtils {
             const int* receivedProjectIds = getProjectIds();
             int* projectIdsToUse = Config::DEFAULT_PROJECT_IDS;
             bool hasReceivedProjects = false;
-            for (int i = 0; i < 6; i++) {
+            for (int i = 0; i < FACE_COUNT; i++) {
                 if (receivedProjectIds[i] != 0) {
                     hasReceivedProjects = true;
                     break;
@@ -149,11 +149,11 @@ namespace SystemUtils {
     }
 
     void showBLESetupStatus(LEDController& ledController) {
-        ledController.setColor(Config::BLE_SETUP_COLOR[0], Config::BLE_SETUP_COLOR[1], Config::BLE_SETUP_COLOR[2]);
+        ledController.showFeedback(LED_FEEDBACK_CONFIG_WAITING);
     }
 
     void showSuccess(LEDController& ledController) {
-        ledController.setColor(Config::SUCCESS_COLOR[0], Config::SUCCESS_COLOR[1], Config::SUCCESS_COLOR[2]);
+        ledController.showFeedback(LED_FEEDBACK_CONFIG_APPLIED);
         delay(Config::SUCCESS_DISPLAY_DELAY);
         ledController.turnOff();
     }
@@ -0,0 +1,27 @@
+#include "TapEventQueue.h"
+
+TapEventQueue::TapEventQueue() : head(0), count(0), dropped(0) {
+}
+
+bool TapEventQueue::push(const TapEvent& event) {
+    if (count == CAPACITY) {
+        dropped++;
+        return false;
+    }
+    events[(head + count) % CAPACITY] = event;
+    count++;
+    return true;
+}
+
+bool TapEventQueue::pop(TapEvent& event) {
+    if (count == 0) return false;
+    event = events[head];
+    head = (head + 1) % CAPACITY;
+    count--;
+    return true;
+}
+
+void TapEventQueue::clear() {
+    head = 0;
+    count = 0;
+}
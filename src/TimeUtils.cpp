@@ -0,0 +1,90 @@
+#include "TimeUtils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace TimeUtils {
+
+    // Days since 1970-01-01 for a proleptic Gregorian date (Howard Hinnant's algorithm)
+    static int32_t daysFromCivil(int year, int month, int day) {
+        year -= month <= 2;
+        const int32_t era = (year >= 0 ? year : year - 399) / 400;
+        const int32_t yearOfEra = year - era * 400;
+        const int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+        const int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+        return era * 146097 + dayOfEra - 719468;
+    }
+
+    static void civilFromDays(int32_t days, int& year, int& month, int& day) {
+        days += 719468;
+        const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+        const int32_t dayOfEra = days - era * 146097;
+        const int32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        const int32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        const int32_t monthIndex = (5 * dayOfYear + 2) / 153;
+        day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+        month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+        year = yearOfEra + era * 400 + (month <= 2);
+    }
+
+    uint32_t toEpoch(int year, int month, int day, int hour, int minute, int second) {
+        int32_t days = daysFromCivil(year, month, day);
+        if (days < 0) return 0;
+        return (uint32_t)days * 86400UL + hour * 3600UL + minute * 60UL + second;
+    }
+
+    uint32_t parseHttpDate(const char* value) {
+        static const char* MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+        char monthName[4] = {0};
+        int day, year, hour, minute, second;
+
+        const char* comma = strchr(value, ',');
+        const char* fields = comma ? comma + 1 : value;
+        if (sscanf(fields, " %d %3s %d %d:%d:%d", &day, monthName, &year, &hour, &minute, &second) != 6) {
+            return 0;
+        }
+
+        // Only a match on a name boundary counts: "anF" is inside "JanFeb" but no month
+        const char* match = strstr(MONTHS, monthName);
+        if (!match || strlen(monthName) != 3 || (match - MONTHS) % 3 != 0) return 0;
+        int month = (match - MONTHS) / 3 + 1;
+        return toEpoch(year, month, day, hour, minute, second);
+    }
+
+    uint32_t parseIso8601(const char* value) {
+        int year, month, day, hour, minute, second;
+        if (sscanf(value, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6) {
+            return 0;
+        }
+        return toEpoch(year, month, day, hour, minute, second);
+    }
+
+    // Exactly width digits of value, so no field can run past its slot
+    static char* putDigits(char* out, uint32_t value, int width) {
+        for (int i = width - 1; i >= 0; i--) {
+            out[i] = '0' + value % 10;
+            value /= 10;
+        }
+        return out + width;
+    }
+
+    void formatIso8601(uint32_t epoch, char* out) {
+        int year, month, day;
+        civilFromDays((int32_t)(epoch / 86400UL), year, month, day);
+        uint32_t secondsOfDay = epoch % 86400UL;
+        // uint32_t epochs end in 2106, so every field fits its width
+        char* p = putDigits(out, year, 4);
+        *p++ = '-';
+        p = putDigits(p, month, 2);
+        *p++ = '-';
+        p = putDigits(p, day, 2);
+        *p++ = 'T';
+        p = putDigits(p, secondsOfDay / 3600, 2);
+        *p++ = ':';
+        p = putDigits(p, (secondsOfDay / 60) % 60, 2);
+        *p++ = ':';
+        p = putDigits(p, secondsOfDay % 60, 2);
+        *p++ = 'Z';
+        *p = '\0';
+    }
+}
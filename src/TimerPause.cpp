@@ -0,0 +1,34 @@
+#include "TimerPause.h"
+#include "SystemDiagnostics.h"
+
+TimerPause::TimerPause()
+    : paused(false), pausedFace(UNKNOWN), pausedAtMs(0), stats({0, 0, 0}), diagnostics(nullptr) {
+}
+
+TimerPauseAction TimerPause::onTap(const TapEvent& tap, Orientation settledFace, bool busy) {
+    if (tap.gesture != TAP_DOUBLE) return TIMER_PAUSE_NONE;
+
+    bool tracked = settledFace != UNKNOWN && settledFace != FACE_UP;
+    // Resuming is only for the face that was paused; a turn away ends the pause when it commits
+    if (busy || !tracked || (paused && settledFace != pausedFace)) {
+        stats.tapsIgnored++;
+        return TIMER_PAUSE_NONE;
+    }
+
+    paused = !paused;
+    if (paused) {
+        pausedFace = settledFace;
+        pausedAtMs = tap.atMs;
+        stats.pauses++;
+    } else {
+        stats.resumes++;
+    }
+    if (diagnostics) diagnostics->recordTimerPause(paused);
+    return paused ? TIMER_PAUSE_STOP : TIMER_PAUSE_RESUME;
+}
+
+void TimerPause::onFaceCommitted() {
+    if (!paused) return;
+    paused = false;
+    if (diagnostics) diagnostics->recordTimerPause(false);
+}
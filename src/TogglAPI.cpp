@@ -1,118 +1,334 @@
 #include "TogglAPI.h"
 #include "Configuration.h"
 #include "Config.h"
+#include "TimeUtils.h"
 
-TogglAPI::TogglAPI(HttpClient* httpClient) : client(httpClient) {
-    currentTimeEntryId = "";
-    currentTimeEntryName = "";
+// Copy into a fixed buffer, truncating if needed
+static void copyText(char* out, size_t size, const char* text) {
+    strncpy(out, text ? text : "", size - 1);
+    out[size - 1] = '\0';
 }
 
-String TogglAPI::base64Encode(const String& str) {
-    const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-    String encoded = "";
-    int i = 0;
-    unsigned char char_array_3[3];
-    unsigned char char_array_4[4];
+TogglAPI::TogglAPI(Client* transport)
+    : http(*transport, Config::TOGGL_SERVER, Config::TOGGL_PORT) {
+    currentTimeEntryId[0] = '\0';
+    currentTimeEntryName[0] = '\0';
+    switchPreviousEntryId[0] = '\0';
+    unverifiedEntryId[0] = '\0';
+    unknownOutcome.type = TogglOperation::NONE;
+    unknownOutcome.description[0] = '\0';
+    unknownOutcome.expectedStart = 0;
+    unknownOutcome.entryId[0] = '\0';
+    requestPath[0] = '\0';
+    requestBody[0] = '\0';
+    responseScanner.addField("id", responseId, sizeof(responseId));
+    responseScanner.addField("description", responseDescription, sizeof(responseDescription));
+    responseScanner.addField("start", responseStart, sizeof(responseStart));
+    responseScanner.addField("duration", responseDuration, sizeof(responseDuration));
+    rebuildRequestTemplates();
+}
+
+void TogglAPI::rebuildRequestTemplates() {
+    // Runtime values win over compile-time Configuration.h, field by field
+    String token = hasRuntimeConfig && runtimeToken.length() > 0
+        ? runtimeToken
+        : String(togglApiToken);
+    String workspace = hasRuntimeConfig && runtimeWorkspaceId.length() > 0
+        ? runtimeWorkspaceId
+        : String(workspaceId);
+    int projectIds[TogglRequestTemplates::ORIENTATION_COUNT];
+    for (int i = 0; i < TogglRequestTemplates::ORIENTATION_COUNT; i++) {
+        projectIds[i] = getProjectId(i);
+    }
+
+    if (!templates.configure(token.c_str(), workspace.c_str(), projectIds)) {
+        Serial.println("[TOGGL] Credentials too long for the request templates");
+    }
+}
+
+bool TogglAPI::enqueue(TogglOperation type, int orientationIndex, const String& description,
+                       uint32_t epoch, uint32_t duration) {
+    if (pendingCount >= MAX_PENDING_OPERATIONS) {
+        Serial.println("[TOGGL] Operation queue full - dropping request");
+        return false;
+    }
+
+    PendingOperation& operation = pendingOperations[(pendingHead + pendingCount) % MAX_PENDING_OPERATIONS];
+    operation.type = type;
+    operation.orientationIndex = orientationIndex;
+    copyText(operation.description, sizeof(operation.description), description.c_str());
+    operation.epoch = epoch;
+    operation.duration = duration;
+    pendingCount++;
+    return true;
+}
+
+bool TogglAPI::requestStart(int orientationIndex, const String& description, uint32_t startEpoch) {
+    if (orientationIndex < 0 || orientationIndex >= FACE_COUNT) return false;
+    return enqueue(TogglOperation::START, orientationIndex, description, startEpoch, 0);
+}
+
+bool TogglAPI::requestStop(uint32_t stopEpoch) {
+    // The entry to stop is resolved at dispatch time, so a stop queued behind
+    // a start that is still in flight stops the entry that start created
+    return enqueue(TogglOperation::STOP, -1, "", stopEpoch, 0);
+}
+
+bool TogglAPI::requestCompletedEntry(int orientationIndex, const String& description,
+                                     uint32_t startEpoch, uint32_t durationSeconds) {
+    if (orientationIndex < 0 || orientationIndex >= FACE_COUNT) return false;
+    if (startEpoch == 0 || durationSeconds == 0) return false;
+    return enqueue(TogglOperation::COMPLETED_ENTRY, orientationIndex, description, startEpoch, durationSeconds);
+}
 
-    const char *bytes_to_encode = str.c_str();
-    int in_len = str.length();
+bool TogglAPI::requestTimeSync() {
+    return enqueue(TogglOperation::TIME_SYNC, -1, "", 0, 0);
+}
 
-    while (i < in_len) {
-        char_array_3[0] = bytes_to_encode[i++];
-        char_array_3[1] = (i < in_len) ? bytes_to_encode[i++] : 0;
-        char_array_3[2] = (i < in_len) ? bytes_to_encode[i++] : 0;
+bool TogglAPI::requestSwitch(int orientationIndex, const String& description, uint32_t startEpoch) {
+    if (orientationIndex < 0 || orientationIndex >= FACE_COUNT) return false;
+    if (!canSwitch()) {
+        // Server does not stop running entries itself: fall back to two requests
+        return requestStop(startEpoch) && requestStart(orientationIndex, description, startEpoch);
+    }
+    return enqueue(TogglOperation::SWITCH, orientationIndex, description, startEpoch, 0);
+}
 
-        char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-        char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-        char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-        char_array_4[3] = char_array_3[2] & 0x3f;
+bool TogglAPI::requestSwitchVerification() {
+    if (!needsSwitchVerification()) return false;
+    return enqueue(TogglOperation::VERIFY_SWITCH, -1, "", 0, 0);
+}
 
-        for (int j = 0; j < 4; j++) {
-            encoded += base64_chars[char_array_4[j]];
+bool TogglAPI::requestReconcile() {
+    if (!hasUnknownOutcome()) return false;
+    return enqueue(TogglOperation::RECONCILE, -1, "", 0, 0);
+}
+
+uint32_t TogglAPI::epochAtMillis(unsigned long ms) const {
+    if (serverEpoch == 0) return 0;
+    long offsetMs = (long)(ms - serverEpochMillis);
+    return serverEpoch + offsetMs / 1000;
+}
+
+void TogglAPI::poll(unsigned long nowMs) {
+    pollMs = nowMs;
+    if (activeOperation.type == TogglOperation::NONE) {
+        if (!dispatchNextOperation()) {
+            return;
         }
     }
 
-    // Add padding if needed
-    int padding = 3 - (in_len % 3);
-    if (padding != 3) {
-        for (int j = 0; j < padding; j++) {
-            encoded[encoded.length() - 1 - j] = '=';
+    http.poll(nowMs);
+    if (!http.isBusy()) {
+        completeActiveOperation();
+    }
+}
+
+bool TogglAPI::dispatchNextOperation() {
+    while (pendingCount > 0) {
+        PendingOperation operation = pendingOperations[pendingHead];
+        TogglEndpoint endpoint = endpointFor(operation.type);
+        if (!scheduler.tryAcquire(endpoint, pollMs)) {
+            return false; // Stays queued until the scheduler lets it go
+        }
+        pendingHead = (pendingHead + 1) % MAX_PENDING_OPERATIONS;
+        pendingCount--;
+        // Where a new entry would start, to recognise it if the response is lost
+        activeDispatchEpoch = operation.epoch != 0 ? operation.epoch : epochAtMillis(pollMs);
+
+        bool dispatched;
+        switch (operation.type) {
+            case TogglOperation::START:
+            case TogglOperation::COMPLETED_ENTRY:
+                dispatched = dispatchStart(operation);
+                break;
+            case TogglOperation::STOP:
+                dispatched = dispatchStop(operation);
+                break;
+            case TogglOperation::TIME_SYNC:
+                dispatched = dispatchTimeSync();
+                break;
+            case TogglOperation::SWITCH:
+                copyText(switchPreviousEntryId, sizeof(switchPreviousEntryId), currentTimeEntryId);
+                dispatched = dispatchStart(operation);
+                break;
+            case TogglOperation::VERIFY_SWITCH:
+                dispatched = dispatchVerifySwitch();
+                break;
+            case TogglOperation::RECONCILE:
+                // Same query as a time sync: the running entry tells what happened
+                dispatched = hasUnknownOutcome() && dispatchTimeSync();
+                break;
+            default:
+                dispatched = false;
+                break;
+        }
+        if (dispatched) {
+            activeOperation = operation;
+            return true;
+        }
+
+        // Nothing to send (e.g. stop without a running entry)
+        scheduler.release(endpoint);
+        lastOperationSuccess = false;
+        lastStatusCode = 0;
+        if (completionCallback) {
+            completionCallback(operation.type, false, 0);
         }
     }
+    return false;
+}
+
+bool TogglAPI::dispatchStart(const PendingOperation& operation) {
+    long duration = operation.type == TogglOperation::COMPLETED_ENTRY ? (long)operation.duration : -1L;
+    size_t bodyLength = templates.formatStartBody(operation.orientationIndex, operation.description,
+                                                  operation.epoch, duration, requestBody, sizeof(requestBody));
+    if (bodyLength == 0) return false;
 
-    return encoded;
+    http.begin("POST", "/api/v9/time_entries");
+    http.addHeaders(templates.headerBlock());
+    http.setBody(requestBody, bodyLength);
+    if (operation.type == TogglOperation::COMPLETED_ENTRY) {
+        http.discardBody(); // Completed entries are not tracked locally
+    } else {
+        responseScanner.reset();
+        http.streamBodyTo(&responseScanner);
+    }
+    Serial.println("[TOGGL] Submitting start request...");
+    return http.submit(pollMs);
 }
 
+bool TogglAPI::dispatchStop(const PendingOperation& operation) {
+    if (!hasCurrentEntry()) return false;
 
+    Serial.println("Stopping current time entry...");
+    return submitStop(currentTimeEntryId, operation.epoch);
+}
 
+bool TogglAPI::submitStop(const char* entryId, uint32_t stopEpoch) {
+    if (stopEpoch != 0) {
+        // Back-dated stop: update the entry's stop time instead of using /stop
+        size_t bodyLength = templates.formatStopBody(stopEpoch, requestBody, sizeof(requestBody));
+        if (templates.formatEntryPath(entryId, nullptr, requestPath, sizeof(requestPath)) == 0) return false;
+        http.begin("PUT", requestPath);
+        http.setBody(requestBody, bodyLength);
+    } else {
+        if (templates.formatEntryPath(entryId, "/stop", requestPath, sizeof(requestPath)) == 0) return false;
+        http.begin("PATCH", requestPath);
+    }
+    http.discardBody(); // Only the status code matters
+    http.addHeaders(templates.headerBlock());
+    Serial.println("[TOGGL] Submitting stop request...");
+    return http.submit(pollMs);
+}
 
-bool TogglAPI::startTimeEntry(int orientationIndex, const String& description) {
-    if (!client || orientationIndex < 0 || orientationIndex >= 6) return false;
+bool TogglAPI::dispatchTimeSync() {
+    http.begin("GET", "/api/v9/me/time_entries/current");
+    http.addHeaders(templates.headerBlock());
+    responseScanner.reset();
+    http.streamBodyTo(&responseScanner);
+    Serial.println("[TOGGL] Submitting time sync request...");
+    return http.submit(pollMs);
+}
 
-    JsonDocument timeEntry;
-    timeEntry["description"] = description;
-    // Prefer runtime workspace ID if set
-    String wsIdStr = hasRuntimeConfig && runtimeWorkspaceId.length() > 0
-        ? runtimeWorkspaceId
-        : String(workspaceId);
-    long wsIdNum = wsIdStr.toInt();
-    timeEntry["workspace_id"] = wsIdNum;
+bool TogglAPI::dispatchVerifySwitch() {
+    if (!needsSwitchVerification()) return false;
 
-    int projectId = (hasRuntimeConfig && runtimeProjectIds[orientationIndex] != 0)
-        ? runtimeProjectIds[orientationIndex]
-        : orientationProjectIds[orientationIndex];
-    if (projectId != 0) {
-        timeEntry["project_id"] = projectId;
+    verifyStopping = false;
+    snprintf(requestPath, sizeof(requestPath), "/api/v9/me/time_entries/%s", unverifiedEntryId);
+    http.begin("GET", requestPath);
+    http.addHeaders(templates.headerBlock());
+    responseScanner.reset();
+    http.streamBodyTo(&responseScanner);
+    Serial.println("[TOGGL] Checking that the switched-from entry was stopped...");
+    return http.submit(pollMs);
+}
+
+void TogglAPI::completeActiveOperation() {
+    TogglOperation operation = activeOperation.type;
+    int statusCode = http.getStatusCode();
+
+    uint32_t serverDate = http.getServerDate();
+    if (serverDate != 0) {
+        serverEpoch = serverDate;
+        serverEpochMillis = pollMs;
     }
-    
-    // Let server set start time to current server time
-    timeEntry["duration"] = -1;
-    timeEntry["created_with"] = "TimeTracker Redux";
 
-    String jsonString;
-    serializeJson(timeEntry, jsonString);
+    // Every finished exchange feeds backoff, breaker and diagnostics; the
+    // explicit stop chained by VERIFY_SWITCH updates an entry
+    TogglEndpoint endpoint = verifyStopping ? TogglEndpoint::UPDATE_ENTRY : endpointFor(operation);
+    scheduler.recordResult(endpoint, statusCode, http.getRetryAfterSeconds(), pollMs);
+    if (diagnostics && http.wasRequestSent()) {
+        diagnostics->recordRequestWrites(http.getRequestWrites(), http.getFlushBytes());
+    }
 
-    // Set timeout to prevent device hangs
-    client->setTimeout(5000); // 5 second timeout
-    
-    client->beginRequest();
-    client->post("/api/v9/time_entries");
-    client->sendHeader("Content-Type", "application/json");
-    // Prefer runtime token if set
-    String token = hasRuntimeConfig && runtimeToken.length() > 0
-        ? runtimeToken
-        : String(togglApiToken);
-    client->sendHeader("Authorization", "Basic " + base64Encode(token + ":api_token"));
-    client->sendHeader("Content-Length", jsonString.length());
-    client->beginBody();
-    client->print(jsonString);
-    
-    // Log before potentially blocking operation
-    Serial.println("[TOGGL] Sending HTTP request...");
-    client->endRequest();
-    Serial.println("[TOGGL] Request sent, waiting for response...");
+    // Count handshakes vs. reused sockets per call type (journal replay
+    // and time sync calls are counted with starts)
+    TogglConnectionStats& stats = operation == TogglOperation::STOP ? stopStats : startStats;
+    lastRequestReusedConnection = http.wasConnectionReused();
+    if (http.hadStaleReconnect()) {
+        stats.staleReconnects++;
+        stats.handshakes++;
+    } else if (lastRequestReusedConnection) {
+        stats.reusedConnections++;
+    } else {
+        stats.handshakes++;
+    }
+
+    // No response to a request the server may already have acted on
+    if (statusCode <= 0 && http.wasRequestSent() && !verifyStopping) {
+        rememberUnknownOutcome(operation);
+    }
+
+    bool success;
+    switch (operation) {
+        case TogglOperation::START:
+            success = handleStartResponse(statusCode, http.getResponseBody());
+            break;
+        case TogglOperation::COMPLETED_ENTRY:
+            success = handleCompletedEntryResponse(statusCode, http.getResponseBody());
+            break;
+        case TogglOperation::TIME_SYNC:
+            success = handleTimeSyncResponse(statusCode, http.getResponseBody());
+            break;
+        case TogglOperation::SWITCH:
+            success = handleSwitchResponse(statusCode, http.getResponseBody());
+            break;
+        case TogglOperation::RECONCILE:
+            success = handleReconcileResponse(statusCode);
+            break;
+        case TogglOperation::VERIFY_SWITCH:
+            success = handleVerifySwitchResponse(statusCode, http.getResponseBody());
+            if (verifyStopping && http.isBusy()) {
+                return; // Explicit stop submitted as part of the same operation
+            }
+            break;
+        default:
+            success = handleStopResponse(statusCode, http.getResponseBody());
+            break;
+    }
 
-    int statusCode = client->responseStatusCode();
-    String response = client->responseBody();
-    Serial.println("[TOGGL] Response received");
+    activeOperation.type = TogglOperation::NONE;
+    lastOperationSuccess = success;
+    lastStatusCode = statusCode;
+    if (completionCallback) {
+        completionCallback(operation, success, statusCode);
+    }
+}
 
+bool TogglAPI::handleStartResponse(int statusCode, const String& response) {
     Serial.print("Toggl API startTimeEntry - Status: ");
-    Serial.print(statusCode);
-    Serial.print(", Response length: ");
-    Serial.println(response.length());
+    Serial.println(statusCode);
     
-    if (statusCode == 200) {
-        JsonDocument responseDoc;
-        DeserializationError error = deserializeJson(responseDoc, response);
-        
-        if (!error) {
-            currentTimeEntryName = responseDoc["description"].as<String>();
-            currentTimeEntryId = responseDoc["id"].as<String>();
-            Serial.print("Started time entry: " + currentTimeEntryName + " (");
-            Serial.print(currentTimeEntryId);
-            Serial.println(")");
-            return true;
-        }
+    if (statusCode == 200 && responseScanner.isFound(FIELD_ID)) {
+        copyText(currentTimeEntryName, sizeof(currentTimeEntryName), responseDescription);
+        copyText(currentTimeEntryId, sizeof(currentTimeEntryId), responseId);
+        Serial.print("Started time entry: ");
+        Serial.print(currentTimeEntryName);
+        Serial.print(" (");
+        Serial.print(currentTimeEntryId);
+        Serial.println(")");
+        return true;
     }
     
     Serial.print("Failed to start time entry. Status: ");
@@ -125,43 +341,15 @@ bool TogglAPI::startTimeEntry(int orientationIndex, const String& description) {
         Serial.println("AUTHENTICATION ERROR: Check Toggl API token and permissions");
     } else if (statusCode == 404) {
         Serial.println("NOT FOUND ERROR: Check workspace ID and project ID");
-    } else if (statusCode == 0) {
+    } else if (statusCode <= 0) {
         Serial.println("CONNECTION ERROR: Check WiFi connection to api.track.toggl.com");
     }
     
-    currentTimeEntryId = "";
+    currentTimeEntryId[0] = '\0';
     return false;
 }
 
-bool TogglAPI::stopCurrentTimeEntry() {
-    if (currentTimeEntryId == "" || !client) return false;
-
-    Serial.println("Stopping current time entry...");
-    String wsIdStr = hasRuntimeConfig && runtimeWorkspaceId.length() > 0
-        ? runtimeWorkspaceId
-        : String(workspaceId);
-    String endpoint = "/api/v9/workspaces/" + wsIdStr + "/time_entries/" + currentTimeEntryId + "/stop";
-    
-    // Set timeout to prevent device hangs
-    client->setTimeout(5000); // 5 second timeout
-    
-    client->beginRequest();
-    client->patch(endpoint);
-    client->sendHeader("Content-Type", "application/json");
-    String token = hasRuntimeConfig && runtimeToken.length() > 0
-        ? runtimeToken
-        : String(togglApiToken);
-    client->sendHeader("Authorization", "Basic " + base64Encode(token + ":api_token"));
-    
-    // Log before potentially blocking operation  
-    Serial.println("[TOGGL] Sending stop request...");
-    client->endRequest();
-    Serial.println("[TOGGL] Stop request sent, waiting for response...");
-
-    int statusCode = client->responseStatusCode();
-    String response = client->responseBody();
-    Serial.println("[TOGGL] Stop response received");
-    
+bool TogglAPI::handleStopResponse(int statusCode, const String& response) {
     Serial.print("Toggl API stopTimeEntry - Status: ");
     Serial.print(statusCode);
     Serial.print(", Response length: ");
@@ -170,7 +358,7 @@ bool TogglAPI::stopCurrentTimeEntry() {
     if (statusCode == 200) {
         Serial.print("Stopped time entry ID: ");
         Serial.println(currentTimeEntryId);
-        currentTimeEntryId = "";
+        currentTimeEntryId[0] = '\0';
         return true;
     } else {
         Serial.print("Failed to stop time entry. Status: ");
@@ -187,8 +375,196 @@ bool TogglAPI::stopCurrentTimeEntry() {
     }
 }
 
+bool TogglAPI::handleCompletedEntryResponse(int statusCode, const String& response) {
+    Serial.print("Toggl API completed entry - Status: ");
+    Serial.println(statusCode);
+
+    if (statusCode == 200) {
+        return true;
+    }
+    Serial.print("Failed to create completed time entry. Response: ");
+    Serial.println(response);
+    return false;
+}
+
+bool TogglAPI::handleTimeSyncResponse(int statusCode, const String& response) {
+    Serial.print("Toggl API current entry - Status: ");
+    Serial.println(statusCode);
+
+    if (statusCode != 200) {
+        return false;
+    }
+
+    // Body is the running entry, or "null" when nothing is running
+    if (responseScanner.isFound(FIELD_ID)) {
+        copyText(currentTimeEntryId, sizeof(currentTimeEntryId), responseId);
+        copyText(currentTimeEntryName, sizeof(currentTimeEntryName), responseDescription);
+    } else {
+        currentTimeEntryId[0] = '\0';
+        currentTimeEntryName[0] = '\0';
+    }
+    return true;
+}
+
+bool TogglAPI::handleSwitchResponse(int statusCode, const String& response) {
+    if (!handleStartResponse(statusCode, response)) {
+        // Nothing was created, so the previous entry is still the running one
+        copyText(currentTimeEntryId, sizeof(currentTimeEntryId), switchPreviousEntryId);
+        switchPreviousEntryId[0] = '\0';
+        return false;
+    }
+
+    if (switchPreviousEntryId[0] != '\0' && switchSupport == SwitchSupport::UNKNOWN) {
+        copyText(unverifiedEntryId, sizeof(unverifiedEntryId), switchPreviousEntryId);
+        unverifiedStopEpoch = responseScanner.isFound(FIELD_START)
+            ? TimeUtils::parseIso8601(responseStart)
+            : epochAtMillis(pollMs);
+    }
+    switchPreviousEntryId[0] = '\0';
+    return true;
+}
+
+bool TogglAPI::handleVerifySwitchResponse(int statusCode, const String& response) {
+    if (verifyStopping) {
+        // Result of the explicit stop issued below
+        verifyStopping = false;
+        if (statusCode == 200 || statusCode == 404) {
+            unverifiedEntryId[0] = '\0';
+            return true;
+        }
+        Serial.print("[TOGGL] Explicit stop after switch failed: ");
+        Serial.println(statusCode);
+        return false;
+    }
+
+    if (statusCode == 404) {
+        unverifiedEntryId[0] = '\0'; // Entry was deleted; nothing left running
+        return true;
+    }
+    if (statusCode != 200) {
+        return false;
+    }
+
+    bool stillRunning = !responseScanner.isFound(FIELD_DURATION) || responseDuration[0] == '-';
+    if (!stillRunning) {
+        Serial.println("[TOGGL] Server stops running entries on start - switching in one request");
+        switchSupport = SwitchSupport::VERIFIED;
+        unverifiedEntryId[0] = '\0';
+        return true;
+    }
+
+    // The server left it running: end it where the new entry began and
+    // go back to explicit stop + start
+    Serial.println("[TOGGL] Server kept the previous entry running - using explicit stops");
+    switchSupport = SwitchSupport::UNSUPPORTED;
+    verifyStopping = submitStop(unverifiedEntryId, unverifiedStopEpoch);
+    return false;
+}
+
+bool TogglAPI::waitForIdle() {
+    // A backoff or an open breaker can hold the queue for minutes; don't sit it out.
+    // A request already on the wire finishes or times out on its own.
+    unsigned long start = millis();
+    while (isBusy()) {
+        if (millis() - start >= http.getTimeout() && !http.isBusy()) {
+            Serial.println("[TOGGL] Request still queued after the timeout - left for poll()");
+            return false;
+        }
+        poll();
+        delay(1);
+    }
+    return lastOperationSuccess;
+}
+
+void TogglAPI::rememberUnknownOutcome(TogglOperation operation) {
+    if (operation != TogglOperation::START && operation != TogglOperation::SWITCH &&
+        operation != TogglOperation::STOP) {
+        return; // Reads are safe to repeat; completed entries are replayed
+    }
+    unknownOutcome.type = operation;
+    copyText(unknownOutcome.description, sizeof(unknownOutcome.description), activeOperation.description);
+    unknownOutcome.expectedStart = operation == TogglOperation::STOP ? 0 : activeDispatchEpoch;
+    // Still the entry that was running when the request went out
+    copyText(unknownOutcome.entryId, sizeof(unknownOutcome.entryId), currentTimeEntryId);
+    Serial.println("[TOGGL] No response to a sent request - outcome unknown, will reconcile");
+}
+
+bool TogglAPI::handleReconcileResponse(int statusCode) {
+    if (statusCode != 200) {
+        return false; // Still unknown; the caller retries the reconcile
+    }
+
+    bool running = responseScanner.isFound(FIELD_ID);
+    bool applied;
+    if (unknownOutcome.type == TogglOperation::STOP) {
+        // The stop went through unless that entry is still the running one
+        applied = !running || strcmp(responseId, unknownOutcome.entryId) != 0;
+    } else {
+        // The start went through if a new entry with our description began at
+        // about the time we asked for
+        uint32_t start = running ? TimeUtils::parseIso8601(responseStart) : 0;
+        uint32_t expected = unknownOutcome.expectedStart;
+        bool startMatches = expected == 0 ||
+            (start + Config::TOGGL_RECONCILE_START_TOLERANCE_S >= expected &&
+             start <= expected + Config::TOGGL_RECONCILE_START_TOLERANCE_S);
+        applied = running && strcmp(responseId, unknownOutcome.entryId) != 0 &&
+                  strcmp(responseDescription, unknownOutcome.description) == 0 && startMatches;
+
+        if (applied && unknownOutcome.type == TogglOperation::SWITCH &&
+            unknownOutcome.entryId[0] != '\0' && switchSupport == SwitchSupport::UNKNOWN) {
+            // Same follow-up as a switch that got its response
+            copyText(unverifiedEntryId, sizeof(unverifiedEntryId), unknownOutcome.entryId);
+            unverifiedStopEpoch = start;
+        }
+    }
+
+    // Either way the server's running entry is now known
+    copyText(currentTimeEntryId, sizeof(currentTimeEntryId), running ? responseId : "");
+    copyText(currentTimeEntryName, sizeof(currentTimeEntryName), running ? responseDescription : "");
+
+    Serial.print("[TOGGL] Unknown outcome settled: ");
+    Serial.print(applied ? "request was applied" : "request was not applied");
+    if (running) {
+        Serial.print(", running entry ");
+        Serial.print(currentTimeEntryId);
+    }
+    Serial.println();
+
+    unknownOutcome.type = TogglOperation::NONE;
+    reconcileApplied = applied;
+    return true;
+}
+
+TogglEndpoint TogglAPI::endpointFor(TogglOperation operation) {
+    switch (operation) {
+        case TogglOperation::STOP:
+            return TogglEndpoint::UPDATE_ENTRY;
+        case TogglOperation::TIME_SYNC:
+        case TogglOperation::VERIFY_SWITCH:
+        case TogglOperation::RECONCILE:
+            return TogglEndpoint::READ_ENTRY;
+        default:
+            return TogglEndpoint::CREATE_ENTRY;
+    }
+}
+
+bool TogglAPI::startTimeEntry(int orientationIndex, const String& description) {
+    if (!requestStart(orientationIndex, description)) return false;
+    return waitForIdle();
+}
+
+bool TogglAPI::stopCurrentTimeEntry() {
+    if (!hasCurrentEntry()) return false;
+    if (!requestStop()) return false;
+    return waitForIdle();
+}
+
+void TogglAPI::closeConnection() {
+    http.stop();
+}
+
 int TogglAPI::getProjectId(int orientationIndex) const {
-    if (orientationIndex >= 0 && orientationIndex < 6) {
+    if (orientationIndex >= 0 && orientationIndex < FACE_COUNT) {
         if (hasRuntimeConfig && runtimeProjectIds[orientationIndex] != 0) {
             return runtimeProjectIds[orientationIndex];
         }
@@ -203,20 +579,29 @@ void TogglAPI::setCredentials(const String& token, const String& workspaceId) {
     runtimeToken = token;
     runtimeWorkspaceId = workspaceId;
     hasRuntimeConfig = true;
+    rebuildRequestTemplates();
 }
 
 void TogglAPI::setProjectIds(const int* ids) {
     if (ids) {
-        for (int i = 0; i < 6; i++) {
+        for (int i = 0; i < FACE_COUNT; i++) {
             runtimeProjectIds[i] = ids[i];
         }
         hasRuntimeConfig = true;
+        rebuildRequestTemplates();
+    }
+}
+
+void TogglAPI::restoreCurrentEntry(const char* entryId) {
+    if (currentTimeEntryId[0] == '\0' && entryId) {
+        copyText(currentTimeEntryId, sizeof(currentTimeEntryId), entryId);
     }
 }
 
 void TogglAPI::clearRuntimeConfig() {
     runtimeToken = "";
     runtimeWorkspaceId = "";
-    for (int i = 0; i < 6; i++) runtimeProjectIds[i] = 0;
+    for (int i = 0; i < FACE_COUNT; i++) runtimeProjectIds[i] = 0;
     hasRuntimeConfig = false;
+    rebuildRequestTemplates();
 }
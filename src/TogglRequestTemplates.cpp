@@ -0,0 +1,170 @@
+#include "TogglRequestTemplates.h"
+#include "TimeUtils.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+    // Appends into a caller buffer, remembering if anything was cut off
+    struct BufferWriter {
+        char* out;
+        size_t size;
+        size_t used;
+        bool overflow;
+
+        BufferWriter(char* buffer, size_t bufferSize) : out(buffer), size(bufferSize), used(0), overflow(false) {
+            if (size > 0) out[0] = '\0';
+        }
+
+        void append(const char* text, size_t length) {
+            if (overflow || used + length >= size) {
+                overflow = true;
+                return;
+            }
+            memcpy(out + used, text, length);
+            used += length;
+            out[used] = '\0';
+        }
+
+        void append(const char* text) { append(text, strlen(text)); }
+
+        void appendNumber(long value) {
+            char digits[20];
+            int count = 0;
+            unsigned long magnitude = value < 0 ? (unsigned long)(-value) : (unsigned long)value;
+            do {
+                digits[count++] = (char)('0' + magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude > 0 && count < (int)sizeof(digits));
+            if (value < 0) append("-", 1);
+            while (count > 0) append(&digits[--count], 1);
+        }
+
+        void appendJsonEscaped(const char* text) {
+            static const char HEX_DIGITS[] = "0123456789abcdef";
+            for (const char* p = text; *p; p++) {
+                unsigned char c = (unsigned char)*p;
+                if (c == '"' || c == '\\') {
+                    char escaped[2] = {'\\', (char)c};
+                    append(escaped, 2);
+                } else if (c < 0x20) {
+                    char escaped[6] = {'\\', 'u', '0', '0', HEX_DIGITS[c >> 4], HEX_DIGITS[c & 0x0F]};
+                    append(escaped, 6);
+                } else {
+                    append((const char*)&c, 1);
+                }
+            }
+        }
+
+        size_t result() const { return overflow ? 0 : used; }
+    };
+}
+
+TogglRequestTemplates::TogglRequestTemplates() : entryPathPrefixLength(0) {
+    headers[0] = '\0';
+    entryPathPrefix[0] = '\0';
+    for (int i = 0; i < ORIENTATION_COUNT; i++) {
+        bodyPrefix[i][0] = '\0';
+        bodyPrefixLength[i] = 0;
+    }
+}
+
+bool TogglRequestTemplates::configure(const char* apiToken, const char* workspaceId, const int* projectIds) {
+    // Authorization: Basic base64("<token>:api_token")
+    char credentials[96];
+    BufferWriter plain(credentials, sizeof(credentials));
+    plain.append(apiToken ? apiToken : "");
+    plain.append(":api_token");
+    char encoded[HEADER_BLOCK_SIZE];
+    size_t encodedLength = base64Encode(credentials, plain.used, encoded, sizeof(encoded));
+
+    BufferWriter header(headers, sizeof(headers));
+    header.append("Content-Type: application/json\r\nAuthorization: Basic ");
+    header.append(encoded, encodedLength);
+    header.append("\r\n");
+
+    // Same conversion the JSON body always used (toInt semantics)
+    long workspace = workspaceId ? strtol(workspaceId, nullptr, 10) : 0;
+
+    BufferWriter path(entryPathPrefix, sizeof(entryPathPrefix));
+    path.append("/api/v9/workspaces/");
+    path.appendNumber(workspace);
+    path.append("/time_entries/");
+    entryPathPrefixLength = path.used;
+
+    bool fits = !plain.overflow && encodedLength > 0 && !header.overflow && !path.overflow;
+    for (int i = 0; i < ORIENTATION_COUNT; i++) {
+        BufferWriter body(bodyPrefix[i], sizeof(bodyPrefix[i]));
+        body.append("{\"workspace_id\":");
+        body.appendNumber(workspace);
+        int projectId = projectIds ? projectIds[i] : 0;
+        if (projectId != 0) {
+            body.append(",\"project_id\":");
+            body.appendNumber(projectId);
+        }
+        body.append(",\"created_with\":\"TimeTracker Redux\",\"description\":\"");
+        bodyPrefixLength[i] = body.used;
+        fits = fits && !body.overflow;
+    }
+    return fits;
+}
+
+size_t TogglRequestTemplates::formatStartBody(int orientationIndex, const char* description, uint32_t startEpoch,
+                                              long duration, char* out, size_t size) const {
+    if (orientationIndex < 0 || orientationIndex >= ORIENTATION_COUNT) return 0;
+
+    BufferWriter body(out, size);
+    body.append(bodyPrefix[orientationIndex], bodyPrefixLength[orientationIndex]);
+    body.appendJsonEscaped(description ? description : "");
+    body.append("\"");
+    if (startEpoch != 0) {
+        char start[TimeUtils::ISO8601_BUFFER_SIZE];
+        TimeUtils::formatIso8601(startEpoch, start);
+        body.append(",\"start\":\"");
+        body.append(start);
+        body.append("\"");
+    }
+    // Running entries use -1; without an explicit start the server uses its current time
+    body.append(",\"duration\":");
+    body.appendNumber(duration);
+    body.append("}");
+    return body.result();
+}
+
+size_t TogglRequestTemplates::formatStopBody(uint32_t stopEpoch, char* out, size_t size) const {
+    char stop[TimeUtils::ISO8601_BUFFER_SIZE];
+    TimeUtils::formatIso8601(stopEpoch, stop);
+
+    BufferWriter body(out, size);
+    body.append("{\"stop\":\"");
+    body.append(stop);
+    body.append("\"}");
+    return body.result();
+}
+
+size_t TogglRequestTemplates::formatEntryPath(const char* entryId, const char* suffix, char* out, size_t size) const {
+    BufferWriter path(out, size);
+    path.append(entryPathPrefix, entryPathPrefixLength);
+    path.append(entryId);
+    if (suffix) path.append(suffix);
+    return path.result();
+}
+
+size_t TogglRequestTemplates::base64Encode(const char* in, size_t length, char* out, size_t size) {
+    static const char BASE64_CHARS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t encodedLength = ((length + 2) / 3) * 4;
+    if (encodedLength + 1 > size) return 0;
+
+    size_t o = 0;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t triple = (uint32_t)(unsigned char)in[i] << 16;
+        if (i + 1 < length) triple |= (uint32_t)(unsigned char)in[i + 1] << 8;
+        if (i + 2 < length) triple |= (uint32_t)(unsigned char)in[i + 2];
+
+        out[o++] = BASE64_CHARS[(triple >> 18) & 0x3F];
+        out[o++] = BASE64_CHARS[(triple >> 12) & 0x3F];
+        out[o++] = i + 1 < length ? BASE64_CHARS[(triple >> 6) & 0x3F] : '=';
+        out[o++] = i + 2 < length ? BASE64_CHARS[triple & 0x3F] : '=';
+    }
+    out[o] = '\0';
+    return o;
+}
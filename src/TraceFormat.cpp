@@ -0,0 +1,116 @@
+#include "TraceFormat.h"
+
+static void putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+}
+
+static uint16_t getU16(const uint8_t* in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+// Byte that brings the sum of the frame to zero
+static uint8_t checksum(const uint8_t* data, int length) {
+    uint8_t sum = 0;
+    for (int i = 0; i < length; i++) sum += data[i];
+    return (uint8_t)(0x100 - sum);
+}
+
+static int frameBytes(uint8_t type) {
+    if (type == TraceFormat::TYPE_TIME) return TraceFormat::TIME_FRAME_BYTES;
+    if (type == TraceFormat::TYPE_SAMPLE) return TraceFormat::SAMPLE_FRAME_BYTES;
+    return 0;
+}
+
+int TraceFormat::encodeTime(uint32_t ms, uint8_t* out) {
+    out[0] = SYNC;
+    out[1] = TYPE_TIME;
+    putU16(out + 2, ms & 0xFFFF);
+    putU16(out + 4, ms >> 16);
+    out[6] = checksum(out, 6);
+    return TIME_FRAME_BYTES;
+}
+
+int TraceFormat::encodeSample(uint16_t dtMs, const AccelSample& sample, uint8_t* out) {
+    out[0] = SYNC;
+    out[1] = TYPE_SAMPLE;
+    putU16(out + 2, dtMs);
+    putU16(out + 4, (uint16_t)sample.x);
+    putU16(out + 6, (uint16_t)sample.y);
+    putU16(out + 8, (uint16_t)sample.z);
+    out[10] = checksum(out, 10);
+    return SAMPLE_FRAME_BYTES;
+}
+
+TraceDecoder::TraceDecoder() {
+    reset();
+}
+
+void TraceDecoder::reset() {
+    length = 0;
+    expected = 0;
+    haveTime = false;
+    timeMs = 0;
+    stats = {0, 0, 0, 0};
+}
+
+bool TraceDecoder::feed(uint8_t byte, TraceRecord& record) {
+    if (length == 0) {
+        if (byte != TraceFormat::SYNC) {
+            stats.skippedBytes++;
+            return false;
+        }
+        frame[length++] = byte;
+        return false;
+    }
+
+    frame[length++] = byte;
+    if (length == 2) {
+        expected = frameBytes(byte);
+        if (expected == 0) {
+            stats.badFrames++;
+            resync();
+            return false;
+        }
+    }
+    if (length < expected) return false;
+    return completeFrame(record);
+}
+
+bool TraceDecoder::completeFrame(TraceRecord& record) {
+    uint8_t sum = 0;
+    for (int i = 0; i < length; i++) sum += frame[i];
+    if (sum != 0) {
+        stats.badFrames++;
+        resync();
+        return false;
+    }
+
+    length = 0;
+    if (frame[1] == TraceFormat::TYPE_TIME) {
+        timeMs = getU16(frame + 2) | ((uint32_t)getU16(frame + 4) << 16);
+        haveTime = true;
+        stats.timeFrames++;
+        return false;
+    }
+
+    if (!haveTime) return false;
+    timeMs += getU16(frame + 2);
+    record.ms = timeMs;
+    record.sample.x = (int16_t)getU16(frame + 4);
+    record.sample.y = (int16_t)getU16(frame + 6);
+    record.sample.z = (int16_t)getU16(frame + 8);
+    stats.samples++;
+    return true;
+}
+
+void TraceDecoder::resync() {
+    // The sync byte may have been noise: look for a frame start in what followed it.
+    // The remainder is shorter than a sample frame, so replaying it cannot yield one.
+    uint8_t rest[TraceFormat::MAX_FRAME_BYTES];
+    int restLength = length - 1;
+    for (int i = 0; i < restLength; i++) rest[i] = frame[i + 1];
+    length = 0;
+    TraceRecord ignored;
+    for (int i = 0; i < restLength; i++) feed(rest[i], ignored);
+}
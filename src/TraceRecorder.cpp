@@ -0,0 +1,32 @@
+#include "TraceRecorder.h"
+
+TraceRecorder::TraceRecorder(Print& output)
+    : out(output), started(false), lastMs(0), sinceTimeFrame(0), samplesWritten(0), bytesWritten(0) {
+}
+
+void TraceRecorder::record(const AccelSample* samples, int count, unsigned long nowMs, unsigned long samplePeriodMs) {
+    uint8_t frame[TraceFormat::MAX_FRAME_BYTES];
+    for (int i = 0; i < count; i++) {
+        unsigned long ms = nowMs - (unsigned long)(count - 1 - i) * samplePeriodMs;
+        // The back-dated estimate can overlap the previous batch by a little
+        if (started && (long)(ms - lastMs) < 0) ms = lastMs;
+
+        if (!started || ms - lastMs > 0xFFFF || sinceTimeFrame >= TIME_FRAME_INTERVAL) {
+            writeTime(ms);
+        }
+        int length = TraceFormat::encodeSample((uint16_t)(ms - lastMs), samples[i], frame);
+        bytesWritten += out.write(frame, length);
+        lastMs = ms;
+        sinceTimeFrame++;
+        samplesWritten++;
+    }
+}
+
+void TraceRecorder::writeTime(unsigned long ms) {
+    uint8_t frame[TraceFormat::TIME_FRAME_BYTES];
+    int length = TraceFormat::encodeTime(ms, frame);
+    bytesWritten += out.write(frame, length);
+    started = true;
+    lastMs = ms;
+    sinceTimeFrame = 0;
+}
@@ -1,5 +1,4 @@
 #include <Arduino.h>
-#include <ArduinoHttpClient.h>
 #include <ArduinoBLE.h>
 
 // Platform-specific includes
@@ -24,7 +23,17 @@
 #include "Config.h"
 #include "LEDController.h"
 #include "OrientationDetector.h"
+#include "OrientationCoalescer.h"
+#include "TraceRecorder.h"
 #include "TogglAPI.h"
+#include "SystemDiagnostics.h"
+#include "FlashRegion.h"
+#include "EventJournal.h"
+#include "JournalReplayer.h"
+#include "ConfigStorage.h"
+#include "KvStore.h"
+#include "ImuCalibration.h"
+#include "TimerPause.h"
 
 // Configuration will be received via BLE from the mobile app
 
@@ -35,19 +44,49 @@ String configWifiSSID = "";
 String configWifiPassword = "";
 String configTogglToken = "";
 String configWorkspaceId = "";
-int configProjectIds[6] = {0, 0, 0, 0, 0, 0};
+int configProjectIds[FACE_COUNT] = {0};
 
 // Global objects
 LEDController ledController;
-OrientationDetector orientationDetector(Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
+LSM6DSBackend imuBackend;
+OrientationDetector orientationDetector(imuBackend, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
+OrientationCoalescer orientationCoalescer(Config::ORIENTATION_COALESCE_MS);
+TimerPause timerPause;   // Double tap on the resting face, from the sensor's tap engine
+TraceRecorder traceRecorder(Serial);
 
-// Network client
+// Network client (requests are driven asynchronously by togglAPI.poll())
 WiFiSSLClient sslClient;
-HttpClient httpClient(sslClient, Config::TOGGL_SERVER, Config::TOGGL_PORT);
-TogglAPI togglAPI(&httpClient);
+TogglAPI togglAPI(&sslClient);
+SystemDiagnostics systemDiagnostics;   // Fed by the Toggl request scheduler and motion detection
+
+// Every orientation change is journaled to flash first; the replayer sends it
+InternalFlash journalFlash(Config::JOURNAL_FLASH_OFFSET, Config::JOURNAL_FLASH_SIZE);
+EventJournal eventJournal(journalFlash);
+JournalReplayer journalReplayer(eventJournal, togglAPI);
+
+// Small state that changes often (calibration, running entry, counters) as a wear-leveled log
+InternalFlash stateFlash(Config::STATE_FLASH_OFFSET, Config::STATE_FLASH_SIZE);
+KvStore stateStore(stateFlash);
+
+// BLE configuration in A/B flash slots; the per-device IMU calibration goes to the state store
+InternalFlash configFlash(Config::CONFIG_FLASH_OFFSET, Config::CONFIG_FLASH_SIZE);
+ConfigStorage configStorage(configFlash, &stateStore);
+ImuCalibrator imuCalibrator;
+
+// Toggl entry the timer is running under, kept in the state store across resets
+String currentTimeEntryId = "";
 
 // Function declarations
 void handleOrientationChange(Orientation newOrientation, float accelX, float accelY, float accelZ);
+void commitOrientationChange(const OrientationChange& change);
+void handleTap(const TapEvent& tap);
+void onTogglOperationComplete(TogglOperation operation, bool success, int statusCode);
+void serviceCalibration();
+bool loadStoredConfiguration();
+void receiveBLEConfiguration();
+bool connectWiFi();
+void saveRunningEntry();
+void saveDiagnosticCounters();
 
 // SimpleBLEConfig functions (from SimpleBLEConfig.cpp)
 bool simpleBLEBegin();
@@ -59,6 +98,8 @@ String getTogglToken();
 String getWorkspaceId();
 int* getProjectIds();
 void testAuthCallbackSetup();
+int takeCalibrationCommand();
+extern "C" void updateBLEStatus(const char* status);
 
 void setup() {
     // Initialize serial communication
@@ -69,9 +110,10 @@ void setup() {
     Serial.println("Initializing components...");
     
     // Initialize LED
+    ledController.setDiagnostics(&systemDiagnostics);
     if (ledController.begin()) {
         Serial.println("LED controller initialized");
-        ledController.setColor(0, 0, 255); // Blue during BLE setup
+        ledController.showFeedback(LED_FEEDBACK_STARTING); // Blue during BLE setup
     } else {
         Serial.println("LED controller failed");
     }
@@ -82,9 +124,151 @@ void setup() {
     } else {
         Serial.println("IMU initialization failed!");
         ledController.showError();
-        while(1) delay(1000); // Stop here if IMU fails
+        while(1) {  // Stop here if IMU fails, flashing the error
+            ledController.updateBLEAnimation();
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+    
+    // State store first: it holds the calibration and the counters of earlier boots
+    stateStore.setDiagnostics(&systemDiagnostics);
+    if (!stateFlash.begin() || !stateStore.begin()) {
+        Serial.println("State store unavailable - calibration and counters will not survive a power cycle");
+    }
+    DiagnosticCounters counters;
+    if (stateStore.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters)) {
+        systemDiagnostics.restoreCounters(counters);
+    }
+    
+    // Stored configuration; correct for how the board sits in this cube, if it has been calibrated
+    if (!configFlash.begin()) {
+        Serial.println("Configuration flash unavailable - setup will be needed after every power cycle");
+    }
+    configStorage.begin();
+    if (configStorage.hasCalibration()) {
+        orientationDetector.setCalibration(&configStorage.getCalibration());
+        Serial.println("IMU calibration applied");
+    }
+    
+    // A cube that was set up before goes straight to tracking, unless it was
+    // reset again before the LED went dark: then it takes a new configuration
+    bool setupRequested = configStorage.checkSetupRequest();
+    bool storedConfig = !setupRequested && loadStoredConfiguration();
+    if (!storedConfig) {
+        receiveBLEConfiguration();
     }
     
+    bool wifiConnected = connectWiFi();
+    if (!wifiConnected && storedConfig) {
+        // The stored network may be gone: take a new configuration over BLE
+        Serial.println("Stored WiFi network not reachable - waiting for a new configuration");
+        receiveBLEConfiguration();
+        storedConfig = false;
+        wifiConnected = connectWiFi();
+    }
+    
+    if (wifiConnected) {
+        Serial.println();
+        Serial.print("WiFi connected! IP: ");
+        Serial.println(WiFi.localIP());
+        if (!storedConfig) {
+            // Known to work now: keep it for the next power cycle
+            configStorage.saveConfiguration(configWifiSSID, configWifiPassword, configTogglToken,
+                                            configWorkspaceId, configProjectIds);
+        }
+        ledController.showFeedback(LED_FEEDBACK_WIFI_CONNECTED); // Green when connected
+        delay(1000);
+    } else {
+        Serial.println();
+        Serial.println("WiFi connection failed!");
+        Serial.println("Returning to BLE advertising mode for reconfiguration...");
+        
+        // Show WiFi error pattern for 5 seconds to indicate failure
+        ledController.showWiFiError();
+        unsigned long errorStartTime = millis();
+        while (millis() - errorStartTime < 5000) {
+            ledController.updateBLEAnimation();
+            delay(50);
+        }
+        
+        // Restart device to go back to initial BLE advertising state
+        // This ensures we return to exactly the same state as startup
+        Serial.println("Restarting device to return to initial BLE advertising state...");
+        configStorage.finishStartup();   // Not a reset gesture
+        delay(1000); // Brief delay for serial message
+        
+        // Restart device (platform-specific)
+        #if defined(ARDUINO_ARCH_SAMD)
+            NVIC_SystemReset();
+        #elif defined(ARDUINO_NANO_RP2040_CONNECT)
+            // For Arduino Nano RP2040 Connect - use watchdog reset
+            watchdog_enable(1, 1);
+            while(1);
+        #else
+            // For other platforms, try NVIC reset
+            NVIC_SystemReset();
+        #endif
+    }
+    
+    // Configure Toggl API with received values
+    togglAPI.setCredentials(configTogglToken, configWorkspaceId);
+    togglAPI.setProjectIds(configProjectIds);
+    togglAPI.setCompletionCallback(onTogglOperationComplete);
+    // WiFi join time differs per cube, so retries after a shared outage spread out
+    togglAPI.getScheduler().setJitterSeed(micros());
+    togglAPI.setDiagnostics(&systemDiagnostics);
+    orientationDetector.setDiagnostics(&systemDiagnostics);
+    timerPause.setDiagnostics(&systemDiagnostics);
+    
+    // A timer left running before the reset is stopped by the next face change
+    char runningEntryId[TogglAPI::MAX_ENTRY_ID_LENGTH];
+    if (stateStore.getString(KV_KEY_RUNNING_ENTRY, runningEntryId, sizeof(runningEntryId))) {
+        togglAPI.restoreCurrentEntry(runningEntryId);
+        currentTimeEntryId = runningEntryId;
+        Serial.print("Running entry from before the reset: ");
+        Serial.println(currentTimeEntryId);
+    }
+    
+    // Open the event journal (pending events from before a reset are replayed)
+    if (!journalFlash.begin() || !eventJournal.begin()) {
+        Serial.println("Event journal unavailable - timer changes during outages will be lost");
+    }
+    
+    Serial.println("Configuration complete!");
+    Serial.println("WiFi: " + configWifiSSID);
+    Serial.println("Workspace: " + configWorkspaceId);
+    Serial.println("Token: " + configTogglToken.substring(0,8) + "...");
+    
+    Serial.println("TimeTracker ready for time tracking!");
+    ledController.turnOff(); // Turn off LED, ready for orientation detection
+    configStorage.finishStartup();
+    
+    // millis() started at reset: this is the whole boot
+    unsigned long bootMs = millis();
+    systemDiagnostics.recordBoot(bootMs, storedConfig);
+    saveDiagnosticCounters();
+    Serial.print("Ready ");
+    Serial.print(bootMs);
+    Serial.println(storedConfig ? " ms after boot (stored configuration)" : " ms after boot (BLE setup)");
+}
+
+bool loadStoredConfiguration() {
+    if (!configStorage.loadConfiguration() || !configStorage.hasValidConfiguration()) {
+        return false;
+    }
+    configWifiSSID = configStorage.getWifiSSID();
+    configWifiPassword = configStorage.getWifiPassword();
+    configTogglToken = configStorage.getTogglToken();
+    configWorkspaceId = configStorage.getWorkspaceId();
+    const int* storedProjectIds = configStorage.getProjectIds();
+    for (int i = 0; i < FACE_COUNT; i++) {
+        configProjectIds[i] = storedProjectIds[i];
+    }
+    Serial.println("Stored configuration found - skipping BLE setup");
+    return true;
+}
+
+void receiveBLEConfiguration() {
     // Wait for BLE configuration - no timeout, keep advertising until configured
     Serial.println("Starting BLE configuration mode...");
     Serial.println("Waiting for configuration from mobile app...");
@@ -92,9 +276,10 @@ void setup() {
     if (simpleBLEBegin()) {
         Serial.println("BLE started successfully - advertising until configured");
         
-        // Wait indefinitely for configuration
-        while (!isConfigComplete()) {
+        // Wait indefinitely for configuration (and for a calibration the app started to finish)
+        while (!isConfigComplete() || imuCalibrator.getState() == CALIBRATION_CAPTURING) {
             simpleBLEPoll();
+            serviceCalibration();
             delay(100);
             
             // Show we're still waiting every 10 seconds - distinguish between connection states
@@ -119,7 +304,7 @@ void setup() {
         // Get project IDs
         int* receivedProjectIds = getProjectIds();
         if (receivedProjectIds) {
-            for (int i = 0; i < 6; i++) {
+            for (int i = 0; i < FACE_COUNT; i++) {
                 configProjectIds[i] = receivedProjectIds[i];
             }
         }
@@ -130,13 +315,18 @@ void setup() {
     } else {
         Serial.println("BLE start failed - cannot continue without configuration!");
         ledController.showError();
-        while(1) delay(1000); // Stop here if BLE fails
+        while(1) {  // Stop here if BLE fails, flashing the error
+            ledController.updateBLEAnimation();
+            delay(Config::MAIN_LOOP_DELAY);
+        }
     }
+}
 
+bool connectWiFi() {
     // Initialize WiFi connection with received config
     Serial.print("Connecting to WiFi: ");
     Serial.println(configWifiSSID);
-    ledController.setColor(255, 255, 0); // Yellow during WiFi connection
+    ledController.showFeedback(LED_FEEDBACK_WIFI_CONNECTING); // Yellow during WiFi connection
     
     WiFi.begin(configWifiSSID.c_str(), configWifiPassword.c_str());
     int attempts = 0;
@@ -145,59 +335,10 @@ void setup() {
         Serial.print(".");
         attempts++;
     }
-    
-    if (WiFi.status() == WL_CONNECTED) {
-        Serial.println();
-        Serial.print("WiFi connected! IP: ");
-        Serial.println(WiFi.localIP());
-        ledController.setColor(0, 255, 0); // Green when connected
-        delay(1000);
-    } else {
-        Serial.println();
-        Serial.println("WiFi connection failed!");
-        Serial.println("Returning to BLE advertising mode for reconfiguration...");
-        
-        // Show WiFi error pattern for 5 seconds to indicate failure
-        ledController.showWiFiError();
-        unsigned long errorStartTime = millis();
-        while (millis() - errorStartTime < 5000) {
-            ledController.updateBLEAnimation();
-            delay(50);
-        }
-        
-        // Restart device to go back to initial BLE advertising state
-        // This ensures we return to exactly the same state as startup
-        Serial.println("Restarting device to return to initial BLE advertising state...");
-        delay(1000); // Brief delay for serial message
-        
-        // Restart device (platform-specific)
-        #if defined(ARDUINO_ARCH_SAMD)
-            NVIC_SystemReset();
-        #elif defined(ARDUINO_NANO_RP2040_CONNECT)
-            // For Arduino Nano RP2040 Connect - use watchdog reset
-            watchdog_enable(1, 1);
-            while(1);
-        #else
-            // For other platforms, try NVIC reset
-            NVIC_SystemReset();
-        #endif
-    }
-    
-    // Configure Toggl API with received values
-    togglAPI.setCredentials(configTogglToken, configWorkspaceId);
-    togglAPI.setProjectIds(configProjectIds);
-    
-    Serial.println("Configuration complete!");
-    Serial.println("WiFi: " + configWifiSSID);
-    Serial.println("Workspace: " + configWorkspaceId);
-    Serial.println("Token: " + configTogglToken.substring(0,8) + "...");
-    
-    Serial.println("TimeTracker ready for time tracking!");
-    ledController.turnOff(); // Turn off LED, ready for orientation detection
+    return WiFi.status() == WL_CONNECTED;
 }
 
 // Global state for tracking
-String currentTimeEntryId = "";
 Orientation lastOrientation = UNKNOWN;
 
 void loop() {
@@ -209,65 +350,213 @@ void loop() {
     // Read IMU data using OrientationDetector
     float accelX, accelY, accelZ;
     if (orientationDetector.readAcceleration(accelX, accelY, accelZ)) {
-        // Detect current orientation
-        Orientation currentOrientation = orientationDetector.detectOrientation(accelX, accelY, accelZ);
+        if (Config::IMU_TRACE_ENABLED) {
+            traceRecorder.record(orientationDetector.getLastBatch(), orientationDetector.getLastBatchSize(),
+                                 millis(), orientationDetector.getSamplePeriodMs());
+        }
+        
+        // Filtered, hysteretic decision over the samples just read
+        Orientation currentOrientation = orientationDetector.getClassifiedOrientation();
         
         // Check if orientation changed (with debouncing)
         if (orientationDetector.hasOrientationChanged(currentOrientation)) {
             handleOrientationChange(currentOrientation, accelX, accelY, accelZ);
-            orientationDetector.updateOrientation(currentOrientation);
             lastOrientation = currentOrientation;
         }
     }
     
+    // Only the face the cube settles on reaches Toggl, back-dated to when it got there;
+    // nothing is sent while it is being carried or turned
+    OrientationChange change;
+    if (!orientationDetector.isMoving() && orientationCoalescer.poll(millis(), change)) {
+        timerPause.onFaceCommitted();
+        commitOrientationChange(change);
+    }
+    
+    // Taps were latched by the sensor and queued when its events were read
+    TapEvent tap;
+    while (orientationDetector.takeTap(tap)) {
+        handleTap(tap);
+    }
+    
+    // Replay journaled events and advance any in-flight Toggl request without blocking the loop
+    journalReplayer.poll(WiFi.status() == WL_CONNECTED, millis());
+    togglAPI.poll();
+    
+    // Reclaim a full state store page a record at a time; counters only go out now and then
+    stateStore.poll();
+    static unsigned long lastCountersSaveMs = 0;
+    if (millis() - lastCountersSaveMs >= Config::STATE_COUNTERS_SAVE_MS) {
+        saveDiagnosticCounters();
+        lastCountersSaveMs = millis();
+    }
+    
     // Update LED animations for BLE status and WiFi errors
     ledController.updateBLEAnimation();
     
-    // Small delay for stability
-    delay(Config::MAIN_LOOP_DELAY);
+    // Sleep while nothing is moving or pending; the IMU interrupt ends the wait
+    if (orientationDetector.isIdle() && !orientationCoalescer.isHolding() && journalReplayer.isIdle() &&
+        !togglAPI.isBusy() && !ledController.isAnimating() && !stateStore.isCompactionDue()) {
+        orientationDetector.waitForEvent(Config::IMU_IDLE_LOOP_DELAY);
+    } else {
+        delay(Config::MAIN_LOOP_DELAY);
+    }
 }
 
 void handleOrientationChange(Orientation newOrientation, float accelX, float accelY, float accelZ) {
+    // Immediate feedback; the timer change is held by the coalescer
+    orientationDetector.updateOrientation(newOrientation);
+    ledController.updateColorForOrientation(newOrientation, Config::LED_MAX_INTENSITY);
+    orientationDetector.printOrientation(newOrientation, accelX, accelY, accelZ);
+    orientationCoalescer.offer(newOrientation, millis());
+}
+
+void handleTap(const TapEvent& tap) {
+    Orientation face = orientationDetector.getCurrentOrientation();
+    bool busy = orientationCoalescer.isHolding() || orientationDetector.isMoving();
+    TimerPauseAction action = timerPause.onTap(tap, face, busy);
+    if (action == TIMER_PAUSE_NONE) return;
+    
+    // Committed like a face change, back-dated to the tap: turning face up stops the
+    // timer, and coming back to the same face starts it again
+    Serial.println(action == TIMER_PAUSE_STOP ? "Double tap - pausing timer" : "Double tap - resuming timer");
+    OrientationChange change = {face, action == TIMER_PAUSE_STOP ? FACE_UP : face, tap.atMs};
+    commitOrientationChange(change);
+    ledController.updateColorForOrientation(face, action == TIMER_PAUSE_STOP ? Config::LED_PAUSED_INTENSITY
+                                                                             : Config::LED_MAX_INTENSITY);
+}
+
+void commitOrientationChange(const OrientationChange& change) {
     Serial.println("\n--- Orientation Change ---");
+    Orientation newOrientation = change.to;
     
-    // Stop current timer if running  
-    if (currentTimeEntryId != "") {
+    // Journal a stop for the current timer; the request runs from loop() via the replayer.
+    // Both events are back-dated to when the cube reached the new face
+    uint32_t epoch = togglAPI.epochAtMillis(change.atMs);
+    bool tracked = newOrientation != UNKNOWN && newOrientation != FACE_UP;
+    bool timerRunning = currentTimeEntryId != "" || togglAPI.isBusy();
+    // Without the journal, a face change is sent as one switch request
+    bool switching = !eventJournal.isReady() && tracked && timerRunning && togglAPI.canSwitch();
+    if (eventJournal.isReady()) {
+        if (eventJournal.isSegmentOpen()) {
+            Serial.println("Stopping current timer...");
+            if (!eventJournal.recordStop(epoch, change.atMs)) {
+                Serial.println("Failed to journal timer stop");
+            }
+        }
+    } else if (timerRunning && !switching) {
         Serial.println("Stopping current timer...");
-        if (togglAPI.stopCurrentTimeEntry()) {
-            Serial.println("Timer stopped successfully");
-            currentTimeEntryId = "";
-        } else {
-            Serial.println("Failed to stop timer");
+        if (!togglAPI.requestStop(epoch)) {
+            Serial.println("Failed to queue timer stop");
         }
     }
     
-    // Update orientation in detector
-    orientationDetector.updateOrientation(newOrientation);
-    
-    // Update LED for new orientation
-    ledController.updateColorForOrientation(newOrientation, Config::LED_MAX_INTENSITY);
-    
-    // Print orientation info
-    orientationDetector.printOrientation(newOrientation, accelX, accelY, accelZ);
-    
     // Start new timer if not timer stopped
-    if (newOrientation != UNKNOWN && newOrientation != FACE_UP) {
+    if (tracked) {
         String description = orientationDetector.getOrientationName(newOrientation);
         Serial.print("Starting timer for: ");
         Serial.println(description);
         
-        if (togglAPI.startTimeEntry(newOrientation, description)) {
+        if (eventJournal.isReady()) {
+            if (!eventJournal.recordStart(newOrientation, epoch, change.atMs)) {
+                Serial.println("Failed to journal timer start");
+            }
+        } else if (switching) {
+            if (!togglAPI.requestSwitch(newOrientation, description, epoch)) {
+                Serial.println("Failed to queue timer switch");
+            }
+        } else if (!togglAPI.requestStart(newOrientation, description, epoch)) {
+            Serial.println("Failed to queue timer start");
+        }
+    } else if (newOrientation == FACE_UP) {
+        Serial.println("No timer started");
+    }
+    
+    Serial.println("--- End Orientation Change ---\n");
+}
+
+void onTogglOperationComplete(TogglOperation operation, bool success, int statusCode) {
+    if (operation == TogglOperation::TIME_SYNC || operation == TogglOperation::RECONCILE) {
+        if (success) currentTimeEntryId = togglAPI.getCurrentEntryId();
+    } else if (operation == TogglOperation::STOP) {
+        if (success) {
+            Serial.println("Timer stopped successfully");
+            currentTimeEntryId = "";
+        } else {
+            Serial.println("Failed to stop timer");
+        }
+    } else if (operation == TogglOperation::START || operation == TogglOperation::SWITCH) {
+        if (success) {
             currentTimeEntryId = togglAPI.getCurrentEntryId();
             Serial.print("Timer started successfully! ID: ");
             Serial.println(currentTimeEntryId);
         } else {
             Serial.println("Failed to start timer");
         }
-    } else if (newOrientation == FACE_UP) {
-        Serial.println("No timer started");
+    } else if (operation == TogglOperation::VERIFY_SWITCH) {
+        currentTimeEntryId = togglAPI.getCurrentEntryId();
+    }
+    saveRunningEntry();
+}
+
+void saveRunningEntry() {
+    // The store skips the write when the entry did not change
+    if (currentTimeEntryId == "") {
+        stateStore.remove(KV_KEY_RUNNING_ENTRY);
+    } else {
+        stateStore.putString(KV_KEY_RUNNING_ENTRY, currentTimeEntryId.c_str());
+    }
+}
+
+void saveDiagnosticCounters() {
+    stateStore.put(KV_KEY_DIAGNOSTIC_COUNTERS, systemDiagnostics.getLifetimeCounters());
+}
+
+// Runs a calibration the app asked for: progress and result go out on the status characteristic
+void serviceCalibration() {
+    int command = takeCalibrationCommand();
+    if (command == CALIBRATION_COMMAND_START) {
+        // Capture raw samples; the old correction stays in storage until a new one succeeds
+        orientationDetector.setCalibration(nullptr);
+        imuCalibrator.start();
+        Serial.println("IMU calibration started - rest the cube on each face in turn");
+        updateBLEStatus("cal_0_of_6");
+    } else if (command == CALIBRATION_COMMAND_CLEAR) {
+        imuCalibrator.cancel();
+        configStorage.clearCalibration();
+        orientationDetector.setCalibration(nullptr);
+        updateBLEStatus("cal_cleared");
     }
     
-    Serial.println("--- End Orientation Change ---\n");
+    if (imuCalibrator.getState() != CALIBRATION_CAPTURING) return;
+    float accelX, accelY, accelZ;
+    if (!orientationDetector.readAcceleration(accelX, accelY, accelZ)) return;
+    if (!imuCalibrator.addSamples(orientationDetector.getLastBatch(), orientationDetector.getLastBatchSize(),
+                                  orientationDetector.isMoving())) {
+        return;
+    }
+    
+    Serial.print("Captured ");
+    Serial.println(orientationDetector.getOrientationName(imuCalibrator.getLastCaptured()));
+    if (imuCalibrator.getState() == CALIBRATION_DONE) {
+        configStorage.saveCalibration(imuCalibrator.getResult());
+        orientationDetector.setCalibration(&imuCalibrator.getResult());
+        Serial.print("IMU calibrated, worst residual ");
+        Serial.print(imuCalibrator.getWorstResidual());
+        Serial.println(" mg");
+        updateBLEStatus("calibrated");
+    } else if (imuCalibrator.getState() == CALIBRATION_FAILED) {
+        // Back to the stored correction, if any
+        if (configStorage.hasCalibration()) {
+            orientationDetector.setCalibration(&configStorage.getCalibration());
+        }
+        Serial.println("IMU calibration failed - a face was captured off flat");
+        updateBLEStatus("cal_failed");
+    } else {
+        char progress[16];
+        snprintf(progress, sizeof(progress), "cal_%d_of_6", imuCalibrator.getCapturedCount());
+        updateBLEStatus(progress);
+    }
 }
 
 // BLE Configuration Functions
@@ -0,0 +1,147 @@
+#ifndef FAKE_CLIENT_H
+#define FAKE_CLIENT_H
+
+#include <Arduino.h>
+#include <Client.h>
+
+/**
+ * Scripted Client used by the network tests.
+ *
+ * Raw HTTP responses are queued up front. The first write of a request arms
+ * the next queued response, which is then released bytesPerMs at a time based
+ * on millis(), so tests can watch the engine while data trickles in.
+ */
+class ScriptedClient : public Client {
+public:
+    static const int MAX_RESPONSES = 8;
+
+    // Behaviour knobs
+    unsigned long bytesPerMs = 0;   // 0 = whole response available at once
+    bool closeAfterResponse = false;
+    bool staleSocket = false;       // Looks connected, but the next write fails
+
+    // Counters
+    int connectCount = 0;
+    int writeCalls = 0;
+    int stopCount = 0;
+    String written;
+
+    ScriptedClient() : isConnected(false), responseCount(0), responseHead(0),
+                       armed(false), armTime(0), readPos(0) {}
+
+    void queueResponse(const String& raw) {
+        if (responseCount < MAX_RESPONSES) {
+            responses[(responseHead + responseCount) % MAX_RESPONSES] = raw;
+            responseCount++;
+        }
+    }
+
+    void setConnected(bool connected) { isConnected = connected; }
+    int pendingResponses() const { return responseCount; }
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("ip", port); }
+    int connect(const char* host, uint16_t port) override {
+        connectCount++;
+        isConnected = true;
+        staleSocket = false;
+        return 1;
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override {
+        writeCalls++;
+        if (!isConnected || staleSocket) {
+            isConnected = false;
+            return 0;
+        }
+        written.concat((const char*)buf, size);
+        if (!armed && responseCount > 0) {
+            armed = true;
+            armTime = millis();
+            readPos = 0;
+        }
+        return size;
+    }
+
+    int available() override {
+        if (!armed) return 0;
+        const String& response = responses[responseHead];
+        unsigned long released = response.length();
+        if (bytesPerMs > 0) {
+            unsigned long budget = (millis() - armTime) * bytesPerMs;
+            if (budget < released) released = budget;
+        }
+        return (int)(released - readPos);
+    }
+
+    int read() override {
+        if (available() <= 0) return -1;
+        const String& response = responses[responseHead];
+        uint8_t c = (uint8_t)response[readPos++];
+        if (readPos >= response.length()) {
+            // Response fully delivered
+            responses[responseHead] = "";
+            responseHead = (responseHead + 1) % MAX_RESPONSES;
+            responseCount--;
+            armed = false;
+            if (closeAfterResponse) isConnected = false;
+        }
+        return c;
+    }
+
+    int read(uint8_t* buf, size_t size) override {
+        size_t n = 0;
+        while (n < size && available() > 0) buf[n++] = (uint8_t)read();
+        return (int)n;
+    }
+
+    int peek() override {
+        if (available() <= 0) return -1;
+        return (uint8_t)responses[responseHead][readPos];
+    }
+
+    void flush() override {}
+    void stop() override {
+        stopCount++;
+        isConnected = false;
+        if (armed) {
+            // Drop the rest of an in-flight response with the socket
+            responses[responseHead] = "";
+            responseHead = (responseHead + 1) % MAX_RESPONSES;
+            responseCount--;
+            armed = false;
+        }
+    }
+    uint8_t connected() override { return isConnected || available() > 0; }
+    operator bool() override { return isConnected; }
+
+private:
+    bool isConnected;
+    String responses[MAX_RESPONSES];
+    int responseCount;
+    int responseHead;
+    bool armed;
+    unsigned long armTime;
+    unsigned int readPos;
+};
+
+// Minimal well-formed Toggl responses
+inline String httpResponse(int status, const String& body, bool chunked = false) {
+    String raw = "HTTP/1.1 " + String(status) + (status == 200 ? " OK" : " Error") + "\r\n";
+    raw += "Content-Type: application/json\r\n";
+    if (chunked) {
+        raw += "Transfer-Encoding: chunked\r\n\r\n";
+        unsigned int half = body.length() / 2;
+        String first = body.substring(0, half);
+        String second = body.substring(half);
+        raw += String((int)first.length(), HEX) + "\r\n" + first + "\r\n";
+        raw += String((int)second.length(), HEX) + "\r\n" + second + "\r\n";
+        raw += "0\r\n\r\n";
+    } else {
+        raw += "Content-Length: " + String(body.length()) + "\r\n\r\n";
+        raw += body;
+    }
+    return raw;
+}
+
+#endif // FAKE_CLIENT_H
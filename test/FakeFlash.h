@@ -0,0 +1,90 @@
+#ifndef FAKE_FLASH_H
+#define FAKE_FLASH_H
+
+#include <string.h>
+#include "FlashRegion.h"
+
+/**
+ * RAM-backed FlashRegion with NOR semantics for the storage tests.
+ *
+ * program() can only clear bits, like real flash. cutPowerAfter() simulates
+ * a power loss part way through a write: only the given number of bytes of
+ * the next program() land, and every access fails until restorePower().
+ * cutPowerDuringErase() does the same for the next erase, leaving the rest
+ * of the sector as it was. Erases are also counted per sector, for wear.
+ *
+ * The storage is sized by the template arguments, so a fake costs what the
+ * test asks for: a 4 KB journal rig fits on the device test's stack.
+ */
+template <uint32_t REGION_SIZE, uint32_t SECTOR_SIZE>
+class FakeFlash : public FlashRegion {
+public:
+    static_assert(REGION_SIZE % SECTOR_SIZE == 0, "Region must be whole sectors");
+    static const uint32_t SECTOR_COUNT = REGION_SIZE / SECTOR_SIZE;
+
+    // Counters
+    int readCalls = 0;
+    int programCalls = 0;
+    int eraseCalls = 0;
+
+    FakeFlash() : powered(true), cutAfterBytes(-1), cutEraseAfterBytes(-1) {
+        memset(memory, 0xFF, sizeof(memory));
+        memset(sectorErases, 0, sizeof(sectorErases));
+    }
+
+    uint32_t size() const override { return REGION_SIZE; }
+    uint32_t sectorSize() const override { return SECTOR_SIZE; }
+
+    bool read(uint32_t offset, void* data, uint32_t length) override {
+        if (!powered || offset + length > REGION_SIZE) return false;
+        readCalls++;
+        memcpy(data, memory + offset, length);
+        return true;
+    }
+
+    bool program(uint32_t offset, const void* data, uint32_t length) override {
+        if (!powered || offset + length > REGION_SIZE) return false;
+        programCalls++;
+        const uint8_t* source = (const uint8_t*)data;
+        for (uint32_t i = 0; i < length; i++) {
+            if (cutAfterBytes == 0) {
+                powered = false;
+                cutAfterBytes = -1;
+                return false;
+            }
+            if (cutAfterBytes > 0) cutAfterBytes--;
+            memory[offset + i] &= source[i];
+        }
+        return true;
+    }
+
+    bool eraseSector(uint32_t offset) override {
+        if (!powered || offset % SECTOR_SIZE != 0 || offset + SECTOR_SIZE > REGION_SIZE) return false;
+        eraseCalls++;
+        sectorErases[offset / SECTOR_SIZE]++;
+        if (cutEraseAfterBytes >= 0 && (uint32_t)cutEraseAfterBytes < SECTOR_SIZE) {
+            memset(memory + offset, 0xFF, cutEraseAfterBytes);
+            powered = false;
+            cutEraseAfterBytes = -1;
+            return false;
+        }
+        memset(memory + offset, 0xFF, SECTOR_SIZE);
+        return true;
+    }
+
+    void cutPowerAfter(int bytes) { cutAfterBytes = bytes; }
+    void cutPowerDuringErase(int bytes) { cutEraseAfterBytes = bytes; }
+    void restorePower() { powered = true; }
+    bool isPowered() const { return powered; }
+    uint8_t* raw() { return memory; }
+    int erasesOf(uint32_t sectorIndex) const { return sectorIndex < SECTOR_COUNT ? sectorErases[sectorIndex] : 0; }
+
+private:
+    uint8_t memory[REGION_SIZE];
+    int sectorErases[SECTOR_COUNT];
+    bool powered;
+    int cutAfterBytes;
+    int cutEraseAfterBytes;
+};
+
+#endif // FAKE_FLASH_H
@@ -0,0 +1,165 @@
+#ifndef FAKE_IMU_H
+#define FAKE_IMU_H
+
+#include <math.h>
+#include "ImuBackend.h"
+
+/**
+ * Scripted ImuBackend for the sampling tests.
+ *
+ * push() plays the sensor producing a sample (in g). With the FIFO enabled samples
+ * queue up to FIFO_CAPACITY (continuous mode: the oldest is overwritten and
+ * an overrun is flagged); without it only the newest sample is held, like
+ * the output registers. Bus transactions are counted the way the
+ * LSM6DSBackend performs them.
+ *
+ * With hasGyro, readGyro() returns the angular rate set in gyro.
+ * With hasLowPower, setLowPower() is accepted and recorded; the test decides
+ * how often to push() at either rate.
+ * With hasEvents, raise() plays the 6D/wake-up engines latching an event on
+ * the interrupt line until takeEvents() reads the sources; with hasTaps as
+ * well, enableTaps() is accepted and raise() can latch tap events too.
+ */
+class FakeImu : public ImuBackend {
+public:
+    static const int FIFO_CAPACITY = 64;
+
+    bool hasFifo = true;
+    bool fifoEnabled = false;
+    uint16_t watermark = 0;
+    uint16_t rateHz = 0;
+    int burstReads = 0;
+    bool hasEvents = false;
+    bool eventsEnabled = false;
+    uint16_t wakeThresholdMg = 0;
+    int eventReads = 0;
+    bool hasTaps = false;
+    bool tapsEnabled = false;
+    uint16_t tapThresholdMg = 0;
+    bool hasGyro = false;
+    GyroSample gyro = {0, 0, 0};   // Angular rate returned by readGyro(), in dps
+    bool hasLowPower = false;
+    bool lowPower = false;
+    uint16_t lowPowerRateHz = 0;
+    int rateChanges = 0;
+
+    bool begin() override {
+        busTransactions++;
+        fifoEnabled = false;
+        eventsEnabled = false;
+        tapsEnabled = false;
+        lowPower = false;
+        count = 0;
+        return true;
+    }
+
+    bool enableFifo(uint16_t fifoWatermark, uint16_t fifoRateHz) override {
+        if (!hasFifo) return false;
+        busTransactions += 5;   // Bypass, watermark (2), rate, mode
+        fifoEnabled = true;
+        watermark = fifoWatermark;
+        rateHz = fifoRateHz;
+        count = 0;
+        overrun = false;
+        return true;
+    }
+
+    void push(float x, float y, float z) {
+        if (!fifoEnabled) {
+            head = 0;
+            count = 0;
+        } else if (count == FIFO_CAPACITY) {
+            head = (head + 1) % FIFO_CAPACITY;
+            count--;
+            overrun = true;
+        }
+        AccelSample& sample = fifo[(head + count) % FIFO_CAPACITY];
+        sample.x = (int16_t)lroundf(x * 1000.0f);
+        sample.y = (int16_t)lroundf(y * 1000.0f);
+        sample.z = (int16_t)lroundf(z * 1000.0f);
+        count++;
+    }
+
+    int available() override {
+        busTransactions++;
+        return count;
+    }
+
+    int readSamples(AccelSample* samples, int maxSamples) override {
+        int n = maxSamples < count ? maxSamples : count;
+        if (n <= 0) return 0;
+        busTransactions++;
+        burstReads++;
+        for (int i = 0; i < n; i++) {
+            samples[i] = fifo[head];
+            head = (head + 1) % FIFO_CAPACITY;
+        }
+        count -= n;
+        return n;
+    }
+
+    bool takeOverrun() override {
+        bool result = overrun;
+        overrun = false;
+        return result;
+    }
+
+    bool enableEvents(uint16_t thresholdMg) override {
+        if (!hasEvents) return false;
+        busTransactions += 7;   // Latch, enable, 6D, threshold, duration, routing, clear
+        eventsEnabled = true;
+        wakeThresholdMg = thresholdMg;
+        latched = 0;
+        return true;
+    }
+
+    bool enableTaps(uint16_t thresholdMg) override {
+        if (!hasTaps || !eventsEnabled) return false;
+        busTransactions += 11;   // Three reads, then axes, thresholds, timing, mode, rate and routing
+        tapsEnabled = true;
+        tapThresholdMg = thresholdMg;
+        return true;
+    }
+
+    void raise(uint8_t events) {
+        if (!tapsEnabled) events &= ~(IMU_EVENT_SINGLE_TAP | IMU_EVENT_DOUBLE_TAP);
+        if (eventsEnabled) latched |= events;
+    }
+
+    bool eventPending() override { return latched != 0; }
+
+    uint8_t takeEvents() override {
+        busTransactions++;
+        eventReads++;
+        uint8_t events = latched;
+        latched = 0;
+        return events;
+    }
+
+    bool readGyro(GyroSample& rate) override {
+        if (!hasGyro) return false;
+        busTransactions++;
+        rate = gyro;
+        return true;
+    }
+
+    bool setLowPower(bool enabled, uint16_t rate) override {
+        if (!hasLowPower) return false;
+        busTransactions += fifoEnabled ? 5 : 4;   // CTRL6_C read and write, CTRL1_XL, CTRL2_G, FIFO rate
+        if (enabled != lowPower) rateChanges++;
+        lowPower = enabled;
+        lowPowerRateHz = rate;
+        return true;
+    }
+
+    int queued() const { return count; }
+
+private:
+    AccelSample fifo[FIFO_CAPACITY];
+    int head = 0;
+    int count = 0;
+    bool overrun = false;
+    uint8_t latched = 0;
+};
+
+#endif // FAKE_IMU_H
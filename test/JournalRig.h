@@ -0,0 +1,59 @@
+#ifndef JOURNAL_RIG_H
+#define JOURNAL_RIG_H
+
+#include <Arduino.h>
+#include "EventJournal.h"
+#include "JournalReplayer.h"
+#include "TogglAPI.h"
+#include "OrientationDetector.h"
+#include "Config.h"
+#include "FakeFlash.h"
+#include "MockTogglServer.h"
+
+static const int RIG_PROJECT_IDS[FACE_COUNT] = {0, 101, 102, 103, 104, 105};
+
+/**
+ * The replay path as main.cpp wires it: journal on fake flash -> replayer ->
+ * TogglAPI -> mock server.
+ *
+ * Time is a virtual clock, nowMs, handed to every poll() and read by the mock
+ * for its Date header; run() advances it a main-loop tick at a time without
+ * delay(), so an hour offline replays in milliseconds on the board too.
+ */
+struct JournalRig {
+    FakeFlash<4096, 1024> flash;
+    MockTogglServer server;
+    TogglAPI toggl;
+    EventJournal journal;
+    JournalReplayer replayer;
+    unsigned long nowMs = 0;
+
+    JournalRig() : toggl(&server), journal(flash), replayer(journal, toggl) {
+        server.clock = &nowMs;
+        toggl.setCredentials("test-token", "123456");
+        toggl.setProjectIds(RIG_PROJECT_IDS);
+        journal.begin();
+    }
+
+    // Same journaling as handleOrientationChange() in main.cpp, at atMs
+    void commit(Orientation orientation, unsigned long atMs) {
+        uint32_t epoch = toggl.epochAtMillis(atMs);
+        if (journal.isSegmentOpen()) journal.recordStop(epoch, atMs);
+        if (orientation != FACE_UP && orientation != UNKNOWN) journal.recordStart(orientation, epoch, atMs);
+    }
+    void flip(Orientation orientation) { commit(orientation, nowMs); }
+
+    // One pass of the main loop, then the loop delay
+    void tick() {
+        replayer.poll(server.online, nowMs);
+        toggl.poll(nowMs);
+        nowMs += Config::MAIN_LOOP_DELAY;
+    }
+
+    void run(unsigned long durationMs) {
+        unsigned long start = nowMs;
+        while (nowMs - start < durationMs) tick();
+    }
+};
+
+#endif // JOURNAL_RIG_H
@@ -0,0 +1,294 @@
+#ifndef MOCK_TOGGL_SERVER_H
+#define MOCK_TOGGL_SERVER_H
+
+#include <Arduino.h>
+#include <Client.h>
+#include <stdio.h>
+#include "TimeUtils.h"
+
+/**
+ * In-process stand-in for the Toggl v9 time entry API, wired in as the
+ * TogglAPI transport.
+ *
+ * Parses each HTTP request written to it, keeps a list of time entries and
+ * answers like Toggl does, including a Date header derived from millis(), or
+ * from the test's virtual clock when one is set.
+ * Setting online = false makes connect() and writes fail, as when WiFi drops;
+ * stopsRunningOnStart = false models a server that leaves the previous entry
+ * running when a new one is started. loseResponses and loseRequests drop
+ * traffic after the request was sent, so the client only sees a timeout.
+ */
+class MockTogglServer : public Client {
+public:
+    struct Entry {
+        long id;
+        long projectId;
+        String description;
+        uint32_t start;
+        uint32_t stop;
+        bool running;
+    };
+    static const int MAX_ENTRIES = 64;
+
+    // Behaviour knobs
+    bool online = true;
+    uint32_t epochAtBoot = 1790000000UL;  // Server time when millis() == 0
+    int failStatus = 0;                   // Answer the next failCount requests with this status
+    int failCount = 0;
+    uint32_t retryAfterSeconds = 0;       // Sent as Retry-After with failStatus answers
+    bool stopsRunningOnStart = true;      // Toggl's behaviour for a new running entry
+    int loseResponses = 0;                // Apply the next requests but never answer them
+    int loseRequests = 0;                 // Swallow the next requests unprocessed
+    const unsigned long* clock = nullptr; // Virtual clock read instead of millis()
+
+    // Recorded traffic
+    int requestCount = 0;
+    int connectCount = 0;
+    String lastMethod;
+    String lastPath;
+
+    Entry entries[MAX_ENTRIES];
+    int entryCount = 0;
+
+    MockTogglServer() : isConnected(false), outPos(0), nextId(1000) {}
+
+    uint32_t now() const { return epochAtBoot + (clock ? *clock : millis()) / 1000; }
+
+    Entry* runningEntry() {
+        for (int i = 0; i < entryCount; i++) {
+            if (entries[i].running) return &entries[i];
+        }
+        return nullptr;
+    }
+
+    int runningCount() const {
+        int count = 0;
+        for (int i = 0; i < entryCount; i++) {
+            if (entries[i].running) count++;
+        }
+        return count;
+    }
+
+    // True if any two entries cover the same second (running entries extend to now())
+    bool hasOverlaps() const {
+        for (int i = 0; i < entryCount; i++) {
+            for (int j = i + 1; j < entryCount; j++) {
+                uint32_t endI = entries[i].running ? now() : entries[i].stop;
+                uint32_t endJ = entries[j].running ? now() : entries[j].stop;
+                if (entries[i].start < endJ && entries[j].start < endI) return true;
+            }
+        }
+        return false;
+    }
+
+    Entry* addRunningEntry(long projectId, const String& description, uint32_t start) {
+        if (entryCount >= MAX_ENTRIES) return nullptr;
+        Entry& entry = entries[entryCount++];
+        entry.id = nextId++;
+        entry.projectId = projectId;
+        entry.description = description;
+        entry.start = start;
+        entry.stop = 0;
+        entry.running = true;
+        return &entry;
+    }
+
+    int connect(IPAddress ip, uint16_t port) override { return connect("ip", port); }
+    int connect(const char* host, uint16_t port) override {
+        if (!online) return 0;
+        connectCount++;
+        isConnected = true;
+        inbox = "";
+        return 1;
+    }
+
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override {
+        if (!isConnected || !online) {
+            isConnected = false;
+            return 0;
+        }
+        inbox.concat((const char*)buf, size);
+        processRequest();
+        return size;
+    }
+
+    int available() override { return (int)(outbox.length() - outPos); }
+    int read() override {
+        if (available() <= 0) return -1;
+        return (uint8_t)outbox[outPos++];
+    }
+    int read(uint8_t* buf, size_t size) override {
+        size_t n = 0;
+        while (n < size && available() > 0) buf[n++] = (uint8_t)read();
+        return (int)n;
+    }
+    int peek() override { return available() > 0 ? (uint8_t)outbox[outPos] : -1; }
+    void flush() override {}
+    void stop() override {
+        isConnected = false;
+        inbox = "";
+        outbox = "";
+        outPos = 0;
+    }
+    uint8_t connected() override { return (isConnected && online) || available() > 0; }
+    operator bool() override { return isConnected; }
+
+private:
+    bool isConnected;
+    String inbox;
+    String outbox;
+    unsigned int outPos;
+    long nextId;
+
+    void processRequest() {
+        int headerEnd = inbox.indexOf("\r\n\r\n");
+        if (headerEnd < 0) return;
+
+        long contentLength = 0;
+        int lengthAt = inbox.indexOf("Content-Length: ");
+        if (lengthAt >= 0 && lengthAt < headerEnd) {
+            contentLength = inbox.substring(lengthAt + 16).toInt();
+        }
+        unsigned int requestEnd = headerEnd + 4 + contentLength;
+        if (inbox.length() < requestEnd) return;
+
+        String requestLine = inbox.substring(0, inbox.indexOf("\r\n"));
+        String body = inbox.substring(headerEnd + 4, requestEnd);
+        inbox = inbox.substring(requestEnd);
+
+        int space = requestLine.indexOf(' ');
+        lastMethod = requestLine.substring(0, space);
+        String rest = requestLine.substring(space + 1);
+        lastPath = rest.substring(0, rest.indexOf(' '));
+        requestCount++;
+
+        if (loseRequests > 0) {
+            loseRequests--;
+            return;
+        }
+        if (failCount > 0) {
+            failCount--;
+            respond(failStatus, "{}");
+            return;
+        }
+        route(lastMethod, lastPath, body);
+        if (loseResponses > 0) {
+            loseResponses--;
+            outbox = outbox.substring(0, outPos);
+        }
+    }
+
+    void route(const String& method, const String& path, const String& body) {
+        if (method == "POST" && path == "/api/v9/time_entries") {
+            createEntry(body);
+        } else if (method == "GET" && path == "/api/v9/me/time_entries/current") {
+            Entry* running = runningEntry();
+            respond(200, running ? entryJson(*running) : String("null"));
+        } else if (method == "GET" && path.startsWith("/api/v9/me/time_entries/")) {
+            Entry* entry = findEntry(path.substring(24).toInt());
+            if (entry) {
+                respond(200, entryJson(*entry));
+            } else {
+                respond(404, "\"Time entry not found\"");
+            }
+        } else if (path.indexOf("/time_entries/") >= 0 && (method == "PATCH" || method == "PUT")) {
+            String tail = path.substring(path.indexOf("/time_entries/") + 14);
+            Entry* entry = findEntry(tail.toInt());
+            if (!entry) {
+                respond(404, "\"Time entry not found\"");
+                return;
+            }
+            if (method == "PATCH" && tail.endsWith("/stop")) {
+                if (entry->running) closeEntry(*entry, now());
+            } else {
+                String stop = jsonField(body, "stop");
+                if (stop.length() > 0) closeEntry(*entry, TimeUtils::parseIso8601(stop.c_str()));
+            }
+            respond(200, entryJson(*entry));
+        } else {
+            respond(404, "\"Not found\"");
+        }
+    }
+
+    void createEntry(const String& body) {
+        String start = jsonField(body, "start");
+        uint32_t startEpoch = start.length() > 0 ? TimeUtils::parseIso8601(start.c_str()) : now();
+        long duration = jsonField(body, "duration").toInt();
+
+        // Toggl stops the running entry when a new running entry is created
+        Entry* running = runningEntry();
+        if (duration < 0 && running && stopsRunningOnStart) closeEntry(*running, startEpoch);
+
+        Entry* entry = addRunningEntry(jsonField(body, "project_id").toInt(), jsonField(body, "description"), startEpoch);
+        if (!entry) {
+            respond(500, "{}");
+            return;
+        }
+        if (duration >= 0) closeEntry(*entry, startEpoch + duration);
+        respond(200, entryJson(*entry));
+    }
+
+    static void closeEntry(Entry& entry, uint32_t stop) {
+        entry.stop = stop;
+        entry.running = false;
+    }
+
+    Entry* findEntry(long id) {
+        for (int i = 0; i < entryCount; i++) {
+            if (entries[i].id == id) return &entries[i];
+        }
+        return nullptr;
+    }
+
+    static String jsonField(const String& body, const char* key) {
+        String pattern = String("\"") + key + "\":";
+        int at = body.indexOf(pattern);
+        if (at < 0) return "";
+        unsigned int i = at + pattern.length();
+        String value;
+        if (body[i] == '"') {
+            for (i++; i < body.length() && body[i] != '"'; i++) value += body[i];
+        } else {
+            for (; i < body.length() && body[i] != ',' && body[i] != '}'; i++) value += body[i];
+        }
+        return value;
+    }
+
+    String entryJson(const Entry& entry) const {
+        char start[TimeUtils::ISO8601_BUFFER_SIZE];
+        TimeUtils::formatIso8601(entry.start, start);
+        long duration = entry.running ? -1 : (long)(entry.stop - entry.start);
+        return "{\"id\":" + String(entry.id) + ",\"project_id\":" + String(entry.projectId) +
+               ",\"description\":\"" + entry.description + "\",\"start\":\"" + start +
+               "\",\"duration\":" + String(duration) + "}";
+    }
+
+    void respond(int status, const String& body) {
+        // RFC 7231 date built from the ISO form: "Fri, 16 Oct 2026 08:12:31 GMT"
+        static const char* MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                       "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+        static const char* DAYS[] = {"Thu", "Fri", "Sat", "Sun", "Mon", "Tue", "Wed"};
+        char iso[TimeUtils::ISO8601_BUFFER_SIZE];
+        uint32_t epoch = now();
+        TimeUtils::formatIso8601(epoch, iso);
+        int year, month, day, hour, minute, second;
+        sscanf(iso, "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second);
+        char date[40];
+        snprintf(date, sizeof(date), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                 DAYS[(epoch / 86400UL) % 7], day, MONTHS[month - 1], year, hour, minute, second);
+
+        outbox = outbox.substring(outPos);
+        outPos = 0;
+        outbox += "HTTP/1.1 " + String(status) + (status == 200 ? " OK" : " Error") + "\r\n";
+        outbox += String("Date: ") + date + "\r\n";
+        if (retryAfterSeconds > 0 && status == failStatus) {
+            outbox += "Retry-After: " + String(retryAfterSeconds) + "\r\n";
+        }
+        outbox += "Content-Type: application/json\r\n";
+        outbox += "Content-Length: " + String(body.length()) + "\r\n\r\n";
+        outbox += body;
+    }
+};
+
+#endif // MOCK_TOGGL_SERVER_H
@@ -0,0 +1,49 @@
+#ifndef RECORDING_LED_H
+#define RECORDING_LED_H
+
+#include <Arduino.h>
+#include "LedOutput.h"
+#include "LedAnimator.h"
+
+/**
+ * LedOutput that records what the LED was told to show, for the LED tests.
+ *
+ * Each channel write is kept with millis() at the time, up to MAX_WRITES,
+ * and writes counts them all: on the board each is one bus command. The
+ * PWM levels shown now are in current. With monochrome set it stands in
+ * for the Nano 33 IoT's built-in LED, which has only channel 0.
+ */
+class RecordingLed : public LedOutput {
+public:
+    static const int MAX_WRITES = 512;
+
+    struct Write {
+        unsigned long atMs;
+        uint8_t channel;
+        uint8_t level;
+    };
+
+    bool monochrome = false;
+    int writes = 0;
+    Write log[MAX_WRITES];
+    LedColor current = {0, 0, 0};
+
+    bool begin() override { return true; }
+
+    void writeChannel(uint8_t channel, uint8_t level) override {
+        if (channel == LED_CHANNEL_RED) current.red = level;
+        if (channel == LED_CHANNEL_GREEN) current.green = level;
+        if (channel == LED_CHANNEL_BLUE) current.blue = level;
+        if (writes < MAX_WRITES) log[writes] = {millis(), channel, level};
+        writes++;
+    }
+
+    int getChannels() const override { return monochrome ? 1 : 3; }
+
+    uint8_t brightness() const {
+        uint8_t level = current.red > current.green ? current.red : current.green;
+        return level > current.blue ? level : current.blue;
+    }
+};
+
+#endif // RECORDING_LED_H
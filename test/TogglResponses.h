@@ -0,0 +1,49 @@
+#ifndef TOGGL_RESPONSES_H
+#define TOGGL_RESPONSES_H
+
+// Toggl Track v9 response bodies in the shape the API returns them, with
+// ids and names anonymised. Shared by the parser tests and tools/json_bench.
+
+// POST /api/v9/time_entries (running entry)
+static const char TOGGL_START_RESPONSE[] =
+    "{\"id\":3612345678,\"workspace_id\":7654321,\"project_id\":212267805,\"task_id\":null,"
+    "\"billable\":false,\"start\":\"2026-10-16T08:12:31+00:00\",\"stop\":null,\"duration\":-1,"
+    "\"description\":\"Face Down Project\",\"tags\":[],\"tag_ids\":[],\"duronly\":true,"
+    "\"at\":\"2026-10-16T08:12:31+00:00\",\"server_deleted_at\":null,\"user_id\":9876543,"
+    "\"uid\":9876543,\"wid\":7654321,\"pid\":212267805,\"tid\":null,"
+    "\"shared_with\":null,\"permissions\":null,\"expense_ids\":[],"
+    "\"client_name\":\"Internal\",\"project_name\":\"Deep Work\",\"project_color\":\"#c9806b\","
+    "\"project_active\":true,\"project_billable\":false,\"user_name\":null,\"user_avatar_url\":null}";
+
+// PATCH /api/v9/workspaces/{wid}/time_entries/{id}/stop
+static const char TOGGL_STOP_RESPONSE[] =
+    "{\"id\":3612345678,\"workspace_id\":7654321,\"project_id\":212267805,\"task_id\":null,"
+    "\"billable\":false,\"start\":\"2026-10-16T08:12:31+00:00\",\"stop\":\"2026-10-16T09:47:02+00:00\","
+    "\"duration\":5671,\"description\":\"Face Down Project\",\"tags\":[\"focus\",\"desk\"],"
+    "\"tag_ids\":[18273645,18273646],\"duronly\":true,\"at\":\"2026-10-16T09:47:02+00:00\","
+    "\"server_deleted_at\":null,\"user_id\":9876543,\"uid\":9876543,\"wid\":7654321,"
+    "\"pid\":212267805,\"tid\":null,\"shared_with\":null,\"permissions\":null,\"expense_ids\":[],"
+    "\"client_name\":\"Internal\",\"project_name\":\"Deep Work\",\"project_color\":\"#c9806b\","
+    "\"project_active\":true,\"project_billable\":false,\"user_name\":null,\"user_avatar_url\":null}";
+
+// GET /api/v9/me/time_entries/current, pretty-printed with nested objects and escapes
+static const char TOGGL_CURRENT_RESPONSE[] =
+    "{\n"
+    "  \"at\": \"2026-10-16T10:01:44+00:00\",\n"
+    "  \"billable\": false,\n"
+    "  \"description\": \"Review \\\"Q4\\\" plan \\u2013 draft\",\n"
+    "  \"duration\": -1790000000,\n"
+    "  \"duronly\": true,\n"
+    "  \"shared_with\": [{\"user_id\": 1, \"user_name\": \"a}b\"}],\n"
+    "  \"id\": 3612349999,\n"
+    "  \"pid\": 212267804,\n"
+    "  \"project_id\": 212267804,\n"
+    "  \"start\": \"2026-10-16T10:01:44+00:00\",\n"
+    "  \"tags\": null,\n"
+    "  \"workspace_id\": 7654321\n"
+    "}";
+
+// GET /api/v9/me/time_entries/current with nothing running
+static const char TOGGL_NO_CURRENT_RESPONSE[] = "null";
+
+#endif // TOGGL_RESPONSES_H
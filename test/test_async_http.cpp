@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "AsyncHttpClient.h"
+#include "TogglAPI.h"
+#include "SystemDiagnostics.h"
+#include "Config.h"
+#include "FakeClient.h"
+
+static const char* START_RESPONSE_BODY =
+    "{\"id\":3456789012,\"workspace_id\":123456,\"project_id\":111,"
+    "\"description\":\"Face Down Project\",\"duration\":-1}";
+
+// Drive a request to completion, counting poll() calls
+static int pollUntilDone(AsyncHttpClient& http, int maxPolls) {
+    int polls = 0;
+    while (http.isBusy() && polls < maxPolls) {
+        http.poll();
+        polls++;
+        delay(1);
+    }
+    return polls;
+}
+
+void test_async_http_content_length_response(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    TEST_ASSERT_TRUE(http.begin("POST", "/api/v9/time_entries"));
+    http.addHeader("Content-Type", "application/json");
+    http.setBody("{}");
+    TEST_ASSERT_TRUE(http.submit());
+
+    pollUntilDone(http, 1000);
+    TEST_ASSERT_TRUE_MESSAGE(http.isComplete(), "Request should complete");
+    TEST_ASSERT_EQUAL_INT(200, http.getStatusCode());
+    TEST_ASSERT_EQUAL_STRING(START_RESPONSE_BODY, http.getResponseBody().c_str());
+    TEST_ASSERT_TRUE_MESSAGE(fake.written.indexOf("Connection: keep-alive") >= 0, "Request should ask for keep-alive");
+    TEST_ASSERT_TRUE_MESSAGE(fake.written.indexOf("Content-Length: 2") >= 0, "Request should carry Content-Length");
+}
+
+void test_async_http_chunked_response(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY, true));
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.begin("PATCH", "/api/v9/workspaces/1/time_entries/2/stop");
+    http.submit();
+
+    pollUntilDone(http, 1000);
+    TEST_ASSERT_TRUE_MESSAGE(http.isComplete(), "Chunked request should complete");
+    TEST_ASSERT_EQUAL_STRING(START_RESPONSE_BODY, http.getResponseBody().c_str());
+}
+
+void test_async_http_reads_incrementally(void) {
+    ScriptedClient fake;
+    fake.bytesPerMs = 1; // Response trickles in over ~200 ms
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.begin("POST", "/api/v9/time_entries");
+    http.submit();
+
+    int polls = pollUntilDone(http, 5000);
+    TEST_ASSERT_TRUE_MESSAGE(http.isComplete(), "Slow request should complete");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(10, polls, "Slow response should take many short polls");
+    TEST_ASSERT_EQUAL_INT(200, http.getStatusCode());
+}
+
+void test_async_http_times_out(void) {
+    ScriptedClient fake; // No response queued
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.setTimeout(100);
+    http.begin("POST", "/api/v9/time_entries");
+    http.submit();
+
+    pollUntilDone(http, 1000);
+    TEST_ASSERT_EQUAL_INT(AsyncHttpClient::FAILED, http.getState());
+    TEST_ASSERT_EQUAL_INT(AsyncHttpClient::ERROR_TIMED_OUT, http.getStatusCode());
+}
+
+void test_async_http_reuses_and_reconnects(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, "{}"));
+    fake.queueResponse(httpResponse(200, "{}"));
+    fake.queueResponse(httpResponse(200, "{}"));
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.begin("GET", "/a");
+    http.submit();
+    pollUntilDone(http, 100);
+    TEST_ASSERT_FALSE_MESSAGE(http.wasConnectionReused(), "First request needs a handshake");
+
+    http.begin("GET", "/b");
+    http.submit();
+    pollUntilDone(http, 100);
+    TEST_ASSERT_TRUE_MESSAGE(http.wasConnectionReused(), "Second request should reuse the socket");
+    TEST_ASSERT_EQUAL_INT(1, fake.connectCount);
+
+    // Server silently closed the kept-alive socket
+    fake.staleSocket = true;
+    http.begin("GET", "/c");
+    http.submit();
+    pollUntilDone(http, 100);
+    TEST_ASSERT_TRUE_MESSAGE(http.isComplete(), "Stale socket should be replaced transparently");
+    TEST_ASSERT_TRUE(http.hadStaleReconnect());
+    TEST_ASSERT_EQUAL_INT(2, fake.connectCount);
+}
+
+void test_async_http_sends_request_in_one_write(void) {
+    // Body longer than a read budget: still one write, straight from the request buffer
+    String body = "{\"description\":\"";
+    while (body.length() < 600) body += "x";
+    body += "\"}";
+
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.begin("POST", "/api/v9/time_entries");
+    http.addHeader("Content-Type", "application/json");
+    http.setBody(body.c_str());
+    TEST_ASSERT_TRUE(http.submit());
+    pollUntilDone(http, 100);
+
+    TEST_ASSERT_TRUE(http.isComplete());
+    TEST_ASSERT_EQUAL_INT(1, fake.writeCalls);
+    TEST_ASSERT_TRUE(fake.written.indexOf(body) > 0);
+    TEST_ASSERT_EQUAL_UINT(1, http.getRequestWrites());
+    TEST_ASSERT_EQUAL_UINT(fake.written.length(), http.getFlushBytes());
+
+    // A Toggl start is a single write as well, and shows up in the diagnostics
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+    TogglAPI toggl(&fake);
+    SystemDiagnostics diagnostics;
+    toggl.setCredentials("test-token", "123456");
+    toggl.setDiagnostics(&diagnostics);
+    fake.writeCalls = 0;
+    TEST_ASSERT_TRUE(toggl.startTimeEntry(1, "Deep Work"));
+    TEST_ASSERT_EQUAL_INT(1, fake.writeCalls);
+    TEST_ASSERT_EQUAL_UINT32(1, diagnostics.getRequestsSent());
+    TEST_ASSERT_EQUAL_UINT(1, diagnostics.getLastRequestWrites());
+    TEST_ASSERT_EQUAL_UINT32(1, diagnostics.getAverageWritesPerRequest());
+    TEST_ASSERT_TRUE(diagnostics.getAverageFlushBytes() > 100);
+}
+
+// Loop period must stay at MAIN_LOOP_DELAY while a slow request is in flight
+void test_toggl_loop_period_with_slow_server(void) {
+    ScriptedClient fake;
+    fake.bytesPerMs = 1;
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+
+    TogglAPI toggl(&fake);
+    toggl.setCredentials("test_token_12345678901234567890", "123456");
+    TEST_ASSERT_TRUE(toggl.requestStart(1, "Face Down Project"));
+
+    unsigned long maxPeriod = 0;
+    int iterations = 0;
+    while (toggl.isBusy() && iterations < 200) {
+        unsigned long loopStart = millis();
+        toggl.poll();
+        delay(Config::MAIN_LOOP_DELAY);
+        unsigned long period = millis() - loopStart;
+        if (period > maxPeriod) maxPeriod = period;
+        iterations++;
+    }
+
+    TEST_ASSERT_FALSE_MESSAGE(toggl.isBusy(), "Start request should finish");
+    TEST_ASSERT_GREATER_THAN_MESSAGE(1, iterations, "Request should span several loop iterations");
+    TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(Config::MAIN_LOOP_DELAY + 5, maxPeriod, "Loop period should not stretch");
+    TEST_ASSERT_EQUAL_STRING("3456789012", toggl.getCurrentEntryId().c_str());
+}
+
+static int completedOperations = 0;
+static TogglOperation lastCompletedOperation = TogglOperation::NONE;
+
+static void recordCompletion(TogglOperation operation, bool success, int statusCode) {
+    completedOperations++;
+    lastCompletedOperation = operation;
+}
+
+void test_toggl_queue_runs_stop_after_start(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, START_RESPONSE_BODY));
+    fake.queueResponse(httpResponse(200, "{}"));
+
+    TogglAPI toggl(&fake);
+    toggl.setCredentials("test_token_12345678901234567890", "123456");
+    toggl.setCompletionCallback(recordCompletion);
+    completedOperations = 0;
+
+    // Stop queued while the start is still in flight resolves the new entry ID
+    toggl.requestStart(1, "Face Down Project");
+    toggl.requestStop();
+    for (int i = 0; i < 100 && toggl.isBusy(); i++) {
+        toggl.poll();
+    }
+
+    TEST_ASSERT_EQUAL_INT(2, completedOperations);
+    TEST_ASSERT_TRUE(lastCompletedOperation == TogglOperation::STOP);
+    TEST_ASSERT_TRUE_MESSAGE(fake.written.indexOf("/time_entries/3456789012/stop") >= 0, "Stop should target the started entry");
+    TEST_ASSERT_EQUAL_INT(1, (int)toggl.getStopConnectionStats().reusedConnections);
+}
+
+// Test suite runner
+void runAsyncHttpTests(void) {
+    RUN_TEST(test_async_http_content_length_response);
+    RUN_TEST(test_async_http_chunked_response);
+    RUN_TEST(test_async_http_reads_incrementally);
+    RUN_TEST(test_async_http_times_out);
+    RUN_TEST(test_async_http_reuses_and_reconnects);
+    RUN_TEST(test_async_http_sends_request_in_one_write);
+    RUN_TEST(test_toggl_loop_period_with_slow_server);
+    RUN_TEST(test_toggl_queue_runs_stop_after_start);
+}
@@ -1,6 +1,8 @@
 #include <unity.h>
 #include <Arduino.h>
 #include "ConfigStorage.h"
+#include "KvStore.h"
+#include "FakeFlash.h"
 
 // Test fixtures
 ConfigStorage* storage;
@@ -95,6 +97,194 @@ void test_backup_restore(void) {
     TEST_ASSERT_EQUAL_STRING_MESSAGE(ssid.c_str(), storage->getWifiSSID().c_str(), "SSID should be restored");
 }
 
+// Flash-backed storage: two 4 KB slots of 1 KB sectors, as Config::CONFIG_FLASH_SIZE
+static const int FLASH_PROJECTS_A[] = {0, 100, 200, 300, 400, 500};
+static const int FLASH_PROJECTS_B[] = {0, 901, 902, 903, 904, 905};
+
+static bool saveA(ConfigStorage& store) {
+    return store.saveConfiguration("NetworkA", "PasswordA123", "token_a_1234567890abcdef", "111111", FLASH_PROJECTS_A);
+}
+
+static bool saveB(ConfigStorage& store) {
+    return store.saveConfiguration("NetworkB", "PasswordB123", "token_b_1234567890abcdef", "222222", FLASH_PROJECTS_B);
+}
+
+void test_config_storage_survives_power_cycle(void) {
+    static FakeFlash<8192, 1024> flash;
+    static FakeFlash<2048, 256> stateFlash;
+    {
+        KvStore state(stateFlash);
+        TEST_ASSERT_TRUE(state.begin());
+        ConfigStorage first(flash, &state);
+        TEST_ASSERT_TRUE(first.begin());
+        TEST_ASSERT_FALSE(first.loadConfiguration());
+        TEST_ASSERT_TRUE(saveA(first));
+        ImuCalibrationData calibration = {};
+        calibration.matrix[0] = calibration.matrix[4] = calibration.matrix[8] = 16384;
+        calibration.bias[2] = -12;
+        calibration.valid = 1;
+        TEST_ASSERT_TRUE(first.saveCalibration(calibration));
+    }
+
+    KvStore state(stateFlash);
+    TEST_ASSERT_TRUE(state.begin());
+    ConfigStorage rebooted(flash, &state);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_TRUE_MESSAGE(rebooted.hasCalibration(), "Calibration should be there right after begin()");
+    TEST_ASSERT_EQUAL_INT16(-12, rebooted.getCalibration().bias[2]);
+    TEST_ASSERT_TRUE(rebooted.loadConfiguration());
+    TEST_ASSERT_TRUE(rebooted.hasValidConfiguration());
+    TEST_ASSERT_EQUAL_STRING("NetworkA", rebooted.getWifiSSID().c_str());
+    TEST_ASSERT_EQUAL_STRING("token_a_1234567890abcdef", rebooted.getTogglToken().c_str());
+    TEST_ASSERT_EQUAL_INT(500, rebooted.getProjectIds()[5]);
+    // The calibration went to the state store: one save, one slot written
+    TEST_ASSERT_EQUAL_UINT32(1, rebooted.getSlotSequence());
+
+    // Clearing it appends a record and leaves the configuration alone
+    int erases = flash.eraseCalls;
+    rebooted.clearCalibration();
+    TEST_ASSERT_EQUAL_INT(erases, flash.eraseCalls);
+    ConfigStorage cleared(flash, &state);
+    TEST_ASSERT_TRUE(cleared.begin());
+    TEST_ASSERT_FALSE(cleared.hasCalibration());
+    TEST_ASSERT_TRUE(cleared.loadConfiguration());
+}
+
+void test_config_storage_alternates_slots(void) {
+    static FakeFlash<8192, 1024> flash;
+    ConfigStorage store(flash);
+    store.begin();
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(i % 2 ? saveB(store) : saveA(store));
+        TEST_ASSERT_EQUAL_INT(i % 2, store.getActiveSlot());
+        TEST_ASSERT_EQUAL_UINT32(i + 1, store.getSlotSequence());
+    }
+
+    // Boot cost does not grow with the number of saves: two headers and one config
+    ConfigStorage rebooted(flash);
+    int readsBefore = flash.readCalls;
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_INT(3, flash.readCalls - readsBefore);
+    TEST_ASSERT_EQUAL_INT(0, rebooted.getActiveSlot());
+    TEST_ASSERT_EQUAL_STRING("NetworkA", rebooted.getWifiSSID().c_str());
+
+    // A newest copy that fails its CRC falls back to the other slot
+    flash.raw()[sizeof(ConfigSlotHeader) + 10] ^= 0x01;
+    ConfigStorage corrupted(flash);
+    TEST_ASSERT_TRUE(corrupted.begin());
+    TEST_ASSERT_EQUAL_INT(1, corrupted.getActiveSlot());
+    TEST_ASSERT_EQUAL_STRING("NetworkB", corrupted.getWifiSSID().c_str());
+    TEST_ASSERT_EQUAL_UINT32(6, corrupted.getSlotSequence());
+}
+
+void test_config_storage_power_cut_keeps_a_copy(void) {
+    // Static: two 8 KB fakes are too much for a device test's stack
+    static FakeFlash<8192, 1024> stored;
+    static FakeFlash<8192, 1024> flash;
+    {
+        ConfigStorage store(stored);
+        store.begin();
+        saveA(store);
+        saveB(store);
+        saveA(store);           // A in slot 0, B in slot 1; the next save goes to slot 1
+    }
+
+    // Cut the power at every byte of the next save, then part way through its first erase
+    const int bytes = sizeof(StoredConfig) + sizeof(ConfigSlotHeader);
+    const int eraseCuts[] = {0, 8, 300, 1000};
+    for (int run = 0; run < bytes + 4; run++) {
+        memcpy(flash.raw(), stored.raw(), 8192);
+        flash.restorePower();
+        ConfigStorage store(flash);
+        store.begin();
+        if (run < bytes) {
+            flash.cutPowerAfter(run);
+        } else {
+            flash.cutPowerDuringErase(eraseCuts[run - bytes]);
+        }
+        TEST_ASSERT_FALSE(saveB(store));
+        flash.restorePower();
+
+        // The torn slot is passed over; the old copy is loaded whole
+        ConfigStorage rebooted(flash);
+        rebooted.begin();
+        TEST_ASSERT_TRUE_MESSAGE(rebooted.loadConfiguration(), "A copy must survive any power cut");
+        TEST_ASSERT_EQUAL_INT(0, rebooted.getActiveSlot());
+        TEST_ASSERT_EQUAL_STRING("NetworkA", rebooted.getWifiSSID().c_str());
+        TEST_ASSERT_EQUAL_STRING("token_a_1234567890abcdef", rebooted.getTogglToken().c_str());
+        TEST_ASSERT_EQUAL_INT(500, rebooted.getProjectIds()[5]);
+    }
+
+    // Power back: the next save goes into the torn slot and wins
+    memcpy(flash.raw(), stored.raw(), 8192);
+    ConfigStorage store(flash);
+    store.begin();
+    flash.cutPowerAfter(100);
+    TEST_ASSERT_FALSE(saveB(store));
+    TEST_ASSERT_FALSE(store.isStorageHealthy());
+    flash.restorePower();
+    TEST_ASSERT_TRUE(saveB(store));
+    TEST_ASSERT_EQUAL_INT(1, store.getActiveSlot());
+    ConfigStorage rebooted(flash);
+    rebooted.begin();
+    TEST_ASSERT_EQUAL_STRING("NetworkB", rebooted.getWifiSSID().c_str());
+    TEST_ASSERT_EQUAL_UINT32(4, rebooted.getSlotSequence());
+}
+
+// One boot as setup() runs it: reset gesture, stored config or a new one, then startup done
+static bool bootRequestsSetup(FakeFlash<8192, 1024>& flash, FakeFlash<2048, 256>& stateFlash,
+                              bool resetBeforeReady) {
+    KvStore state(stateFlash);
+    TEST_ASSERT_TRUE(state.begin());
+    ConfigStorage store(flash, &state);
+    store.begin();
+    bool requested = store.checkSetupRequest();
+    if (!resetBeforeReady) store.finishStartup();
+    return requested;
+}
+
+void test_config_storage_reset_twice_replaces_config(void) {
+    static FakeFlash<8192, 1024> flash;
+    static FakeFlash<2048, 256> stateFlash;
+    {
+        KvStore state(stateFlash);
+        TEST_ASSERT_TRUE(state.begin());
+        ConfigStorage store(flash, &state);
+        store.begin();
+        TEST_ASSERT_TRUE(saveA(store));
+    }
+
+    // Ordinary boots use the stored configuration
+    TEST_ASSERT_FALSE(bootRequestsSetup(flash, stateFlash, false));
+    TEST_ASSERT_FALSE(bootRequestsSetup(flash, stateFlash, false));
+
+    // Reset while starting up, then boot again: BLE setup, and its configuration replaces the stored one
+    TEST_ASSERT_FALSE(bootRequestsSetup(flash, stateFlash, true));
+    {
+        KvStore state(stateFlash);
+        TEST_ASSERT_TRUE(state.begin());
+        ConfigStorage store(flash, &state);
+        store.begin();
+        TEST_ASSERT_TRUE_MESSAGE(store.checkSetupRequest(), "Second reset should ask for setup");
+        TEST_ASSERT_TRUE(saveB(store));
+        store.finishStartup();
+    }
+    KvStore state(stateFlash);
+    TEST_ASSERT_TRUE(state.begin());
+    ConfigStorage rebooted(flash, &state);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_FALSE(rebooted.checkSetupRequest());
+    TEST_ASSERT_TRUE(rebooted.loadConfiguration());
+    TEST_ASSERT_EQUAL_STRING("NetworkB", rebooted.getWifiSSID().c_str());
+    TEST_ASSERT_EQUAL_STRING("token_b_1234567890abcdef", rebooted.getTogglToken().c_str());
+    rebooted.finishStartup();
+
+    // A reset during setup itself is not armed again: the next boot is an ordinary one
+    TEST_ASSERT_FALSE(bootRequestsSetup(flash, stateFlash, true));
+    TEST_ASSERT_TRUE(bootRequestsSetup(flash, stateFlash, true));
+    TEST_ASSERT_FALSE(bootRequestsSetup(flash, stateFlash, false));
+}
+
 // Test suite runner
 void runConfigStorageTests(void) {
     RUN_TEST(test_config_storage_initialization);
@@ -102,4 +292,8 @@ void runConfigStorageTests(void) {
     RUN_TEST(test_wifi_validation);
     RUN_TEST(test_toggl_validation);
     RUN_TEST(test_backup_restore);
+    RUN_TEST(test_config_storage_survives_power_cycle);
+    RUN_TEST(test_config_storage_alternates_slots);
+    RUN_TEST(test_config_storage_power_cut_keeps_a_copy);
+    RUN_TEST(test_config_storage_reset_twice_replaces_config);
 }
\ No newline at end of file
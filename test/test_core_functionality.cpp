@@ -20,9 +20,9 @@
 
 // Global test objects
 LEDController* testLedController = nullptr;
+LSM6DSBackend testImuBackend;
 OrientationDetector* testOrientationDetector = nullptr;
 WiFiSSLClient* testSslClient = nullptr;
-HttpClient* testHttpClient = nullptr;
 TogglAPI* testTogglAPI = nullptr;
 
 // Test results tracking
@@ -63,7 +63,7 @@ void setUp(void) {
     }
     
     // Initialize orientation detector
-    testOrientationDetector = new OrientationDetector(Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
+    testOrientationDetector = new OrientationDetector(testImuBackend, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
     Serial.println("✓ OrientationDetector created");
     
     // Initialize WiFi (critical for Toggl API)
@@ -97,8 +97,7 @@ void setUp(void) {
     // Initialize Toggl API (only if WiFi is connected)
     if (results.wifiConnected) {
         testSslClient = new WiFiSSLClient();
-        testHttpClient = new HttpClient(*testSslClient, Config::TOGGL_SERVER, Config::TOGGL_PORT);
-        testTogglAPI = new TogglAPI(testHttpClient);
+        testTogglAPI = new TogglAPI(testSslClient);
         
         // Configure Toggl API
         int projectIds[6] = {0, TEST_PROJECT_FACE_DOWN, TEST_PROJECT_LEFT_SIDE, 
@@ -123,10 +122,6 @@ void tearDown(void) {
         delete testTogglAPI;
         testTogglAPI = nullptr;
     }
-    if (testHttpClient) {
-        delete testHttpClient;
-        testHttpClient = nullptr;
-    }
     if (testSslClient) {
         delete testSslClient;
         testSslClient = nullptr;
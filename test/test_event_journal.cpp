@@ -0,0 +1,203 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "EventJournal.h"
+#include "JournalReplayer.h"
+#include "TogglAPI.h"
+#include "OrientationDetector.h"
+#include "Config.h"
+#include "FakeFlash.h"
+#include "JournalRig.h"
+
+void test_event_journal_survives_reboot(void) {
+    FakeFlash<4096, 1024> flash;
+    {
+        EventJournal journal(flash);
+        TEST_ASSERT_TRUE(journal.begin());
+        TEST_ASSERT_TRUE(journal.recordStart(FACE_DOWN, 1790000000UL, millis()));
+        TEST_ASSERT_TRUE(journal.recordStop(1790000100UL, millis()));
+        TEST_ASSERT_TRUE(journal.recordStart(LEFT_SIDE, 1790000100UL, millis()));
+    }
+
+    EventJournal rebooted(flash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(3, rebooted.countPending(), "All events should survive the reboot");
+    TEST_ASSERT_TRUE(rebooted.isSegmentOpen());
+    TEST_ASSERT_EQUAL_UINT8(LEFT_SIDE, rebooted.getOpenOrientation());
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(2, rebooted.getBootId(), "Boot id should advance past the stored records");
+
+    JournalRecord pending[4];
+    TEST_ASSERT_EQUAL_INT(3, rebooted.readPending(pending, 4));
+    TEST_ASSERT_EQUAL_UINT8((uint8_t)JournalEventType::START, pending[0].type);
+    TEST_ASSERT_EQUAL_UINT32(1790000000UL, pending[0].timestamp);
+    TEST_ASSERT_TRUE(rebooted.commitThrough(pending[1].sequence));
+
+    EventJournal again(flash);
+    TEST_ASSERT_TRUE(again.begin());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, again.countPending(), "Committed events should stay delivered");
+}
+
+void test_event_journal_recovers_from_torn_write(void) {
+    FakeFlash<4096, 1024> flash;
+    EventJournal journal(flash);
+    TEST_ASSERT_TRUE(journal.begin());
+    journal.recordStart(FACE_DOWN, 1790000000UL, millis());
+    journal.recordStop(1790000060UL, millis());
+
+    // Power fails seven bytes into the next record
+    flash.cutPowerAfter(7);
+    TEST_ASSERT_FALSE(journal.recordStart(RIGHT_SIDE, 1790000060UL, millis()));
+    flash.restorePower();
+
+    EventJournal rebooted(flash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(2, rebooted.countPending(), "Torn record should be ignored");
+    TEST_ASSERT_FALSE(rebooted.isSegmentOpen());
+
+    TEST_ASSERT_TRUE(rebooted.recordStart(RIGHT_SIDE, 1790000070UL, millis()));
+    JournalRecord pending[4];
+    TEST_ASSERT_EQUAL_INT(3, rebooted.readPending(pending, 4));
+    TEST_ASSERT_GREATER_THAN(pending[1].sequence, pending[2].sequence);
+    TEST_ASSERT_EQUAL_UINT8(RIGHT_SIDE, pending[2].orientation);
+}
+
+void test_event_journal_wraps_and_counts_drops(void) {
+    FakeFlash<512, 256> flash; // Two sectors of 16 slots
+    EventJournal journal(flash);
+    TEST_ASSERT_TRUE(journal.begin());
+
+    // Delivered events can be overwritten freely
+    for (int i = 0; i < 40; i++) {
+        TEST_ASSERT_TRUE(journal.recordStart(FACE_DOWN, 1790000000UL + i, millis()));
+        TEST_ASSERT_TRUE(journal.commitThrough(journal.getCommittedSequence() + 2));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, journal.getDroppedEvents());
+    TEST_ASSERT_FALSE(journal.hasPending());
+
+    // Undelivered events are only lost once the ring is full
+    for (int i = 0; i < 40; i++) {
+        journal.recordStop(1790001000UL + i, millis());
+    }
+    TEST_ASSERT_GREATER_THAN(0, journal.getDroppedEvents());
+    TEST_ASSERT_GREATER_THAN(0, journal.countPending());
+
+    EventJournal rebooted(flash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(journal.countPending(), rebooted.countPending(),
+                                     "Wrapped ring should rescan to the same state");
+}
+
+void test_event_journal_full_ring_keeps_pending(void) {
+    FakeFlash<512, 256> flash; // Two sectors of 16 slots
+    EventJournal journal(flash);
+    TEST_ASSERT_TRUE(journal.begin());
+
+    // Offline long enough to fill every slot, nothing delivered
+    for (int i = 0; i < 32; i++) {
+        TEST_ASSERT_TRUE(journal.recordStart(FACE_DOWN, 1790000000UL + i, millis()));
+    }
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(32, journal.countPending(), "A full ring is not an empty one");
+    JournalRecord oldest;
+    TEST_ASSERT_EQUAL_INT(1, journal.readPending(&oldest, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, oldest.sequence);
+
+    EventJournal rebooted(flash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(32, rebooted.countPending(), "Full ring should rescan as full");
+
+    // The next event costs the oldest sector; everything else is still pending
+    TEST_ASSERT_TRUE(rebooted.recordStart(LEFT_SIDE, 1790000100UL, millis()));
+    TEST_ASSERT_EQUAL_UINT32(16, rebooted.getDroppedEvents());
+    TEST_ASSERT_EQUAL_UINT32(17, rebooted.countPending());
+    TEST_ASSERT_EQUAL_INT(1, rebooted.readPending(&oldest, 1));
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(17, oldest.sequence, "Replay should resume after the dropped sector");
+
+    EventJournal again(flash);
+    TEST_ASSERT_TRUE(again.begin());
+    TEST_ASSERT_EQUAL_UINT32(17, again.countPending());
+}
+
+void test_event_journal_hour_offline_replay(void) {
+    JournalRig rig;
+    TEST_ASSERT_TRUE(rig.journal.isReady());
+
+    // Online: time sync, then the first entry starts live
+    rig.flip(FACE_DOWN);
+    rig.run(2000);
+    TEST_ASSERT_EQUAL_INT(1, rig.server.entryCount);
+    TEST_ASSERT_TRUE(rig.server.entries[0].running);
+    TEST_ASSERT_FALSE(rig.journal.hasPending());
+
+    // An hour offline, flipping every 100 s
+    static const Orientation SEQUENCE[] = {LEFT_SIDE, RIGHT_SIDE, FACE_UP, FRONT_EDGE, BACK_EDGE, FACE_DOWN};
+    static const int FLIPS = 36;
+    uint32_t flipEpochs[FLIPS];
+    int startsOffline = 0;
+
+    rig.server.online = false;
+    for (int i = 0; i < FLIPS; i++) {
+        rig.run(100000);
+        Orientation face = SEQUENCE[i % 6];
+        flipEpochs[i] = rig.server.now();
+        rig.flip(face);
+        if (face != FACE_UP) startsOffline++;
+    }
+    rig.run(60000);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(1, rig.server.entryCount, "Nothing should reach the server while offline");
+
+    int requestsBefore = rig.server.requestCount;
+    rig.server.online = true;
+    rig.run(Config::TOGGL_RETRY_MAX_MS + 60000);
+    TEST_ASSERT_TRUE_MESSAGE(rig.replayer.isIdle(), "Journal should drain after reconnecting");
+
+    // One stop, one completed entry per closed segment, one running entry
+    int requests = rig.server.requestCount - requestsBefore;
+    TEST_ASSERT_EQUAL_INT_MESSAGE(startsOffline + 1, requests, "Replay should collapse start/stop pairs");
+    TEST_ASSERT_LESS_THAN(2 * FLIPS, requests);
+    TEST_ASSERT_EQUAL_INT(startsOffline + 1, rig.server.entryCount);
+
+    // First entry was stopped at the time of the first offline flip
+    TEST_ASSERT_FALSE(rig.server.entries[0].running);
+    TEST_ASSERT_INT_WITHIN(1, (long)flipEpochs[0], (long)rig.server.entries[0].stop);
+
+    // Every offline segment landed with its own start and stop times
+    int entry = 1;
+    for (int i = 0; i < FLIPS; i++) {
+        Orientation face = SEQUENCE[i % 6];
+        if (face == FACE_UP) continue;
+        MockTogglServer::Entry& e = rig.server.entries[entry++];
+        TEST_ASSERT_EQUAL_INT(RIG_PROJECT_IDS[face], e.projectId);
+        TEST_ASSERT_INT_WITHIN(1, (long)flipEpochs[i], (long)e.start);
+        if (i + 1 < FLIPS) {
+            TEST_ASSERT_FALSE(e.running);
+            TEST_ASSERT_INT_WITHIN(1, (long)flipEpochs[i + 1], (long)e.stop);
+        } else {
+            TEST_ASSERT_TRUE_MESSAGE(e.running, "Last segment should still be running");
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(startsOffline - 1, rig.replayer.getStats().entriesCollapsed);
+}
+
+void test_event_journal_retries_server_errors(void) {
+    JournalRig rig;
+    TEST_ASSERT_TRUE(rig.journal.isReady());
+    rig.run(100);
+
+    rig.server.failStatus = 503;
+    rig.server.failCount = 3;   // First three attempts are answered with 503
+    rig.flip(RIGHT_SIDE);
+    rig.run(Config::TOGGL_RETRY_MIN_MS * 8);
+
+    TEST_ASSERT_EQUAL_UINT32(3, rig.replayer.getStats().retries);
+    TEST_ASSERT_EQUAL_INT(1, rig.server.entryCount);
+    TEST_ASSERT_EQUAL_INT(RIG_PROJECT_IDS[RIGHT_SIDE], rig.server.entries[0].projectId);
+    TEST_ASSERT_FALSE(rig.journal.hasPending());
+}
+
+void runEventJournalTests(void) {
+    RUN_TEST(test_event_journal_survives_reboot);
+    RUN_TEST(test_event_journal_recovers_from_torn_write);
+    RUN_TEST(test_event_journal_wraps_and_counts_drops);
+    RUN_TEST(test_event_journal_full_ring_keeps_pending);
+    RUN_TEST(test_event_journal_hour_offline_replay);
+    RUN_TEST(test_event_journal_retries_server_errors);
+}
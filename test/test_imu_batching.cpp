@@ -0,0 +1,137 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDetector.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Sensor producing samples at a fixed rate while the main loop polls every MAIN_LOOP_DELAY
+struct ImuRig {
+    FakeImu imu;
+    OrientationDetector detector;
+    float x = 0.0f, y = 0.0f, z = 1.0f;
+    float sampleIntervalMs;
+    float nextSampleMs;
+    int produced = 0;
+    int reads = 0;
+    int samplesRead = 0;
+    Orientation lastOrientation = UNKNOWN;
+
+    ImuRig(bool fifo, float sensorRateHz) : detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME) {
+        imu.hasFifo = fifo;
+        detector.begin();
+        sampleIntervalMs = 1000.0f / sensorRateHz;
+        nextSampleMs = millis();
+    }
+
+    void produce() {
+        while ((float)millis() >= nextSampleMs) {
+            imu.push(x, y, z);
+            produced++;
+            nextSampleMs += sampleIntervalMs;
+        }
+    }
+
+    void run(unsigned long durationMs) {
+        unsigned long start = millis();
+        while (millis() - start < durationMs) {
+            produce();
+            float ax, ay, az;
+            if (detector.readAcceleration(ax, ay, az)) {
+                reads++;
+                samplesRead += detector.getLastBatchSize();
+                lastOrientation = detector.detectOrientation(ax, ay, az);
+            }
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+
+    // Loop stuck in a blocking call: the sensor keeps producing
+    void stall(unsigned long durationMs) {
+        unsigned long start = millis();
+        while (millis() - start < durationMs) {
+            delay(10);
+            produce();
+        }
+    }
+};
+
+void test_imu_batch_waits_for_watermark(void) {
+    ImuRig rig(true, Config::IMU_FIFO_RATE_HZ);
+    TEST_ASSERT_TRUE(rig.detector.isBatching());
+    TEST_ASSERT_EQUAL_INT(Config::IMU_FIFO_WATERMARK, rig.imu.watermark);
+
+    rig.x = 0.02f;
+    rig.y = -0.03f;
+    rig.z = -0.98f;
+    rig.run(400);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, rig.reads, "No block before the watermark");
+    rig.run(10000);
+
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, rig.lastOrientation);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, rig.detector.getClassifiedOrientation());
+    TEST_ASSERT_TRUE(rig.reads >= 18 && rig.reads <= 22);
+    const ImuBatchStats& stats = rig.detector.getBatchStats();
+    TEST_ASSERT_EQUAL_UINT32(rig.reads, stats.batches);
+    TEST_ASSERT_EQUAL_UINT32(rig.samplesRead, stats.samples);
+    TEST_ASSERT_TRUE_MESSAGE(stats.samples >= stats.batches * Config::IMU_FIFO_WATERMARK, "Every block reaches the watermark");
+    // Nothing produced is lost or counted twice
+    TEST_ASSERT_EQUAL_INT(rig.produced, rig.samplesRead + rig.imu.queued());
+    TEST_ASSERT_EQUAL_INT(rig.reads, rig.imu.burstReads);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+}
+
+void test_imu_batching_cuts_bus_transactions(void) {
+    // Same 10 s face down, polled per sample from a 104 Hz sensor vs. drained from the FIFO
+    ImuRig polled(false, 104);
+    TEST_ASSERT_FALSE(polled.detector.isBatching());
+    polled.z = -1.0f;
+    unsigned long polledBefore = polled.detector.getBusTransactions();
+    polled.run(10000);
+    unsigned long polledTransactions = polled.detector.getBusTransactions() - polledBefore;
+
+    ImuRig batched(true, Config::IMU_FIFO_RATE_HZ);
+    batched.z = -1.0f;
+    unsigned long batchedBefore = batched.detector.getBusTransactions();
+    batched.run(10000);
+    unsigned long batchedTransactions = batched.detector.getBusTransactions() - batchedBefore;
+
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, polled.lastOrientation);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, batched.lastOrientation);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(polled.reads, polled.samplesRead, "Polling classifies single samples");
+    TEST_ASSERT_TRUE(batched.samplesRead / batched.reads >= Config::IMU_FIFO_WATERMARK);
+    TEST_ASSERT_TRUE_MESSAGE(batchedTransactions * 5 < polledTransactions, "FIFO should cut bus transactions at least 5x");
+}
+
+void test_imu_batch_averages_noise_and_survives_overrun(void) {
+    // A knock in the middle of a block: single samples would read as another face
+    AccelSample block[Config::IMU_FIFO_WATERMARK];
+    for (int i = 0; i < Config::IMU_FIFO_WATERMARK; i++) {
+        block[i] = {50, 0, -950};
+    }
+    block[5] = {1600, 200, 300};
+    block[6] = {-900, 100, -200};
+    FakeImu imu;
+    OrientationDetector detector(imu);
+    TEST_ASSERT_EQUAL_INT(RIGHT_SIDE, detector.detectOrientation(1.6f, 0.2f, 0.3f));
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, detector.classifyBlock(block, Config::IMU_FIFO_WATERMARK));
+
+    // A blocking TLS handshake keeps the loop away long enough for the FIFO to fill
+    ImuRig rig(true, Config::IMU_FIFO_RATE_HZ);
+    rig.x = -1.0f;
+    rig.z = 0.0f;
+    rig.run(1000);
+    rig.stall(4000);
+    TEST_ASSERT_TRUE(rig.imu.queued() == FakeImu::FIFO_CAPACITY);
+    rig.run(100);
+    TEST_ASSERT_EQUAL_UINT32(1, rig.detector.getBatchStats().overruns);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(Config::IMU_MAX_BATCH, rig.detector.getLastBatchSize(), "One bounded block per read");
+    rig.run(2000);
+    TEST_ASSERT_TRUE_MESSAGE(rig.imu.queued() < Config::IMU_FIFO_WATERMARK, "Backlog drained");
+    TEST_ASSERT_EQUAL_INT(LEFT_SIDE, rig.lastOrientation);
+}
+
+void runImuBatchingTests(void) {
+    RUN_TEST(test_imu_batch_waits_for_watermark);
+    RUN_TEST(test_imu_batching_cuts_bus_transactions);
+    RUN_TEST(test_imu_batch_averages_noise_and_survives_overrun);
+}
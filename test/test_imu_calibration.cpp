@@ -0,0 +1,204 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <math.h>
+#include "ImuCalibration.h"
+#include "OrientationDetector.h"
+#include "ConfigStorage.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Gravity as read on each face by a perfectly mounted board (Orientation order)
+static const int IDEAL_FACE[6][3] = {
+    {0, 0, 1000}, {0, 0, -1000}, {-1000, 0, 0}, {1000, 0, 0}, {0, 1000, 0}, {0, -1000, 0}
+};
+
+// Board rotated about x then z, with a scale error and a zero-g offset
+struct Mounting {
+    float angleX, angleZ, scale;
+    int bias[3];
+
+    AccelSample read(const float g[3]) const {
+        float cx = cosf(angleX), sx = sinf(angleX), cz = cosf(angleZ), sz = sinf(angleZ);
+        float y1 = cx * g[1] - sx * g[2];
+        float z1 = sx * g[1] + cx * g[2];
+        float x2 = cz * g[0] - sz * y1;
+        float y2 = sz * g[0] + cz * y1;
+        AccelSample s;
+        s.x = (int16_t)lroundf(x2 * scale + bias[0]);
+        s.y = (int16_t)lroundf(y2 * scale + bias[1]);
+        s.z = (int16_t)lroundf(z1 * scale + bias[2]);
+        return s;
+    }
+
+    AccelSample face(int f) const {
+        float g[3] = {(float)IDEAL_FACE[f][0], (float)IDEAL_FACE[f][1], (float)IDEAL_FACE[f][2]};
+        return read(g);
+    }
+};
+
+static const float DEG = 0.0174533f;
+static const Mounting TYPICAL = {10 * DEG, 7 * DEG, 1.03f, {40, -25, 60}};
+
+static int worstError(const AccelSample& sample, const int expected[3]) {
+    int errors[3] = {abs(sample.x - expected[0]), abs(sample.y - expected[1]), abs(sample.z - expected[2])};
+    int worst = errors[0];
+    if (errors[1] > worst) worst = errors[1];
+    if (errors[2] > worst) worst = errors[2];
+    return worst;
+}
+
+void test_imu_calibration_solves_misaligned_board(void) {
+    AccelSample faces[6];
+    for (int f = 0; f < 6; f++) faces[f] = TYPICAL.face(f);
+    TEST_ASSERT_TRUE_MESSAGE(worstError(faces[FACE_UP], IDEAL_FACE[FACE_UP]) > 150, "Raw readings well off true");
+
+    ImuCalibrationData data;
+    int residual = 0;
+    TEST_ASSERT_TRUE(ImuCalibration::solve(faces, data, &residual));
+    TEST_ASSERT_EQUAL_UINT8(1, data.valid);
+    TEST_ASSERT_TRUE(residual >= 0 && residual <= 3);
+    TEST_ASSERT_TRUE(abs(data.bias[0] - 40) <= 2 && abs(data.bias[1] + 25) <= 2 && abs(data.bias[2] - 60) <= 2);
+
+    ImuCalibration calibration;
+    TEST_ASSERT_FALSE(calibration.isValid());
+    calibration.set(data);
+    TEST_ASSERT_TRUE(calibration.isValid());
+    for (int f = 0; f < 6; f++) {
+        AccelSample corrected = faces[f];
+        calibration.apply(&corrected, 1);
+        TEST_ASSERT_TRUE(worstError(corrected, IDEAL_FACE[f]) <= 3);
+    }
+
+    // Anything in between is corrected too: the cube tipped 30 degrees towards its right side
+    float g[3] = {500.0f, 0.0f, 866.0f};
+    AccelSample tilted = TYPICAL.read(g);
+    calibration.apply(&tilted, 1);
+    const int expected[3] = {500, 0, 866};
+    TEST_ASSERT_TRUE(worstError(tilted, expected) <= 4);
+}
+
+void test_imu_calibration_rejects_bad_captures(void) {
+    AccelSample faces[6];
+    ImuCalibrationData data;
+    int residual = 0;
+
+    // One face captured while propped up 20 degrees
+    for (int f = 0; f < 6; f++) faces[f] = TYPICAL.face(f);
+    Mounting propped = TYPICAL;
+    propped.angleX += 20 * DEG;
+    faces[FRONT_EDGE] = propped.face(FRONT_EDGE);
+    TEST_ASSERT_FALSE(ImuCalibration::solve(faces, data, &residual));
+    TEST_ASSERT_TRUE(residual > Config::CALIBRATION_MAX_RESIDUAL_MG);
+    TEST_ASSERT_EQUAL_UINT8(0, data.valid);
+
+    // Two faces swapped: the axes come out mirrored
+    for (int f = 0; f < 6; f++) faces[f] = TYPICAL.face(f);
+    AccelSample swap = faces[LEFT_SIDE];
+    faces[LEFT_SIDE] = faces[RIGHT_SIDE];
+    faces[RIGHT_SIDE] = swap;
+    TEST_ASSERT_FALSE(ImuCalibration::solve(faces, data));
+
+    // The same face captured twice
+    for (int f = 0; f < 6; f++) faces[f] = TYPICAL.face(f);
+    faces[FACE_DOWN] = faces[FACE_UP];
+    TEST_ASSERT_FALSE(ImuCalibration::solve(faces, data));
+
+    // Invalid data leaves samples untouched
+    ImuCalibration calibration;
+    calibration.set(data);
+    AccelSample raw = TYPICAL.face(FACE_UP);
+    AccelSample copy = raw;
+    calibration.apply(&copy, 1);
+    TEST_ASSERT_EQUAL_INT(raw.z, copy.z);
+}
+
+void test_imu_calibrator_captures_each_face(void) {
+    ImuCalibrator calibrator;
+    AccelSample batch[13];
+    TEST_ASSERT_EQUAL_INT(CALIBRATION_IDLE, calibrator.getState());
+
+    calibrator.start();
+    TEST_ASSERT_EQUAL_INT(CALIBRATION_CAPTURING, calibrator.getState());
+
+    // Half a capture, then the cube is picked up: the average starts over
+    for (int i = 0; i < 13; i++) batch[i] = TYPICAL.face(FACE_UP);
+    TEST_ASSERT_FALSE(calibrator.addSamples(batch, 13, false));
+    TEST_ASSERT_FALSE(calibrator.addSamples(batch, 13, true));
+    TEST_ASSERT_FALSE(calibrator.addSamples(batch, 13, false));
+    TEST_ASSERT_EQUAL_INT(0, calibrator.getCapturedCount());
+    TEST_ASSERT_TRUE(calibrator.addSamples(batch, 13, false));
+    TEST_ASSERT_TRUE(calibrator.hasCaptured(FACE_UP));
+    TEST_ASSERT_EQUAL_INT(FACE_UP, calibrator.getLastCaptured());
+
+    // Left on the same face: nothing more to capture
+    TEST_ASSERT_FALSE(calibrator.addSamples(batch, 13, false));
+    TEST_ASSERT_FALSE(calibrator.addSamples(batch, 13, false));
+    TEST_ASSERT_EQUAL_INT(1, calibrator.getCapturedCount());
+
+    // The rest in any order, two batches each
+    const Orientation order[] = {RIGHT_SIDE, FACE_DOWN, BACK_EDGE, LEFT_SIDE, FRONT_EDGE};
+    for (int n = 0; n < 5; n++) {
+        for (int i = 0; i < 13; i++) batch[i] = TYPICAL.face(order[n]);
+        calibrator.addSamples(batch, 13, false);
+        TEST_ASSERT_TRUE(calibrator.addSamples(batch, 13, false));
+    }
+    TEST_ASSERT_EQUAL_INT(6, calibrator.getCapturedCount());
+    TEST_ASSERT_EQUAL_INT(CALIBRATION_DONE, calibrator.getState());
+    TEST_ASSERT_TRUE(calibrator.getWorstResidual() <= 3);
+    TEST_ASSERT_EQUAL_UINT8(1, calibrator.getResult().valid);
+
+    // Stored with the configuration and kept when the configuration is replaced
+    ConfigStorage storage;
+    storage.begin();
+    TEST_ASSERT_FALSE(storage.hasCalibration());
+    TEST_ASSERT_TRUE(storage.saveCalibration(calibrator.getResult()));
+    int projects[] = {0, 111, 222, 333, 444, 555};
+    storage.saveConfiguration("TestNetwork", "TestPassword123", "test_token_12345678901234567890", "123456", projects);
+    TEST_ASSERT_TRUE(storage.hasCalibration());
+    TEST_ASSERT_EQUAL_MEMORY(&calibrator.getResult(), &storage.getCalibration(), sizeof(ImuCalibrationData));
+    TEST_ASSERT_TRUE(storage.loadConfiguration());
+    storage.clearCalibration();
+    TEST_ASSERT_FALSE(storage.hasCalibration());
+    TEST_ASSERT_TRUE(storage.loadConfiguration());
+}
+
+void test_imu_calibration_allows_tighter_thresholds(void) {
+    // Board tipped 28 degrees in its mounting, cube resting face down
+    Mounting crooked = {28 * DEG, 0.0f, 1.0f, {0, 0, 0}};
+    FakeImu imu;
+    imu.hasFifo = false;
+    OrientationDetector detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
+    detector.begin();
+    detector.setHysteresis(Config::ORIENTATION_CALIBRATED_ENTER_MG, Config::ORIENTATION_CALIBRATED_EXIT_MG);
+
+    float ax, ay, az;
+    AccelSample down = crooked.face(FACE_DOWN);
+    for (int i = 0; i < 20; i++) {
+        imu.push(down.x * 0.001f, down.y * 0.001f, down.z * 0.001f);
+        detector.readAcceleration(ax, ay, az);
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(UNKNOWN, detector.getClassifiedOrientation(), "Tight thresholds miss a crooked board");
+
+    AccelSample faces[6];
+    for (int f = 0; f < 6; f++) faces[f] = crooked.face(f);
+    ImuCalibrationData data;
+    TEST_ASSERT_TRUE(ImuCalibration::solve(faces, data));
+    detector.setCalibration(&data);
+    TEST_ASSERT_TRUE(detector.isCalibrated());
+    for (int i = 0; i < 20; i++) {
+        imu.push(down.x * 0.001f, down.y * 0.001f, down.z * 0.001f);
+        detector.readAcceleration(ax, ay, az);
+    }
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, detector.getClassifiedOrientation());
+    TEST_ASSERT_TRUE(az < -0.99f && fabsf(ay) < 0.01f);
+
+    detector.setCalibration(nullptr);
+    TEST_ASSERT_FALSE(detector.isCalibrated());
+}
+
+void runImuCalibrationTests(void) {
+    RUN_TEST(test_imu_calibration_solves_misaligned_board);
+    RUN_TEST(test_imu_calibration_rejects_bad_captures);
+    RUN_TEST(test_imu_calibrator_captures_each_face);
+    RUN_TEST(test_imu_calibration_allows_tighter_thresholds);
+}
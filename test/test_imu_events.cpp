@@ -0,0 +1,114 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDetector.h"
+#include "ImuWakeGate.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Sensor with its interrupt line wired, producing samples while the main loop polls
+struct EventRig {
+    FakeImu imu;
+    OrientationDetector detector;
+    float x = 0.0f, y = 0.0f, z = -1.0f;
+    unsigned long nextSampleMs;
+    int reads = 0;
+
+    EventRig(unsigned long awakeWindowMs) : detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME) {
+        imu.hasEvents = true;
+        detector.setAwakeWindow(awakeWindowMs);
+        detector.begin();
+        nextSampleMs = millis();
+    }
+
+    void run(unsigned long durationMs) {
+        unsigned long start = millis();
+        while (millis() - start < durationMs) {
+            while (millis() >= nextSampleMs) {
+                imu.push(x, y, z);
+                nextSampleMs += 1000 / Config::IMU_FIFO_RATE_HZ;
+            }
+            float ax, ay, az;
+            if (detector.readAcceleration(ax, ay, az)) reads++;
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+};
+
+void test_imu_events_idle_until_interrupt(void) {
+    EventRig rig(1500);
+    TEST_ASSERT_TRUE(rig.detector.isEventDriven());
+    TEST_ASSERT_EQUAL_UINT16(Config::IMU_WAKE_THRESHOLD_MG, rig.imu.wakeThresholdMg);
+
+    // Classifies the resting face in the window opened at boot, then goes idle
+    rig.run(2500);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, rig.detector.getClassifiedOrientation());
+    TEST_ASSERT_TRUE(rig.detector.isIdle());
+    unsigned long idleTransactions = rig.detector.getBusTransactions();
+    int idleReads = rig.reads;
+
+    // Turned over without the engines noticing: nothing is read
+    rig.x = -1.0f;
+    rig.z = 0.0f;
+    rig.run(1500);
+    TEST_ASSERT_EQUAL_INT(idleReads, rig.reads);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(idleTransactions, rig.detector.getBusTransactions(), "Idle costs no bus traffic");
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, rig.detector.getClassifiedOrientation());
+
+    // The 6D interrupt wakes the detector, which catches up from the FIFO
+    rig.imu.raise(IMU_EVENT_ORIENTATION);
+    rig.run(1000);
+    TEST_ASSERT_EQUAL_INT(LEFT_SIDE, rig.detector.getClassifiedOrientation());
+    const ImuWakeStats& stats = rig.detector.getWakeStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.wakeups);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.orientationEvents);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(0, rig.detector.getBatchStats().overruns, "Overwrites while idle are expected");
+}
+
+void test_imu_events_fall_back_without_interrupt_line(void) {
+    FakeImu imu;
+    OrientationDetector detector(imu);
+    detector.begin();
+    TEST_ASSERT_FALSE(detector.isEventDriven());
+    TEST_ASSERT_FALSE(detector.isIdle());
+}
+
+void test_imu_wake_gate_desk_hour(void) {
+    // An hour at the desk on a virtual clock, loop every 50 ms:
+    // six turns (2 s of movement, the wake-up engine firing on every 26 Hz
+    // sample, then a 6D change) and twenty knocks that trip the wake-up engine once.
+    FakeImu imu;
+    imu.hasEvents = true;
+    imu.enableEvents(Config::IMU_WAKE_THRESHOLD_MG);
+    ImuWakeGate gate(Config::IMU_AWAKE_MS);
+
+    const unsigned long HOUR_MS = 3600000UL;
+    const unsigned long LOOP_MS = Config::MAIN_LOOP_DELAY;
+    unsigned long awakeLoops = 0;
+    for (unsigned long t = 0; t < HOUR_MS; t += LOOP_MS) {
+        unsigned long inTurn = (t + 300000) % 600000;   // Turns at 5, 15, ... 55 min
+        if (inTurn < 2000) imu.raise(IMU_EVENT_MOTION);
+        if (inTurn == 2000) imu.raise(IMU_EVENT_ORIENTATION);
+        if (t % 180000 == 90000) imu.raise(IMU_EVENT_MOTION);
+
+        if (imu.eventPending()) gate.onEvents(imu.takeEvents(), t);
+        if (gate.isAwake(t)) awakeLoops++;
+    }
+
+    const ImuWakeStats& stats = gate.getStats();
+    TEST_ASSERT_EQUAL_UINT32(26, stats.wakeups);
+    TEST_ASSERT_EQUAL_UINT32(6, stats.orientationEvents);
+    unsigned long awakeMs = gate.getAwakeMs(HOUR_MS);
+    TEST_ASSERT_EQUAL_UINT32(awakeLoops * LOOP_MS, awakeMs);
+    TEST_ASSERT_TRUE_MESSAGE(awakeMs * 20 < HOUR_MS, "Sampling under 5% of the hour");
+    Serial.print("Desk hour: wakeups ");
+    Serial.print((int)stats.wakeups);
+    Serial.print(", awake ");
+    Serial.print((int)(awakeMs / 1000));
+    Serial.println(" s");
+}
+
+void runImuEventTests(void) {
+    RUN_TEST(test_imu_events_idle_until_interrupt);
+    RUN_TEST(test_imu_events_fall_back_without_interrupt_line);
+    RUN_TEST(test_imu_wake_gate_desk_hour);
+}
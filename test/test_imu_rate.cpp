@@ -0,0 +1,149 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDetector.h"
+#include "ImuRateGovernor.h"
+#include "SystemDiagnostics.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Sensor that honours low-power mode, producing samples at whichever rate it is in
+struct RateRig {
+    FakeImu imu;
+    OrientationDetector detector;
+    float x = 0.0f, y = 0.0f, z = -1.0f;
+    unsigned long nextSampleMs;
+    int reads = 0;
+    int settles = 0;
+    Orientation settled = UNKNOWN;
+    unsigned long settledAt = 0;
+
+    explicit RateRig(bool adaptive) : detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME) {
+        imu.hasLowPower = adaptive;
+        detector.begin();
+        nextSampleMs = millis();
+    }
+
+    void run(unsigned long durationMs) {
+        unsigned long start = millis();
+        while (millis() - start < durationMs) {
+            while (millis() >= nextSampleMs) {
+                imu.push(x, y, z);
+                nextSampleMs += 1000 / (imu.lowPower ? imu.lowPowerRateHz : Config::IMU_FIFO_RATE_HZ);
+            }
+            float ax, ay, az;
+            if (detector.readAcceleration(ax, ay, az)) {
+                reads++;
+                Orientation face = detector.getClassifiedOrientation();
+                if (detector.hasOrientationChanged(face)) {
+                    detector.updateOrientation(face);
+                    settled = face;
+                    settledAt = millis();
+                    settles++;
+                }
+            }
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+
+    // Quarter turn from face down onto the left side, then time until it settles there
+    unsigned long turnAndSettle() {
+        for (int i = 1; i <= 6; i++) {
+            float angle = i * 1.5707963f / 6;
+            x = -sinf(angle);
+            z = -cosf(angle);
+            run(100);
+        }
+        x = -1.0f;
+        z = 0.0f;
+        unsigned long landed = millis();
+        run(3000);
+        return settled == LEFT_SIDE ? settledAt - landed : 0xFFFFFFFFUL;
+    }
+};
+
+void test_imu_rate_governor_steps(void) {
+    ImuRateGovernor governor(2000);
+    SystemDiagnostics diagnostics;
+    governor.setDiagnostics(&diagnostics);
+    governor.start(1000);
+
+    TEST_ASSERT_FALSE(governor.onQuiet(2500));
+    TEST_ASSERT_FALSE(governor.onActivity(2800));
+    TEST_ASSERT_FALSE_MESSAGE(governor.onQuiet(4700), "Still time counts from the last activity");
+    TEST_ASSERT_TRUE(governor.onQuiet(4800));
+    TEST_ASSERT_TRUE(governor.isStill());
+    TEST_ASSERT_TRUE(diagnostics.isImuStill());
+    TEST_ASSERT_FALSE(governor.onQuiet(9000));
+
+    TEST_ASSERT_TRUE(governor.onActivity(10800));
+    TEST_ASSERT_FALSE(governor.isStill());
+    TEST_ASSERT_EQUAL_UINT32(1, governor.getStats().stepsDown);
+    TEST_ASSERT_EQUAL_UINT32(1, governor.getStats().stepsUp);
+    TEST_ASSERT_EQUAL_UINT32(3800, governor.getActiveMs(10800));
+    TEST_ASSERT_EQUAL_UINT32(6000, governor.getStillMs(10800));
+    TEST_ASSERT_EQUAL_UINT32(3800, diagnostics.getImuActiveTime());
+    TEST_ASSERT_EQUAL_UINT32(6000, diagnostics.getImuStillTime());
+
+    // Nothing saved at full rate; most of the sensor current while mostly still
+    TEST_ASSERT_EQUAL_INT(0, ImuRateGovernor::savingPercent(1000, 0));
+    TEST_ASSERT_EQUAL_UINT32(Config::IMU_STILL_CURRENT_UA, ImuRateGovernor::averageCurrentUa(0, 1000));
+    int saving = ImuRateGovernor::savingPercent(1000, 9000);
+    TEST_ASSERT_TRUE(saving > 80 && saving < 100);
+    TEST_ASSERT_EQUAL_INT(ImuRateGovernor::savingPercent(3800, 6000), diagnostics.getImuSavingPercent());
+
+    // The tap engine keeps the accelerometer at 416 Hz while still: far less is saved
+    int tapSaving = ImuRateGovernor::savingPercent(1000, 9000, ImuRateGovernor::stillCurrentUa(true));
+    TEST_ASSERT_TRUE(tapSaving < saving - 20);
+    diagnostics.setImuStillCurrent(Config::IMU_TAP_STILL_CURRENT_UA);
+    TEST_ASSERT_EQUAL_INT(ImuRateGovernor::savingPercent(3800, 6000, Config::IMU_TAP_STILL_CURRENT_UA),
+                          diagnostics.getImuSavingPercent());
+}
+
+void test_imu_rate_drops_while_still(void) {
+    RateRig rig(true);
+    TEST_ASSERT_TRUE(rig.detector.isAdaptiveRate());
+
+    // Settles face down, then drops to the low-power rate
+    rig.run(1000 + Config::IMU_STILL_AFTER_MS + 1000);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, rig.settled);
+    TEST_ASSERT_TRUE(rig.detector.isStill());
+    TEST_ASSERT_TRUE(rig.detector.isIdle());
+    TEST_ASSERT_TRUE(rig.imu.lowPower);
+    TEST_ASSERT_EQUAL_UINT16(Config::IMU_STILL_RATE_HZ, rig.imu.lowPowerRateHz);
+
+    // About one reading a second for the next minute
+    int readsBefore = rig.reads;
+    unsigned long transactionsBefore = rig.detector.getBusTransactions();
+    rig.run(60000);
+    int stillReads = rig.reads - readsBefore;
+    TEST_ASSERT_TRUE_MESSAGE(stillReads >= 50 && stillReads <= 60, "About 1 Hz while still");
+    TEST_ASSERT_TRUE(rig.detector.getBusTransactions() - transactionsBefore <= 60 * 3);
+    TEST_ASSERT_EQUAL_INT(1, rig.settles);
+    TEST_ASSERT_TRUE(rig.detector.getStillRateMs() >= 60000);
+    TEST_ASSERT_EQUAL_UINT32(1, rig.detector.getRateStats().stepsDown);
+}
+
+void test_imu_rate_flip_latency_unchanged(void) {
+    RateRig adaptive(true);
+    RateRig fullRate(false);
+    adaptive.run(8000);
+    fullRate.run(8000);
+    TEST_ASSERT_TRUE(adaptive.detector.isStill());
+    TEST_ASSERT_FALSE(fullRate.detector.isAdaptiveRate());
+
+    unsigned long adaptiveLatency = adaptive.turnAndSettle();
+    unsigned long fullRateLatency = fullRate.turnAndSettle();
+
+    // Back at full rate by the time it lands; batches may be out of step by up to one
+    TEST_ASSERT_FALSE(adaptive.imu.lowPower);
+    TEST_ASSERT_EQUAL_UINT32(1, adaptive.detector.getRateStats().stepsUp);
+    TEST_ASSERT_TRUE(fullRateLatency < 2000);
+    unsigned long batchMs = (unsigned long)Config::IMU_FIFO_WATERMARK * 1000UL / Config::IMU_FIFO_RATE_HZ;
+    TEST_ASSERT_TRUE_MESSAGE(adaptiveLatency <= fullRateLatency + batchMs, "Settles about as fast as at full rate");
+}
+
+void runImuRateTests(void) {
+    RUN_TEST(test_imu_rate_governor_steps);
+    RUN_TEST(test_imu_rate_drops_while_still);
+    RUN_TEST(test_imu_rate_flip_latency_unchanged);
+}
@@ -0,0 +1,191 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDetector.h"
+#include "TapEventQueue.h"
+#include "TimerPause.h"
+#include "SystemDiagnostics.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Sensor with its interrupt line and tap engine, resting face down on the desk
+struct TapRig {
+    FakeImu imu;
+    OrientationDetector detector;
+    unsigned long nextSampleMs;
+    int reads = 0;
+
+    TapRig() : detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME) {
+        imu.hasEvents = true;
+        imu.hasTaps = true;
+        detector.setAwakeWindow(1000);
+        detector.begin();
+        nextSampleMs = millis();
+    }
+
+    void run(unsigned long durationMs) {
+        unsigned long start = millis();
+        while (millis() - start < durationMs) {
+            while (millis() >= nextSampleMs) {
+                imu.push(0.0f, 0.0f, -1.0f);
+                nextSampleMs += 1000 / Config::IMU_FIFO_RATE_HZ;
+            }
+            float ax, ay, az;
+            if (detector.readAcceleration(ax, ay, az)) reads++;
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+};
+
+void test_imu_taps_queued_without_sampling(void) {
+    TapRig rig;
+    TEST_ASSERT_TRUE(rig.detector.areTapsEnabled());
+    TEST_ASSERT_EQUAL_UINT16(Config::IMU_TAP_THRESHOLD_MG, rig.imu.tapThresholdMg);
+    rig.run(2000);
+    TEST_ASSERT_TRUE(rig.detector.isIdle());
+    unsigned long idleTransactions = rig.detector.getBusTransactions();
+    int idleReads = rig.reads;
+
+    // A double tap that did not move the cube: one read of the event sources, no samples
+    rig.imu.raise(IMU_EVENT_SINGLE_TAP | IMU_EVENT_DOUBLE_TAP);
+    rig.run(200);
+    TEST_ASSERT_EQUAL_UINT32(idleTransactions + 1, rig.detector.getBusTransactions());
+    TEST_ASSERT_EQUAL_INT(idleReads, rig.reads);
+    TEST_ASSERT_TRUE(rig.detector.isIdle());
+
+    TapEvent tap;
+    TEST_ASSERT_TRUE(rig.detector.takeTap(tap));
+    TEST_ASSERT_EQUAL_INT(TAP_SINGLE, tap.gesture);
+    TEST_ASSERT_TRUE(rig.detector.takeTap(tap));
+    TEST_ASSERT_EQUAL_INT(TAP_DOUBLE, tap.gesture);
+    TEST_ASSERT_FALSE(rig.detector.takeTap(tap));
+    TEST_ASSERT_EQUAL_UINT32(0, rig.detector.getWakeStats().wakeups);
+}
+
+void test_imu_taps_ignored_while_moving(void) {
+    TapRig rig;
+    SystemDiagnostics diagnostics;
+    rig.detector.setDiagnostics(&diagnostics);
+    rig.imu.hasGyro = true;
+
+    // Picked up and turning: a knock on the desk edge is not a gesture
+    rig.imu.gyro.x = 120;
+    rig.imu.raise(IMU_EVENT_MOTION);
+    rig.run(1200);
+    TEST_ASSERT_TRUE(rig.detector.isMoving());
+    rig.imu.raise(IMU_EVENT_MOTION | IMU_EVENT_DOUBLE_TAP);
+    rig.run(200);
+    TapEvent tap;
+    TEST_ASSERT_FALSE(rig.detector.takeTap(tap));
+
+    // Put down and left at rest: the next double tap counts
+    rig.imu.gyro.x = 0;
+    rig.run(1000);
+    TEST_ASSERT_FALSE(rig.detector.isMoving());
+    rig.imu.raise(IMU_EVENT_DOUBLE_TAP);
+    rig.run(100);
+    TEST_ASSERT_TRUE(rig.detector.takeTap(tap));
+    TEST_ASSERT_EQUAL_INT(TAP_DOUBLE, tap.gesture);
+
+    TEST_ASSERT_EQUAL_UINT32(2, diagnostics.getDoubleTaps());
+    TEST_ASSERT_EQUAL_UINT32(0, diagnostics.getSingleTaps());
+    TEST_ASSERT_EQUAL_UINT32(1, diagnostics.getTapsIgnored());
+}
+
+void test_imu_taps_counted_in_current_estimate(void) {
+    // The tap engine's rate while still is what the saving is reported against
+    TapRig rig;
+    SystemDiagnostics diagnostics;
+    rig.detector.setDiagnostics(&diagnostics);
+    diagnostics.recordImuRate(true, 1000);
+    diagnostics.recordImuRate(false, 9000);
+    TEST_ASSERT_EQUAL_UINT32(ImuRateGovernor::averageCurrentUa(1000, 9000, Config::IMU_TAP_STILL_CURRENT_UA),
+                             diagnostics.getImuAverageCurrent());
+
+    // Without it the accelerometer drops to its low-power rate
+    rig.detector.enableTaps(0);
+    TEST_ASSERT_EQUAL_UINT32(ImuRateGovernor::averageCurrentUa(1000, 9000), diagnostics.getImuAverageCurrent());
+}
+
+void test_imu_taps_need_events(void) {
+    // Tap engine present but INT1 not wired: nothing to raise the taps
+    FakeImu imu;
+    imu.hasTaps = true;
+    OrientationDetector detector(imu);
+    detector.begin();
+    TEST_ASSERT_FALSE(detector.isEventDriven());
+    TEST_ASSERT_FALSE(detector.areTapsEnabled());
+
+    // Interrupts but no tap engine
+    FakeImu plain;
+    plain.hasEvents = true;
+    OrientationDetector events(plain);
+    events.begin();
+    TEST_ASSERT_TRUE(events.isEventDriven());
+    TEST_ASSERT_FALSE(events.areTapsEnabled());
+    plain.raise(IMU_EVENT_DOUBLE_TAP);
+    TEST_ASSERT_FALSE(plain.eventPending());
+}
+
+void test_tap_event_queue_keeps_order(void) {
+    TapEventQueue queue;
+    for (int i = 0; i < TapEventQueue::CAPACITY + 2; i++) {
+        TapEvent tap = {i % 2 ? TAP_DOUBLE : TAP_SINGLE, (unsigned long)i * 100};
+        TEST_ASSERT_EQUAL(i < TapEventQueue::CAPACITY, queue.push(tap));
+    }
+    TEST_ASSERT_EQUAL_INT(TapEventQueue::CAPACITY, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(2, queue.getDropped());
+
+    TapEvent tap;
+    for (int i = 0; i < TapEventQueue::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(queue.pop(tap));
+        TEST_ASSERT_EQUAL_UINT32(i * 100, tap.atMs);
+    }
+    TEST_ASSERT_FALSE(queue.pop(tap));
+}
+
+void test_timer_pause_double_tap_toggles(void) {
+    TimerPause pause;
+    SystemDiagnostics diagnostics;
+    pause.setDiagnostics(&diagnostics);
+    TapEvent single = {TAP_SINGLE, 1000};
+    TapEvent doubleTap = {TAP_DOUBLE, 2000};
+
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_NONE, pause.onTap(single, LEFT_SIDE, false));
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_STOP, pause.onTap(doubleTap, LEFT_SIDE, false));
+    TEST_ASSERT_TRUE(pause.isPaused());
+    TEST_ASSERT_EQUAL_INT(LEFT_SIDE, pause.getPausedFace());
+    TEST_ASSERT_EQUAL_UINT32(2000, pause.getPausedAtMs());
+    TEST_ASSERT_TRUE(diagnostics.isTimerPaused());
+
+    // A change on its way owns the timer
+    doubleTap.atMs = 5000;
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_NONE, pause.onTap(doubleTap, LEFT_SIDE, true));
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_RESUME, pause.onTap(doubleTap, LEFT_SIDE, false));
+    TEST_ASSERT_FALSE(pause.isPaused());
+    TEST_ASSERT_FALSE(diagnostics.isTimerPaused());
+
+    // Nothing to pause face up or off any face
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_NONE, pause.onTap(doubleTap, FACE_UP, false));
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_NONE, pause.onTap(doubleTap, UNKNOWN, false));
+
+    // Turning the cube ends a pause; the new face starts as usual
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_STOP, pause.onTap(doubleTap, FRONT_EDGE, false));
+    pause.onFaceCommitted();
+    TEST_ASSERT_FALSE(pause.isPaused());
+    TEST_ASSERT_EQUAL_INT(TIMER_PAUSE_STOP, pause.onTap(doubleTap, FACE_DOWN, false));
+
+    const TimerPauseStats& stats = pause.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3, stats.pauses);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.resumes);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.tapsIgnored);
+    TEST_ASSERT_EQUAL_UINT32(3, diagnostics.getTimerPauses());
+}
+
+void runImuTapTests(void) {
+    RUN_TEST(test_imu_taps_queued_without_sampling);
+    RUN_TEST(test_imu_taps_ignored_while_moving);
+    RUN_TEST(test_imu_taps_counted_in_current_estimate);
+    RUN_TEST(test_imu_taps_need_events);
+    RUN_TEST(test_tap_event_queue_keeps_order);
+    RUN_TEST(test_timer_pause_double_tap_toggles);
+}
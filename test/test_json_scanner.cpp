@@ -0,0 +1,96 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "JsonFieldScanner.h"
+#include "TogglAPI.h"
+#include "Config.h"
+#include "FakeClient.h"
+#include "TogglResponses.h"
+
+void test_json_scanner_extracts_top_level_fields(void) {
+    char id[24];
+    char description[64];
+    JsonFieldScanner scanner;
+    scanner.addField("id", id, sizeof(id));
+    scanner.addField("description", description, sizeof(description));
+
+    scanner.feed(TOGGL_START_RESPONSE, strlen(TOGGL_START_RESPONSE));
+    TEST_ASSERT_TRUE(scanner.isComplete());
+    TEST_ASSERT_TRUE(scanner.isFound(0));
+    TEST_ASSERT_EQUAL_STRING("3612345678", id);
+    TEST_ASSERT_EQUAL_STRING("Face Down Project", description);
+}
+
+void test_json_scanner_skips_nested_values_and_unescapes(void) {
+    char id[24];
+    char description[64];
+    JsonFieldScanner scanner;
+    scanner.addField("id", id, sizeof(id));
+    scanner.addField("description", description, sizeof(description));
+
+    // Byte at a time, as the HTTP engine delivers it
+    for (const char* p = TOGGL_CURRENT_RESPONSE; *p; p++) scanner.feed(*p);
+    TEST_ASSERT_TRUE(scanner.isComplete());
+    TEST_ASSERT_FALSE(scanner.hasError());
+    TEST_ASSERT_EQUAL_STRING("3612349999", id);
+    TEST_ASSERT_EQUAL_STRING("Review \"Q4\" plan ? draft", description);
+}
+
+void test_json_scanner_handles_null_and_truncation(void) {
+    char id[6];
+    JsonFieldScanner scanner;
+    scanner.addField("id", id, sizeof(id));
+
+    scanner.feed(TOGGL_NO_CURRENT_RESPONSE, strlen(TOGGL_NO_CURRENT_RESPONSE));
+    TEST_ASSERT_TRUE(scanner.isNull());
+    TEST_ASSERT_FALSE(scanner.isFound(0));
+
+    scanner.reset();
+    scanner.feed(TOGGL_STOP_RESPONSE, strlen(TOGGL_STOP_RESPONSE));
+    TEST_ASSERT_TRUE(scanner.isFound(0));
+    TEST_ASSERT_TRUE_MESSAGE(scanner.isTruncated(0), "Oversized value should be flagged");
+    TEST_ASSERT_EQUAL_STRING("36123", id);
+}
+
+void test_toggl_start_parses_streamed_response(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, TOGGL_START_RESPONSE, true));
+    fake.queueResponse(httpResponse(200, TOGGL_STOP_RESPONSE));
+
+    TogglAPI toggl(&fake);
+    TEST_ASSERT_TRUE(toggl.startTimeEntry(1, "Face Down Project"));
+    TEST_ASSERT_EQUAL_STRING("3612345678", toggl.getCurrentEntryId().c_str());
+    TEST_ASSERT_EQUAL_STRING("Face Down Project", toggl.getCurrentEntryName().c_str());
+
+    TEST_ASSERT_TRUE(toggl.stopCurrentTimeEntry());
+    TEST_ASSERT_TRUE(toggl.getCurrentEntryId().isEmpty());
+}
+
+void test_async_http_discards_success_body(void) {
+    ScriptedClient fake;
+    fake.queueResponse(httpResponse(200, TOGGL_STOP_RESPONSE));
+    fake.queueResponse(httpResponse(404, "\"Time entry not found\""));
+
+    AsyncHttpClient http(fake, Config::TOGGL_SERVER, Config::TOGGL_PORT);
+    http.begin("PATCH", "/api/v9/workspaces/1/time_entries/2/stop");
+    http.discardBody();
+    http.submit();
+    while (http.isBusy()) { http.poll(); delay(1); }
+    TEST_ASSERT_EQUAL_INT(200, http.getStatusCode());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, http.getResponseBody().length(), "Success body should not be stored");
+
+    // Error bodies are still kept for logging
+    http.begin("PATCH", "/api/v9/workspaces/1/time_entries/2/stop");
+    http.discardBody();
+    http.submit();
+    while (http.isBusy()) { http.poll(); delay(1); }
+    TEST_ASSERT_EQUAL_INT(404, http.getStatusCode());
+    TEST_ASSERT_EQUAL_STRING("\"Time entry not found\"", http.getResponseBody().c_str());
+}
+
+void runJsonScannerTests(void) {
+    RUN_TEST(test_json_scanner_extracts_top_level_fields);
+    RUN_TEST(test_json_scanner_skips_nested_values_and_unescapes);
+    RUN_TEST(test_json_scanner_handles_null_and_truncation);
+    RUN_TEST(test_toggl_start_parses_streamed_response);
+    RUN_TEST(test_async_http_discards_success_body);
+}
@@ -0,0 +1,254 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "KvStore.h"
+#include "ImuCalibration.h"
+#include "SystemDiagnostics.h"
+#include "FakeFlash.h"
+
+// Shared by the tests below; each one blanks them with resetFlash() first
+static FakeFlash<2048, 256> kvFlash;
+static FakeFlash<2048, 512> kvBase;
+static FakeFlash<2048, 512> kvCut;
+
+static ImuCalibrationData testCalibration() {
+    ImuCalibrationData calibration = {};
+    calibration.bias[0] = 7;
+    calibration.bias[2] = -12;
+    calibration.matrix[0] = calibration.matrix[4] = calibration.matrix[8] = 16384;
+    calibration.valid = 1;
+    return calibration;
+}
+
+template <typename Flash>
+static void resetFlash(Flash& flash) {
+    memset(flash.raw(), 0xFF, flash.size());
+    flash.restorePower();
+    flash.cutPowerAfter(-1);
+}
+
+void test_kv_store_typed_values_survive_reboot(void) {
+    resetFlash(kvFlash);
+    {
+        KvStore store(kvFlash);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_EQUAL_INT(8, store.getPageCount());
+        TEST_ASSERT_FALSE(store.contains(KV_KEY_IMU_CALIBRATION));
+        TEST_ASSERT_TRUE(store.put(KV_KEY_IMU_CALIBRATION, testCalibration()));
+        TEST_ASSERT_TRUE(store.putString(KV_KEY_RUNNING_ENTRY, "3456789012"));
+        TEST_ASSERT_TRUE(store.putString(KV_KEY_RUNNING_ENTRY, "3456789013"));
+        DiagnosticCounters counters = {4, 120, 3, 9, 2};
+        TEST_ASSERT_TRUE(store.put(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+        TEST_ASSERT_TRUE(store.remove(KV_KEY_DIAGNOSTIC_COUNTERS));
+
+        // The same value again costs no flash
+        int programs = kvFlash.programCalls;
+        TEST_ASSERT_TRUE(store.putString(KV_KEY_RUNNING_ENTRY, "3456789013"));
+        TEST_ASSERT_EQUAL_INT(programs, kvFlash.programCalls);
+        TEST_ASSERT_EQUAL_UINT32(1, store.getStats().skipped);
+    }
+
+    KvStore rebooted(kvFlash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    int reads = kvFlash.readCalls;
+    ImuCalibrationData calibration;
+    TEST_ASSERT_TRUE(rebooted.get(KV_KEY_IMU_CALIBRATION, calibration));
+    TEST_ASSERT_EQUAL_INT_MESSAGE(1, kvFlash.readCalls - reads, "A get is one read from the index");
+    TEST_ASSERT_EQUAL_INT(-12, calibration.bias[2]);
+    TEST_ASSERT_EQUAL_INT(16384, calibration.matrix[8]);
+
+    char entry[24];
+    TEST_ASSERT_TRUE(rebooted.getString(KV_KEY_RUNNING_ENTRY, entry, sizeof(entry)));
+    TEST_ASSERT_EQUAL_STRING("3456789013", entry);
+    DiagnosticCounters counters;
+    TEST_ASSERT_FALSE(rebooted.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+
+    // A value of another size is not read as the type
+    uint32_t wrongSize;
+    TEST_ASSERT_FALSE(rebooted.get(KV_KEY_IMU_CALIBRATION, wrongSize));
+    TEST_ASSERT_FALSE(rebooted.putBytes(0, &wrongSize, sizeof(wrongSize)));
+}
+
+void test_kv_store_wear_is_even(void) {
+    // Nano 33 IoT: 256-byte rows. A counter saved thousands of times next to a
+    // calibration written once
+    resetFlash(kvFlash);
+    KvStore store(kvFlash);
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_TRUE(store.put(KV_KEY_IMU_CALIBRATION, testCalibration()));
+    TEST_ASSERT_TRUE(store.putString(KV_KEY_RUNNING_ENTRY, "3456789013"));
+
+    DiagnosticCounters counters = {1, 0, 0, 0, 0};
+    for (uint32_t i = 0; i < 3000; i++) {
+        counters.timerOperations = i;
+        int erases = kvFlash.eraseCalls;
+        TEST_ASSERT_TRUE(store.put(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+        TEST_ASSERT_EQUAL_INT_MESSAGE(erases, kvFlash.eraseCalls, "A put must not wait for an erase");
+        while (store.poll()) {
+        }
+    }
+
+    int least = kvFlash.erasesOf(0);
+    int most = least;
+    for (int page = 1; page < store.getPageCount(); page++) {
+        if (kvFlash.erasesOf(page) < least) least = kvFlash.erasesOf(page);
+        if (kvFlash.erasesOf(page) > most) most = kvFlash.erasesOf(page);
+    }
+    TEST_ASSERT_TRUE(least >= 40);
+    TEST_ASSERT_TRUE_MESSAGE(most - least <= 1, "Every page should take its turn");
+    TEST_ASSERT_TRUE(store.getStats().recordsMoved > 0);
+
+    KvStore rebooted(kvFlash);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    ImuCalibrationData calibration;
+    TEST_ASSERT_TRUE_MESSAGE(rebooted.get(KV_KEY_IMU_CALIBRATION, calibration), "Cold data moves with the pages");
+    TEST_ASSERT_EQUAL_INT(7, calibration.bias[0]);
+    TEST_ASSERT_TRUE(rebooted.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+    TEST_ASSERT_EQUAL_UINT32(2999, counters.timerOperations);
+}
+
+void test_kv_store_without_poll_reclaims_inline(void) {
+    // RP2040 Connect: two 4 KB sectors, here 512 bytes each; nobody calls poll()
+    static FakeFlash<1024, 512> twoPages;
+    resetFlash(twoPages);
+    KvStore store(twoPages);
+    TEST_ASSERT_TRUE(store.begin());
+    TEST_ASSERT_EQUAL_INT(2, store.getPageCount());
+    TEST_ASSERT_TRUE(store.put(KV_KEY_IMU_CALIBRATION, testCalibration()));
+
+    DiagnosticCounters counters = {1, 0, 0, 0, 0};
+    for (uint32_t i = 0; i < 500; i++) {
+        counters.doubleTaps = i;
+        TEST_ASSERT_TRUE(store.put(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+    }
+    TEST_ASSERT_TRUE(twoPages.erasesOf(0) > 10);
+    TEST_ASSERT_TRUE(twoPages.erasesOf(0) - twoPages.erasesOf(1) <= 1);
+    TEST_ASSERT_TRUE(twoPages.erasesOf(1) - twoPages.erasesOf(0) <= 1);
+
+    KvStore rebooted(twoPages);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    ImuCalibrationData calibration;
+    TEST_ASSERT_TRUE(rebooted.get(KV_KEY_IMU_CALIBRATION, calibration));
+    TEST_ASSERT_TRUE(rebooted.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+    TEST_ASSERT_EQUAL_UINT32(499, counters.doubleTaps);
+}
+
+// Puts of counters.doubleTaps = first..first+count-1 with poll() after each; the last one acknowledged
+static int putCounters(KvStore& store, int first, int count) {
+    int acked = first - 1;
+    DiagnosticCounters counters = {1, 0, 0, 0, 0};
+    for (int i = first; i < first + count; i++) {
+        counters.doubleTaps = i;
+        if (!store.put(KV_KEY_DIAGNOSTIC_COUNTERS, counters)) break;
+        acked = i;
+        while (store.poll()) {
+        }
+    }
+    return acked;
+}
+
+static void checkAfterPowerCut(int acked) {
+    kvCut.restorePower();
+    kvCut.cutPowerAfter(-1);
+    KvStore rebooted(kvCut);
+    TEST_ASSERT_TRUE(rebooted.begin());
+    ImuCalibrationData calibration;
+    TEST_ASSERT_TRUE_MESSAGE(rebooted.get(KV_KEY_IMU_CALIBRATION, calibration), "Untouched keys survive any cut");
+    TEST_ASSERT_EQUAL_INT(-12, calibration.bias[2]);
+    char entry[24];
+    TEST_ASSERT_TRUE(rebooted.getString(KV_KEY_RUNNING_ENTRY, entry, sizeof(entry)));
+    TEST_ASSERT_EQUAL_STRING("3456789013", entry);
+    DiagnosticCounters counters;
+    TEST_ASSERT_TRUE(rebooted.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+    TEST_ASSERT_TRUE_MESSAGE(counters.doubleTaps == (uint32_t)acked || counters.doubleTaps == (uint32_t)acked + 1,
+                             "The last acknowledged value, or the one being written");
+
+    // Writing goes on past the torn record, through the next compaction, and survives a reboot
+    TEST_ASSERT_EQUAL_INT(1099, putCounters(rebooted, 1000, 100));
+    KvStore again(kvCut);
+    TEST_ASSERT_TRUE(again.begin());
+    TEST_ASSERT_TRUE(again.get(KV_KEY_DIAGNOSTIC_COUNTERS, counters));
+    TEST_ASSERT_EQUAL_UINT32(1099, counters.doubleTaps);
+    TEST_ASSERT_TRUE(again.get(KV_KEY_IMU_CALIBRATION, calibration));
+}
+
+void test_kv_store_recovers_from_torn_writes(void) {
+    // Four pages, the head nearly full: the next puts open a page and reclaim the oldest
+    resetFlash(kvBase);
+    {
+        KvStore store(kvBase);
+        TEST_ASSERT_TRUE(store.begin());
+        TEST_ASSERT_TRUE(store.put(KV_KEY_IMU_CALIBRATION, testCalibration()));
+        TEST_ASSERT_TRUE(store.putString(KV_KEY_RUNNING_ENTRY, "3456789013"));
+        TEST_ASSERT_EQUAL_INT(59, putCounters(store, 0, 60));
+    }
+
+    // Power cut after every byte programmed over the next 30 puts
+    int runs = 0;
+    for (int cut = 0;; cut++) {
+        memcpy(kvCut.raw(), kvBase.raw(), kvBase.size());
+        kvCut.restorePower();
+        KvStore store(kvCut);
+        TEST_ASSERT_TRUE(store.begin());
+        kvCut.cutPowerAfter(cut);
+        int acked = putCounters(store, 60, 30);
+        if (kvCut.isPowered()) {
+            TEST_ASSERT_EQUAL_INT(89, acked);
+            break;
+        }
+        checkAfterPowerCut(acked);
+        runs++;
+    }
+    TEST_ASSERT_TRUE(runs > 30 * 28);
+
+    // And part way through erasing a reclaimed page
+    const int eraseCuts[] = {0, 4, 8, 100, 511};
+    for (int i = 0; i < 5; i++) {
+        memcpy(kvCut.raw(), kvBase.raw(), kvBase.size());
+        kvCut.restorePower();
+        kvCut.cutPowerAfter(-1);
+        KvStore store(kvCut);
+        TEST_ASSERT_TRUE(store.begin());
+        int erases = kvCut.eraseCalls;
+        kvCut.cutPowerDuringErase(eraseCuts[i]);
+        int acked = putCounters(store, 60, 30);
+        TEST_ASSERT_TRUE(kvCut.eraseCalls > erases);
+        checkAfterPowerCut(acked);
+    }
+}
+
+void test_diagnostic_counters_carry_over_boots(void) {
+    resetFlash(kvFlash);
+    KvStore store(kvFlash);
+    store.begin();
+    {
+        SystemDiagnostics first;
+        store.setDiagnostics(&first);
+        first.recordTap(true, true);
+        first.recordTimerOperation(true, "create");
+        first.recordTimerOperation(false, "update");
+        TEST_ASSERT_TRUE(store.put(KV_KEY_DIAGNOSTIC_COUNTERS, first.getLifetimeCounters()));
+        TEST_ASSERT_TRUE(store.put(KV_KEY_DIAGNOSTIC_COUNTERS, first.getLifetimeCounters()));
+        TEST_ASSERT_EQUAL_UINT32(1, first.getStateWrites());
+        TEST_ASSERT_EQUAL_UINT32(1, first.getStateWritesSkipped());
+        store.setDiagnostics(nullptr);
+    }
+
+    SystemDiagnostics second;
+    DiagnosticCounters stored;
+    TEST_ASSERT_TRUE(store.get(KV_KEY_DIAGNOSTIC_COUNTERS, stored));
+    second.restoreCounters(stored);
+    second.recordTap(true, true);
+    DiagnosticCounters lifetime = second.getLifetimeCounters();
+    TEST_ASSERT_EQUAL_UINT32(2, lifetime.boots);
+    TEST_ASSERT_EQUAL_UINT32(2, lifetime.timerOperations);
+    TEST_ASSERT_EQUAL_UINT32(1, lifetime.timerFailures);
+    TEST_ASSERT_EQUAL_UINT32(2, lifetime.doubleTaps);
+}
+
+void runKvStoreTests(void) {
+    RUN_TEST(test_kv_store_typed_values_survive_reboot);
+    RUN_TEST(test_kv_store_wear_is_even);
+    RUN_TEST(test_kv_store_without_poll_reclaims_inline);
+    RUN_TEST(test_kv_store_recovers_from_torn_writes);
+    RUN_TEST(test_diagnostic_counters_carry_over_boots);
+}
@@ -0,0 +1,258 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "LEDController.h"
+#include "LedAnimator.h"
+#include "SystemDiagnostics.h"
+#include "RecordingLed.h"
+
+// What the delay()-based patterns showed, t ms after they were started.
+// Pulses now ease in and out along the sine table instead of a linear ramp.
+
+static bool blinkCodeOn(int blinks, unsigned long t) {
+    // 300 ms off, then 200 ms on / 200 ms off per blink
+    return t >= 300 && (t - 300) / 400 < (unsigned long)blinks && (t - 300) % 400 < 200;
+}
+
+static int pulseLevel(unsigned long cycleMs, unsigned long t) {
+    unsigned long position = t % cycleMs;
+    unsigned long half = cycleMs / 2;
+    int level = position < half ? 128 * LedAnimator::ease(position, half) / 256
+                                : 128 - 128 * LedAnimator::ease(position - half, half) / 256;
+    return LEDController::gammaCorrect(level);
+}
+
+static bool wifiErrorOn(unsigned long t) {
+    unsigned long position = t % 1750;
+    return position < 150 || (position >= 450 && position < 600);
+}
+
+static bool errorFlashOn(unsigned long t) {
+    return t / 400 < 5 && t % 400 < 200;
+}
+
+// Main loop on a virtual clock: advance, then let the controller update
+static void step(LEDController& led, unsigned long ms) {
+    delay(ms);
+    led.updateBLEAnimation();
+}
+
+void test_led_blink_code_without_blocking(void) {
+    RecordingLed output;
+    output.monochrome = true;
+    LEDController led(output);
+    led.begin();
+
+    unsigned long start = millis();
+    led.updateColorForOrientation(BACK_EDGE);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(start, millis(), "No delay() in the LED path");
+    TEST_ASSERT_TRUE(led.isAnimating());
+
+    // Six blinks, sampled every 10 ms as a fast loop would
+    int mismatches = 0;
+    while (millis() - start < 3000) {
+        step(led, 10);
+        unsigned long t = millis() - start;
+        if ((output.brightness() > 0) != blinkCodeOn(6, t)) mismatches++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+    TEST_ASSERT_FALSE(led.isAnimating());
+    TEST_ASSERT_EQUAL_INT(0, output.brightness());
+
+    // At the 50 ms loop the edges land within one loop of where they were
+    unsigned long second = millis();
+    led.updateColorForOrientation(FACE_DOWN);
+    unsigned long lastOn = 0;
+    int onTransitions = 0;
+    bool wasOn = false;
+    while (led.isAnimating()) {
+        step(led, Config::MAIN_LOOP_DELAY);
+        bool on = output.brightness() > 0;
+        if (on && !wasOn) {
+            onTransitions++;
+            lastOn = millis() - second;
+        }
+        wasOn = on;
+    }
+    TEST_ASSERT_EQUAL_INT(2, onTransitions);
+    TEST_ASSERT_TRUE(lastOn >= 700 && lastOn < 700 + Config::MAIN_LOOP_DELAY);
+    TEST_ASSERT_TRUE(millis() - second <= 1100 + Config::MAIN_LOOP_DELAY);
+}
+
+void test_led_pulse_and_wifi_error_patterns(void) {
+    RecordingLed output;
+    output.monochrome = true;
+    LEDController led(output);
+    led.begin();
+
+    unsigned long start = millis();
+    led.showBLESetupMode();
+    int mismatches = 0;
+    for (int i = 0; i < 500; i++) {
+        step(led, 7);
+        if (output.brightness() != pulseLevel(2000, millis() - start)) mismatches++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+
+    start = millis();
+    led.showBLEConnecting();
+    for (int i = 0; i < 300; i++) {
+        step(led, 7);
+        if (output.brightness() != pulseLevel(1000, millis() - start)) mismatches++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+    TEST_ASSERT_TRUE(led.isAnimating());
+
+    // RGB LED: red blinks, everything else off
+    RecordingLed rgb;
+    LEDController color(rgb);
+    color.begin();
+    start = millis();
+    color.showWiFiError();
+    for (int i = 0; i < 1000; i++) {
+        step(color, 10);
+        bool on = wifiErrorOn(millis() - start);
+        if (rgb.current.red != (on ? 255 : 0) || rgb.current.green != 0 || rgb.current.blue != 0) mismatches++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+
+    // A colour ends the pattern
+    color.setColor(0, 0, 128);
+    TEST_ASSERT_FALSE(color.isAnimating());
+    step(color, 150);
+    TEST_ASSERT_EQUAL_INT(LEDController::gammaCorrect(128), rgb.current.blue);
+}
+
+void test_led_error_flash_catches_up(void) {
+    RecordingLed output;
+    LEDController led(output);
+    led.begin();
+
+    unsigned long start = millis();
+    led.showError();
+    TEST_ASSERT_EQUAL_UINT32(start, millis());
+    TEST_ASSERT_EQUAL_INT(255, output.current.red);
+
+    // A loop held up by a slow request lands wherever the pattern is by then
+    int mismatches = 0;
+    const unsigned long gaps[] = {130, 610, 20, 450, 90, 333};
+    for (int i = 0; led.isAnimating(); i = (i + 1) % 6) {
+        step(led, gaps[i]);
+        if ((output.current.red > 0) != errorFlashOn(millis() - start)) mismatches++;
+    }
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+    TEST_ASSERT_EQUAL_INT(0, output.current.red);
+    TEST_ASSERT_TRUE(millis() - start >= 2000);
+}
+
+void test_led_animator_passes(void) {
+    static const uint8_t pattern[] = {
+        LED_PATTERN(3, 1),
+        LED_STEP(10, 0, 0, LED_EASE_HOLD, 100),
+        LED_STEP(20, 0, 0, LED_EASE_LINEAR, 100),
+        LED_STEP(40, 0, 0, LED_EASE_HOLD, 100)
+    };
+    LedAnimator animator;
+    LedColor color;
+    TEST_ASSERT_FALSE(animator.update(0, color));
+
+    // Lead-in once, loop part twice: 100 + 2 x 200 ms
+    animator.start(pattern, 1000, 2);
+    TEST_ASSERT_TRUE(animator.update(1000, color));
+    TEST_ASSERT_EQUAL_INT(10, color.red);
+    animator.update(1150, color);
+    TEST_ASSERT_EQUAL_INT(30, color.red);     // Halfway from 20 to 40
+    animator.update(1250, color);
+    TEST_ASSERT_EQUAL_INT(40, color.red);
+    animator.update(1300, color);
+    TEST_ASSERT_EQUAL_INT(20, color.red);     // Second pass
+    animator.update(1350, color);
+    TEST_ASSERT_EQUAL_INT(30, color.red);
+    TEST_ASSERT_TRUE(animator.isRunning());
+    TEST_ASSERT_TRUE(animator.update(1500, color));
+    TEST_ASSERT_EQUAL_INT(40, color.red);     // Ends on the last keyframe
+    TEST_ASSERT_FALSE(animator.isRunning());
+    TEST_ASSERT_FALSE(animator.update(1600, color));
+
+    // Forever: still going after any number of passes
+    animator.start(pattern, 0, LedAnimator::REPEAT_FOREVER);
+    TEST_ASSERT_TRUE(animator.update(100150, color));
+    TEST_ASSERT_TRUE(animator.isRunning());
+    TEST_ASSERT_EQUAL_INT(30, color.red);     // 100 + 500 x 200 + 50 ms in
+}
+
+void test_led_skips_unchanged_channels(void) {
+    RecordingLed rgb;
+    SystemDiagnostics diagnostics;
+    LEDController led(rgb);
+    led.setDiagnostics(&diagnostics);
+    led.begin();
+
+    // WiFi error for 10 s at the 50 ms loop: the old output sent all three channels every loop
+    unsigned long start = millis();
+    led.showWiFiError();
+    int updates = 1;
+    while (millis() - start < 10000) {
+        step(led, Config::MAIN_LOOP_DELAY);
+        updates++;
+    }
+    const LedWriteStats& stats = led.getWriteStats();
+    TEST_ASSERT_EQUAL_UINT32(3 * updates, stats.writes + stats.skipped);
+    // Three to start, then red on and off twice per 1.75 s cycle
+    TEST_ASSERT_EQUAL_INT(rgb.writes, (int)stats.writes);
+    TEST_ASSERT_TRUE(stats.writes <= 3 + 4 * (10000 / 1750 + 1));
+    for (int i = 3; i < rgb.writes; i++) {
+        TEST_ASSERT_EQUAL_INT(LED_CHANNEL_RED, rgb.log[i].channel);
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.writes, diagnostics.getLedWrites());
+    TEST_ASSERT_EQUAL_UINT32(stats.skipped, diagnostics.getLedWritesSkipped());
+    TEST_ASSERT_TRUE(diagnostics.getLedWritesPerSecond() <= 3);
+
+    // A colour set over and over goes out once; a new one only on the channels it changes
+    int before = rgb.writes;
+    for (int i = 0; i < 20; i++) led.setColor(0, 255, 0);
+    TEST_ASSERT_EQUAL_INT(before + 1, rgb.writes);   // Red was already off, 1250 ms into a cycle
+    led.setColor(0, 255, 255);
+    TEST_ASSERT_EQUAL_INT(before + 2, rgb.writes);
+    TEST_ASSERT_EQUAL_INT(LED_CHANNEL_BLUE, rgb.log[before + 1].channel);
+    TEST_ASSERT_EQUAL_INT(255, rgb.log[before + 1].level);
+
+    // A slow pulse on the built-in LED writes at most once per loop, not every channel
+    RecordingLed single;
+    single.monochrome = true;
+    LEDController pulse(single);
+    pulse.begin();
+    pulse.showBLESetupMode();
+    for (int i = 0; i < 200; i++) step(pulse, Config::MAIN_LOOP_DELAY);
+    TEST_ASSERT_TRUE(single.writes <= 201);
+    TEST_ASSERT_EQUAL_UINT32(single.writes, pulse.getWriteStats().writes);
+}
+
+void test_led_gamma_and_ease_tables(void) {
+    // Gamma: ends fixed, strictly dimmer in between, never decreasing
+    TEST_ASSERT_EQUAL_INT(0, LEDController::gammaCorrect(0));
+    TEST_ASSERT_EQUAL_INT(255, LEDController::gammaCorrect(255));
+    TEST_ASSERT_EQUAL_INT(56, LEDController::gammaCorrect(128));
+    for (int level = 1; level < 256; level++) {
+        TEST_ASSERT_TRUE(LEDController::gammaCorrect(level) >= LEDController::gammaCorrect(level - 1));
+        if (level < 255) TEST_ASSERT_TRUE(LEDController::gammaCorrect(level) < level);
+    }
+
+    // Ease: 0 to 256, half way at the middle, slow at both ends
+    TEST_ASSERT_EQUAL_UINT16(0, LedAnimator::ease(0, 1000));
+    TEST_ASSERT_EQUAL_UINT16(128, LedAnimator::ease(500, 1000));
+    TEST_ASSERT_EQUAL_UINT16(256, LedAnimator::ease(1000, 1000));
+    TEST_ASSERT_TRUE(LedAnimator::ease(100, 1000) < 256 / 10);
+    TEST_ASSERT_TRUE(LedAnimator::ease(900, 1000) > 256 - 256 / 10);
+    for (uint32_t t = 1; t <= 1000; t++) {
+        TEST_ASSERT_TRUE(LedAnimator::ease(t, 1000) >= LedAnimator::ease(t - 1, 1000));
+    }
+}
+
+void runLedAnimationTests(void) {
+    RUN_TEST(test_led_blink_code_without_blocking);
+    RUN_TEST(test_led_pulse_and_wifi_error_patterns);
+    RUN_TEST(test_led_error_flash_catches_up);
+    RUN_TEST(test_led_animator_passes);
+    RUN_TEST(test_led_skips_unchanged_channels);
+    RUN_TEST(test_led_gamma_and_ease_tables);
+}
@@ -0,0 +1,138 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "LedAnimator.h"
+#include "LedPatterns.h"
+#include "LEDController.h"
+#include "RecordingLed.h"
+
+// Colour a pattern shows t ms after it was started, and whether it is still playing
+struct GoldenFrame {
+    unsigned long atMs;
+    uint8_t red, green, blue;
+    bool running;
+};
+
+static int checkGolden(const uint8_t* pattern, uint8_t passes, const GoldenFrame* golden, int count) {
+    LedAnimator animator;
+    animator.start(pattern, 5000, passes);
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        LedColor color = {1, 2, 3};
+        animator.update(5000 + golden[i].atMs, color);
+        if (color.red != golden[i].red || color.green != golden[i].green || color.blue != golden[i].blue ||
+            animator.isRunning() != golden[i].running) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void test_led_patterns_golden_frames(void) {
+    // Two blinks: 300 ms lead-in, then 200 on / 200 off per blink
+    static const GoldenFrame blinkCode[] = {
+        {0, 0, 0, 0, true}, {299, 0, 0, 0, true}, {300, 255, 255, 255, true}, {499, 255, 255, 255, true},
+        {500, 0, 0, 0, true}, {700, 255, 255, 255, true}, {900, 0, 0, 0, true}, {1100, 0, 0, 0, false}
+    };
+    TEST_ASSERT_EQUAL_INT(0, checkGolden(LedPatterns::BLINK_CODE, 2, blinkCode, 8));
+
+    static const GoldenFrame flash[] = {
+        {0, 255, 0, 0, true}, {200, 0, 0, 0, true}, {400, 255, 0, 0, true}, {1000, 0, 0, 0, true},
+        {1199, 0, 0, 0, true}, {1200, 0, 0, 0, false}
+    };
+    TEST_ASSERT_EQUAL_INT(0, checkGolden(LedPatterns::FLASH, 3, flash, 6));
+
+    // Sine-eased breathing; the way down truncates towards the top
+    static const GoldenFrame slowPulse[] = {
+        {0, 0, 0, 0, true}, {250, 18, 18, 18, true}, {500, 64, 64, 64, true}, {750, 109, 109, 109, true},
+        {1000, 128, 128, 128, true}, {1250, 110, 110, 110, true}, {1500, 64, 64, 64, true},
+        {1750, 19, 19, 19, true}, {2000, 0, 0, 0, true}, {40250, 18, 18, 18, true}
+    };
+    TEST_ASSERT_EQUAL_INT(0, checkGolden(LedPatterns::SLOW_PULSE, LedAnimator::REPEAT_FOREVER, slowPulse, 10));
+
+    static const GoldenFrame fastPulse[] = {
+        {0, 0, 0, 0, true}, {125, 18, 18, 18, true}, {250, 64, 64, 64, true}, {500, 128, 128, 128, true},
+        {625, 110, 110, 110, true}, {875, 19, 19, 19, true}, {1000, 0, 0, 0, true}
+    };
+    TEST_ASSERT_EQUAL_INT(0, checkGolden(LedPatterns::FAST_PULSE, LedAnimator::REPEAT_FOREVER, fastPulse, 7));
+
+    static const GoldenFrame wifiError[] = {
+        {0, 255, 0, 0, true}, {149, 255, 0, 0, true}, {150, 0, 0, 0, true}, {450, 255, 0, 0, true},
+        {600, 0, 0, 0, true}, {1749, 0, 0, 0, true}, {1750, 255, 0, 0, true}, {175000 + 460, 255, 0, 0, true}
+    };
+    TEST_ASSERT_EQUAL_INT(0, checkGolden(LedPatterns::WIFI_ERROR, LedAnimator::REPEAT_FOREVER, wifiError, 8));
+}
+
+void test_led_patterns_late_update_skips_passes(void) {
+    // Ten minutes of a forever pattern in one update lands where it should
+    LedAnimator animator;
+    LedColor color;
+    animator.start(LedPatterns::WIFI_ERROR, 0, LedAnimator::REPEAT_FOREVER);
+    TEST_ASSERT_TRUE(animator.update(600000 + 1750 * 3 + 500, color));
+    TEST_ASSERT_EQUAL_INT((600000 % 1750 + 500) % 1750 < 150 ? 255 : 0, color.red);
+
+    // A finite pattern updated long after it ended shows its last step and stops
+    animator.start(LedPatterns::BLINK_CODE, 0, 6);
+    TEST_ASSERT_TRUE(animator.update(1000000, color));
+    TEST_ASSERT_FALSE(animator.isRunning());
+    TEST_ASSERT_EQUAL_INT(0, color.red);
+
+    // Skipping passes still counts them: ends on time, not one pass late
+    animator.start(LedPatterns::BLINK_CODE, 0, 6);
+    animator.update(300 + 4 * 400 + 50, color);     // Fifth blink
+    TEST_ASSERT_EQUAL_INT(255, color.red);
+    animator.update(300 + 6 * 400 - 1, color);
+    TEST_ASSERT_TRUE(animator.isRunning());
+    animator.update(300 + 6 * 400, color);
+    TEST_ASSERT_FALSE(animator.isRunning());
+}
+
+void test_led_patterns_feedback_tables(void) {
+    // Every entry is a well-formed pattern for both kinds of LED
+    for (int i = 0; i < LED_FEEDBACK_COUNT; i++) {
+        const LedFeedbackPatterns& patterns = LedPatterns::feedback((LedFeedback)i);
+        TEST_ASSERT_NOT_NULL(patterns.rgb);
+        TEST_ASSERT_NOT_NULL(patterns.single);
+        TEST_ASSERT_TRUE(patterns.rgb[0] > 0 && patterns.rgb[1] < patterns.rgb[0]);
+        TEST_ASSERT_TRUE(patterns.single[0] > 0 && patterns.single[1] < patterns.single[0]);
+    }
+
+    // Faces keep their colours and blink codes
+    static const uint8_t colors[6][3] = {
+        {0, 255, 0}, {255, 0, 0}, {0, 0, 255}, {255, 255, 0}, {128, 0, 128}, {0, 255, 255}
+    };
+    for (int face = FACE_UP; face <= BACK_EDGE; face++) {
+        const LedFaceFeedback& feedback = LedPatterns::face((Orientation)face);
+        TEST_ASSERT_EQUAL_INT(colors[face][0], feedback.red);
+        TEST_ASSERT_EQUAL_INT(colors[face][1], feedback.green);
+        TEST_ASSERT_EQUAL_INT(colors[face][2], feedback.blue);
+        TEST_ASSERT_EQUAL_INT(face + 1, feedback.blinks);
+    }
+    TEST_ASSERT_EQUAL_INT(0, LedPatterns::face(UNKNOWN).blinks);
+    TEST_ASSERT_EQUAL_INT(255, LedPatterns::face(UNKNOWN).blue);
+
+    // A solid colour is shown at once and leaves nothing running
+    RecordingLed rgb;
+    LEDController led(rgb);
+    led.begin();
+    led.showBLEConnecting();
+    TEST_ASSERT_FALSE(led.isAnimating());
+    TEST_ASSERT_EQUAL_INT(LEDController::gammaCorrect(128), rgb.current.red);
+    TEST_ASSERT_EQUAL_INT(0, rgb.current.blue);
+
+    // The same status on a single LED is a pulse that keeps going
+    RecordingLed single;
+    single.monochrome = true;
+    LEDController builtin(single);
+    builtin.begin();
+    builtin.showBLEConnecting();
+    TEST_ASSERT_TRUE(builtin.isAnimating());
+    builtin.showBLEConnected();
+    TEST_ASSERT_FALSE(builtin.isAnimating());
+    TEST_ASSERT_EQUAL_INT(LEDController::gammaCorrect(128), single.brightness());
+}
+
+void runLedPatternTests(void) {
+    RUN_TEST(test_led_patterns_golden_frames);
+    RUN_TEST(test_led_patterns_late_update_skips_passes);
+    RUN_TEST(test_led_patterns_feedback_tables);
+}
@@ -9,6 +9,26 @@ extern void runSystemDiagnosticsTests(void);
 extern void runBLEConnectivityTests(void);
 extern void runAdvancedBLETests(void);
 extern void runBLEUserFlowTests(void);
+extern void runAsyncHttpTests(void);
+extern void runEventJournalTests(void);
+extern void runJsonScannerTests(void);
+extern void runTogglSwitchTests(void);
+extern void runOrientationCoalescerTests(void);
+extern void runRequestTemplateTests(void);
+extern void runRequestSchedulerTests(void);
+extern void runReconcileTests(void);
+extern void runImuBatchingTests(void);
+extern void runOrientationClassifierTests(void);
+extern void runTraceFormatTests(void);
+extern void runOrientationDebouncerTests(void);
+extern void runImuEventTests(void);
+extern void runMotionDetectorTests(void);
+extern void runImuRateTests(void);
+extern void runImuCalibrationTests(void);
+extern void runImuTapTests(void);
+extern void runLedAnimationTests(void);
+extern void runLedPatternTests(void);
+extern void runKvStoreTests(void);
 
 // Integration Tests
 void test_system_integration(void) {
@@ -160,6 +180,66 @@ void setup() {
     Serial.println("\n--- SystemDiagnostics Tests ---");
     runSystemDiagnosticsTests();
     
+    Serial.println("\n--- Async HTTP Tests ---");
+    runAsyncHttpTests();
+    
+    Serial.println("\n--- Event Journal Tests ---");
+    runEventJournalTests();
+    
+    Serial.println("\n--- JSON Scanner Tests ---");
+    runJsonScannerTests();
+    
+    Serial.println("\n--- Toggl Switch Tests ---");
+    runTogglSwitchTests();
+    
+    Serial.println("\n--- Orientation Coalescer Tests ---");
+    runOrientationCoalescerTests();
+    
+    Serial.println("\n--- Request Template Tests ---");
+    runRequestTemplateTests();
+    
+    Serial.println("\n--- Request Scheduler Tests ---");
+    runRequestSchedulerTests();
+    
+    Serial.println("\n--- Reconcile Tests ---");
+    runReconcileTests();
+    
+    Serial.println("\n--- IMU Batching Tests ---");
+    runImuBatchingTests();
+    
+    Serial.println("\n--- Orientation Classifier Tests ---");
+    runOrientationClassifierTests();
+    
+    Serial.println("\n--- Trace Format Tests ---");
+    runTraceFormatTests();
+    
+    Serial.println("\n--- Orientation Debouncer Tests ---");
+    runOrientationDebouncerTests();
+    
+    Serial.println("\n--- IMU Event Tests ---");
+    runImuEventTests();
+    
+    Serial.println("\n--- Motion Detector Tests ---");
+    runMotionDetectorTests();
+    
+    Serial.println("\n--- IMU Rate Tests ---");
+    runImuRateTests();
+    
+    Serial.println("\n--- IMU Calibration Tests ---");
+    runImuCalibrationTests();
+    
+    Serial.println("\n--- IMU Tap Tests ---");
+    runImuTapTests();
+    
+    Serial.println("\n--- LED Animation Tests ---");
+    runLedAnimationTests();
+    
+    Serial.println("\n--- LED Pattern Tests ---");
+    runLedPatternTests();
+    
+    Serial.println("\n--- KV Store Tests ---");
+    runKvStoreTests();
+    
     // Finish tests
     UNITY_END();
     
@@ -0,0 +1,127 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <math.h>
+#include "MotionDetector.h"
+#include "OrientationDetector.h"
+#include "SystemDiagnostics.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// A FIFO batch resting on a face with a little sensor noise, or shaken about
+static void restingBatch(AccelSample* batch, int count, int noiseMg, int seed) {
+    for (int i = 0; i < count; i++) {
+        int n = ((seed + i) * 37) % (2 * noiseMg + 1) - noiseMg;
+        batch[i] = {(int16_t)n, (int16_t)-n, (int16_t)(-1000 + n)};
+    }
+}
+
+static void shakenBatch(AccelSample* batch, int count, int seed) {
+    for (int i = 0; i < count; i++) {
+        float t = (seed + i) * 0.9f;
+        batch[i] = {(int16_t)(400 * sinf(t)), (int16_t)(300 * cosf(t * 1.4f)), (int16_t)(-1000 + 200 * sinf(t * 0.7f))};
+    }
+}
+
+void test_motion_gyro_rate_and_rest_time(void) {
+    MotionDetector motion(2500, 30, 300);
+    SystemDiagnostics diagnostics;
+    motion.setDiagnostics(&diagnostics);
+    AccelSample batch[13];
+    GyroSample still = {0, 1, -2};
+    GyroSample turning = {5, 80, 0};
+
+    restingBatch(batch, 13, 20, 0);
+    motion.update(batch, 13, &still, 500);
+    TEST_ASSERT_FALSE(motion.isMoving());
+    TEST_ASSERT_TRUE(motion.getAccelVariance() < 2500);
+
+    // Rotating without the accelerometer showing much yet
+    motion.update(batch, 13, &turning, 1000);
+    TEST_ASSERT_TRUE(motion.isMoving());
+    TEST_ASSERT_TRUE(diagnostics.isMoving());
+    TEST_ASSERT_EQUAL_UINT32(1000, diagnostics.getRestTime());
+
+    motion.update(batch, 13, &still, 1500);
+    TEST_ASSERT_TRUE_MESSAGE(motion.isMoving(), "Must stay quiet for the rest time");
+    motion.update(batch, 13, &still, 2000);
+    TEST_ASSERT_FALSE(motion.isMoving());
+
+    const MotionStats& stats = motion.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.periods);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.movingMs);
+    TEST_ASSERT_EQUAL_UINT32(1, diagnostics.getMotionPeriods());
+    TEST_ASSERT_EQUAL_UINT32(1000, diagnostics.getMotionTime());
+    TEST_ASSERT_FALSE(diagnostics.isMoving());
+}
+
+void test_motion_accel_variance_without_gyro(void) {
+    MotionDetector motion(2500, 30, 300);
+    AccelSample batch[13];
+    unsigned long t = 0;
+
+    // Desk vibration stays below the limit
+    for (int i = 0; i < 10; i++) {
+        restingBatch(batch, 13, 30, i * 13);
+        motion.update(batch, 13, nullptr, t += 500);
+        TEST_ASSERT_FALSE(motion.isMoving());
+    }
+
+    // Carried about: moving from the first batch until a whole window is quiet again
+    shakenBatch(batch, 13, 0);
+    motion.update(batch, 13, nullptr, t += 500);
+    TEST_ASSERT_TRUE(motion.isMoving());
+    TEST_ASSERT_TRUE(motion.getAccelVariance() > 2500);
+    int batchesToRest = 0;
+    while (motion.isMoving() && batchesToRest < 10) {
+        restingBatch(batch, 13, 20, batchesToRest * 13);
+        motion.update(batch, 13, nullptr, t += 500);
+        batchesToRest++;
+    }
+    TEST_ASSERT_TRUE(batchesToRest >= 2 && batchesToRest <= 3);
+}
+
+void test_motion_holds_changes_while_carried(void) {
+    FakeImu imu;
+    imu.hasGyro = true;
+    OrientationDetector detector(imu, Config::ORIENTATION_THRESHOLD, Config::DEBOUNCE_TIME);
+    detector.begin();
+    int settles = 0;
+    Orientation settled = UNKNOWN;
+    unsigned long nextSample = millis();
+
+    // Face down, then carried across the room on its left side, then put back face down
+    struct Phase { float x, z; int16_t gyroDps; unsigned long ms; };
+    const Phase phases[] = {{0.0f, -1.0f, 0, 3000}, {-1.0f, 0.0f, 120, 3000}, {0.0f, -1.0f, 0, 3000}};
+    for (const Phase& phase : phases) {
+        imu.gyro = {0, phase.gyroDps, 0};
+        unsigned long start = millis();
+        while (millis() - start < phase.ms) {
+            while (millis() >= nextSample) {
+                imu.push(phase.x, 0.0f, phase.z);
+                nextSample += 1000 / Config::IMU_FIFO_RATE_HZ;
+            }
+            float ax, ay, az;
+            if (detector.readAcceleration(ax, ay, az)) {
+                Orientation face = detector.getClassifiedOrientation();
+                if (detector.hasOrientationChanged(face)) {
+                    detector.updateOrientation(face);
+                    settled = face;
+                    settles++;
+                }
+            }
+            delay(Config::MAIN_LOOP_DELAY);
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(1, settles, "Only the initial face down; the carried face never settles");
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, settled);
+    TEST_ASSERT_FALSE(detector.isMoving());
+    TEST_ASSERT_EQUAL_UINT32(1, detector.getMotionStats().periods);
+    TEST_ASSERT_TRUE(detector.getMotionStats().heldReadings > 0);
+}
+
+void runMotionDetectorTests(void) {
+    RUN_TEST(test_motion_gyro_rate_and_rest_time);
+    RUN_TEST(test_motion_accel_variance_without_gyro);
+    RUN_TEST(test_motion_holds_changes_while_carried);
+}
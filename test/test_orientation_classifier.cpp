@@ -0,0 +1,121 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <math.h>
+#include "OrientationClassifier.h"
+#include "OrientationDetector.h"
+#include "FaceTable.h"
+#include "Config.h"
+#include "FakeImu.h"
+
+// Deterministic sensor noise in milli-g, roughly uniform in [-amplitude, amplitude]
+static uint32_t noiseState = 12345;
+static int16_t noise(int amplitude) {
+    noiseState = noiseState * 1103515245UL + 12345UL;
+    return (int16_t)((int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude);
+}
+
+// Cube tipped from face down towards its left side by angleDeg
+static AccelSample tilted(float angleDeg, int noiseMg) {
+    float radians = angleDeg * 3.14159265f / 180.0f;
+    AccelSample sample;
+    sample.x = (int16_t)(-1000.0f * sinf(radians)) + noise(noiseMg);
+    sample.y = noise(noiseMg);
+    sample.z = (int16_t)(-1000.0f * cosf(radians)) + noise(noiseMg);
+    return sample;
+}
+
+void test_classifier_faces_and_confidence(void) {
+    const AccelSample faces[6] = {
+        {0, 0, 1000}, {0, 0, -1000}, {-1000, 0, 0}, {1000, 0, 0}, {0, 1000, 0}, {0, -1000, 0}
+    };
+    const Orientation expected[6] = {FACE_UP, FACE_DOWN, LEFT_SIDE, RIGHT_SIDE, FRONT_EDGE, BACK_EDGE};
+    OrientationClassifier classifier;
+    for (int face = 0; face < 6; face++) {
+        classifier.reset();
+        for (int i = 0; i < 10; i++) classifier.update(faces[face]);
+        TEST_ASSERT_EQUAL_INT(expected[face], classifier.getOrientation());
+        TEST_ASSERT_TRUE(classifier.getConfidence() >= 95);
+    }
+
+    // Nothing dominant (free fall, or held at an odd angle)
+    classifier.reset();
+    AccelSample corner = {577, 577, 577};
+    classifier.update(corner);
+    TEST_ASSERT_EQUAL_INT(UNKNOWN, classifier.getOrientation());
+    TEST_ASSERT_EQUAL_INT(0, classifier.getConfidence());
+    TEST_ASSERT_EQUAL_INT(577, classifier.getFiltered().x);
+}
+
+void test_classifier_holds_face_near_45_degrees(void) {
+    // Face down, then left resting near 45 degrees on a slightly wobbly desk for a minute at 26 Hz
+    OrientationClassifier classifier;
+    FakeImu imu;
+    OrientationDetector legacy(imu);
+    Orientation lastClassified = UNKNOWN, lastLegacy = UNKNOWN;
+    int classifiedChanges = 0, legacyChanges = 0;
+    for (int i = 0; i < 26 * 60; i++) {
+        float angle = i < 26 ? 0.0f : 45.0f + 6.0f * sinf(i * 0.21f);
+        AccelSample sample = tilted(angle, 30);
+        Orientation classified = classifier.update(sample);
+        Orientation single = legacy.detectOrientation(sample.x * 0.001f, sample.y * 0.001f, sample.z * 0.001f);
+        if (classified != lastClassified) classifiedChanges++;
+        if (single != lastLegacy) legacyChanges++;
+        lastClassified = classified;
+        lastLegacy = single;
+    }
+    TEST_ASSERT_EQUAL_INT_MESSAGE(1, classifiedChanges, "Only the initial face down");
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, lastClassified);
+    TEST_ASSERT_TRUE_MESSAGE(legacyChanges > 20, "Single-sample thresholding flickers here");
+    TEST_ASSERT_TRUE_MESSAGE(classifier.getConfidence() < 30, "Held, but with little confidence");
+}
+
+void test_classifier_rejects_knock_but_follows_turn(void) {
+    OrientationClassifier classifier;
+    AccelSample down = {0, 0, -1000};
+    for (int i = 0; i < 10; i++) classifier.update(down);
+
+    AccelSample knock = {1600, 200, 300};
+    TEST_ASSERT_EQUAL_INT_MESSAGE(FACE_DOWN, classifier.update(knock), "One-sample spike is filtered out");
+    for (int i = 0; i < 10; i++) classifier.update(down);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, classifier.getOrientation());
+
+    // A real turn onto the left side is followed within a few samples (~0.3 s at 26 Hz)
+    AccelSample left = {-1000, 0, 0};
+    int samples = 0;
+    while (classifier.update(left) != LEFT_SIDE && samples < 50) samples++;
+    TEST_ASSERT_TRUE(samples <= 8);
+    TEST_ASSERT_EQUAL_INT(LEFT_SIDE, classifier.getOrientation());
+}
+
+void test_face_tables_nearest_normal(void) {
+    // Adjacent faces: 90 degrees apart on the cube, 70.5 on the d8, 63.4 on the d10 and d12
+    const int counts[] = {6, 8, 10, 12};
+    const int neighbourMg[] = {0, 333, 447, 447};
+    for (int t = 0; t < 4; t++) {
+        const FaceNormal* table = FaceTable::forCount(counts[t]);
+        TEST_ASSERT_NOT_NULL(table);
+        for (int face = 0; face < counts[t]; face++) {
+            // At rest on the face: 1 g along its normal, -1 g along the opposite face's
+            int32_t v[3] = {table[face].x * 1000 / 16384, table[face].y * 1000 / 16384, table[face].z * 1000 / 16384};
+            int32_t best, second;
+            TEST_ASSERT_EQUAL_INT(face, FaceTable::nearest(table, counts[t], v, best, second));
+            TEST_ASSERT_TRUE(abs(best - 1000) <= 2);
+            TEST_ASSERT_TRUE(abs(second - neighbourMg[t]) <= 2);
+            TEST_ASSERT_TRUE(abs(FaceTable::project(table[face ^ 1], v) + 1000) <= 2);
+        }
+    }
+    TEST_ASSERT_NULL(FaceTable::forCount(7));
+    TEST_ASSERT_TRUE(FaceTable::normals() == FaceTable::forCount(FACE_COUNT));
+
+    // The cube's table gives the axis itself, exactly
+    int32_t v[3] = {-321, 45, -987};
+    TEST_ASSERT_EQUAL_INT(-987, FaceTable::project(FaceTable::forCount(6)[FACE_UP], v));
+    TEST_ASSERT_EQUAL_INT(321, FaceTable::project(FaceTable::forCount(6)[LEFT_SIDE], v));
+}
+
+void runOrientationClassifierTests(void) {
+    RUN_TEST(test_classifier_faces_and_confidence);
+    RUN_TEST(test_classifier_holds_face_near_45_degrees);
+    RUN_TEST(test_classifier_rejects_knock_but_follows_turn);
+    RUN_TEST(test_face_tables_nearest_normal);
+}
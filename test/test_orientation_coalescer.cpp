@@ -0,0 +1,130 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationCoalescer.h"
+#include "Config.h"
+#include "JournalRig.h"
+
+// Settled faces as reported by OrientationDetector over a 40 minute session
+struct TraceStep {
+    unsigned long atMs;
+    Orientation face;
+};
+
+static const TraceStep USAGE_TRACE[] = {
+    {0, FACE_DOWN},
+    // Rolled across two faces to reach the next project
+    {600000, LEFT_SIDE}, {601500, RIGHT_SIDE}, {603000, FRONT_EDGE},
+    // Picked up to look at it and put back down
+    {1200000, UNKNOWN}, {1202000, FRONT_EDGE},
+    // Break, with a bump that tipped it over for a moment
+    {1500000, FACE_UP}, {1530000, FACE_DOWN}, {1531500, FACE_UP},
+    {1800000, BACK_EDGE},
+};
+static const unsigned long TRACE_END_MS = 2400000;
+
+// Detector -> coalescer -> journal -> replayer -> mock server, as in main.cpp
+struct CoalescingRig : JournalRig {
+    OrientationCoalescer coalescer;
+
+    CoalescingRig(unsigned long windowMs) : coalescer(windowMs) {}
+
+    void play(const TraceStep* trace, int steps, unsigned long endMs) {
+        unsigned long origin = nowMs;
+        int next = 0;
+        while (nowMs - origin < endMs) {
+            while (next < steps && trace[next].atMs <= nowMs - origin) {
+                coalescer.offer(trace[next++].face, nowMs);
+            }
+            OrientationChange change;
+            if (coalescer.poll(nowMs, change)) commit(change.to, change.atMs);
+            tick();
+        }
+    }
+
+    // Seconds tracked on a project, counting a running entry up to now
+    long trackedSeconds(long projectId) {
+        long total = 0;
+        for (int i = 0; i < server.entryCount; i++) {
+            const MockTogglServer::Entry& entry = server.entries[i];
+            if (entry.projectId != projectId) continue;
+            total += (long)((entry.running ? server.now() : entry.stop) - entry.start);
+        }
+        return total;
+    }
+};
+
+void test_coalescer_commits_only_final_face(void) {
+    OrientationCoalescer coalescer(3000);
+    OrientationChange change;
+
+    coalescer.offer(FACE_DOWN, 1000);
+    TEST_ASSERT_FALSE(coalescer.poll(3999, change));
+    TEST_ASSERT_TRUE(coalescer.poll(4000, change));
+    TEST_ASSERT_EQUAL_INT(UNKNOWN, change.from);
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, change.to);
+
+    // Rolled over two faces; the window restarts on each one
+    coalescer.offer(LEFT_SIDE, 10000);
+    coalescer.offer(RIGHT_SIDE, 11000);
+    coalescer.offer(FRONT_EDGE, 12500);
+    TEST_ASSERT_FALSE_MESSAGE(coalescer.poll(15000, change), "Window should restart at the last face");
+    TEST_ASSERT_TRUE(coalescer.poll(15500, change));
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, change.from);
+    TEST_ASSERT_EQUAL_INT(FRONT_EDGE, change.to);
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(12500, change.atMs, "Change is dated when the final face was reached");
+    TEST_ASSERT_FALSE(coalescer.poll(20000, change));
+
+    TEST_ASSERT_EQUAL_UINT32(2, coalescer.getStats().changesCommitted);
+    TEST_ASSERT_EQUAL_UINT32(2, coalescer.getStats().facesSkipped);
+}
+
+void test_coalescer_drops_round_trip(void) {
+    OrientationCoalescer coalescer(3000);
+    OrientationChange change;
+    coalescer.reset(FACE_DOWN);
+
+    coalescer.offer(UNKNOWN, 1000);
+    coalescer.offer(LEFT_SIDE, 1500);
+    coalescer.offer(FACE_DOWN, 2000);
+    TEST_ASSERT_FALSE(coalescer.isHolding());
+    TEST_ASSERT_FALSE(coalescer.poll(10000, change));
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, coalescer.getCommittedOrientation());
+    TEST_ASSERT_EQUAL_UINT32(1, coalescer.getStats().roundTripsDropped);
+
+    // Re-reporting the tracked face is not a change
+    coalescer.offer(FACE_DOWN, 11000);
+    TEST_ASSERT_FALSE(coalescer.isHolding());
+}
+
+void test_coalescer_reduces_requests_on_usage_trace(void) {
+    const int steps = sizeof(USAGE_TRACE) / sizeof(USAGE_TRACE[0]);
+
+    CoalescingRig direct(0);
+    direct.play(USAGE_TRACE, steps, TRACE_END_MS);
+    CoalescingRig coalesced(Config::ORIENTATION_COALESCE_MS);
+    coalesced.play(USAGE_TRACE, steps, TRACE_END_MS);
+
+    Serial.print("Usage trace requests: direct ");
+    Serial.print(direct.server.requestCount);
+    Serial.print(", coalesced ");
+    Serial.println(coalesced.server.requestCount);
+
+    TEST_ASSERT_EQUAL_UINT32(10, direct.coalescer.getStats().changesCommitted);
+    TEST_ASSERT_EQUAL_UINT32(4, coalesced.coalescer.getStats().changesCommitted);
+    TEST_ASSERT_TRUE_MESSAGE(coalesced.server.requestCount * 2 <= direct.server.requestCount,
+                             "Coalescing should at least halve API calls on this trace");
+    TEST_ASSERT_TRUE(coalesced.replayer.isIdle());
+    TEST_ASSERT_FALSE(coalesced.server.hasOverlaps());
+
+    // Back-dating keeps tracked time exact despite the window
+    TEST_ASSERT_INT_WITHIN(1, 603, coalesced.trackedSeconds(101));
+    TEST_ASSERT_INT_WITHIN(1, 897, coalesced.trackedSeconds(104));
+    TEST_ASSERT_INT_WITHIN(1, 600, coalesced.trackedSeconds(105));
+    TEST_ASSERT_EQUAL_INT(0, coalesced.trackedSeconds(102));
+}
+
+void runOrientationCoalescerTests(void) {
+    RUN_TEST(test_coalescer_commits_only_final_face);
+    RUN_TEST(test_coalescer_drops_round_trip);
+    RUN_TEST(test_coalescer_reduces_requests_on_usage_trace);
+}
@@ -0,0 +1,78 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDebouncer.h"
+
+// Classifier decisions as they arrive, one per FIFO batch (~500 ms)
+static int feed(OrientationDebouncer& debouncer, Orientation face, unsigned long fromMs, unsigned long toMs,
+                unsigned long& settledAt) {
+    int settled = 0;
+    for (unsigned long t = fromMs; t <= toMs; t += 500) {
+        if (debouncer.observe(face, t)) {
+            debouncer.commit(face, t);
+            settledAt = t;
+            settled++;
+        }
+    }
+    return settled;
+}
+
+void test_debouncer_settles_after_dwell_without_dead_time(void) {
+    OrientationDebouncer debouncer(1000);
+    debouncer.reset(FACE_DOWN);
+
+    TEST_ASSERT_FALSE(debouncer.observe(LEFT_SIDE, 10000));
+    TEST_ASSERT_FALSE(debouncer.observe(LEFT_SIDE, 10500));
+    TEST_ASSERT_EQUAL_UINT32(500, debouncer.getCandidateAge(10500));
+    TEST_ASSERT_TRUE(debouncer.observe(LEFT_SIDE, 11000));
+    debouncer.commit(LEFT_SIDE, 11000);
+    TEST_ASSERT_EQUAL_INT(LEFT_SIDE, debouncer.getCommittedOrientation());
+    TEST_ASSERT_FALSE(debouncer.hasCandidate());
+
+    // The next clean flip only waits for its own dwell
+    unsigned long settledAt = 0;
+    TEST_ASSERT_EQUAL_INT(1, feed(debouncer, FACE_UP, 11500, 14000, settledAt));
+    TEST_ASSERT_EQUAL_UINT32(12500, settledAt);
+
+    const DebouncerStats& stats = debouncer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.committed);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats.candidateMs[LEFT_SIDE]);
+}
+
+void test_debouncer_rejects_wobble(void) {
+    OrientationDebouncer debouncer(1000);
+    debouncer.reset(FACE_DOWN);
+
+    // Still moving: each face shows up for one batch only, then it lands on the right side
+    const Orientation wobble[] = {LEFT_SIDE, FACE_DOWN, LEFT_SIDE, FRONT_EDGE, LEFT_SIDE};
+    unsigned long t = 20000;
+    for (Orientation face : wobble) {
+        TEST_ASSERT_FALSE(debouncer.observe(face, t));
+        t += 500;
+    }
+    TEST_ASSERT_EQUAL_INT(FACE_DOWN, debouncer.getCommittedOrientation());
+
+    unsigned long settledAt = 0;
+    TEST_ASSERT_EQUAL_INT(1, feed(debouncer, RIGHT_SIDE, t, t + 3000, settledAt));
+    TEST_ASSERT_EQUAL_UINT32(t + 1000, settledAt);
+
+    const DebouncerStats& stats = debouncer.getStats();
+    TEST_ASSERT_EQUAL_UINT32(5, stats.candidates);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.committed);
+    TEST_ASSERT_EQUAL_UINT32(1500, stats.candidateMs[LEFT_SIDE]);
+    TEST_ASSERT_EQUAL_UINT32(500, stats.candidateMs[FRONT_EDGE]);
+}
+
+void test_debouncer_zero_dwell_settles_at_once(void) {
+    OrientationDebouncer debouncer(0);
+    TEST_ASSERT_TRUE(debouncer.observe(BACK_EDGE, 500));
+    debouncer.commit(BACK_EDGE, 500);
+    TEST_ASSERT_FALSE(debouncer.observe(BACK_EDGE, 1000));
+}
+
+void runOrientationDebouncerTests(void) {
+    RUN_TEST(test_debouncer_settles_after_dwell_without_dead_time);
+    RUN_TEST(test_debouncer_rejects_wobble);
+    RUN_TEST(test_debouncer_zero_dwell_settles_at_once);
+}
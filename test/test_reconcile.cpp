@@ -0,0 +1,90 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "OrientationDetector.h"
+#include "MockTogglServer.h"
+#include "JournalRig.h"
+
+// Shared replay rig; each test has the mock drop traffic on request
+struct ReconcileRig : JournalRig {
+    // One ordinary entry, so the running entry and clock are known from here on
+    void warmUp() {
+        flip(LEFT_SIDE);
+        run(5000);
+        flip(FACE_UP);
+        run(5000);
+        TEST_ASSERT_TRUE(replayer.isIdle());
+        TEST_ASSERT_EQUAL_INT(1, server.entryCount);
+    }
+
+    void assertAdoptedRunningEntry() {
+        MockTogglServer::Entry* running = server.runningEntry();
+        TEST_ASSERT_NOT_NULL(running);
+        TEST_ASSERT_EQUAL_STRING(String(running->id).c_str(), toggl.getCurrentEntryId().c_str());
+    }
+};
+
+void test_reconcile_lost_start_response(void) {
+    ReconcileRig rig;
+    rig.warmUp();
+
+    // Toggl created the entry but the response never arrived
+    rig.server.loseResponses = 1;
+    rig.flip(RIGHT_SIDE);
+    rig.run(60000);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(2, rig.server.entryCount, "Start must not be posted twice");
+    TEST_ASSERT_FALSE(rig.toggl.hasUnknownOutcome());
+    rig.assertAdoptedRunningEntry();
+
+    // Same for a switch: the new entry is adopted, the old one is stopped
+    rig.server.loseResponses = 1;
+    rig.flip(LEFT_SIDE);
+    rig.run(60000);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT(3, rig.server.entryCount);
+    TEST_ASSERT_EQUAL_INT(1, rig.server.runningCount());
+    TEST_ASSERT_FALSE(rig.server.hasOverlaps());
+    rig.assertAdoptedRunningEntry();
+    TEST_ASSERT_EQUAL_UINT32(2, rig.replayer.getStats().outcomesReconciled);
+}
+
+void test_reconcile_lost_start_request(void) {
+    ReconcileRig rig;
+    rig.warmUp();
+
+    // The request never reached Toggl: reconcile finds nothing and it is resent once
+    rig.server.loseRequests = 1;
+    int requestsBefore = rig.server.requestCount;
+    rig.flip(RIGHT_SIDE);
+    rig.run(60000);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT(2, rig.server.entryCount);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(3, rig.server.requestCount - requestsBefore, "Start, reconcile, start");
+    rig.assertAdoptedRunningEntry();
+    TEST_ASSERT_EQUAL_UINT32(1, rig.replayer.getStats().outcomesReconciled);
+}
+
+void test_reconcile_lost_stop_response(void) {
+    ReconcileRig rig;
+    rig.warmUp();
+    rig.flip(RIGHT_SIDE);
+    rig.run(5000);
+    TEST_ASSERT_EQUAL_INT(1, rig.server.runningCount());
+
+    rig.server.loseResponses = 1;
+    int requestsBefore = rig.server.requestCount;
+    rig.flip(FACE_UP);
+    rig.run(60000);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT(2, rig.server.entryCount);
+    TEST_ASSERT_EQUAL_INT(0, rig.server.runningCount());
+    TEST_ASSERT_EQUAL_INT_MESSAGE(2, rig.server.requestCount - requestsBefore, "Stop, reconcile");
+    TEST_ASSERT_EQUAL_STRING("", rig.toggl.getCurrentEntryId().c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, rig.replayer.getStats().outcomesReconciled);
+}
+
+void runReconcileTests(void) {
+    RUN_TEST(test_reconcile_lost_start_response);
+    RUN_TEST(test_reconcile_lost_start_request);
+    RUN_TEST(test_reconcile_lost_stop_response);
+}
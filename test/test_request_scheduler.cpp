@@ -0,0 +1,176 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "RequestScheduler.h"
+#include "SystemDiagnostics.h"
+#include "TogglAPI.h"
+#include "Config.h"
+#include "MockTogglServer.h"
+#include "JournalRig.h"
+
+// Replay path with the scheduler reporting to diagnostics, as in main.cpp
+struct SchedulerRig : JournalRig {
+    SystemDiagnostics diagnostics;
+
+    SchedulerRig() { toggl.getScheduler().setDiagnostics(&diagnostics); }
+};
+
+void test_request_scheduler_token_buckets(void) {
+    RequestScheduler scheduler;
+    scheduler.configure(1000, 2, 5000, 300000, 5, 120000);
+    unsigned long now = 100000;
+
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now));
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now));
+    TEST_ASSERT_FALSE_MESSAGE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now), "Burst should be spent");
+    TEST_ASSERT_TRUE_MESSAGE(scheduler.tryAcquire(TogglEndpoint::UPDATE_ENTRY, now), "Endpoints have their own bucket");
+
+    TEST_ASSERT_FALSE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now + 999));
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now + 1000));
+    TEST_ASSERT_FALSE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now + 1500));
+
+    // A slot given back is available again right away
+    scheduler.release(TogglEndpoint::CREATE_ENTRY);
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now + 1500));
+    TEST_ASSERT_EQUAL_UINT32(3, scheduler.getStats().deferredByRateLimit);
+}
+
+void test_request_scheduler_backoff_and_retry_after(void) {
+    RequestScheduler a, b;
+    a.configure(0, 1, 5000, 300000, 100, 120000);
+    b.configure(0, 1, 5000, 300000, 100, 120000);
+    a.setJitterSeed(1);
+    b.setJitterSeed(2);
+    unsigned long now = 100000;
+
+    unsigned long step = 5000;
+    bool spread = false;
+    for (int i = 0; i < 8; i++) {
+        a.recordResult(TogglEndpoint::CREATE_ENTRY, 503, 0, now);
+        b.recordResult(TogglEndpoint::CREATE_ENTRY, 503, 0, now);
+        unsigned long delayA = a.getHoldUntil() - now;
+        TEST_ASSERT_TRUE(delayA >= step / 2 && delayA <= step);
+        if (delayA != b.getHoldUntil() - now) spread = true;
+        TEST_ASSERT_FALSE(a.isReady(now + delayA - 1));
+        TEST_ASSERT_FALSE(a.tryAcquire(TogglEndpoint::READ_ENTRY, now + delayA - 1));
+        TEST_ASSERT_TRUE(a.isReady(now + delayA));
+        step = step * 2 > 300000 ? 300000 : step * 2;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(spread, "Differently seeded cubes should not retry in lockstep");
+
+    // A longer Retry-After wins over the backoff
+    RequestScheduler limited;
+    limited.recordResult(TogglEndpoint::CREATE_ENTRY, 429, 90, now);
+    TEST_ASSERT_FALSE(limited.isReady(now + 89999));
+    TEST_ASSERT_TRUE(limited.isReady(now + 90000));
+    TEST_ASSERT_EQUAL_UINT32(1, limited.getStats().retryAfterHonoured);
+
+    // Success and permanent rejections end the backoff
+    a.recordResult(TogglEndpoint::CREATE_ENTRY, 200, 0, now);
+    TEST_ASSERT_TRUE(a.isReady(now));
+    TEST_ASSERT_EQUAL_INT(0, a.getConsecutiveFailures());
+    TEST_ASSERT_FALSE(RequestScheduler::isRetryable(400));
+    TEST_ASSERT_TRUE(RequestScheduler::isRetryable(401));
+    TEST_ASSERT_FALSE(RequestScheduler::isServiceFailure(401));
+}
+
+void test_request_scheduler_circuit_breaker(void) {
+    SystemDiagnostics diagnostics;
+    RequestScheduler scheduler;
+    scheduler.configure(0, 1, 1000, 1000, 3, 60000);
+    scheduler.setDiagnostics(&diagnostics);
+    unsigned long now = 100000;
+
+    // Rejections prove the service is up and do not count
+    scheduler.recordResult(TogglEndpoint::CREATE_ENTRY, 503, 0, now);
+    scheduler.recordResult(TogglEndpoint::CREATE_ENTRY, 400, 0, now);
+    scheduler.recordResult(TogglEndpoint::CREATE_ENTRY, -1, 0, now);
+    scheduler.recordResult(TogglEndpoint::CREATE_ENTRY, -3, 0, now);
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::CLOSED, (int)scheduler.getCircuitState());
+
+    scheduler.recordResult(TogglEndpoint::CREATE_ENTRY, 502, 0, now);
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::OPEN, (int)scheduler.getCircuitState());
+    TEST_ASSERT_TRUE(diagnostics.isTogglCircuitOpen());
+    TEST_ASSERT_FALSE(diagnostics.isTogglAPIHealthy());
+    TEST_ASSERT_FALSE(scheduler.tryAcquire(TogglEndpoint::READ_ENTRY, now + 59999));
+
+    // One probe after the open period; it fails and the circuit reopens
+    now += 60000;
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::READ_ENTRY, now));
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::HALF_OPEN, (int)scheduler.getCircuitState());
+    TEST_ASSERT_FALSE_MESSAGE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now), "Only one probe at a time");
+    scheduler.recordResult(TogglEndpoint::READ_ENTRY, -1, 0, now);
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::OPEN, (int)scheduler.getCircuitState());
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getStats().breakerTrips);
+
+    // Next probe succeeds
+    now += 60000;
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::READ_ENTRY, now));
+    scheduler.recordResult(TogglEndpoint::READ_ENTRY, 200, 0, now);
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::CLOSED, (int)scheduler.getCircuitState());
+    TEST_ASSERT_FALSE(diagnostics.isTogglCircuitOpen());
+    TEST_ASSERT_TRUE(scheduler.tryAcquire(TogglEndpoint::CREATE_ENTRY, now));
+}
+
+void test_request_scheduler_outage_replay(void) {
+    SchedulerRig rig;
+    rig.run(1000);
+
+    // Ten minute outage: without a breaker and backoff this would be a request per loop
+    rig.server.failStatus = 503;
+    rig.server.failCount = 1000;
+    int requestsBefore = rig.server.requestCount;
+    rig.flip(LEFT_SIDE);
+    rig.run(600000);
+    int outageRequests = rig.server.requestCount - requestsBefore;
+    TEST_ASSERT_TRUE_MESSAGE(outageRequests >= Config::TOGGL_BREAKER_THRESHOLD, "Failures should be retried");
+    TEST_ASSERT_TRUE(outageRequests <= Config::TOGGL_BREAKER_THRESHOLD + 5);
+    TEST_ASSERT_TRUE(rig.toggl.getScheduler().getStats().breakerTrips >= 1);
+    TEST_ASSERT_FALSE(rig.diagnostics.isTogglAPIHealthy());
+    TEST_ASSERT_EQUAL_INT(0, rig.server.entryCount);
+
+    // Service back: the next probe goes through and the journal drains
+    rig.server.failCount = 0;
+    rig.run(Config::TOGGL_RETRY_MAX_MS + Config::TOGGL_BREAKER_OPEN_MS);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT(1, rig.server.entryCount);
+    TEST_ASSERT_FALSE(rig.diagnostics.isTogglCircuitOpen());
+
+    // Rate limited with Retry-After: nothing is sent before the server's deadline
+    rig.server.failStatus = 429;
+    rig.server.failCount = 1;
+    rig.server.retryAfterSeconds = 90;
+    requestsBefore = rig.server.requestCount;
+    rig.flip(RIGHT_SIDE);
+    rig.run(85000);
+    TEST_ASSERT_EQUAL_INT(1, rig.server.requestCount - requestsBefore);
+    rig.run(15000);
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT(2, rig.server.entryCount);
+}
+
+void test_request_scheduler_blocking_call_gives_up(void) {
+    MockTogglServer server;
+    TogglAPI toggl(&server);
+    toggl.setCredentials("test-token", "123456");
+
+    // Breaker open: the queue is held for TOGGL_BREAKER_OPEN_MS
+    for (int i = 0; i < Config::TOGGL_BREAKER_THRESHOLD; i++) {
+        toggl.getScheduler().recordResult(TogglEndpoint::CREATE_ENTRY, 503, 0, millis());
+    }
+    TEST_ASSERT_EQUAL_INT((int)CircuitState::OPEN, (int)toggl.getScheduler().getCircuitState());
+
+    unsigned long start = millis();
+    TEST_ASSERT_FALSE(toggl.startTimeEntry(FACE_DOWN, "Face Down"));
+    TEST_ASSERT_TRUE_MESSAGE(millis() - start < 2 * AsyncHttpClient::DEFAULT_TIMEOUT_MS,
+                             "Blocking call should give up after the request timeout");
+    TEST_ASSERT_EQUAL_INT(0, server.requestCount);
+    TEST_ASSERT_TRUE_MESSAGE(toggl.isBusy(), "The start stays queued for poll()");
+}
+
+void runRequestSchedulerTests(void) {
+    RUN_TEST(test_request_scheduler_token_buckets);
+    RUN_TEST(test_request_scheduler_backoff_and_retry_after);
+    RUN_TEST(test_request_scheduler_circuit_breaker);
+    RUN_TEST(test_request_scheduler_outage_replay);
+    RUN_TEST(test_request_scheduler_blocking_call_gives_up);
+}
@@ -0,0 +1,112 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "TogglAPI.h"
+#include "OrientationDetector.h"
+#include "MockTogglServer.h"
+#include "JournalRig.h"
+
+static const Orientation SWITCH_FACES[] = {LEFT_SIDE, RIGHT_SIDE, FRONT_EDGE, BACK_EDGE, FACE_DOWN};
+static const int SWITCH_FLIPS = 10;
+
+// Journal-backed device talking to the mock server, as in main.cpp
+struct SwitchRig : JournalRig {
+    SwitchRig(bool switchEnabled) { toggl.setSwitchEnabled(switchEnabled); }
+
+    // Requests spent on SWITCH_FLIPS face changes, after one-time sync and verification
+    int requestsForFlips() {
+        flip(FACE_DOWN);
+        run(3000);
+        flip(LEFT_SIDE);
+        run(3000);
+
+        int before = server.requestCount;
+        for (int i = 0; i < SWITCH_FLIPS; i++) {
+            flip(SWITCH_FACES[(i + 1) % 5]);
+            run(3000);
+        }
+        return server.requestCount - before;
+    }
+};
+
+void test_toggl_switch_halves_requests_per_flip(void) {
+    SwitchRig separate(false);
+    int separateRequests = separate.requestsForFlips();
+    TEST_ASSERT_TRUE(separate.replayer.isIdle());
+    TEST_ASSERT_FALSE(separate.server.hasOverlaps());
+
+    SwitchRig switching(true);
+    int switchRequests = switching.requestsForFlips();
+    TEST_ASSERT_TRUE(switching.replayer.isIdle());
+    TEST_ASSERT_EQUAL_INT((int)SwitchSupport::VERIFIED, (int)switching.toggl.getSwitchSupport());
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(2 * SWITCH_FLIPS, separateRequests, "Stop + start per flip");
+    TEST_ASSERT_EQUAL_INT_MESSAGE(SWITCH_FLIPS, switchRequests, "One switch request per flip");
+    TEST_ASSERT_FALSE_MESSAGE(switching.server.hasOverlaps(), "Switched entries must not overlap");
+    TEST_ASSERT_EQUAL_INT(1, switching.server.runningCount());
+    TEST_ASSERT_EQUAL_INT(SWITCH_FLIPS + 2, switching.server.entryCount);
+}
+
+void test_toggl_switch_falls_back_to_explicit_stop(void) {
+    SwitchRig rig(true);
+    rig.server.stopsRunningOnStart = false;
+
+    rig.flip(FACE_DOWN);
+    rig.run(3000);
+    rig.flip(LEFT_SIDE);
+    rig.run(3000);
+
+    // The first switch left FACE_DOWN running; verification ended it at the switch time
+    TEST_ASSERT_EQUAL_INT((int)SwitchSupport::UNSUPPORTED, (int)rig.toggl.getSwitchSupport());
+    TEST_ASSERT_FALSE(rig.toggl.canSwitch());
+    TEST_ASSERT_FALSE_MESSAGE(rig.server.hasOverlaps(), "Fallback stop should end the previous entry at the switch");
+    TEST_ASSERT_EQUAL_INT(1, rig.server.runningCount());
+    TEST_ASSERT_TRUE(rig.replayer.isIdle());
+
+    // Later flips go back to stop + start
+    int before = rig.server.requestCount;
+    rig.flip(RIGHT_SIDE);
+    rig.run(3000);
+    TEST_ASSERT_EQUAL_INT(2, rig.server.requestCount - before);
+    TEST_ASSERT_FALSE(rig.server.hasOverlaps());
+    TEST_ASSERT_EQUAL_INT(1, rig.server.runningCount());
+}
+
+static bool settle(TogglAPI& toggl) {
+    while (toggl.isBusy()) {
+        toggl.poll();
+        delay(1);
+    }
+    return toggl.wasLastOperationSuccessful();
+}
+
+void test_toggl_switch_restores_entry_on_failure(void) {
+    MockTogglServer server;
+    TogglAPI toggl(&server);
+    toggl.setCredentials("test-token", "123456");
+    toggl.setProjectIds(RIG_PROJECT_IDS);
+
+    TEST_ASSERT_TRUE(toggl.startTimeEntry(FACE_DOWN, "Face Down"));
+    String running = toggl.getCurrentEntryId();
+
+    server.failStatus = 500;
+    server.failCount = 1;
+    TEST_ASSERT_TRUE(toggl.requestSwitch(LEFT_SIDE, "Left Side"));
+    TEST_ASSERT_FALSE(settle(toggl));
+    TEST_ASSERT_EQUAL_STRING_MESSAGE(running.c_str(), toggl.getCurrentEntryId().c_str(),
+                                     "A failed switch leaves the previous entry current");
+    TEST_ASSERT_FALSE(toggl.needsSwitchVerification());
+
+    TEST_ASSERT_TRUE(toggl.requestSwitch(LEFT_SIDE, "Left Side"));
+    TEST_ASSERT_TRUE(settle(toggl));
+    TEST_ASSERT_TRUE(toggl.needsSwitchVerification());
+    TEST_ASSERT_TRUE(toggl.requestSwitchVerification());
+    TEST_ASSERT_TRUE(settle(toggl));
+    TEST_ASSERT_EQUAL_INT((int)SwitchSupport::VERIFIED, (int)toggl.getSwitchSupport());
+    TEST_ASSERT_EQUAL_INT(1, server.runningCount());
+}
+
+void runTogglSwitchTests(void) {
+    RUN_TEST(test_toggl_switch_halves_requests_per_flip);
+    RUN_TEST(test_toggl_switch_falls_back_to_explicit_stop);
+    RUN_TEST(test_toggl_switch_restores_entry_on_failure);
+}
@@ -0,0 +1,97 @@
+#include <unity.h>
+#include <Arduino.h>
+#include "TraceFormat.h"
+#include "TraceRecorder.h"
+
+// Print that keeps what was written, standing in for the serial port
+class CapturePrint : public Print {
+public:
+    static const int CAPACITY = 3072;
+    uint8_t data[CAPACITY];
+    int length = 0;
+
+    void clear() { length = 0; }
+
+    size_t write(uint8_t byte) override {
+        if (length >= CAPACITY) return 0;
+        data[length++] = byte;
+        return 1;
+    }
+    using Print::write;
+};
+
+// Too big for the stack on the Nano 33 IoT
+static CapturePrint port;
+
+static int decodeAll(const uint8_t* data, int length, TraceDecoder& decoder, TraceRecord* records, int maxRecords) {
+    int count = 0;
+    TraceRecord record;
+    for (int i = 0; i < length; i++) {
+        if (decoder.feed(data[i], record) && count < maxRecords) records[count++] = record;
+    }
+    return count;
+}
+
+void test_trace_round_trip_back_dates_batch(void) {
+    port.clear();
+    TraceRecorder recorder(port);
+    AccelSample batch[3] = {{10, -20, -1000}, {-32768, 32767, 0}, {5, 5, 990}};
+    // Newest read at 5000 ms, 40 ms apart
+    recorder.record(batch, 3, 5000, 40);
+
+    TEST_ASSERT_EQUAL_INT(TraceFormat::TIME_FRAME_BYTES + 3 * TraceFormat::SAMPLE_FRAME_BYTES, port.length);
+    TEST_ASSERT_EQUAL_INT(port.length, (int)recorder.getBytesWritten());
+
+    TraceDecoder decoder;
+    TraceRecord records[4];
+    TEST_ASSERT_EQUAL_INT(3, decodeAll(port.data, port.length, decoder, records, 4));
+    TEST_ASSERT_EQUAL_UINT32(4920, records[0].ms);
+    TEST_ASSERT_EQUAL_UINT32(4960, records[1].ms);
+    TEST_ASSERT_EQUAL_UINT32(5000, records[2].ms);
+    TEST_ASSERT_EQUAL_INT(-32768, records[1].sample.x);
+    TEST_ASSERT_EQUAL_INT(32767, records[1].sample.y);
+    TEST_ASSERT_EQUAL_INT(-1000, records[0].sample.z);
+}
+
+void test_trace_decoder_skips_log_text_and_bad_frames(void) {
+    port.clear();
+    TraceRecorder recorder(port);
+    AccelSample sample = {0, 0, -1000};
+    recorder.record(&sample, 1, 1000, 40);
+    port.print("Orientation: Project 1\n");
+    int corrupted = port.length;
+    recorder.record(&sample, 1, 1040, 40);
+    recorder.record(&sample, 1, 1080, 40);
+    port.data[corrupted + 5] ^= 0x10;
+
+    TraceDecoder decoder;
+    TraceRecord records[4];
+    TEST_ASSERT_EQUAL_INT(2, decodeAll(port.data, port.length, decoder, records, 4));
+    // The dropped sample's delta is lost with it, the next one is 40 ms later still
+    TEST_ASSERT_EQUAL_UINT32(1040, records[1].ms);
+    TEST_ASSERT_EQUAL_UINT32(1, decoder.getStats().badFrames);
+    TEST_ASSERT_TRUE(decoder.getStats().skippedBytes >= 23);
+}
+
+void test_trace_decoder_waits_for_time_frame(void) {
+    port.clear();
+    TraceRecorder recorder(port);
+    AccelSample sample = {0, 1000, 0};
+    for (int i = 0; i < TraceRecorder::TIME_FRAME_INTERVAL + 4; i++) {
+        recorder.record(&sample, 1, 100 + i * 40UL, 40);
+    }
+
+    // Capture joined mid-stream: nothing until the repeated time frame
+    int joinAt = TraceFormat::TIME_FRAME_BYTES + 10 * TraceFormat::SAMPLE_FRAME_BYTES + 3;
+    TraceDecoder decoder;
+    TraceRecord records[8];
+    int count = decodeAll(port.data + joinAt, port.length - joinAt, decoder, records, 8);
+    TEST_ASSERT_EQUAL_INT(4, count);
+    TEST_ASSERT_EQUAL_UINT32(100 + TraceRecorder::TIME_FRAME_INTERVAL * 40UL, records[0].ms);
+}
+
+void runTraceFormatTests(void) {
+    RUN_TEST(test_trace_round_trip_back_dates_batch);
+    RUN_TEST(test_trace_decoder_skips_log_text_and_bad_frames);
+    RUN_TEST(test_trace_decoder_waits_for_time_frame);
+}
@@ -0,0 +1,310 @@
+// Host benchmark: orientation decisions per trace and cycles per sample.
+//
+// "single" reproduces the previous OrientationDetector::determineOrientation:
+// z, x, then y against a 0.75 g float threshold on each raw sample. "filtered"
+// is OrientationClassifier (integer IIR low-pass, enter/exit thresholds).
+// A decision change is what used to turn into a Toggl request, so fewer is
+// better as long as real turns still come through.
+//
+// Built-in traces are synthetic (seeded noise, 26 Hz like the IMU FIFO). CSV
+// traces given on the command line are read as "ms,x_mg,y_mg,z_mg" lines;
+// other lines (headers, comments) are skipped.
+//
+// Host cycle counts only rank the two. On the Cortex-M0+ every float
+// comparison in "single" is a library call as well; see `make check-m0`.
+//
+// The last table is the nearest-normal search against face count, for every
+// face table: the fixed-point kernel the classifier runs on the MCU, and a
+// float kernel vectorised across samples (four per SSE/NEON register) for the host.
+// `make run FACES=12` builds the classifier itself for another tracker.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "OrientationClassifier.h"
+#include "FaceTable.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static unsigned long long cycleCounter() { return __rdtsc(); }
+#define HAVE_CYCLE_COUNTER 1
+#else
+static unsigned long long cycleCounter() { return 0; }
+#define HAVE_CYCLE_COUNTER 0
+#endif
+
+static const int SAMPLE_RATE_HZ = 26;
+
+struct Trace {
+    const char* name;
+    std::vector<AccelSample> samples;
+};
+
+// Keeps the optimiser from dropping the decisions
+static volatile int sink = 0;
+
+// --- Previous classifier ---
+
+static Orientation singleSample(float x, float y, float z) {
+    const float threshold = 0.75f;
+    if (z > threshold) return FACE_UP;
+    if (z < -threshold) return FACE_DOWN;
+    if (x > threshold) return RIGHT_SIDE;
+    if (x < -threshold) return LEFT_SIDE;
+    if (y > threshold) return FRONT_EDGE;
+    if (y < -threshold) return BACK_EDGE;
+    return UNKNOWN;
+}
+
+// --- Synthetic traces ---
+
+static unsigned int noiseState = 1;
+static int noise(int amplitude) {
+    noiseState = noiseState * 1103515245u + 12345u;
+    return (int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static AccelSample vector(float x, float y, float z, int noiseMg) {
+    AccelSample sample;
+    sample.x = (int16_t)(x * 1000.0f) + noise(noiseMg);
+    sample.y = (int16_t)(y * 1000.0f) + noise(noiseMg);
+    sample.z = (int16_t)(z * 1000.0f) + noise(noiseMg);
+    return sample;
+}
+
+// Face down tipped towards the left side by angleDeg
+static AccelSample tipped(float angleDeg, int noiseMg) {
+    float radians = angleDeg * 3.14159265f / 180.0f;
+    return vector(-sinf(radians), 0.0f, -cosf(radians), noiseMg);
+}
+
+static Trace deskTrace() {
+    Trace trace = {"desk (face down, 60 s)", {}};
+    for (int i = 0; i < SAMPLE_RATE_HZ * 60; i++) trace.samples.push_back(tipped(0.0f, 20));
+    return trace;
+}
+
+static Trace tiltTrace() {
+    Trace trace = {"resting near 45 deg, 60 s", {}};
+    for (int i = 0; i < SAMPLE_RATE_HZ * 60; i++) {
+        float angle = i < SAMPLE_RATE_HZ ? 0.0f : 45.0f + 6.0f * sinf(i * 0.21f);
+        trace.samples.push_back(tipped(angle, 30));
+    }
+    return trace;
+}
+
+static Trace knockTrace() {
+    // Typing next to the cube: a one-sample spike every two seconds
+    Trace trace = {"face down with knocks, 60 s", {}};
+    for (int i = 0; i < SAMPLE_RATE_HZ * 60; i++) {
+        if (i % (2 * SAMPLE_RATE_HZ) == SAMPLE_RATE_HZ) {
+            trace.samples.push_back(vector(1.2f, 0.3f, 0.2f, 100));
+        } else {
+            trace.samples.push_back(tipped(0.0f, 25));
+        }
+    }
+    return trace;
+}
+
+static Trace turnTrace() {
+    // Ten deliberate turns between face down and left side, 0.5 s each
+    Trace trace = {"10 turns down <-> left side", {}};
+    float angle = 0.0f;
+    for (int turn = 0; turn <= 10; turn++) {
+        for (int i = 0; i < SAMPLE_RATE_HZ * 5; i++) trace.samples.push_back(tipped(angle, 25));
+        float target = turn % 2 == 0 ? 90.0f : 0.0f;
+        int steps = SAMPLE_RATE_HZ / 2;
+        for (int i = 1; i <= steps && turn < 10; i++) {
+            trace.samples.push_back(tipped(angle + (target - angle) * i / steps, 60));
+        }
+        if (turn < 10) angle = target;
+    }
+    return trace;
+}
+
+static bool loadCsv(const char* path, Trace& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    trace.name = path;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        long ms;
+        int x, y, z;
+        if (sscanf(line, "%ld,%d,%d,%d", &ms, &x, &y, &z) == 4) {
+            trace.samples.push_back({(int16_t)x, (int16_t)y, (int16_t)z});
+        }
+    }
+    fclose(file);
+    return !trace.samples.empty();
+}
+
+// --- Comparison ---
+
+static void compare(const Trace& trace) {
+    OrientationClassifier classifier;
+    Orientation lastSingle = UNKNOWN, lastFiltered = UNKNOWN;
+    int singleChanges = 0, filteredChanges = 0;
+    unsigned long confidenceSum = 0;
+    for (const AccelSample& sample : trace.samples) {
+        Orientation single = singleSample(sample.x * 0.001f, sample.y * 0.001f, sample.z * 0.001f);
+        Orientation filtered = classifier.update(sample);
+        if (single != lastSingle) singleChanges++;
+        if (filtered != lastFiltered) filteredChanges++;
+        lastSingle = single;
+        lastFiltered = filtered;
+        confidenceSum += classifier.getConfidence();
+    }
+    double minutes = trace.samples.size() / (double)SAMPLE_RATE_HZ / 60.0;
+    printf("%-32s %6zu samples  single %4d changes (%6.1f/min)  filtered %4d (%5.1f/min)  mean confidence %3lu\n",
+           trace.name, trace.samples.size(), singleChanges, singleChanges / minutes, filteredChanges,
+           filteredChanges / minutes, confidenceSum / trace.samples.size());
+}
+
+static void benchCycles(const Trace& trace) {
+    const int rounds = 2000;
+    const std::vector<AccelSample>& samples = trace.samples;
+    size_t total = samples.size() * rounds;
+
+    unsigned long long cycles = cycleCounter();
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const AccelSample& sample : samples) {
+            sink += singleSample(sample.x * 0.001f, sample.y * 0.001f, sample.z * 0.001f);
+        }
+    }
+    double singleNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    unsigned long long singleCycles = cycleCounter() - cycles;
+
+    OrientationClassifier classifier;
+    cycles = cycleCounter();
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const AccelSample& sample : samples) {
+            sink += classifier.update(sample);
+        }
+    }
+    double filteredNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    unsigned long long filteredCycles = cycleCounter() - cycles;
+
+    printf("single   %6.2f ns/sample", singleNs / total);
+    if (HAVE_CYCLE_COUNTER) printf("  %6.1f cycles/sample", (double)singleCycles / total);
+    printf("\nfiltered %6.2f ns/sample", filteredNs / total);
+    if (HAVE_CYCLE_COUNTER) printf("  %6.1f cycles/sample", (double)filteredCycles / total);
+    printf("\n");
+}
+
+// --- Nearest-normal kernels against face count ---
+
+static const int LANES = 4;
+typedef float FloatLanes __attribute__((vector_size(LANES * sizeof(float))));
+typedef int32_t IntLanes __attribute__((vector_size(LANES * sizeof(int32_t))));
+
+// Samples split into x, y and z arrays, padded to whole vectors
+struct SampleColumns {
+    std::vector<FloatLanes> x, y, z;
+    size_t count;
+};
+
+static SampleColumns toColumns(const std::vector<AccelSample>& samples) {
+    SampleColumns columns;
+    columns.count = samples.size();
+    size_t vectors = (samples.size() + LANES - 1) / LANES;
+    columns.x.assign(vectors, FloatLanes{});
+    columns.y.assign(vectors, FloatLanes{});
+    columns.z.assign(vectors, FloatLanes{});
+    for (size_t i = 0; i < samples.size(); i++) {
+        columns.x[i / LANES][i % LANES] = samples[i].x;
+        columns.y[i / LANES][i % LANES] = samples[i].y;
+        columns.z[i / LANES][i % LANES] = samples[i].z;
+    }
+    return columns;
+}
+
+// Nearest face for four samples at once: one multiply-add per axis and face per vector
+static void nearestLanes(const float* nx, const float* ny, const float* nz, int faces, const SampleColumns& columns,
+                         std::vector<IntLanes>& out) {
+    for (size_t v = 0; v < columns.x.size(); v++) {
+        FloatLanes x = columns.x[v], y = columns.y[v], z = columns.z[v];
+        FloatLanes best = nx[0] * x + ny[0] * y + nz[0] * z;
+        IntLanes face = {};
+        for (int f = 1; f < faces; f++) {
+            FloatLanes along = nx[f] * x + ny[f] * y + nz[f] * z;
+            IntLanes closer = along > best;
+            best = closer ? along : best;
+            face = closer ? IntLanes{} + f : face;
+        }
+        out[v] = face;
+    }
+}
+
+static void benchFaceCounts(const std::vector<AccelSample>& samples) {
+    const int rounds = 500;
+    const int counts[] = {6, 8, 10, 12};
+    size_t total = samples.size() * rounds;
+    SampleColumns columns = toColumns(samples);
+    std::vector<IntLanes> lanes(columns.x.size());
+
+    printf("faces  fixed-point ns/sample  vector ns/sample  disagreements\n");
+    for (int faces : counts) {
+        const FaceNormal* table = FaceTable::forCount(faces);
+        float nx[12], ny[12], nz[12];
+        for (int f = 0; f < faces; f++) {
+            nx[f] = table[f].x / 16384.0f;
+            ny[f] = table[f].y / 16384.0f;
+            nz[f] = table[f].z / 16384.0f;
+        }
+
+        std::vector<int> fixedFaces(samples.size());
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (size_t i = 0; i < samples.size(); i++) {
+                int32_t v[3] = {samples[i].x, samples[i].y, samples[i].z};
+                int32_t best, second;
+                fixedFaces[i] = FaceTable::nearest(table, faces, v, best, second);
+            }
+            sink += fixedFaces[r % samples.size()];
+        }
+        double fixedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            nearestLanes(nx, ny, nz, faces, columns, lanes);
+            sink += lanes[r % lanes.size()][0];
+        }
+        double vectorNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        // Only near-ties between two faces may round differently
+        int disagreements = 0;
+        for (size_t i = 0; i < samples.size(); i++) {
+            if (lanes[i / LANES][i % LANES] != fixedFaces[i]) disagreements++;
+        }
+        printf("%5d  %21.2f  %16.2f  %13d\n", faces, fixedNs / total, vectorNs / total, disagreements);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::vector<Trace> traces = {deskTrace(), tiltTrace(), knockTrace(), turnTrace()};
+    for (int i = 1; i < argc; i++) {
+        Trace trace;
+        if (!loadCsv(argv[i], trace)) {
+            printf("Cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+        traces.push_back(trace);
+    }
+
+    printf("Orientation decision changes per trace (each one used to reach Toggl)\n");
+    for (const Trace& trace : traces) compare(trace);
+
+    printf("\nClassification cost over the built-in traces (host timings; relative cost only)\n");
+    Trace all = {"all", {}};
+    for (int i = 0; i < 4; i++) all.samples.insert(all.samples.end(), traces[i].samples.begin(), traces[i].samples.end());
+    benchCycles(all);
+
+    printf("\nNearest-normal search against face count (classifier built for %d faces)\n", FACE_COUNT);
+    benchFaceCounts(all.samples);
+    return 0;
+}
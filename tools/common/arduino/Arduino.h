@@ -0,0 +1,68 @@
+// Just enough of the Arduino core to run the sensor-side classes on a host.
+//
+// millis() reads a virtual clock the tool advances itself, so a replay runs
+// as fast as the host allows while the code under test sees device time.
+// Serial output is dropped unless arduino_host::setSerialEcho(true).
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+class String {
+public:
+    String(const char* text = "") : value(text ? text : "") {}
+    explicit String(int number) : value(std::to_string(number)) {}
+    explicit String(unsigned int number) : value(std::to_string(number)) {}
+    explicit String(long number) : value(std::to_string(number)) {}
+    explicit String(unsigned long number) : value(std::to_string(number)) {}
+    const char* c_str() const { return value.c_str(); }
+    unsigned int length() const { return value.size(); }
+    bool operator==(const String& other) const { return value == other.value; }
+    String& operator+=(const String& other) {
+        value += other.value;
+        return *this;
+    }
+    friend String operator+(const String& a, const String& b) {
+        String result(a);
+        result += b;
+        return result;
+    }
+
+private:
+    std::string value;
+};
+
+class HostSerial {
+public:
+    void print(const char* text) { write(text); }
+    void print(const String& text) { write(text.c_str()); }
+    void print(float value);
+    void println() { write("\n"); }
+    template <typename T>
+    void println(const T& value) {
+        print(value);
+        println();
+    }
+    explicit operator bool() const { return true; }
+
+private:
+    void write(const char* text);
+};
+
+extern HostSerial Serial;
+
+unsigned long millis();
+void delay(unsigned long ms);
+
+namespace arduino_host {
+    void setMillis(unsigned long ms);
+    void setSerialEcho(bool echo);
+}
+
+#endif // HOST_ARDUINO_H
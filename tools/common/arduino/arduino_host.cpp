@@ -0,0 +1,32 @@
+#include "Arduino.h"
+
+HostSerial Serial;
+
+static unsigned long clockMs = 0;
+static bool serialEcho = false;
+
+unsigned long millis() {
+    return clockMs;
+}
+
+void delay(unsigned long ms) {
+    clockMs += ms;
+}
+
+void HostSerial::print(float value) {
+    char text[24];
+    snprintf(text, sizeof(text), "%.2f", value);
+    write(text);
+}
+
+void HostSerial::write(const char* text) {
+    if (serialEcho) fputs(text, stderr);
+}
+
+void arduino_host::setMillis(unsigned long ms) {
+    clockMs = ms;
+}
+
+void arduino_host::setSerialEcho(bool echo) {
+    serialEcho = echo;
+}
@@ -0,0 +1,68 @@
+#ifndef HEAP_TRACKER_H
+#define HEAP_TRACKER_H
+
+// Heap accounting for the host benchmarks (glibc): every allocation in the
+// process is routed through these wrappers. Include from exactly one
+// translation unit per benchmark binary.
+
+#include <cstddef>
+#include <malloc.h>
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void __libc_free(void* ptr);
+
+namespace HeapTracker {
+    static bool tracking = false;
+    static long currentHeap = 0;
+    static long peakHeap = 0;
+    static long allocations = 0;
+
+    inline void start() {
+        currentHeap = 0;
+        peakHeap = 0;
+        allocations = 0;
+        tracking = true;
+    }
+
+    inline void stop() { tracking = false; }
+
+    inline void onAlloc(void* ptr) {
+        if (!tracking || !ptr) return;
+        currentHeap += (long)malloc_usable_size(ptr);
+        allocations++;
+        if (currentHeap > peakHeap) peakHeap = currentHeap;
+    }
+
+    inline void onFree(void* ptr) {
+        if (!tracking || !ptr) return;
+        currentHeap -= (long)malloc_usable_size(ptr);
+    }
+}
+
+extern "C" void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    HeapTracker::onAlloc(ptr);
+    return ptr;
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    void* ptr = __libc_calloc(count, size);
+    HeapTracker::onAlloc(ptr);
+    return ptr;
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    HeapTracker::onFree(ptr);
+    void* result = __libc_realloc(ptr, size);
+    HeapTracker::onAlloc(result);
+    return result;
+}
+
+extern "C" void free(void* ptr) {
+    HeapTracker::onFree(ptr);
+    __libc_free(ptr);
+}
+
+#endif // HEAP_TRACKER_H
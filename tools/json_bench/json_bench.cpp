@@ -0,0 +1,91 @@
+// Host benchmark: peak heap and time per parse for Toggl responses.
+//
+// Compares the streaming JsonFieldScanner used by TogglAPI with the old
+// approach of accumulating the body in a string (and, when built with
+// ARDUINOJSON=..., deserializing it into a JsonDocument).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "heap_tracker.h"
+#include "JsonFieldScanner.h"
+#include "TogglResponses.h"
+
+#ifdef WITH_ARDUINOJSON
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 0
+#include <ArduinoJson.h>
+#endif
+
+// --- Parsers under test ---
+
+struct ParseResult {
+    char id[24];
+    char description[64];
+};
+
+static bool parseStreaming(const char* body, ParseResult& out) {
+    JsonFieldScanner scanner;
+    scanner.addField("id", out.id, sizeof(out.id));
+    scanner.addField("description", out.description, sizeof(out.description));
+    // Byte at a time, exactly as AsyncHttpClient hands it over
+    for (const char* p = body; *p; p++) scanner.onBodyByte((uint8_t)*p);
+    return scanner.isFound(0) || scanner.isNull();
+}
+
+static bool parseBuffered(const char* body, ParseResult& out) {
+    // Old path: String responseBody += c for every byte, then parse the copy
+    std::string responseBody;
+    for (const char* p = body; *p; p++) responseBody += *p;
+#ifdef WITH_ARDUINOJSON
+    JsonDocument doc;
+    if (deserializeJson(doc, responseBody)) return false;
+    snprintf(out.id, sizeof(out.id), "%s", doc["id"].as<std::string>().c_str());
+    snprintf(out.description, sizeof(out.description), "%s", doc["description"].as<std::string>().c_str());
+    return true;
+#else
+    out.id[0] = '\0';
+    out.description[0] = '\0';
+    return !responseBody.empty();
+#endif
+}
+
+typedef bool (*Parser)(const char* body, ParseResult& out);
+
+static void bench(const char* name, Parser parser, const char* label, const char* body) {
+    ParseResult result;
+
+    HeapTracker::start();
+    bool ok = parser(body, result);
+    HeapTracker::stop();
+
+    const int iterations = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) parser(body, result);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double nsPerParse = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+    printf("%-10s %-16s %5zu B  peak heap %6ld B in %3ld allocs  %8.0f ns/parse  %s id=%s\n",
+           name, label, strlen(body), HeapTracker::peakHeap, HeapTracker::allocations, nsPerParse, ok ? "ok  " : "FAIL", result.id);
+}
+
+int main() {
+    struct { const char* label; const char* body; } responses[] = {
+        {"start", TOGGL_START_RESPONSE},
+        {"stop", TOGGL_STOP_RESPONSE},
+        {"current", TOGGL_CURRENT_RESPONSE},
+        {"no current", TOGGL_NO_CURRENT_RESPONSE},
+    };
+
+    printf("Toggl response parsing (host timings; relative cost only)\n");
+#ifndef WITH_ARDUINOJSON
+    printf("Buffered path counts body buffering only; build with ARDUINOJSON=<path> to include deserializeJson\n");
+#endif
+    for (auto& response : responses) {
+        bench("streaming", parseStreaming, response.label, response.body);
+        bench("buffered", parseBuffered, response.label, response.body);
+    }
+    return 0;
+}
@@ -0,0 +1,155 @@
+// Host benchmark: cycles and heap allocations per startTimeEntry request.
+//
+// "templates" composes the request exactly as TogglAPI::dispatchStart and
+// AsyncHttpClient::submit do now. "per-call" reproduces the previous path:
+// base64 of the token, workspace id conversion and JSON body on every call,
+// then String concatenation of the request line and headers. std::string
+// stands in for Arduino String; its small string optimisation hides some
+// allocations the device String makes, so per-call counts are a lower bound.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "heap_tracker.h"
+#include "HttpRequestBuffer.h"
+#include "TogglRequestTemplates.h"
+#include "TimeUtils.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static unsigned long long cycleCounter() { return __rdtsc(); }
+#define HAVE_CYCLE_COUNTER 1
+#else
+static unsigned long long cycleCounter() { return 0; }
+#define HAVE_CYCLE_COUNTER 0
+#endif
+
+#ifdef WITH_ARDUINOJSON
+#define ARDUINOJSON_ENABLE_ARDUINO_STRING 0
+#include <ArduinoJson.h>
+#endif
+
+static const char* TOKEN = "1971800d4d82861d8f2c1651fea4d212";
+static const char* WORKSPACE_ID = "1234567";
+static const int PROJECT_IDS[6] = {0, 190000001, 190000002, 190000003, 190000004, 190000005};
+static const char* HOST = "api.track.toggl.com";
+
+// Keeps the optimiser from dropping the composed request
+static volatile size_t sink = 0;
+
+// --- Current path ---
+
+static TogglRequestTemplates templates;
+static HttpRequestBuffer request;
+static char requestBody[TogglRequestTemplates::MAX_BODY_LENGTH];
+
+static bool composeTemplated(int orientationIndex, const char* description) {
+    size_t bodyLength = templates.formatStartBody(orientationIndex, description, 0, -1,
+                                                  requestBody, sizeof(requestBody));
+    if (bodyLength == 0) return false;
+    request.begin("POST", "/api/v9/time_entries", HOST);
+    request.addRaw(templates.headerBlock());
+    request.finish(requestBody, bodyLength);
+    sink += request.length();
+    return !request.overflowed();
+}
+
+// --- Previous path ---
+
+static std::string legacyBase64(const std::string& str) {
+    const char base64_chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded = "";
+    size_t i = 0;
+    unsigned char in3[3];
+    while (i < str.length()) {
+        in3[0] = str[i++];
+        in3[1] = i < str.length() ? str[i++] : 0;
+        in3[2] = i < str.length() ? str[i++] : 0;
+        encoded += base64_chars[(in3[0] & 0xfc) >> 2];
+        encoded += base64_chars[((in3[0] & 0x03) << 4) + ((in3[1] & 0xf0) >> 4)];
+        encoded += base64_chars[((in3[1] & 0x0f) << 2) + ((in3[2] & 0xc0) >> 6)];
+        encoded += base64_chars[in3[2] & 0x3f];
+    }
+    int padding = 3 - (int)(str.length() % 3);
+    if (padding != 3) {
+        for (int j = 0; j < padding; j++) encoded[encoded.length() - 1 - j] = '=';
+    }
+    return encoded;
+}
+
+static std::string legacyBody(int orientationIndex, const std::string& description) {
+    long workspace = std::stol(std::string(WORKSPACE_ID));
+    int projectId = PROJECT_IDS[orientationIndex];
+#ifdef WITH_ARDUINOJSON
+    JsonDocument timeEntry;
+    timeEntry["description"] = description;
+    timeEntry["workspace_id"] = workspace;
+    if (projectId != 0) timeEntry["project_id"] = projectId;
+    timeEntry["duration"] = -1L;
+    timeEntry["created_with"] = "TimeTracker Redux";
+    std::string json;
+    serializeJson(timeEntry, json);
+    return json;
+#else
+    std::string json = "{\"description\":\"" + description + "\",\"workspace_id\":" + std::to_string(workspace);
+    if (projectId != 0) json += ",\"project_id\":" + std::to_string(projectId);
+    json += ",\"duration\":-1,\"created_with\":\"TimeTracker Redux\"}";
+    return json;
+#endif
+}
+
+static bool composeLegacy(int orientationIndex, const char* description) {
+    std::string requestText = std::string("POST ") + "/api/v9/time_entries" + " HTTP/1.1\r\n";
+    requestText += std::string("Host: ") + HOST + "\r\n";
+
+    std::string body = legacyBody(orientationIndex, description);
+    requestText += std::string("Content-Type") + ": " + "application/json" + "\r\n";
+    std::string authorization = "Basic " + legacyBase64(std::string(TOKEN) + ":api_token");
+    requestText += std::string("Authorization") + ": " + authorization + "\r\n";
+    requestText += std::string("Content-Length") + ": " + std::to_string(body.length()) + "\r\n";
+    requestText += "Connection: keep-alive\r\n\r\n";
+    requestText += body;
+    sink += requestText.length();
+    return true;
+}
+
+typedef bool (*Composer)(int orientationIndex, const char* description);
+
+static void bench(const char* name, Composer composer) {
+    // Allocations for a single request after warm-up
+    composer(1, "Deep Work");
+    HeapTracker::start();
+    bool ok = composer(1, "Deep Work");
+    HeapTracker::stop();
+
+    const int iterations = 200000;
+    auto start = std::chrono::steady_clock::now();
+    unsigned long long cycles = cycleCounter();
+    for (int i = 0; i < iterations; i++) composer(1 + i % 5, "Deep Work");
+    cycles = cycleCounter() - cycles;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    double nsPerRequest = std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+
+    printf("%-10s peak heap %5ld B in %3ld allocs  %7.0f ns/request", name,
+           HeapTracker::peakHeap, HeapTracker::allocations, nsPerRequest);
+    if (HAVE_CYCLE_COUNTER) printf("  %7llu cycles/request", cycles / iterations);
+    printf("  %s\n", ok ? "ok" : "FAIL");
+}
+
+int main() {
+    if (!templates.configure(TOKEN, WORKSPACE_ID, PROJECT_IDS)) {
+        printf("Templates do not fit their buffers\n");
+        return 1;
+    }
+
+    printf("Toggl start request composition (host timings; relative cost only)\n");
+#ifndef WITH_ARDUINOJSON
+    printf("Per-call body uses string concatenation; build with ARDUINOJSON=<path> to serialize with ArduinoJson\n");
+#endif
+    bench("templates", composeTemplated);
+    bench("per-call", composeLegacy);
+    return 0;
+}
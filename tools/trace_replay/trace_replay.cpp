@@ -0,0 +1,765 @@
+// Host replay of accelerometer traces through the orientation path.
+//
+// Each trace is fed, on a virtual clock, to the real OrientationDetector
+// (classifier, debounce, FIFO batching) and OrientationCoalescer, driven the
+// way loop() drives them. Reported per trace:
+//
+//   settled    faces the detector reported (the LED follows these)
+//   committed  changes the coalescer passed on (each one reaches Toggl)
+//   flicker    settled faces that match no labelled turn
+//   rejected   candidate faces that did not hold for the debounce time
+//   wakeups    idle -> sampling transitions on the emulated 6D/wake-up interrupts
+//   moving     motion periods, the time in them and classifier changes held meanwhile
+//   still      time at the low-power rate and the estimated sensor current saved
+//   latency    from the first sample at rest on a face to its settle / commit
+//
+// Traces are CSV, "ms,x_mg,y_mg,z_mg,label" per line, '#' lines are comments.
+// The label is the face the cube rests on (up, down, left, right, front, back)
+// or '-' while it moves. Unlabelled traces are replayed and counted, but
+// there is nothing to score them against. Labelled traces fail the run on
+// a missed or spurious commit, which is what `make check` relies on. With
+// the adaptive rate on, labelled traces are also replayed at the full rate
+// throughout; a worst settle latency more than STILL_LATENCY_SLACK_MS above
+// that fails the run as well.
+//
+//   trace_replay [options] trace.csv...
+//   trace_replay decode capture.bin > trace.csv     binary serial capture to CSV
+//   trace_replay synth <kind> > trace.csv           generate a synthetic trace
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include "Config.h"
+#include "OrientationCoalescer.h"
+#include "OrientationClassifier.h"
+#include "OrientationDetector.h"
+#include "TraceFormat.h"
+
+static const char* FACE_LABELS[] = {"up", "down", "left", "right", "front", "back"};
+static const unsigned long REPLAY_START_MS = 1000;
+// Turns are scored against settles/commits up to this long after the next turn
+static const unsigned long MATCH_SLACK_MS = 2000;
+// Worst settle latency the adaptive rate may add over replaying at the full rate. Batches
+// after a step up are not in step with the full-rate ones, which moves a settle by up to a batch
+static const unsigned long STILL_LATENCY_SLACK_MS =
+    (unsigned long)Config::IMU_FIFO_WATERMARK * 1000UL / Config::IMU_FIFO_RATE_HZ;
+
+struct Options {
+    int enterMg = Config::ORIENTATION_ENTER_MG;
+    int exitMg = Config::ORIENTATION_EXIT_MG;
+    unsigned long debounceMs = Config::DEBOUNCE_TIME;
+    unsigned long coalesceMs = Config::ORIENTATION_COALESCE_MS;
+    bool fifo = Config::IMU_FIFO_ENABLED;
+    bool events = Config::IMU_EVENTS_ENABLED;
+    bool adaptive = Config::IMU_ADAPTIVE_RATE;
+};
+
+struct TracePoint {
+    uint32_t ms;
+    AccelSample sample;
+    Orientation label;   // UNKNOWN while moving or unlabelled
+};
+
+struct Trace {
+    std::string name;
+    std::vector<TracePoint> points;
+    bool labelled = false;
+};
+
+// A face reached at a point in time: a labelled turn, a settle or a commit
+struct FaceEvent {
+    unsigned long ms;
+    Orientation face;
+};
+
+// --- Trace files ---
+
+static bool parseLabel(const char* text, Orientation& face) {
+    for (int i = 0; i < 6; i++) {
+        if (strcmp(text, FACE_LABELS[i]) == 0) {
+            face = (Orientation)i;
+            return true;
+        }
+    }
+    face = UNKNOWN;
+    return strcmp(text, "-") == 0;
+}
+
+static bool loadCsv(const char* path, Trace& trace) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    trace.name = path;
+    char line[160];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file)) {
+        lineNumber++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == 'm') continue;   // Comment, blank, header
+        unsigned long ms;
+        int x, y, z;
+        char label[16] = "";
+        int fields = sscanf(line, "%lu,%d,%d,%d,%15[^,\r\n]", &ms, &x, &y, &z, label);
+        TracePoint point = {(uint32_t)ms, {(int16_t)x, (int16_t)y, (int16_t)z}, UNKNOWN};
+        if (fields < 4 || (fields == 5 && !parseLabel(label, point.label))) {
+            fprintf(stderr, "%s:%d: cannot parse \"%s\"\n", path, lineNumber, line);
+            fclose(file);
+            return false;
+        }
+        if (fields == 5) trace.labelled = true;
+        trace.points.push_back(point);
+    }
+    fclose(file);
+    return !trace.points.empty();
+}
+
+static int decodeCapture(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "Cannot read %s\n", path);
+        return 1;
+    }
+    TraceDecoder decoder;
+    TraceRecord record;
+    bool first = true;
+    uint32_t startMs = 0;
+    int byte;
+    printf("# decoded from %s\nms,x_mg,y_mg,z_mg\n", path);
+    while ((byte = fgetc(file)) != EOF) {
+        if (!decoder.feed((uint8_t)byte, record)) continue;
+        if (first) {
+            startMs = record.ms;
+            first = false;
+        }
+        printf("%lu,%d,%d,%d\n", (unsigned long)(record.ms - startMs), record.sample.x, record.sample.y,
+               record.sample.z);
+    }
+    fclose(file);
+    const TraceDecoderStats& stats = decoder.getStats();
+    fprintf(stderr, "%lu samples, %lu time frames, %lu bad frames, %lu bytes of other output skipped\n",
+            stats.samples, stats.timeFrames, stats.badFrames, stats.skippedBytes);
+    return stats.samples > 0 ? 0 : 1;
+}
+
+// --- Replay ---
+
+/**
+ * ImuBackend serving a trace on the virtual clock: samples become available
+ * at their timestamp and queue in a FIFO like the sensor's, or only the newest
+ * is held when the FIFO is off.
+ *
+ * With events, the sensor's engines are approximated on each sample: motion
+ * when any axis moved more than the wake-up threshold since the previous
+ * sample, orientation when the axis beyond 60 degrees from level changes.
+ * In low-power mode the sensor is slower than the trace, so only the first
+ * sample in each period of the low rate is produced.
+ */
+class TraceImu : public ImuBackend {
+public:
+    static const int FIFO_CAPACITY = 64;
+
+    TraceImu(const Trace& source, bool allowFifo, bool allowEvents, bool allowLowPower)
+        : trace(source), hasFifo(allowFifo), hasEvents(allowEvents), hasLowPower(allowLowPower) {}
+
+    bool begin() override {
+        busTransactions++;
+        return true;
+    }
+
+    bool enableFifo(uint16_t, uint16_t) override {
+        if (!hasFifo) return false;
+        busTransactions += 5;
+        fifoEnabled = true;
+        count = 0;
+        return true;
+    }
+
+    // Let the sensor catch up to the trace time elapsed since the replay started
+    void advance(unsigned long elapsedMs) {
+        while (next < trace.points.size() && trace.points[next].ms - trace.points[0].ms <= elapsedMs) {
+            if (lowPower) {
+                unsigned long slot = (unsigned long)(trace.points[next].ms - trace.points[0].ms) * lowPowerRateHz / 1000;
+                if (slot == lastSlot) {
+                    next++;
+                    continue;
+                }
+                lastSlot = slot;
+            }
+            if (!fifoEnabled) {
+                head = 0;
+                count = 0;
+            } else if (count == FIFO_CAPACITY) {
+                head = (head + 1) % FIFO_CAPACITY;
+                count--;
+                overruns++;
+            }
+            const AccelSample& sample = trace.points[next++].sample;
+            if (eventsEnabled) detectEvents(sample);
+            fifo[(head + count) % FIFO_CAPACITY] = sample;
+            count++;
+        }
+    }
+
+    // Fewer samples than the watermark may be left queued, as on the cube
+    bool finished() const { return next == trace.points.size(); }
+
+    int available() override {
+        busTransactions++;
+        return count;
+    }
+
+    int readSamples(AccelSample* samples, int maxSamples) override {
+        int n = maxSamples < count ? maxSamples : count;
+        if (n <= 0) return 0;
+        busTransactions++;
+        for (int i = 0; i < n; i++) {
+            samples[i] = fifo[head];
+            head = (head + 1) % FIFO_CAPACITY;
+        }
+        count -= n;
+        return n;
+    }
+
+    bool takeOverrun() override {
+        bool result = overruns > 0;
+        overruns = 0;
+        return result;
+    }
+
+    bool enableEvents(uint16_t thresholdMg) override {
+        if (!hasEvents) return false;
+        busTransactions += 7;
+        eventsEnabled = true;
+        wakeThresholdMg = thresholdMg;
+        return true;
+    }
+
+    bool eventPending() override { return latched != 0; }
+
+    bool setLowPower(bool enabled, uint16_t rateHz) override {
+        if (!hasLowPower) return false;
+        busTransactions += fifoEnabled ? 5 : 4;
+        lowPower = enabled;
+        lowPowerRateHz = rateHz;
+        lastSlot = (unsigned long)-1;
+        return true;
+    }
+
+    uint8_t takeEvents() override {
+        busTransactions++;
+        uint8_t events = latched;
+        latched = 0;
+        return events;
+    }
+
+private:
+    const Trace& trace;
+    bool hasFifo;
+    bool fifoEnabled = false;
+    size_t next = 0;
+    AccelSample fifo[FIFO_CAPACITY];
+    int head = 0;
+    int count = 0;
+    int overruns = 0;
+    bool hasEvents;
+    bool eventsEnabled = false;
+    int wakeThresholdMg = 0;
+    uint8_t latched = 0;
+    bool havePrevious = false;
+    AccelSample previous = {0, 0, 0};
+    int sixD = -1;
+    bool hasLowPower;
+    bool lowPower = false;
+    uint16_t lowPowerRateHz = 0;
+    unsigned long lastSlot = (unsigned long)-1;
+
+    void detectEvents(const AccelSample& sample) {
+        const int16_t axes[3] = {sample.x, sample.y, sample.z};
+        const int16_t before[3] = {previous.x, previous.y, previous.z};
+        int face = -1;
+        for (int i = 0; i < 3; i++) {
+            if (havePrevious && abs(axes[i] - before[i]) > wakeThresholdMg) latched |= IMU_EVENT_MOTION;
+            if (abs(axes[i]) > 866) face = i * 2 + (axes[i] < 0);   // sin(60 deg)
+        }
+        if (face >= 0 && face != sixD) {
+            if (sixD >= 0) latched |= IMU_EVENT_ORIENTATION;
+            sixD = face;
+        }
+        previous = sample;
+        havePrevious = true;
+    }
+};
+
+struct ReplayResult {
+    std::vector<FaceEvent> turns;      // From the labels
+    std::vector<FaceEvent> settles;
+    std::vector<FaceEvent> commits;    // At the time the coalescer released them
+    unsigned long durationMs = 0;
+    unsigned long busTransactions = 0;
+    unsigned long rejected = 0;
+    bool eventDriven = false;
+    unsigned long wakeups = 0;
+    unsigned long awakeMs = 0;
+    unsigned long replayMs = 0;        // Including the tail after the last sample
+    MotionStats motion = {0, 0, 0, 0};
+    bool adaptive = false;
+    unsigned long stepsDown = 0;
+    unsigned long activeMs = 0;
+    unsigned long stillMs = 0;
+};
+
+static std::vector<FaceEvent> labelledTurns(const Trace& trace) {
+    std::vector<FaceEvent> turns;
+    Orientation resting = UNKNOWN;
+    for (const TracePoint& point : trace.points) {
+        if (point.label == UNKNOWN || point.label == resting) continue;
+        resting = point.label;
+        turns.push_back({point.ms - trace.points[0].ms, resting});
+    }
+    return turns;
+}
+
+static ReplayResult replay(const Trace& trace, const Options& options) {
+    ReplayResult result;
+    result.turns = labelledTurns(trace);
+
+    arduino_host::setMillis(REPLAY_START_MS);
+    TraceImu imu(trace, options.fifo, options.events, options.adaptive);
+    OrientationDetector detector(imu, Config::ORIENTATION_THRESHOLD, options.debounceMs);
+    OrientationCoalescer coalescer(options.coalesceMs);
+    detector.setHysteresis(options.enterMg, options.exitMg);
+    detector.begin();
+
+    // Keep looping after the last sample until a held change has had its window
+    unsigned long tailMs = options.coalesceMs + options.debounceMs + Config::MAIN_LOOP_DELAY;
+    unsigned long drainedAt = 0;
+    bool drained = false;
+    while (!drained || millis() - drainedAt < tailMs) {
+        unsigned long elapsed = millis() - REPLAY_START_MS;
+        imu.advance(elapsed);
+
+        float x, y, z;
+        if (detector.readAcceleration(x, y, z)) {
+            Orientation face = detector.getClassifiedOrientation();
+            if (detector.hasOrientationChanged(face)) {
+                detector.updateOrientation(face);
+                coalescer.offer(face, millis());
+                result.settles.push_back({elapsed, face});
+            }
+        }
+        OrientationChange change;
+        if (!detector.isMoving() && coalescer.poll(millis(), change)) {
+            result.commits.push_back({elapsed, change.to});
+        }
+
+        if (!drained && imu.finished()) {
+            drained = true;
+            drainedAt = millis();
+        }
+        delay(Config::MAIN_LOOP_DELAY);
+    }
+    result.durationMs = trace.points.back().ms - trace.points[0].ms;
+    result.busTransactions = imu.getBusTransactions();
+    result.rejected = detector.getDebouncerStats().rejected;
+    result.eventDriven = detector.isEventDriven();
+    result.wakeups = detector.getWakeStats().wakeups;
+    result.awakeMs = detector.getAwakeMs();
+    result.replayMs = millis() - REPLAY_START_MS;
+    result.motion = detector.getMotionStats();
+    result.adaptive = detector.isAdaptiveRate();
+    result.stepsDown = detector.getRateStats().stepsDown;
+    result.activeMs = detector.getActiveRateMs();
+    result.stillMs = detector.getStillRateMs();
+    return result;
+}
+
+// --- Scoring ---
+
+struct Score {
+    int turns = 0;
+    int matchedSettles = 0;
+    int matchedCommits = 0;
+    int missed = 0;
+    int spurious = 0;
+    int flicker = 0;
+    std::vector<unsigned long> settleLatency;
+    std::vector<unsigned long> commitLatency;
+};
+
+// Pair each turn with the first event to its face between the turn and the next one
+static int matchTurns(const std::vector<FaceEvent>& turns, const std::vector<FaceEvent>& events,
+                      unsigned long graceMs, std::vector<unsigned long>& latencies) {
+    std::vector<bool> used(events.size(), false);
+    int matched = 0;
+    for (size_t k = 0; k < turns.size(); k++) {
+        unsigned long until = k + 1 < turns.size() ? turns[k + 1].ms + graceMs : (unsigned long)-1;
+        for (size_t i = 0; i < events.size(); i++) {
+            if (used[i] || events[i].face != turns[k].face) continue;
+            if (events[i].ms < turns[k].ms || events[i].ms >= until) continue;
+            used[i] = true;
+            latencies.push_back(events[i].ms - turns[k].ms);
+            matched++;
+            break;
+        }
+    }
+    return matched;
+}
+
+static Score score(const ReplayResult& result, const Options& options) {
+    Score s;
+    s.turns = result.turns.size();
+    s.matchedSettles = matchTurns(result.turns, result.settles, options.debounceMs + MATCH_SLACK_MS,
+                                  s.settleLatency);
+    s.matchedCommits = matchTurns(result.turns, result.commits,
+                                  options.debounceMs + options.coalesceMs + MATCH_SLACK_MS, s.commitLatency);
+    s.missed = s.turns - s.matchedCommits;
+    s.spurious = (int)result.commits.size() - s.matchedCommits;
+    s.flicker = (int)result.settles.size() - s.matchedSettles;
+    return s;
+}
+
+static long meanLatency(const std::vector<unsigned long>& latencies) {
+    unsigned long sum = 0;
+    for (unsigned long latency : latencies) sum += latency;
+    return latencies.empty() ? 0 : (long)(sum / latencies.size());
+}
+
+static long worstLatency(const std::vector<unsigned long>& latencies) {
+    unsigned long worst = 0;
+    for (unsigned long latency : latencies) {
+        if (latency > worst) worst = latency;
+    }
+    return (long)worst;
+}
+
+static void printLatency(const char* what, const std::vector<unsigned long>& latencies) {
+    if (latencies.empty()) {
+        printf("  %s latency      -\n", what);
+        return;
+    }
+    unsigned long sum = 0, worst = 0;
+    for (unsigned long latency : latencies) {
+        sum += latency;
+        if (latency > worst) worst = latency;
+    }
+    printf("  %s latency  mean %5lu ms  max %5lu ms\n", what, sum / latencies.size(), worst);
+}
+
+static void printActivity(const ReplayResult& result) {
+    printf("  moving %lu times, %.1f s  held %lu readings\n", result.motion.periods, result.motion.movingMs / 1000.0,
+           result.motion.heldReadings);
+    if (result.adaptive) {
+        // Estimated as the device is built: with taps on, the still rate is the tap engine's
+        unsigned long totalMs = result.activeMs + result.stillMs;
+        unsigned long stillUa = ImuRateGovernor::stillCurrentUa(Config::IMU_TAPS_ENABLED);
+        printf("  still %.1f%% of the time, %lu steps down  sensor ~%lu uA (%d%% saved%s)\n",
+               totalMs ? result.stillMs * 100.0 / totalMs : 0.0, result.stepsDown,
+               ImuRateGovernor::averageCurrentUa(result.activeMs, result.stillMs, stillUa),
+               ImuRateGovernor::savingPercent(result.activeMs, result.stillMs, stillUa),
+               Config::IMU_TAPS_ENABLED ? ", taps on" : "");
+    }
+    if (!result.eventDriven) return;
+    printf("  wakeups %lu (%.0f/h)  sampling %.1f%% of the time\n", result.wakeups,
+           result.wakeups * 3600000.0 / result.replayMs, result.awakeMs * 100.0 / result.replayMs);
+}
+
+// --- Classifier throughput ---
+
+static volatile int sink = 0;
+
+static void benchClassifier(const std::vector<Trace>& traces, const Options& options) {
+    size_t total = 0;
+    for (const Trace& trace : traces) total += trace.points.size();
+    if (total == 0) return;
+    int rounds = (int)(2000000 / total) + 1;
+
+    OrientationClassifier classifier(options.enterMg, options.exitMg);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (const Trace& trace : traces) {
+            for (const TracePoint& point : trace.points) sink += classifier.update(point.sample);
+        }
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    double perSample = ns / ((double)total * rounds);
+    printf("\nClassifier throughput: %.1f ns/sample, %.1f M samples/s (host; compare runs, not devices)\n",
+           perSample, 1000.0 / perSample);
+}
+
+// --- Synthetic traces ---
+//
+// Stand-ins until recorded captures are checked in: gravity along the resting
+// face, sensor noise, and turns interpolated between faces at 26 Hz.
+
+static const int SYNTH_RATE_HZ = 26;
+static unsigned int noiseState = 1;
+
+static int noise(int amplitude) {
+    noiseState = noiseState * 1103515245u + 12345u;
+    return (int)((noiseState >> 16) % (2 * amplitude + 1)) - amplitude;
+}
+
+static void gravity(Orientation face, float v[3]) {
+    static const int AXIS[] = {2, 2, 0, 0, 1, 1};
+    static const float SIGN[] = {1, -1, -1, 1, 1, -1};
+    v[0] = v[1] = v[2] = 0;
+    v[AXIS[face]] = SIGN[face];
+}
+
+class Synth {
+public:
+    void rest(Orientation face, float seconds, int noiseMg = 20) {
+        hold(face, seconds, noiseMg, face);
+    }
+
+    // A stop too short to count as resting there
+    void pause(Orientation face, float seconds) {
+        hold(face, seconds, 60, UNKNOWN);
+    }
+
+    // Rest tipped from one face towards another by angleDeg, swaying by swayDeg
+    void lean(Orientation from, Orientation towards, float angleDeg, float swayDeg, float seconds,
+              Orientation label) {
+        for (int i = 0; i < seconds * SYNTH_RATE_HZ; i++) {
+            float angle = angleDeg + swayDeg * sinf(i * 0.21f);
+            emitBetween(from, towards, angle / 90.0f, 30, label);
+        }
+    }
+
+    // Quarter turn to an adjacent face
+    void turn(Orientation from, Orientation to, float seconds) {
+        tip(from, to, 0.0f, 1.0f, seconds);
+    }
+
+    // Part of a quarter turn, from and to given as fractions of it
+    void tip(Orientation from, Orientation to, float startFraction, float endFraction, float seconds) {
+        int steps = (int)(seconds * SYNTH_RATE_HZ);
+        for (int i = 1; i <= steps; i++) {
+            float fraction = startFraction + (endFraction - startFraction) * i / steps;
+            emitBetween(from, to, fraction, 80, UNKNOWN);
+        }
+    }
+
+    // Lifted off the desk and shaken about, roughly keeping a face down
+    void handle(Orientation face, float seconds) {
+        float v[3];
+        gravity(face, v);
+        for (int i = 0; i < seconds * SYNTH_RATE_HZ; i++) {
+            float shaken[3] = {v[0] + 0.4f * sinf(i * 0.9f), v[1] + 0.3f * cosf(i * 1.3f), v[2]};
+            emit(shaken, 150, UNKNOWN);
+        }
+    }
+
+    // One sample jolted sideways, as from a knock on the desk
+    void knock(Orientation label) {
+        float v[3] = {1.2f, 0.3f, 0.2f};
+        emit(v, 100, label);
+    }
+
+    void print(const char* description) const {
+        printf("# synthetic: %s\n# generated by trace_replay synth, not a recording\nms,x_mg,y_mg,z_mg,label\n",
+               description);
+        for (size_t i = 0; i < points.size(); i++) {
+            const TracePoint& p = points[i];
+            printf("%lu,%d,%d,%d,%s\n", (unsigned long)p.ms, p.sample.x, p.sample.y, p.sample.z,
+                   p.label == UNKNOWN ? "-" : FACE_LABELS[p.label]);
+        }
+    }
+
+private:
+    std::vector<TracePoint> points;
+
+    void hold(Orientation face, float seconds, int noiseMg, Orientation label) {
+        float v[3];
+        gravity(face, v);
+        for (int i = 0; i < seconds * SYNTH_RATE_HZ; i++) emit(v, noiseMg, label);
+    }
+
+    void emitBetween(Orientation from, Orientation to, float fraction, int noiseMg, Orientation label) {
+        float a[3], b[3], v[3];
+        gravity(from, a);
+        gravity(to, b);
+        float radians = fraction * 1.5707963f;
+        for (int i = 0; i < 3; i++) v[i] = a[i] * cosf(radians) + b[i] * sinf(radians);
+        emit(v, noiseMg, label);
+    }
+
+    void emit(const float v[3], int noiseMg, Orientation label) {
+        TracePoint point;
+        point.ms = (uint32_t)(points.size() * 1000 / SYNTH_RATE_HZ);
+        point.sample.x = (int16_t)lroundf(v[0] * 1000.0f) + noise(noiseMg);
+        point.sample.y = (int16_t)lroundf(v[1] * 1000.0f) + noise(noiseMg);
+        point.sample.z = (int16_t)lroundf(v[2] * 1000.0f) + noise(noiseMg);
+        point.label = label;
+        points.push_back(point);
+    }
+};
+
+static int synth(const char* kind) {
+    Synth s;
+    if (strcmp(kind, "desk") == 0) {
+        // Face down through a minute of typing next to it
+        for (int i = 0; i < 30; i++) {
+            s.rest(FACE_DOWN, 1.9f, 25);
+            s.knock(FACE_DOWN);
+        }
+        s.print("face down for a minute, a knock every 2 s");
+    } else if (strcmp(kind, "turns") == 0) {
+        // Down -> left -> up -> right -> down, resting 12 s on each
+        const Orientation faces[] = {FACE_DOWN, LEFT_SIDE, FACE_UP, RIGHT_SIDE, FACE_DOWN};
+        for (int i = 0; i < 5; i++) {
+            s.rest(faces[i], 12.0f);
+            if (i < 4) s.turn(faces[i], faces[i + 1], 0.6f);
+        }
+        s.print("four deliberate quarter turns, 12 s rest on each face");
+    } else if (strcmp(kind, "tilt45") == 0) {
+        // Propped against something half way between two faces, then set down on the second
+        s.rest(FACE_DOWN, 10.0f);
+        s.tip(FACE_DOWN, LEFT_SIDE, 0.0f, 0.5f, 0.3f);
+        s.lean(FACE_DOWN, LEFT_SIDE, 45.0f, 6.0f, 30.0f, UNKNOWN);
+        s.tip(FACE_DOWN, LEFT_SIDE, 0.5f, 1.0f, 0.3f);
+        s.rest(LEFT_SIDE, 15.0f);
+        s.print("face down, 30 s leaning near 45 deg, then left side");
+    } else if (strcmp(kind, "pickup") == 0) {
+        // Picked up, looked at and put back the same way: no change should be sent
+        s.rest(FRONT_EDGE, 10.0f);
+        s.handle(FRONT_EDGE, 3.0f);
+        s.turn(FRONT_EDGE, FACE_UP, 0.4f);
+        s.pause(FACE_UP, 1.5f);
+        s.turn(FACE_UP, FRONT_EDGE, 0.4f);
+        s.rest(FRONT_EDGE, 15.0f);
+        s.print("front edge, picked up and briefly face up, put back on the front edge");
+    } else if (strcmp(kind, "roll") == 0) {
+        // Rolled over three faces in a couple of seconds: only the last one counts
+        s.rest(BACK_EDGE, 10.0f);
+        s.turn(BACK_EDGE, FACE_DOWN, 0.4f);
+        s.pause(FACE_DOWN, 0.6f);
+        s.turn(FACE_DOWN, FRONT_EDGE, 0.4f);
+        s.pause(FRONT_EDGE, 0.6f);
+        s.turn(FRONT_EDGE, FACE_UP, 0.4f);
+        s.rest(FACE_UP, 15.0f);
+        s.print("back edge, rolled over down and front within 2 s, ends face up");
+    } else {
+        fprintf(stderr, "Unknown synthetic trace \"%s\" (desk, turns, tilt45, pickup, roll)\n", kind);
+        return 1;
+    }
+    return 0;
+}
+
+// --- Main ---
+
+static void usage() {
+    fprintf(stderr,
+            "usage: trace_replay [--enter MG] [--exit MG] [--debounce MS] [--coalesce MS] [--polling]\n"
+            "                    [--no-events] [--fixed-rate] [--verbose] trace.csv...\n"
+            "       trace_replay decode capture.bin\n"
+            "       trace_replay synth desk|turns|tilt45|pickup|roll\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 2 && strcmp(argv[1], "decode") == 0) {
+        if (argc != 3) {
+            usage();
+            return 2;
+        }
+        return decodeCapture(argv[2]);
+    }
+    if (argc >= 2 && strcmp(argv[1], "synth") == 0) {
+        if (argc != 3) {
+            usage();
+            return 2;
+        }
+        return synth(argv[2]);
+    }
+
+    Options options;
+    std::vector<Trace> traces;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--enter") == 0 && hasValue) {
+            options.enterMg = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--exit") == 0 && hasValue) {
+            options.exitMg = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--debounce") == 0 && hasValue) {
+            options.debounceMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--coalesce") == 0 && hasValue) {
+            options.coalesceMs = strtoul(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--polling") == 0) {
+            options.fifo = false;
+        } else if (strcmp(argv[i], "--no-events") == 0) {
+            options.events = false;
+        } else if (strcmp(argv[i], "--fixed-rate") == 0) {
+            options.adaptive = false;
+        } else if (strcmp(argv[i], "--verbose") == 0) {
+            arduino_host::setSerialEcho(true);
+        } else if (argv[i][0] == '-') {
+            usage();
+            return 2;
+        } else {
+            Trace trace;
+            if (!loadCsv(argv[i], trace)) {
+                fprintf(stderr, "Cannot read trace %s\n", argv[i]);
+                return 2;
+            }
+            traces.push_back(trace);
+        }
+    }
+    if (traces.empty()) {
+        usage();
+        return 2;
+    }
+
+    printf("enter %d mg, exit %d mg, debounce %lu ms, coalesce %lu ms, %s, %s, %s\n\n", options.enterMg,
+           options.exitMg, options.debounceMs, options.coalesceMs, options.fifo ? "FIFO batches" : "polling",
+           options.events ? "interrupt wakeups" : "continuous sampling",
+           options.adaptive ? "adaptive rate" : "full rate");
+
+    int failures = 0;
+    for (const Trace& trace : traces) {
+        ReplayResult result = replay(trace, options);
+        Score s = score(result, options);
+        printf("%s: %zu samples over %.1f s, %lu bus transactions\n", trace.name.c_str(), trace.points.size(),
+               result.durationMs / 1000.0, result.busTransactions);
+        if (!trace.labelled) {
+            printf("  settled %zu  committed %zu  rejected %lu  (unlabelled, not scored)\n", result.settles.size(),
+                   result.commits.size(), result.rejected);
+            printActivity(result);
+            printf("\n");
+            continue;
+        }
+        bool failed = s.missed > 0 || s.spurious > 0;
+        // The adaptive rate must not delay a settle beyond the slack
+        long addedMeanMs = 0, addedWorstMs = 0;
+        if (result.adaptive) {
+            Options fullRate = options;
+            fullRate.adaptive = false;
+            Score reference = score(replay(trace, fullRate), fullRate);
+            addedMeanMs = meanLatency(s.settleLatency) - meanLatency(reference.settleLatency);
+            addedWorstMs = worstLatency(s.settleLatency) - worstLatency(reference.settleLatency);
+            if (addedWorstMs > (long)STILL_LATENCY_SLACK_MS) failed = true;
+        }
+        printf("  turns %d  settled %zu  committed %zu  missed %d  spurious %d  flicker %d  rejected %lu%s\n",
+               s.turns, result.settles.size(), result.commits.size(), s.missed, s.spurious, s.flicker,
+               result.rejected, failed ? "  FAIL" : "");
+        printLatency("settle", s.settleLatency);
+        printLatency("commit", s.commitLatency);
+        if (result.adaptive) {
+            printf("  settle latency vs full rate  mean %+ld ms  max %+ld ms (up to %+ld allowed)%s\n", addedMeanMs,
+                   addedWorstMs, (long)STILL_LATENCY_SLACK_MS, addedWorstMs > (long)STILL_LATENCY_SLACK_MS ? "  FAIL" : "");
+        }
+        printActivity(result);
+        printf("\n");
+        if (failed) failures++;
+    }
+
+    benchClassifier(traces, options);
+    if (failures > 0) {
+        printf("%d of %zu traces committed the wrong changes or settled late\n", failures, traces.size());
+        return 1;
+    }
+    return 0;
+}